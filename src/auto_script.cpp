@@ -11,12 +11,15 @@
 
 #ifndef HAS_PRECOMPILED_STD_HEADERS
 #  include <ctime>
+#  include <cmath>
 #  include <csignal>
 #  include <map>
+#  include <memory>
 #  include <vector>
 #  include <string>
 #  include <fstream>
 #  include <iostream>
+#  include <algorithm>
 #  include <stdexcept>
 #endif
 
@@ -30,6 +33,8 @@
 #include "utilities.h"
 #include "ciyam_base.h"
 #include "class_base.h"
+#include "thread_pool.h"
+#include "timer_wheel.h"
 #include "ciyam_session.h"
 
 //#define DEBUG
@@ -63,6 +68,16 @@ const int c_min_cycle_seconds_for_logging = 3600;
 // FUTURE: This value should probably be allowed to be overidden by a configuration option.
 const size_t c_max_reschedule_attempts = 15000;
 
+// NOTE: The autoscript session sleeps until the next script is due (or until it is notified about
+// a schedule change or shutdown) but never for longer than this (so that a change to the system
+// clock cannot result in it sleeping for much longer than had been intended).
+const unsigned long c_max_wait_msecs = 60000;
+
+// NOTE: If scripts can be reconfigured then the autoscript file's modification time is checked
+// this often (as it can be changed externally) and when changed it will be read after waiting
+// for this same period (to try and make sure it is not being read during an update).
+const unsigned long c_reconfig_check_msecs = 1000;
+
 enum exclude_type
 {
    e_exclude_type_none,
@@ -79,7 +94,7 @@ enum exclude_type
 
 struct script_info
 {
-   script_info( ) : last_mod( 0 ), exclude( e_exclude_type_none ), allow_late_exec( false ) { }
+   script_info( ) : last_mod( 0 ), exclude( e_exclude_type_none ), allow_late_exec( false ), is_scheduled( false ) { }
 
    string name;
 
@@ -100,20 +115,119 @@ struct script_info
    exclude_type exclude;
 
    bool allow_late_exec;
+
+   bool is_scheduled;
+   date_time next_due;
+};
+
+// NOTE: Statistics are kept by script name (so are retained if the scripts are re-read) and a
+// script is "pending" from when it has been queued until it has finished executing (with it not
+// being queued again if it is due during this time but instead being counted as an "overrun").
+// If there are no script workers then scripts are executed asynchronously so are never pending
+// and their durations are not known.
+struct script_stats
+{
+   script_stats( )
+    :
+    is_pending( false ),
+    num_runs( 0 ),
+    num_overruns( 0 ),
+    total_latency( 0 ),
+    max_latency( 0 ),
+    last_duration( 0 ),
+    max_duration( 0 )
+   {
+   }
+
+   bool is_pending;
+
+   size_t num_runs;
+   size_t num_overruns;
+
+   milliseconds total_latency;
+   milliseconds max_latency;
+
+   milliseconds last_duration;
+   milliseconds max_duration;
 };
 
 mutex g_mutex;
 
+condition g_schedule_condition;
+
 bool g_has_read = false;
+bool g_stop_requested = false;
+bool g_schedule_changed = false;
 
 time_t g_scripts_mod = 0;
 
 vector< script_info > g_scripts;
 
-typedef multimap< date_time, int > script_schedule_container;
-typedef script_schedule_container::const_iterator script_schedule_const_iterator;
+date_time g_wheel_base;
+timer_wheel< size_t > g_timer_wheel;
+
+size_t g_num_script_workers = 0;
+
+size_t g_num_busy_scripts = 0;
+size_t g_num_queued_scripts = 0;
+
+map< string, script_stats > g_script_stats;
+
+// NOTE: Must be called with "g_mutex" held.
+void record_script_start( script_stats& stats, const date_time& due )
+{
+   milliseconds latency = ( milliseconds )( ( date_time::local( ) - due ) * 1000.0 );
+
+   if( latency < 0 )
+      latency = 0;
+
+   ++stats.num_runs;
+
+   stats.total_latency += latency;
+   stats.max_latency = max( stats.max_latency, latency );
+}
+
+class script_job : public thread_pool_job
+{
+   public:
+   script_job( const string& name, const string& cmd_and_args, const date_time& due, bool is_script )
+    :
+    name( name ),
+    cmd_and_args( cmd_and_args ),
+    due( due ),
+    is_script( is_script )
+   {
+   }
 
-script_schedule_container g_script_schedule;
+   void run( );
+
+   private:
+   string name;
+   string cmd_and_args;
+
+   date_time due;
+
+   bool is_script;
+};
+
+uint64_t get_tick( const date_time& dt, bool round_up = false )
+{
+   seconds secs( dt - g_wheel_base );
+
+   if( secs <= 0.0 )
+      return 0;
+
+   return ( uint64_t )( round_up ? ceil( secs ) : floor( secs ) );
+}
+
+void schedule_script( size_t num, const date_time& due )
+{
+   g_scripts[ num ].next_due = due;
+   g_scripts[ num ].is_scheduled = true;
+
+   if( due != date_time::maximum( ) )
+      g_timer_wheel.add( num, get_tick( due, true ) );
+}
 
 void read_script_info( )
 {
@@ -131,7 +245,9 @@ void read_script_info( )
       }
 
       g_scripts.clear( );
-      g_script_schedule.clear( );
+
+      g_wheel_base = date_time::local( );
+      g_timer_wheel.clear( 0 );
 
       if( file_exists( c_autoscript_file ) )
       {
@@ -220,7 +336,7 @@ void read_script_info( )
              date_time( udate::local( ), g_scripts[ i ].start_time ),
              date_time( g_scripts[ i ].start_date, g_scripts[ i ].start_time ) );
 
-            g_script_schedule.insert( make_pair( starts_at, i ) );
+            schedule_script( i, starts_at );
          }
       }
    }
@@ -315,19 +431,115 @@ bool scripts_file_has_changed( )
 
 }
 
-void output_schedule( ostream& os )
+void output_schedule( ostream& os, bool output_stats )
 {
    guard g( g_mutex );
 
-   for( script_schedule_const_iterator ssci = g_script_schedule.begin( ); ssci != g_script_schedule.end( ); ++ssci )
+   vector< pair< date_time, size_t > > schedule;
+
+   for( size_t i = 0; i < g_scripts.size( ); i++ )
    {
-      os << ( ssci->first ).as_string( true, false ) << ' ' << g_scripts[ ssci->second ].name;
+      if( g_scripts[ i ].is_scheduled )
+         schedule.push_back( make_pair( g_scripts[ i ].next_due, i ) );
+   }
+
+   sort( schedule.begin( ), schedule.end( ) );
+
+   for( size_t i = 0; i < schedule.size( ); i++ )
+   {
+      os << ( schedule[ i ].first ).as_string( true, false ) << ' ' << g_scripts[ schedule[ i ].second ].name;
 
-      if( !g_scripts[ ssci->second ].tsfilename.empty( ) )
-         os << " [" << g_scripts[ ssci->second ].tsfilename << "]";
+      if( !g_scripts[ schedule[ i ].second ].tsfilename.empty( ) )
+         os << " [" << g_scripts[ schedule[ i ].second ].tsfilename << "]";
 
       os << '\n';
    }
+
+   if( output_stats )
+   {
+      os << "workers: " << g_num_script_workers << " (busy: "
+       << g_num_busy_scripts << "), queued: " << g_num_queued_scripts << '\n';
+
+      for( map< string, script_stats >::const_iterator ci = g_script_stats.begin( ); ci != g_script_stats.end( ); ++ci )
+      {
+         const script_stats& stats( ci->second );
+
+         os << ci->first << " runs: " << stats.num_runs << ", overruns: " << stats.num_overruns;
+
+         os << ", latency: " << ( stats.num_runs ? stats.total_latency / ( milliseconds )stats.num_runs : 0 )
+          << '/' << stats.max_latency << " ms (avg/max), duration: "
+          << stats.last_duration << '/' << stats.max_duration << " ms (last/max)";
+
+         if( stats.is_pending )
+            os << " *";
+
+         os << '\n';
+      }
+   }
+}
+
+void notify_schedule_changed( )
+{
+   guard g( g_mutex );
+
+   g_schedule_changed = true;
+   g_schedule_condition.notify_one( );
+}
+
+void script_job::run( )
+{
+   // NOTE: Scope for guard object.
+   {
+      guard g( g_mutex );
+
+      --g_num_queued_scripts;
+
+      script_stats& stats( g_script_stats[ name ] );
+
+      // NOTE: Any scripts that are still queued when the session is ending are discarded.
+      if( g_stop_requested )
+      {
+         stats.is_pending = false;
+         return;
+      }
+
+      ++g_num_busy_scripts;
+
+      record_script_start( stats, due );
+   }
+
+   date_time started( date_time::local( ) );
+
+   try
+   {
+#ifdef _WIN32
+      // KLUDGE: For some reason under Windows if multiple scripts need to be run at
+      // around the same time then subsequent execs can fail to work if this delay is
+      // not included.
+      if( is_script )
+         msleep( 250 );
+#endif
+      exec_system( cmd_and_args );
+   }
+   catch( exception& x )
+   {
+      TRACE_LOG( TRACE_ANYTHING, "autoscript '" + name + "' error: " + x.what( ) );
+   }
+   catch( ... )
+   {
+      TRACE_LOG( TRACE_ANYTHING, "autoscript '" + name + "' error: unexpected unknown exception caught" );
+   }
+
+   guard g( g_mutex );
+
+   --g_num_busy_scripts;
+
+   script_stats& stats( g_script_stats[ name ] );
+
+   stats.is_pending = false;
+
+   stats.last_duration = ( milliseconds )( ( date_time::local( ) - started ) * 1000.0 );
+   stats.max_duration = max( stats.max_duration, stats.last_duration );
 }
 
 autoscript_session::autoscript_session( )
@@ -345,8 +557,24 @@ void autoscript_session::on_start( )
 #ifdef DEBUG
    cout << "started autoscript session..." << endl;
 #endif
+   auto_ptr< thread_pool > ap_workers;
+
    try
    {
+      size_t num_workers = get_script_workers( );
+
+      if( num_workers )
+      {
+         ap_workers.reset( new thread_pool( num_workers ) );
+         ap_workers->start( );
+      }
+
+      // NOTE: Scope for guard object.
+      {
+         guard g( g_mutex );
+         g_num_script_workers = num_workers;
+      }
+
       bool changed = false;
       bool script_reconfig( get_script_reconfig( ) );
 
@@ -356,13 +584,10 @@ void autoscript_session::on_start( )
       TRACE_LOG( TRACE_SESSIONS,
        "started autoscript session (tid = " + to_string( current_thread_id( ) ) + ")" );
 
+      vector< size_t > due_scripts;
+
       while( true )
       {
-         msleep( 1000 );
-
-         if( g_server_shutdown )
-            break;
-
          // NOTE: The reading of the autoscript file is delayed by one
          // pass to try and make sure it is not being attempted during
          // an update.
@@ -376,122 +601,173 @@ void autoscript_session::on_start( )
 
          guard g( g_mutex );
 
+         if( g_server_shutdown || g_stop_requested )
+            break;
+
          date_time now = date_time::local( );
-         script_schedule_const_iterator i, j;
 
-         vector< date_time > erase_items;
-         script_schedule_container new_schedule_items;
+         due_scripts.clear( );
+         g_timer_wheel.advance( get_tick( now ), due_scripts );
 
-         i = g_script_schedule.lower_bound( now );
-         for( j = g_script_schedule.begin( ); j != i; ++j )
+         for( size_t i = 0; i < due_scripts.size( ); i++ )
          {
-            if( j->first <= now )
-            {
-               erase_items.push_back( j->first );
+            size_t num = due_scripts[ i ];
+            script_info& info( g_scripts[ num ] );
 
-               date_time next( j->first );
+            date_time next( info.next_due );
 
-               bool okay = true;
-               time_t mod_time = 0;
+            script_stats& stats( g_script_stats[ info.name ] );
 
-               // NOTE: If a script is dependent upon file modification then
-               // check whether the file's modificaton time has been changed.
-               string tsfilename( g_scripts[ j->second ].tsfilename );
-               if( !tsfilename.empty( ) && file_exists( tsfilename ) )
-               {
-                  mod_time = last_modification_time( tsfilename );
+            bool okay = true;
+            time_t mod_time = 0;
 
-                  if( mod_time == g_scripts[ j->second ].last_mod )
-                     okay = false;
-               }
+            // NOTE: If the script is still queued or executing then it will not be queued
+            // again (and if it is dependent upon file modification then this will instead
+            // be checked when the script is next due).
+            if( stats.is_pending )
+            {
+               okay = false;
+               ++stats.num_overruns;
+            }
 
-               if( okay && !is_excluded( g_scripts[ j->second ], now )
-                && ( g_scripts[ j->second ].allow_late_exec || ( now - next <= 1.0 ) ) )
-               {
-                  string filename( g_scripts[ j->second ].filename );
-                  bool is_script = ( filename == c_script_dummy_filename );
+            // NOTE: If a script is dependent upon file modification then
+            // check whether the file's modificaton time has been changed.
+            string tsfilename( info.tsfilename );
+            if( okay && !tsfilename.empty( ) && file_exists( tsfilename ) )
+            {
+               mod_time = last_modification_time( tsfilename );
 
-                  string arguments( process_script_args( g_scripts[ j->second ].arguments ) );
+               if( mod_time == info.last_mod )
+                  okay = false;
+            }
 
-                  int cycle_seconds = g_scripts[ j->second ].cycle_seconds;
+            if( okay && !is_excluded( info, now )
+             && ( info.allow_late_exec || ( now - next <= 1.0 ) ) )
+            {
+               string filename( info.filename );
+               bool is_script = ( filename == c_script_dummy_filename );
 
-                  if( !tsfilename.empty( ) )
-                  {
-                     cycle_seconds = mod_time - g_scripts[ j->second ].last_mod;
+               string arguments( process_script_args( info.arguments ) );
 
-                     if( cycle_seconds < 0 )
-                        cycle_seconds *= -1;
+               int cycle_seconds = info.cycle_seconds;
 
-                     g_scripts[ j->second ].last_mod = mod_time;
-                  }
+               if( !tsfilename.empty( ) )
+               {
+                  cycle_seconds = mod_time - info.last_mod;
 
-                  if( is_script )
-                  {
-                     string script_args( "~" + uuid( ).as_string( ) );
+                  if( cycle_seconds < 0 )
+                     cycle_seconds *= -1;
+
+                  info.last_mod = mod_time;
+               }
+
+               string cmd_and_args;
 
-                     ofstream outf( script_args.c_str( ) );
-                     if( !outf )
-                        throw runtime_error( "unable to open '" + script_args + "' for output" );
+               if( is_script )
+               {
+                  string script_args( "~" + uuid( ).as_string( ) );
+
+                  ofstream outf( script_args.c_str( ) );
+                  if( !outf )
+                     throw runtime_error( "unable to open '" + script_args + "' for output" );
 
-                     outf << "<" << arguments << endl;
-                     outf.close( );
+                  outf << "<" << arguments << endl;
+                  outf.close( );
 
-                     // NOTE: Skip logging for any scripts that cycle too frequently.
-                     if( cycle_seconds >= c_min_cycle_seconds_for_logging )
-                        script_args += " " + g_scripts[ j->second ].name;
+                  // NOTE: Skip logging for any scripts that cycle too frequently.
+                  if( cycle_seconds >= c_min_cycle_seconds_for_logging )
+                     script_args += " " + info.name;
 
 #ifdef _WIN32
-                     // KLUDGE: For some reason under Windows if multiple scripts need to be run in
-                     // one pass then subsequent execs can fail to work if this delay is not included.
-                     msleep( 250 );
-                     exec_system( "script " + script_args, true );
+                  cmd_and_args = "script " + script_args;
 #else
-                     exec_system( "./script " + script_args, true );
+                  cmd_and_args = "./script " + script_args;
 #endif
-                  }
-                  else
-                  {
-                     string cmd_and_args( filename );
+               }
+               else
+               {
+                  cmd_and_args = filename;
 
 #ifndef _WIN32
-                     if( cmd_and_args.find( '/' ) == string::npos )
-                        cmd_and_args = "./" + cmd_and_args;
+                  if( cmd_and_args.find( '/' ) == string::npos )
+                     cmd_and_args = "./" + cmd_and_args;
 #endif
 
-                     if( !arguments.empty( ) )
-                        cmd_and_args += " " + arguments;
-
-                     exec_system( cmd_and_args, true );
-                  }
+                  if( !arguments.empty( ) )
+                     cmd_and_args += " " + arguments;
                }
 
-               size_t count = 0;
-               while( next <= now || is_excluded( g_scripts[ j->second ], next ) )
+               if( ap_workers.get( ) )
                {
-                  if( ++count >= c_max_reschedule_attempts )
-                  {
-                     TRACE_LOG( TRACE_ANYTHING,
-                      "warning: unable to scheule autoscript '" + g_scripts[ j->second ].name + "'" );
+                  stats.is_pending = true;
+                  ++g_num_queued_scripts;
 
-                     next = date_time::maximum( );
-                     break;
-                  }
+                  ap_workers->queue_job( new script_job( info.name, cmd_and_args, next, is_script ) );
+               }
+               else
+               {
+                  record_script_start( stats, next );
 
-                  next += ( seconds )g_scripts[ j->second ].cycle_seconds;
+#ifdef _WIN32
+                  // KLUDGE: For some reason under Windows if multiple scripts need to be run in
+                  // one pass then subsequent execs can fail to work if this delay is not included.
+                  if( is_script )
+                     msleep( 250 );
+#endif
+                  exec_system( cmd_and_args, true );
                }
+            }
 
-               if( g_scripts[ j->second ].finish_date != udate( )
-                && now.get_date( ) > g_scripts[ j->second ].finish_date )
-                  continue;
+            size_t count = 0;
+            while( next <= now || is_excluded( info, next ) )
+            {
+               if( ++count >= c_max_reschedule_attempts )
+               {
+                  TRACE_LOG( TRACE_ANYTHING,
+                   "warning: unable to scheule autoscript '" + info.name + "'" );
+
+                  next = date_time::maximum( );
+                  break;
+               }
+
+               next += ( seconds )info.cycle_seconds;
+            }
 
-               new_schedule_items.insert( make_pair( next, j->second ) );
+            if( info.finish_date != udate( ) && now.get_date( ) > info.finish_date )
+            {
+               info.is_scheduled = false;
+               continue;
             }
+
+            schedule_script( num, next );
          }
 
-         for( int x = 0; x < erase_items.size( ); x++ )
-            g_script_schedule.erase( erase_items[ x ] );
+         unsigned long wait_msecs = c_max_wait_msecs;
+
+         if( changed || script_reconfig )
+            wait_msecs = c_reconfig_check_msecs;
+
+         if( !g_timer_wheel.empty( ) )
+         {
+            date_time next_due( g_wheel_base );
+            next_due += ( seconds )g_timer_wheel.next_due( );
 
-         g_script_schedule.insert( new_schedule_items.begin( ), new_schedule_items.end( ) );
+            seconds secs( next_due - date_time::local( ) );
+
+            if( secs <= 0.0 )
+               wait_msecs = 1;
+            else if( secs * 1000.0 < wait_msecs )
+               wait_msecs = ( unsigned long )ceil( secs * 1000.0 );
+         }
+
+         if( !g_schedule_changed && !g_stop_requested && !g_server_shutdown )
+            g_schedule_condition.wait( g_mutex, wait_msecs );
+
+         if( g_schedule_changed )
+         {
+            changed = true;
+            g_schedule_changed = false;
+         }
       }
 
       TRACE_LOG( TRACE_SESSIONS, "finished autoscript session" );
@@ -510,6 +786,17 @@ void autoscript_session::on_start( )
 #endif
       TRACE_LOG( TRACE_ANYTHING, "autoscript error: unexpected unknown exception caught" );
    }
+
+   // NOTE: Any scripts that are still queued are discarded but those already executing need
+   // to finish before the session ends (otherwise the server might unload the library while
+   // the workers are still using it).
+   {
+      guard g( g_mutex );
+      g_stop_requested = true;
+   }
+
+   if( ap_workers.get( ) )
+      ap_workers->stop( );
 #ifdef DEBUG
    cout << "finished autoscript session..." << endl;
 #endif
@@ -518,6 +805,21 @@ void autoscript_session::on_start( )
 
 void init_auto_script( )
 {
+   {
+      guard g( g_mutex );
+
+      g_stop_requested = false;
+      g_schedule_changed = false;
+   }
+
    autoscript_session* p_autoscript_session = new autoscript_session;
    p_autoscript_session->start( );
 }
+
+void term_auto_script( )
+{
+   guard g( g_mutex );
+
+   g_stop_requested = true;
+   g_schedule_condition.notify_one( );
+}
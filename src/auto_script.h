@@ -20,7 +20,9 @@
 #     define CIYAM_BASE_DECL_SPEC DYNAMIC_IMPORT
 #  endif
 
-void CIYAM_BASE_DECL_SPEC output_schedule( std::ostream& os );
+void CIYAM_BASE_DECL_SPEC output_schedule( std::ostream& os, bool output_stats = false );
+
+void CIYAM_BASE_DECL_SPEC notify_schedule_changed( );
 
 class CIYAM_BASE_DECL_SPEC autoscript_session : public thread
 {
@@ -35,5 +37,9 @@ extern "C" void CIYAM_BASE_DECL_SPEC init_auto_script( );
 
 typedef void ( *fp_init_auto_script )( );
 
+extern "C" void CIYAM_BASE_DECL_SPEC term_auto_script( );
+
+typedef void ( *fp_term_auto_script )( );
+
 #endif
 
@@ -10,11 +10,24 @@
 #pragma hdrstop
 
 #ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <memory.h>
 #  include <stdexcept>
 #endif
 
 #include "base64.h"
 
+#if defined( __GNUC__ ) && !defined( __clang__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#  if ( __GNUC__ > 4 ) || ( ( __GNUC__ == 4 ) && ( __GNUC_MINOR__ >= 9 ) )
+#     define BASE64_SIMD
+#  endif
+#endif
+
+#ifdef BASE64_SIMD
+#  include <immintrin.h>
+#  define TARGET_SSSE3 __attribute__( ( target( "ssse3" ) ) )
+#  define TARGET_AVX2 __attribute__( ( target( "avx2" ) ) )
+#endif
+
 using namespace std;
 
 namespace
@@ -22,6 +35,8 @@ namespace
 
 const char c_fillchar = '=';
 
+const unsigned char c_invalid_value = 0xff;
+
 const string g_b64_table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
 char get_b64_char_value( char c )
@@ -38,47 +53,363 @@ char get_b64_char_value( char c )
    return c == '+' ? 62 : 63;
 }
 
+struct decode_table
+{
+   decode_table( )
+   {
+      memset( values, c_invalid_value, sizeof( values ) );
+
+      for( size_t i = 0; i < g_b64_table.size( ); i++ )
+         values[ ( unsigned char )g_b64_table[ i ] ] = i;
+   }
+
+   unsigned char operator [ ]( char c ) const { return values[ ( unsigned char )c ]; }
+
+   unsigned char values[ 256 ];
+};
+
+const decode_table g_decode_table;
+
+base64::simd_level determine_max_simd_level( )
+{
+#ifdef BASE64_SIMD
+   __builtin_cpu_init( );
+
+   if( __builtin_cpu_supports( "avx2" ) )
+      return base64::e_simd_level_avx2;
+
+   if( __builtin_cpu_supports( "ssse3" ) )
+      return base64::e_simd_level_ssse3;
+#endif
+   return base64::e_simd_level_none;
 }
 
-void base64::encode( const unsigned char* p_dat, size_t length, char* p_enc, size_t* p_enc_len )
+const base64::simd_level g_max_simd_level = determine_max_simd_level( );
+
+base64::simd_level g_simd_level = g_max_simd_level;
+
+#ifdef BASE64_SIMD
+// NOTE: The SIMD encoding and decoding (and validation) is based upon the approach described by
+// Wojciech Mula and Daniel Lemire in "Faster Base64 Encoding and Decoding using AVX2 Instructions"
+// (with 12 or 24 bytes being encoded and 16 or 32 characters being decoded in each iteration).
+TARGET_SSSE3 inline __m128i encode_ssse3_block( __m128i in )
 {
-   char c;
-   string::size_type i, o = 0;
-   string::size_type len = length;
+   in = _mm_shuffle_epi8( in, _mm_set_epi8( 10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1 ) );
+
+   __m128i t0 = _mm_and_si128( in, _mm_set1_epi32( 0x0fc0fc00 ) );
+   __m128i t1 = _mm_mulhi_epu16( t0, _mm_set1_epi32( 0x04000040 ) );
+   __m128i t2 = _mm_and_si128( in, _mm_set1_epi32( 0x003f03f0 ) );
+   __m128i t3 = _mm_mullo_epi16( t2, _mm_set1_epi32( 0x01000010 ) );
+
+   __m128i indices = _mm_or_si128( t1, t3 );
+
+   __m128i result = _mm_subs_epu8( indices, _mm_set1_epi8( 51 ) );
+   __m128i less = _mm_cmpgt_epi8( _mm_set1_epi8( 26 ), indices );
+
+   result = _mm_or_si128( result, _mm_and_si128( less, _mm_set1_epi8( 13 ) ) );
+
+   __m128i shifts = _mm_setr_epi8( 'a' - 26, '0' - 52, '0' - 52, '0' - 52,
+    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0 );
+
+   result = _mm_shuffle_epi8( shifts, result );
+
+   return _mm_add_epi8( result, indices );
+}
+
+TARGET_SSSE3 size_t encode_ssse3( const unsigned char* p_dat, size_t length, char* p_enc )
+{
+   size_t i = 0;
 
-   for( i = 0; i < len; ++i )
+   // NOTE: Although only 12 bytes are encoded 16 bytes are read.
+   for( ; i + 16 <= length; i += 12 )
    {
-      c = ( p_dat[ i ] >> 2 ) & 0x3f;
-      p_enc[ o++ ] = g_b64_table[ c ];
+      __m128i in = _mm_loadu_si128( ( const __m128i* )( p_dat + i ) );
+      _mm_storeu_si128( ( __m128i* )p_enc, encode_ssse3_block( in ) );
 
-      c = ( p_dat[ i ] << 4 ) & 0x3f;
+      p_enc += 16;
+   }
 
-      if( ++i < len )
-         c |= ( p_dat[ i ] >> 4 ) & 0x0f;
+   return i;
+}
+
+TARGET_AVX2 size_t encode_avx2( const unsigned char* p_dat, size_t length, char* p_enc )
+{
+   size_t i = 0;
+
+   const __m256i shuffle = _mm256_setr_epi8( 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+    1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10 );
+
+   const __m256i shifts = _mm256_setr_epi8( 'a' - 26, '0' - 52, '0' - 52, '0' - 52,
+    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+    'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+    '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0 );
+
+   // NOTE: Although only 24 bytes are encoded 28 bytes are read.
+   for( ; i + 28 <= length; i += 24 )
+   {
+      __m256i in = _mm256_inserti128_si256( _mm256_castsi128_si256(
+       _mm_loadu_si128( ( const __m128i* )( p_dat + i ) ) ), _mm_loadu_si128( ( const __m128i* )( p_dat + i + 12 ) ), 1 );
+
+      in = _mm256_shuffle_epi8( in, shuffle );
+
+      __m256i t0 = _mm256_and_si256( in, _mm256_set1_epi32( 0x0fc0fc00 ) );
+      __m256i t1 = _mm256_mulhi_epu16( t0, _mm256_set1_epi32( 0x04000040 ) );
+      __m256i t2 = _mm256_and_si256( in, _mm256_set1_epi32( 0x003f03f0 ) );
+      __m256i t3 = _mm256_mullo_epi16( t2, _mm256_set1_epi32( 0x01000010 ) );
+
+      __m256i indices = _mm256_or_si256( t1, t3 );
+
+      __m256i result = _mm256_subs_epu8( indices, _mm256_set1_epi8( 51 ) );
+      __m256i less = _mm256_cmpgt_epi8( _mm256_set1_epi8( 26 ), indices );
+
+      result = _mm256_or_si256( result, _mm256_and_si256( less, _mm256_set1_epi8( 13 ) ) );
+      result = _mm256_add_epi8( _mm256_shuffle_epi8( shifts, result ), indices );
+
+      _mm256_storeu_si256( ( __m256i* )p_enc, result );
+
+      p_enc += 32;
+   }
+
+   return i;
+}
+
+// NOTE: Returns false if any of the characters are not valid (padding is treated as invalid).
+TARGET_SSSE3 inline bool decode_ssse3_block( __m128i& in )
+{
+   __m128i higher_nibble = _mm_and_si128( _mm_srli_epi32( in, 4 ), _mm_set1_epi8( 0x0f ) );
+   __m128i lower_nibble = _mm_and_si128( in, _mm_set1_epi8( 0x0f ) );
+
+   __m128i lo = _mm_shuffle_epi8( _mm_setr_epi8( 0x15, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a ), lower_nibble );
+
+   __m128i hi = _mm_shuffle_epi8( _mm_setr_epi8( 0x10, 0x10, 0x01, 0x02, 0x04, 0x08,
+    0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 ), higher_nibble );
+
+   if( _mm_movemask_epi8( _mm_cmpgt_epi8( _mm_and_si128( lo, hi ), _mm_setzero_si128( ) ) ) )
+      return false;
+
+   __m128i eq_2f = _mm_cmpeq_epi8( in, _mm_set1_epi8( 0x2f ) );
+
+   __m128i roll = _mm_shuffle_epi8( _mm_setr_epi8( 0, 16, 19, 4, -65, -65, -71, -71,
+    0, 0, 0, 0, 0, 0, 0, 0 ), _mm_add_epi8( eq_2f, higher_nibble ) );
+
+   in = _mm_add_epi8( in, roll );
+
+   in = _mm_maddubs_epi16( in, _mm_set1_epi32( 0x01400140 ) );
+   in = _mm_madd_epi16( in, _mm_set1_epi32( 0x00011000 ) );
+
+   in = _mm_shuffle_epi8( in, _mm_setr_epi8( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 ) );
+
+   return true;
+}
+
+// NOTE: Each iteration writes 16 bytes (of which 12 are decoded) so a block is only decoded if
+// this cannot exceed the minimum possible decoded length. Decoding stops at the first block that
+// contains an invalid character (or padding) with the number of characters decoded returned.
+TARGET_SSSE3 size_t decode_ssse3( const char* p_enc, size_t length, unsigned char* p_data )
+{
+   size_t i = 0;
+
+   for( ; i + 24 <= length; i += 16 )
+   {
+      __m128i in = _mm_loadu_si128( ( const __m128i* )( p_enc + i ) );
+
+      if( !decode_ssse3_block( in ) )
+         break;
+
+      _mm_storeu_si128( ( __m128i* )p_data, in );
+
+      p_data += 12;
+   }
+
+   return i;
+}
 
-      p_enc[ o++ ] = g_b64_table[ c ];
+TARGET_AVX2 size_t decode_avx2( const char* p_enc, size_t length, unsigned char* p_data )
+{
+   size_t i = 0;
+
+   const __m256i lut_lo = _mm256_setr_epi8( 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a );
+
+   const __m256i lut_hi = _mm256_setr_epi8( 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 );
+
+   const __m256i lut_roll = _mm256_setr_epi8( 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0 );
+
+   const __m256i shuffle = _mm256_setr_epi8( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+    2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 );
+
+   // NOTE: Each iteration writes 32 bytes (of which 24 are decoded).
+   for( ; i + 48 <= length; i += 32 )
+   {
+      __m256i in = _mm256_loadu_si256( ( const __m256i* )( p_enc + i ) );
+
+      __m256i higher_nibble = _mm256_and_si256( _mm256_srli_epi32( in, 4 ), _mm256_set1_epi8( 0x0f ) );
+      __m256i lower_nibble = _mm256_and_si256( in, _mm256_set1_epi8( 0x0f ) );
+
+      __m256i lo = _mm256_shuffle_epi8( lut_lo, lower_nibble );
+      __m256i hi = _mm256_shuffle_epi8( lut_hi, higher_nibble );
+
+      if( _mm256_movemask_epi8( _mm256_cmpgt_epi8( _mm256_and_si256( lo, hi ), _mm256_setzero_si256( ) ) ) )
+         break;
+
+      __m256i eq_2f = _mm256_cmpeq_epi8( in, _mm256_set1_epi8( 0x2f ) );
+
+      in = _mm256_add_epi8( in, _mm256_shuffle_epi8( lut_roll, _mm256_add_epi8( eq_2f, higher_nibble ) ) );
+
+      in = _mm256_maddubs_epi16( in, _mm256_set1_epi32( 0x01400140 ) );
+      in = _mm256_madd_epi16( in, _mm256_set1_epi32( 0x00011000 ) );
+
+      in = _mm256_shuffle_epi8( in, shuffle );
+      in = _mm256_permutevar8x32_epi32( in, _mm256_setr_epi32( 0, 1, 2, 4, 5, 6, 7, 7 ) );
+
+      _mm256_storeu_si256( ( __m256i* )p_data, in );
+
+      p_data += 24;
+   }
+
+   return i;
+}
+
+// NOTE: Returns the number of leading characters (in blocks of 16) that are known to be valid.
+TARGET_SSSE3 size_t valid_prefix_ssse3( const char* p_enc, size_t length )
+{
+   size_t i = 0;
+
+   for( ; i + 16 <= length; i += 16 )
+   {
+      __m128i in = _mm_loadu_si128( ( const __m128i* )( p_enc + i ) );
+
+      if( !decode_ssse3_block( in ) )
+         break;
+   }
+
+   return i;
+}
+#endif
+
+size_t encode_simd( const unsigned char* p_dat, size_t length, char* p_enc )
+{
+   size_t done = 0;
+
+#ifdef BASE64_SIMD
+   if( g_simd_level == base64::e_simd_level_avx2 )
+      done = encode_avx2( p_dat, length, p_enc );
+
+   if( g_simd_level >= base64::e_simd_level_ssse3 )
+      done += encode_ssse3( p_dat + done, length - done, p_enc + ( ( done / 3 ) * 4 ) );
+#endif
+
+   return done;
+}
 
-      if( i < len )
+size_t decode_simd( const char* p_enc, size_t length, unsigned char* p_data )
+{
+   size_t done = 0;
+
+#ifdef BASE64_SIMD
+   if( g_simd_level == base64::e_simd_level_avx2 )
+      done = decode_avx2( p_enc, length, p_data );
+
+   if( g_simd_level >= base64::e_simd_level_ssse3 )
+      done += decode_ssse3( p_enc + done, length - done, p_data + ( ( done / 4 ) * 3 ) );
+#endif
+
+   return done;
+}
+
+size_t valid_prefix( const char* p_enc, size_t length )
+{
+   size_t done = 0;
+
+#ifdef BASE64_SIMD
+   if( g_simd_level >= base64::e_simd_level_ssse3 )
+      done = valid_prefix_ssse3( p_enc, length );
+#endif
+
+   return done;
+}
+
+// NOTE: This is the original decoding (which does not perform any validation) that is now only
+// being used if the input is not valid (in order to keep the behaviour of "decode" unchanged).
+void decode_unvalidated( const string& input, unsigned char* p_data )
+{
+   char c;
+   char c1;
+   string::size_type o = 0;
+   string::size_type len = input.length( );
+
+   for( string::size_type i = 0; i < len; ++i )
+   {
+      c = get_b64_char_value( input[ i ] );
+      ++i;
+
+      c1 = get_b64_char_value( input[ i ] );
+      c = ( c << 2 ) | ( ( c1 >> 4 ) & 0x03 );
+
+      p_data[ o++ ] = c;
+
+      if( ++i < len )
       {
-         c = ( p_dat[ i ] << 2 ) & 0x3f;
-         if( ++i < len )
-            c |= ( p_dat[ i ] >> 6 ) & 0x03;
+         c = input[ i ];
+         if( c == c_fillchar )
+            break;
+
+         c = get_b64_char_value( c );
+         c1 = ( ( c1 << 4 ) & 0xf0 ) | ( ( c >> 2 ) & 0x0f );
 
-         p_enc[ o++ ] = g_b64_table[ c ];
+         p_data[ o++ ] = c1;
       }
-      else
+
+      if( ++i < len )
       {
-         ++i;
-         p_enc[ o++ ] = c_fillchar;
+         c1 = input[ i ];
+         if( c1 == c_fillchar )
+            break;
+
+         c1 = get_b64_char_value( c1 );
+         c = ( ( c << 6 ) & 0xc0 ) | c1;
+
+         p_data[ o++ ] = c;
       }
+   }
+}
 
-      if( i < len )
+}
+
+void base64::encode( const unsigned char* p_dat, size_t length, char* p_enc, size_t* p_enc_len )
+{
+   size_t i = encode_simd( p_dat, length, p_enc );
+   size_t o = ( i / 3 ) * 4;
+
+   for( ; i + 3 <= length; i += 3 )
+   {
+      p_enc[ o++ ] = g_b64_table[ p_dat[ i ] >> 2 ];
+      p_enc[ o++ ] = g_b64_table[ ( ( p_dat[ i ] << 4 ) & 0x30 ) | ( p_dat[ i + 1 ] >> 4 ) ];
+      p_enc[ o++ ] = g_b64_table[ ( ( p_dat[ i + 1 ] << 2 ) & 0x3c ) | ( p_dat[ i + 2 ] >> 6 ) ];
+      p_enc[ o++ ] = g_b64_table[ p_dat[ i + 2 ] & 0x3f ];
+   }
+
+   if( i < length )
+   {
+      p_enc[ o++ ] = g_b64_table[ p_dat[ i ] >> 2 ];
+
+      if( i + 1 < length )
       {
-         c = p_dat[ i ] & 0x3f;
-         p_enc[ o++ ] = g_b64_table[ c ];
+         p_enc[ o++ ] = g_b64_table[ ( ( p_dat[ i ] << 4 ) & 0x30 ) | ( p_dat[ i + 1 ] >> 4 ) ];
+         p_enc[ o++ ] = g_b64_table[ ( p_dat[ i + 1 ] << 2 ) & 0x3c ];
       }
       else
+      {
+         p_enc[ o++ ] = g_b64_table[ ( p_dat[ i ] << 4 ) & 0x30 ];
          p_enc[ o++ ] = c_fillchar;
+      }
+
+      p_enc[ o++ ] = c_fillchar;
    }
 
    if( p_enc_len )
@@ -93,11 +424,14 @@ bool base64::valid_characters( const string& input )
       rc = false;
    else
    {
-      string::size_type pos = input.find_first_not_of( g_b64_table + c_fillchar );
-
-      if( pos != string::npos
-       && ( ( pos < input.size( ) - 2 ) || ( input[ pos ] != c_fillchar ) ) )
-         rc = false;
+      for( size_t i = valid_prefix( input.data( ), input.length( ) ); i < input.length( ); i++ )
+      {
+         if( input[ i ] != c_fillchar && g_decode_table[ input[ i ] ] == c_invalid_value )
+         {
+            rc = false;
+            break;
+         }
+      }
    }
 
    return rc;
@@ -111,26 +445,24 @@ void base64::validate( const string& input, bool* p_rc )
       invalid = true;
    else
    {
-      size_t i;
-      string table( g_b64_table );
+      size_t len = input.length( );
 
-      for( i = 0; i < input.length( ); i++ )
+      for( size_t i = valid_prefix( input.data( ), len - 2 ); i < len - 2; i++ )
       {
-         if( table.find( input[ i ] ) == string::npos )
+         if( g_decode_table[ input[ i ] ] == c_invalid_value )
+         {
+            invalid = true;
             break;
+         }
       }
 
-      if( i < input.length( ) - 2 )
-         invalid = true;
-      else if( i < input.length( ) )
+      if( !invalid )
       {
-         if( input[ i ] != '=' )
-            invalid = true;
-         else if( i == input.length( ) - 2 )
-         {
-            if( input[ i + 1 ] != '=' )
-               invalid = true;
-         }
+         if( input[ len - 2 ] == c_fillchar )
+            invalid = ( input[ len - 1 ] != c_fillchar );
+         else
+            invalid = ( g_decode_table[ input[ len - 2 ] ] == c_invalid_value
+             || ( input[ len - 1 ] != c_fillchar && g_decode_table[ input[ len - 1 ] ] == c_invalid_value ) );
       }
    }
 
@@ -168,45 +500,196 @@ size_t base64::decode( const string& input, unsigned char* p_data, size_t length
       throw runtime_error( "buffer not big enough to decode base64 (given "
        + to_string( length ) + " bytes but need " + to_string( l ) + " bytes)" );
 
-   char c;
-   char c1;
-   string::size_type o = 0;
-   string::size_type len = input.length( );
+   size_t dec_len = 0;
 
-   for( string::size_type i = 0; i < len; ++i )
-   {
-      c = get_b64_char_value( input[ i ] );
-      ++i;
+   // NOTE: As "decode_if_valid" can write up to the maximum decoded size (which is two bytes more
+   // than the minimum for valid input) it is only used if there are not more than two fill chars.
+   if( l + 2 < decode_size( input.length( ) )
+    || !decode_if_valid( input.data( ), input.length( ), p_data, &dec_len ) )
+      decode_unvalidated( input, p_data );
 
-      c1 = get_b64_char_value( input[ i ] );
-      c = ( c << 2 ) | ( ( c1 >> 4 ) & 0x03 );
+   return l;
+}
 
-      p_data[ o++ ] = c;
+bool base64::decode_if_valid( const char* p_enc, size_t length, unsigned char* p_data, size_t* p_dec_len )
+{
+   if( !length || length % 4 != 0 )
+      return false;
 
-      if( ++i < len )
+   size_t i = decode_simd( p_enc, length, p_data );
+   size_t o = ( i / 4 ) * 3;
+
+   for( ; i < length; i += 4 )
+   {
+      unsigned char c0 = g_decode_table[ p_enc[ i ] ];
+      unsigned char c1 = g_decode_table[ p_enc[ i + 1 ] ];
+      unsigned char c2 = g_decode_table[ p_enc[ i + 2 ] ];
+      unsigned char c3 = g_decode_table[ p_enc[ i + 3 ] ];
+
+      if( ( c0 | c1 | c2 | c3 ) == c_invalid_value )
       {
-         c = input[ i ];
-         if( c == c_fillchar )
-            break;
+         // NOTE: Fill chars are only permitted at the end.
+         if( i + 4 != length || c0 == c_invalid_value || c1 == c_invalid_value || p_enc[ i + 3 ] != c_fillchar )
+            return false;
 
-         c = get_b64_char_value( c );
-         c1 = ( ( c1 << 4 ) & 0xf0 ) | ( ( c >> 2 ) & 0x0f );
+         p_data[ o++ ] = ( c0 << 2 ) | ( c1 >> 4 );
 
-         p_data[ o++ ] = c1;
+         if( p_enc[ i + 2 ] != c_fillchar )
+         {
+            if( c2 == c_invalid_value )
+               return false;
+
+            p_data[ o++ ] = ( c1 << 4 ) | ( c2 >> 2 );
+         }
+
+         break;
       }
 
-      if( ++i < len )
-      {
-         c1 = input[ i ];
-         if( c1 == c_fillchar )
-            break;
+      p_data[ o++ ] = ( c0 << 2 ) | ( c1 >> 4 );
+      p_data[ o++ ] = ( c1 << 4 ) | ( c2 >> 2 );
+      p_data[ o++ ] = ( c2 << 6 ) | c3;
+   }
 
-         c1 = get_b64_char_value( c1 );
-         c = ( ( c << 6 ) & 0xc0 ) | c1;
+   if( p_dec_len )
+      *p_dec_len = o;
 
-         p_data[ o++ ] = c;
-      }
+   return true;
+}
+
+string base64::validate_and_decode( const string& input, bool* p_rc )
+{
+   string str( decode_size( input.length( ) ), '\0' );
+
+   size_t dec_len = 0;
+
+   bool okay = decode_if_valid( input.data( ), input.length( ), ( unsigned char* )str.data( ), &dec_len );
+
+   if( p_rc )
+      *p_rc = okay;
+   else if( !okay )
+      throw runtime_error( "invalid base64 value: " + input );
+
+   str.resize( okay ? dec_len : 0 );
+
+   return str;
+}
+
+base64::simd_level base64::get_simd_level( )
+{
+   return g_simd_level;
+}
+
+base64::simd_level base64::set_simd_level( simd_level level )
+{
+   g_simd_level = ( level > g_max_simd_level ) ? g_max_simd_level : level;
+
+   return g_simd_level;
+}
+
+void base64_encoder::update( const unsigned char* p_dat, size_t length, string& output )
+{
+   while( num_pending && num_pending < 3 && length )
+   {
+      pending[ num_pending++ ] = *p_dat++;
+      --length;
    }
 
-   return l;
+   size_t size = output.size( );
+
+   if( num_pending == 3 )
+   {
+      output.resize( size + 4 );
+      base64::encode( pending, 3, &output[ size ] );
+
+      size += 4;
+      num_pending = 0;
+   }
+
+   size_t remaining = length % 3;
+
+   length -= remaining;
+
+   if( length )
+   {
+      output.resize( size + base64::encode_size( length ) );
+      base64::encode( p_dat, length, &output[ size ] );
+   }
+
+   for( size_t i = 0; i < remaining; i++ )
+      pending[ num_pending++ ] = p_dat[ length + i ];
+}
+
+void base64_encoder::finish( string& output )
+{
+   if( num_pending )
+   {
+      size_t size = output.size( );
+
+      output.resize( size + 4 );
+      base64::encode( pending, num_pending, &output[ size ] );
+
+      num_pending = 0;
+   }
+}
+
+void base64_decoder::update( const char* p_enc, size_t length, string& output )
+{
+   if( length && had_padding )
+      throw runtime_error( "unexpected base64 data found after padding" );
+
+   while( num_pending && num_pending < 4 && length )
+   {
+      pending[ num_pending++ ] = *p_enc++;
+      --length;
+   }
+
+   size_t size = output.size( );
+   size_t dec_len = 0;
+
+   if( num_pending == 4 )
+   {
+      if( length && pending[ 3 ] == '=' )
+         throw runtime_error( "unexpected base64 data found after padding" );
+
+      output.resize( size + 3 );
+
+      if( !base64::decode_if_valid( pending, 4, ( unsigned char* )&output[ size ], &dec_len ) )
+         throw runtime_error( "invalid base64 data: " + string( pending, 4 ) );
+
+      size += dec_len;
+      output.resize( size );
+
+      num_pending = 0;
+      had_padding = ( dec_len < 3 );
+   }
+
+   size_t remaining = length % 4;
+
+   length -= remaining;
+
+   if( length )
+   {
+      if( remaining && p_enc[ length - 1 ] == '=' )
+         throw runtime_error( "unexpected base64 data found after padding" );
+
+      output.resize( size + base64::decode_size( length ) );
+
+      if( !base64::decode_if_valid( p_enc, length, ( unsigned char* )&output[ size ], &dec_len ) )
+         throw runtime_error( "invalid base64 data found" );
+
+      output.resize( size + dec_len );
+
+      had_padding = ( p_enc[ length - 1 ] == '=' );
+   }
+
+   for( size_t i = 0; i < remaining; i++ )
+      pending[ num_pending++ ] = p_enc[ length + i ];
+}
+
+void base64_decoder::finish( )
+{
+   if( num_pending )
+      throw runtime_error( "incomplete base64 data (" + to_string( num_pending ) + " trailing chars)" );
+
+   had_padding = false;
 }
@@ -49,6 +49,72 @@ class base64
 
       return str;
    }
+
+   // NOTE: Validates the input (as "validate" does) whilst decoding it and so only requires one
+   // pass over the input. If invalid then false is returned (with nothing having been decoded).
+   static bool decode_if_valid( const char* p_enc, size_t length, unsigned char* p_data, size_t* p_dec_len );
+
+   static std::string validate_and_decode( const std::string& input, bool* p_rc = 0 );
+
+   // NOTE: Encoding and decoding will use SSSE3 or AVX2 instructions if the CPU supports them
+   // (determined at runtime). The "simd" level can be changed (mainly to allow for testing) but
+   // will not be set to a level higher than what the CPU supports.
+   enum simd_level
+   {
+      e_simd_level_none,
+      e_simd_level_ssse3,
+      e_simd_level_avx2
+   };
+
+   static simd_level get_simd_level( );
+   static simd_level set_simd_level( simd_level level );
+};
+
+// NOTE: Encodes data in any number of chunks (as multiples of three bytes are needed to encode
+// without padding any trailing bytes are retained until either more data is provided or until
+// "finish" is called).
+class base64_encoder
+{
+   public:
+   base64_encoder( ) : num_pending( 0 ) { }
+
+   void update( const unsigned char* p_dat, size_t length, std::string& output );
+
+   void update( const std::string& input, std::string& output )
+   {
+      update( ( const unsigned char* )input.data( ), input.length( ), output );
+   }
+
+   void finish( std::string& output );
+
+   private:
+   size_t num_pending;
+   unsigned char pending[ 3 ];
+};
+
+// NOTE: Decodes (and validates) base64 in any number of chunks with any trailing characters that
+// do not form a complete group of four being retained until more input is provided. An invalid
+// character (or any input after padding) will result in an exception being thrown and "finish"
+// will throw if an incomplete group remains.
+class base64_decoder
+{
+   public:
+   base64_decoder( ) : num_pending( 0 ), had_padding( false ) { }
+
+   void update( const char* p_enc, size_t length, std::string& output );
+
+   void update( const std::string& input, std::string& output )
+   {
+      update( input.data( ), input.length( ), output );
+   }
+
+   void finish( );
+
+   private:
+   size_t num_pending;
+   char pending[ 4 ];
+
+   bool had_padding;
 };
 
 inline std::string hex_to_base64( const std::string& input ) { return base64::encode( hex_decode( input ) ); }
@@ -36,7 +36,7 @@ namespace btree
 {
 #  endif
 
-const uint8_t c_none = 0xffu;
+const uint16_t c_none = 0xffffu;
 
 const uint64_t c_npos = UINT64_C( 0xffffffffffffffff );
 
@@ -44,7 +44,8 @@ const uint8_t c_node_flag_is_leaf = 0x01u;
 const uint8_t c_node_flag_is_rgt_leaf = 0x02u;
 const uint8_t c_node_flag_has_dup_split = 0x04u;
 
-const uint8_t c_maximum_items_per_node = 255;
+const uint16_t c_initial_items_per_node = 255;
+const uint16_t c_maximum_items_per_node = 0xfffdu;
 
 #  ifdef BTREE_DEBUG
 size_t total_number_of_node_splits = 0;
@@ -137,6 +138,11 @@ template< typename T > class bt_node
       item_pairs.resize( n );
    }
 
+   void reserve_items( size_t n )
+   {
+      item_pairs.reserve( n );
+   }
+
    void reset( )
    {
       ref_count = 0;
@@ -148,7 +154,7 @@ template< typename T > class bt_node
       item_pairs.clear( );
    }
 
-   uint8_t size( ) const { return ( uint8_t )item_pairs.size( ); }
+   uint16_t size( ) const { return ( uint16_t )item_pairs.size( ); }
 
    void set_link( int new_link ) { link = new_link; }
 
@@ -179,7 +185,7 @@ template< typename T > class bt_node
       uint64_t rgt_link;
    } data;
 
-   std::deque< std::pair< T, uint64_t > > item_pairs;
+   std::vector< std::pair< T, uint64_t > > item_pairs;
 };
 
 template< typename T > class bt_node_ref
@@ -221,24 +227,24 @@ template< typename T, typename N = bt_node< T > > class bt_node_manager : public
    typedef T item_type;
    typedef N node_type;
 
-   bt_node_manager( ) : items_per_node( c_maximum_items_per_node ) { }
+   bt_node_manager( ) : items_per_node( c_initial_items_per_node ) { }
 
-   uint8_t get_items_per_node( ) const { return items_per_node; }
+   uint16_t get_items_per_node( ) const { return items_per_node; }
 
-   void set_items_per_node( uint8_t val )
+   void set_items_per_node( uint16_t val )
    {
-      if( val % 2 == 0 || val < 3 )
+      if( val % 2 == 0 || val < 3 || val > c_maximum_items_per_node )
          throw std::runtime_error( "unexpected invalid items per node" );
 
       items_per_node = val;
    }
 
    private:
-   uint8_t items_per_node;
+   uint16_t items_per_node;
 };
 
 const size_t c_default_num_to_reserve = 1000;
-const uint8_t c_default_num_items_per_node = 5;
+const uint16_t c_default_num_items_per_node = 5;
 
 template< typename T, typename N = bt_node< T > > class heap_node_manager : public bt_node_manager< T, N >
 {
@@ -352,8 +358,8 @@ template< typename T, typename L = std::less< T >,
 
    void set_fill_factor( uint8_t val ) { state.node_fill_factor = val; }
 
-   uint8_t get_items_per_node( ) const { return node_manager.get_items_per_node( ); }
-   void set_items_per_node( uint8_t val );
+   uint16_t get_items_per_node( ) const { return node_manager.get_items_per_node( ); }
+   void set_items_per_node( uint16_t val );
 
    key_compare key_comp( ) const { return compare_less; }
 
@@ -371,14 +377,14 @@ template< typename T, typename L = std::less< T >,
 
       protected:
       uint64_t node;
-      uint8_t item;
+      uint16_t item;
 
       const bt_base< T, L, N, M >* p_bt_base;
       ref_count_ptr< bt_node_ref< T > > rp_node_ref;
 
       const_iterator( const bt_base< T, L, N, M >* p_bt_base, uint64_t new_node );
 
-      const_iterator( const bt_base< T, L, N, M >* p_bt_base, uint64_t node, uint8_t item )
+      const_iterator( const bt_base< T, L, N, M >* p_bt_base, uint64_t node, uint16_t item )
        : p_bt_base( p_bt_base ), node( node ), item( item )
       {
          rp_node_ref = p_bt_base->allocate_node_ref( node );
@@ -552,7 +558,7 @@ template< typename T, typename L = std::less< T >,
 
    private:
    uint64_t insert_item( uint64_t& node_link, T& item,
-    uint64_t& last_insert_node, uint8_t& last_insert_item, uint64_t& new_duplicate_dge_node );
+    uint64_t& last_insert_node, uint16_t& last_insert_item, uint64_t& new_duplicate_dge_node );
 
    enum find_type
    {
@@ -675,7 +681,7 @@ template< typename T, typename L, typename N, typename M >
 }
 
 template< typename T, typename L, typename N, typename M >
- void bt_base< T, L, N, M >::set_items_per_node( uint8_t val )
+ void bt_base< T, L, N, M >::set_items_per_node( uint16_t val )
 {
    if( state.total_nodes && val < node_manager.get_items_per_node( ) )
       throw std::runtime_error( "cannot shrink items per node" );
@@ -887,7 +893,7 @@ template< typename T, typename L, typename N, typename M >
             node = rp_node_ref->get_node( ).ref_data( ).lft_link;
          }
 
-         item = ( uint8_t )( rp_node_ref->get_node( ).size( ) - 1 );
+         item = ( uint16_t )( rp_node_ref->get_node( ).size( ) - 1 );
       }
       else
          throw std::runtime_error( "invalid iterator #1" );
@@ -914,7 +920,7 @@ template< typename T, typename L, typename N, typename M >
          if( rp_node_ref->get_node( ).size( ) == 0 )
             continue;
 
-         item = ( uint8_t )( rp_node_ref->get_node( ).size( ) - 1 );
+         item = ( uint16_t )( rp_node_ref->get_node( ).size( ) - 1 );
          break;
       }
    }
@@ -960,7 +966,7 @@ template< typename T, typename L, typename N, typename M >
    int item_pos = find_item( node_found, key, e_find_equal_to );
 
    if( item_pos != -1 )
-      return const_iterator( this, node_found, ( uint8_t )item_pos );
+      return const_iterator( this, node_found, ( uint16_t )item_pos );
    else
       return const_iterator( this, c_npos );
 }
@@ -979,7 +985,7 @@ template< typename T, typename L, typename N, typename M >
    int item_pos = find_item( node_found, key, e_find_equal_to_or_greater_than );
 
    if( item_pos != -1 )
-      return const_iterator( this, node_found, ( uint8_t )item_pos );
+      return const_iterator( this, node_found, ( uint16_t )item_pos );
    else
       return const_iterator( this, c_npos );
 }
@@ -998,7 +1004,7 @@ template< typename T, typename L, typename N, typename M >
    int item_pos = find_item( node_found, key, e_find_greater_than );
 
    if( item_pos != -1 )
-      return const_iterator( this, node_found, ( uint8_t )item_pos );
+      return const_iterator( this, node_found, ( uint16_t )item_pos );
    else
       return const_iterator( this, c_npos );
 }
@@ -1006,7 +1012,7 @@ template< typename T, typename L, typename N, typename M >
 template< typename T, typename L, typename N, typename M >
  int bt_base< T, L, N, M >::find_item( uint64_t& node_link, const key_type& key, find_type type_of_find ) const
 {
-   uint8_t s;
+   uint16_t s;
    int pos = -1;
 
 #  ifdef BTREE_DEBUG
@@ -1014,7 +1020,33 @@ template< typename T, typename L, typename N, typename M >
 #  endif
    std::auto_ptr< bt_node_ref< T > > ap_node_ref( allocate_node_ref( node_link ) );
 
-   for( s = 0; s < ap_node_ref->get_node( ).size( ); s++ )
+   s = 0;
+
+   uint16_t size = ap_node_ref->get_node( ).size( );
+
+   // NOTE: As items are sorted a binary search is used to skip over those that are less than
+   // the key (except for a leaf that has had a duplicate split as it needs to check each item).
+   // The last item is never skipped as it may need to be handled for "e_find_greater_than".
+   if( size > 1 && ( ap_node_ref->get_node( ).ref_data( ).flags
+    & ( c_node_flag_is_leaf | c_node_flag_has_dup_split ) ) != ( c_node_flag_is_leaf | c_node_flag_has_dup_split ) )
+   {
+      uint16_t lower = 0;
+      uint16_t upper = ( uint16_t )( size - 1 );
+
+      while( lower < upper )
+      {
+         uint16_t middle = ( uint16_t )( ( lower + upper ) / 2 );
+
+         if( compare_less( ap_node_ref->get_node( ).get_item_data( middle ), key ) )
+            lower = ( uint16_t )( middle + 1 );
+         else
+            upper = middle;
+      }
+
+      s = lower;
+   }
+
+   for( ; s < ap_node_ref->get_node( ).size( ); s++ )
    {
       bool is_equal = false;
 #  ifdef BTREE_DEBUG
@@ -1190,7 +1222,7 @@ template< typename T, typename L, typename N, typename M >
 
    std::auto_ptr< bt_node_ref< T > > ap_node_ref( allocate_node_ref( state.current_append_node ) );
 
-   uint8_t size = ap_node_ref->get_node( ).size( );
+   uint16_t size = ap_node_ref->get_node( ).size( );
 
    bool is_duplicate = false;
 
@@ -1225,9 +1257,9 @@ template< typename T, typename L, typename N, typename M >
    if( is_duplicate )
       fill_factor = 1.0;
 
-   uint8_t items_per_node( node_manager.get_items_per_node( ) );
+   uint16_t items_per_node( node_manager.get_items_per_node( ) );
 
-   if( size < ( uint8_t )( items_per_node * fill_factor )
+   if( size < ( uint16_t )( items_per_node * fill_factor )
     && ( is_duplicate || ap_node_ref->get_node( ).ref_data( ).dge_link == c_npos ) )
       ap_node_ref->get_node( ).append_item( item, c_npos );
    else
@@ -1242,7 +1274,7 @@ template< typename T, typename L, typename N, typename M >
 
       if( is_duplicate )
       {
-         uint8_t first_dup;
+         uint16_t first_dup;
          for( first_dup = 0; first_dup < items_per_node; first_dup++ )
          {
             if( keys_are_equal( item, ap_node_ref->get_node( ).get_item_data( first_dup ) ) )
@@ -1251,7 +1283,7 @@ template< typename T, typename L, typename N, typename M >
 
          if( first_dup != 0 )
          {
-            for( uint8_t i = first_dup; i < items_per_node; i++ )
+            for( uint16_t i = first_dup; i < items_per_node; i++ )
                ap_new_node_ref->get_node( ).append_item(
                 ap_node_ref->get_node( ).get_item_data( i ),
                 ap_node_ref->get_node( ).get_item_link( i ) );
@@ -1322,7 +1354,7 @@ template< typename T, typename L, typename N, typename M >
    }
 
    uint64_t last_insert_node = c_npos;
-   uint8_t last_insert_item = c_none;
+   uint16_t last_insert_item = c_none;
 
    uint64_t new_duplicate_dge_node = c_npos;
 
@@ -1384,9 +1416,9 @@ template< typename T, typename L, typename N, typename M >
 
 template< typename T, typename L, typename N, typename M >
  uint64_t bt_base< T, L, N, M >::insert_item( uint64_t& node_link,
- T& item, uint64_t& last_insert_node, uint8_t& last_insert_item, uint64_t& new_duplicate_dge_node )
+ T& item, uint64_t& last_insert_node, uint16_t& last_insert_item, uint64_t& new_duplicate_dge_node )
 {
-   uint8_t s = 0;
+   uint16_t s = 0;
    int pos = -1;
 
    uint64_t link = c_npos;
@@ -1403,7 +1435,7 @@ template< typename T, typename L, typename N, typename M >
 
    std::auto_ptr< bt_node_ref< T > > ap_node_ref( allocate_node_ref( node_link ) );
 
-   uint8_t size = ap_node_ref->get_node( ).size( );
+   uint16_t size = ap_node_ref->get_node( ).size( );
 
    while( true )
    {
@@ -1440,16 +1472,16 @@ template< typename T, typename L, typename N, typename M >
       }
       else
       {
-         s = ( uint8_t )( size - 1 );
+         s = ( uint16_t )( size - 1 );
 
          if( size >= 2 )
          {
-            uint8_t lower = 1;
-            uint8_t upper = ( uint8_t )( size - 1 );
+            uint16_t lower = 1;
+            uint16_t upper = ( uint16_t )( size - 1 );
 
             while( lower != upper )
             {
-               uint8_t middle = ( uint8_t )( ( lower + upper ) / 2 );
+               uint16_t middle = ( uint16_t )( ( lower + upper ) / 2 );
 
                if( middle == size - 1
                 || compare_less( item, ap_node_ref->get_node( ).get_item_data( middle ) ) )
@@ -1463,7 +1495,7 @@ template< typename T, typename L, typename N, typename M >
                {
                   if( lower == middle )
                      break;
-                  lower = ( uint8_t )( middle + 1 );
+                  lower = ( uint16_t )( middle + 1 );
                }
             }
          }
@@ -1548,7 +1580,7 @@ template< typename T, typename L, typename N, typename M >
 
          if( is_leaf_node )
          {
-            last_insert_item = ( uint8_t )pos;
+            last_insert_item = ( uint16_t )pos;
             last_insert_node = node_link;
          }
 #  ifdef BTREE_DEBUG
@@ -1576,12 +1608,12 @@ template< typename T, typename L, typename N, typename M >
             ap_new_node_ref->get_node( ).reset( );
          }
 
-         uint8_t items_per_node = node_manager.get_items_per_node( );
+         uint16_t items_per_node = node_manager.get_items_per_node( );
 
-         uint8_t split = ( uint8_t )( items_per_node / 2 );
+         uint16_t split = ( uint16_t )( items_per_node / 2 );
 
          if( split >= size )
-            split = ( uint8_t )( size - 1 );
+            split = ( uint16_t )( size - 1 );
 #  ifdef BTREE_DEBUG
          std::cout << "initial split point = " << ( int )split << '\n';
 #  endif
@@ -1612,8 +1644,8 @@ template< typename T, typename L, typename N, typename M >
          }
          else
          {
-            for( uint8_t s1 = ( uint8_t )( split - 1 ),
-             s2 = ( uint8_t )( split + 1 ); ; s1--, s2++ )
+            for( uint16_t s1 = ( uint16_t )( split - 1 ),
+             s2 = ( uint16_t )( split + 1 ); ; s1--, s2++ )
             {
                if( !( keys_are_equal(
                 ap_node_ref->get_node( ).get_item_data( s1 ),
@@ -1651,7 +1683,7 @@ template< typename T, typename L, typename N, typename M >
              ap_node_ref->get_node( ).get_item_data( pos ? items_per_node - 1 : 0 ) ) ) )
             {
                split_okay = true;
-               split = pos ? ( uint8_t )( items_per_node - 1 ) : ( uint8_t )0;
+               split = pos ? ( uint16_t )( items_per_node - 1 ) : ( uint16_t )0;
 #  ifdef BTREE_DEBUG
                std::cout << "split point passed item compare at " << ( int )split << '\n';
 #  endif
@@ -1664,7 +1696,7 @@ template< typename T, typename L, typename N, typename M >
             std::cout << "split point set to "
              << ( int )( items_per_node - 1 ) << " and duplicate flagged\n";
 #  endif
-            split = ( uint8_t )( items_per_node - 1 );
+            split = ( uint16_t )( items_per_node - 1 );
             ap_node_ref->get_node( ).ref_data( ).flags |= c_node_flag_has_dup_split;
          }
 
@@ -1688,7 +1720,7 @@ template< typename T, typename L, typename N, typename M >
 
             if( is_leaf_node )
             {
-               last_insert_item = ( uint8_t )pos;
+               last_insert_item = ( uint16_t )pos;
                last_insert_node = node_link;
             }
          }
@@ -1699,7 +1731,7 @@ template< typename T, typename L, typename N, typename M >
 #  endif
             ap_new_node_ref->get_node( ).append_item( item, link );
 
-            for( s = ( uint8_t )pos; s < size; s++ )
+            for( s = ( uint16_t )pos; s < size; s++ )
                ap_new_node_ref->get_node( ).append_item(
                 ap_node_ref->get_node( ).get_item_data( s ),
                 ap_node_ref->get_node( ).get_item_link( s ) );
@@ -1717,7 +1749,7 @@ template< typename T, typename L, typename N, typename M >
 #  ifdef BTREE_DEBUG
             std::cout << "insert item into new node\n";
 #  endif
-            uint8_t new_pos = ( uint8_t )( pos - split - 1 );
+            uint16_t new_pos = ( uint16_t )( pos - split - 1 );
 
             for( s = 0; s < new_pos; s++ )
                ap_new_node_ref->get_node( ).append_item(
@@ -1726,7 +1758,7 @@ template< typename T, typename L, typename N, typename M >
 
             ap_new_node_ref->get_node( ).append_item( item, link );
 
-            for( s = ( uint8_t )pos; s < size; s++ )
+            for( s = ( uint16_t )pos; s < size; s++ )
                ap_new_node_ref->get_node( ).append_item(
                 ap_node_ref->get_node( ).get_item_data( s ),
                 ap_node_ref->get_node( ).get_item_link( s ) );
@@ -2178,8 +2210,8 @@ template< typename T, typename L, typename N, typename M > void bt_base< T, L, N
 
    float fill_factor( state.node_fill_factor / 100.0 );
 
-   uint8_t items_per_node( node_manager.get_items_per_node( ) );
-   uint8_t items_to_fill_per_node( ( uint8_t )( items_per_node * fill_factor ) );
+   uint16_t items_per_node( node_manager.get_items_per_node( ) );
+   uint16_t items_to_fill_per_node( ( uint16_t )( items_per_node * fill_factor ) );
 
    state.num_levels = 0;
 
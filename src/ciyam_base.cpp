@@ -35,6 +35,7 @@
 #include "cube.h"
 #include "salt.h"
 #include "sha1.h"
+#include "smtp.h"
 #include "array.h"
 #include "base64.h"
 #include "config.h"
@@ -45,6 +46,7 @@
 #include "date_time.h"
 #include "utilities.h"
 #include "class_base.h"
+#include "smtp_spool.h"
 #include "ciyam_files.h"
 #ifdef SSL_SUPPORT
 #  include "ssl_socket.h"
@@ -89,6 +91,11 @@ const size_t c_default_cache_limit = 1000;
 
 const size_t c_iteration_row_cache_limit = 100;
 
+const size_t c_max_rows_per_sql_insert = 500;
+const size_t c_max_bulk_ops_records_per_tx = 1000;
+
+const char* const c_sql_insert_values = " VALUES ";
+
 const int c_max_lock_attempts = 20;
 const int c_lock_attempt_sleep_time = 200;
 
@@ -96,6 +103,12 @@ const int c_loop_variable_digits = 8;
 
 const int c_storable_file_pad_len = 32;
 
+const int c_compact_storage_interval_seconds = 60;
+
+const int c_smtp_spool_retry_msecs = 30000;
+
+const char* const c_smtp_spool_directory = "mail_spool";
+
 // NOTE: Limit the buffer to twice the maximum file size (if a compression
 // call returns buffer too small then the file can be stored uncompressed).
 const int c_max_file_buffer_expansion = 2;
@@ -133,21 +146,26 @@ const char* const c_attribute_use_https = "use_https";
 const char* const c_attribute_local_hash = "local_hash";
 const char* const c_attribute_blockchains = "blockchains";
 const char* const c_attribute_gpg_password = "gpg_password";
+const char* const c_attribute_compact_objects = "compact_objects";
 const char* const c_attribute_max_sessions = "max_sessions";
 const char* const c_attribute_pem_password = "pem_password";
 const char* const c_attribute_rpc_password = "rpc_password";
 const char* const c_attribute_sql_password = "sql_password";
+const char* const c_attribute_script_workers = "script_workers";
 const char* const c_attribute_default_storage = "default_storage";
 const char* const c_attribute_peer_ips_direct = "peer_ips_direct";
 const char* const c_attribute_peer_ips_permit = "peer_ips_permit";
 const char* const c_attribute_peer_ips_reject = "peer_ips_reject";
 const char* const c_attribute_script_reconfig = "script_reconfig";
 const char* const c_attribute_session_timeout = "session_timeout";
+const char* const c_attribute_session_workers = "session_workers";
 const char* const c_attribute_local_public_key = "local_public_key";
 const char* const c_attribute_master_public_key = "master_public_key";
 const char* const c_attribute_max_send_attempts = "max_send_attempts";
 const char* const c_attribute_max_attached_data = "max_attached_data";
+const char* const c_attribute_signature_verifier = "signature_verifier";
 const char* const c_attribute_max_storage_handlers = "max_storage_handlers";
+const char* const c_attribute_max_sql_group_connections = "max_sql_group_connections";
 const char* const c_attribute_files_area_item_max_num = "files_area_item_max_num";
 const char* const c_attribute_files_area_item_max_size = "files_area_item_max_size";
 
@@ -271,6 +289,7 @@ struct session
     next_handle( 0 ),
     p_tx_helper( 0 ),
     ods_tlg_size( 0 ),
+    p_detached_ods( 0 ),
     is_captured( false ),
     running_script( false ),
     skip_fk_fetches( false ),
@@ -284,7 +303,9 @@ struct session
     skip_is_constrained( false ),
     session_commands_executed( 0 ),
     is_peer_session( is_peer_session ),
-    p_storage_handler( p_storage_handler )
+    p_storage_handler( p_storage_handler ),
+    defer_sql_inserts( false ),
+    deferred_sql_insert_line( 0 )
    {
       if( p_ip_addr )
          ip_addr = *p_ip_addr;
@@ -390,6 +411,13 @@ struct session
 
    vector< string > sql_undo_statements;
 
+   bool defer_sql_inserts;
+
+   size_t deferred_sql_insert_line;
+
+   vector< pair< string, size_t > > deferred_sql_inserts;
+   vector< pair< size_t, string > > failed_sql_inserts;
+
    string async_or_delayed_temp_file;
 
    vector< string > async_or_delayed_temp_files;
@@ -398,6 +426,9 @@ struct session
    set< size_t > release_sessions;
    map< size_t, date_time > condemned_sessions;
 
+   ods* p_detached_ods;
+   string detached_module_directory;
+
    module_commands_registry_container commands_registry;
    object_instance_registry_container instance_registry;
 };
@@ -683,6 +714,12 @@ class storage_handler
 
    map< string, vector< string > >& get_record_cache( ) { return record_cache; }
 
+   sql_db_pool* get_sql_db_pool( size_t max_connections );
+   sql_query_pool* get_sql_query_pool( );
+
+   size_t get_class_change_version( const string& class_id ) const;
+   void increment_class_change_versions( const set< string >& tx_key_info );
+
    private:
    size_t slot;
    string name;
@@ -715,6 +752,15 @@ class storage_handler
 
    map< string, vector< string > > record_cache;
 
+   mutable mutex pool_mutex;
+   auto_ptr< sql_db_pool > ap_sql_db_pool;
+
+   // NOTE: Declared after the connection pool so that its workers will be stopped first.
+   auto_ptr< sql_query_pool > ap_sql_query_pool;
+
+   mutable mutex version_mutex;
+   map< string, size_t > class_change_versions;
+
    storage_handler( const storage_handler& );
    storage_handler& operator ==( const storage_handler& );
 };
@@ -743,6 +789,52 @@ void storage_handler::dump_cache( ostream& os ) const
    }
 }
 
+sql_db_pool* storage_handler::get_sql_db_pool( size_t max_connections )
+{
+   guard g( pool_mutex );
+
+   if( !max_connections )
+      return 0;
+
+   if( !ap_sql_db_pool.get( ) )
+   {
+      ap_sql_db_pool.reset( new sql_db_pool( name, name, max_connections ) );
+      ap_sql_query_pool.reset( new sql_query_pool( max_connections ) );
+   }
+
+   return ap_sql_db_pool.get( );
+}
+
+sql_query_pool* storage_handler::get_sql_query_pool( )
+{
+   guard g( pool_mutex );
+
+   return ap_sql_query_pool.get( );
+}
+
+size_t storage_handler::get_class_change_version( const string& class_id ) const
+{
+   guard g( version_mutex );
+
+   map< string, size_t >::const_iterator i = class_change_versions.find( class_id );
+
+   return i == class_change_versions.end( ) ? 0 : i->second;
+}
+
+void storage_handler::increment_class_change_versions( const set< string >& tx_key_info )
+{
+   guard g( version_mutex );
+
+   set< string > class_ids;
+
+   // NOTE: The transaction key info is in the form <class_id>:<key>.
+   for( set< string >::const_iterator i = tx_key_info.begin( ); i != tx_key_info.end( ); ++i )
+      class_ids.insert( i->substr( 0, i->find( ':' ) ) );
+
+   for( set< string >::iterator i = class_ids.begin( ); i != class_ids.end( ); ++i )
+      ++class_change_versions[ *i ];
+}
+
 void storage_handler::dump_locks( ostream& os ) const
 {
    os << "handle key (lock_class:instance)                     type       tx_type    tran_id    tran_level p_session      p_class_base   p_root_class\n";
@@ -1204,6 +1296,9 @@ const size_t c_max_sessions_limit = 1000;
 const size_t c_max_sessions_default = 100;
 const size_t c_max_storage_handlers_default = 10;
 
+// NOTE: If zero then grouped SQL queries are executed sequentially using the session's connection.
+const size_t c_max_sql_group_connections_default = 0;
+
 const size_t c_files_area_item_max_num_default = 10000;
 const size_t c_files_area_item_max_size_default = 1000000; // i.e. 1MB
 
@@ -1212,6 +1307,8 @@ string g_empty_string;
 size_t g_max_sessions = c_max_sessions_default;
 size_t g_max_storage_handlers = c_max_storage_handlers_default + 1; // i.e. extra for <none>
 
+size_t g_max_sql_group_connections = c_max_sql_group_connections_default;
+
 size_t g_files_area_item_max_num = c_files_area_item_max_num_default;
 size_t g_files_area_item_max_size = c_files_area_item_max_size_default;
 
@@ -1790,6 +1887,122 @@ bool fetch_instance_from_cache( class_base& instance, const string& key, bool sy
    return found;
 }
 
+void execute_sql_insert( const string& sql )
+{
+   TRACE_LOG( TRACE_SQLSTMTS, sql );
+   exec_sql( *gtp_session->ap_db, sql );
+
+   ++gtp_session->sql_count;
+}
+
+// NOTE: When a session is deferring SQL inserts (which bulk imports do) these are executed
+// before any other SQL statement or query is executed so that queries will always find rows
+// that had been inserted by earlier operations. Consecutive inserts for the same table will
+// be combined into multi-row inserts (so the original order of the inserts is kept) and if a
+// multi-row insert fails then its rows are inserted one at a time so that each failing row's
+// import line number (along with its error) is added to the session's failed SQL inserts.
+void execute_deferred_sql_inserts( )
+{
+   if( gtp_session && !gtp_session->deferred_sql_inserts.empty( ) )
+   {
+      vector< pair< string, size_t > > inserts;
+      inserts.swap( gtp_session->deferred_sql_inserts );
+
+      gtp_session->failed_sql_inserts.clear( );
+
+      for( size_t i = 0; i < inserts.size( ); )
+      {
+         size_t first = i;
+
+         string prefix;
+         vector< string > all_values;
+
+         for( ; i < inserts.size( ) && all_values.size( ) < c_max_rows_per_sql_insert; i++ )
+         {
+            string::size_type pos = inserts[ i ].first.find( c_sql_insert_values );
+            if( pos == string::npos )
+               throw runtime_error( "unexpected SQL insert format: " + inserts[ i ].first );
+
+            if( i == first )
+               prefix = inserts[ i ].first.substr( 0, pos );
+            else if( inserts[ i ].first.compare( 0, pos, prefix ) != 0 )
+               break;
+
+            string values( inserts[ i ].first.substr( pos + strlen( c_sql_insert_values ) ) );
+
+            if( !values.empty( ) && values[ values.size( ) - 1 ] == ';' )
+               values.erase( values.size( ) - 1 );
+
+            all_values.push_back( values );
+         }
+
+         if( all_values.size( ) == 1 )
+         {
+            try
+            {
+               execute_sql_insert( inserts[ first ].first );
+            }
+            catch( exception& x )
+            {
+               gtp_session->failed_sql_inserts.push_back( make_pair( inserts[ first ].second, string( x.what( ) ) ) );
+               throw;
+            }
+         }
+         else
+         {
+            string sql( prefix + c_sql_insert_values );
+
+            for( size_t j = 0; j < all_values.size( ); j++ )
+            {
+               if( j > 0 )
+                  sql += ',';
+               sql += all_values[ j ];
+            }
+
+            sql += ';';
+
+            try
+            {
+               execute_sql_insert( sql );
+            }
+            catch( exception& )
+            {
+               // NOTE: As the multi-row insert failed as a whole its rows are now inserted one
+               // at a time so that every failing row (rather than just the batch) is reported.
+               for( size_t j = first; j < i; j++ )
+               {
+                  try
+                  {
+                     execute_sql_insert( inserts[ j ].first );
+                  }
+                  catch( exception& x )
+                  {
+                     gtp_session->failed_sql_inserts.push_back( make_pair( inserts[ j ].second, string( x.what( ) ) ) );
+                  }
+               }
+
+               if( gtp_session->failed_sql_inserts.empty( ) )
+                  throw;
+
+               throw runtime_error( gtp_session->failed_sql_inserts[ 0 ].second );
+            }
+         }
+      }
+   }
+}
+
+string records_per_second( size_t num_records, const date_time& dtm_started )
+{
+   string retval;
+
+   seconds elapsed( date_time::standard( ) - dtm_started );
+
+   if( elapsed > 0 )
+      retval = " (" + to_string( ( size_t )( num_records / elapsed ) ) + " records/sec)";
+
+   return retval;
+}
+
 bool fetch_instance_from_db( class_base& instance,
  const map< int, int >& fields, const vector< int >& columns, bool skip_after_fetch )
 {
@@ -1848,6 +2061,8 @@ bool fetch_instance_from_db( class_base& instance,
 
    if( !found && gtp_session && gtp_session->ap_db.get( ) )
    {
+      execute_deferred_sql_inserts( );
+
       TRACE_LOG( TRACE_SQLSTMTS, sql );
 
       sql_dataset ds( *gtp_session->ap_db.get( ), sql );
@@ -3437,12 +3652,17 @@ string g_sql_password;
 string g_default_storage;
 
 unsigned int g_session_timeout = 0;
+unsigned int g_session_workers = 0;
 
 unsigned int g_max_peers = c_default_max_peers;
 unsigned int g_max_user_limit = c_default_max_user_limit;
 
 bool g_script_reconfig = false;
 
+unsigned int g_script_workers = 0;
+
+unsigned int g_compact_objects = 0;
+
 set< string > g_accepted_ip_addrs;
 set< string > g_rejected_ip_addrs;
 set< string > g_accepted_peer_ip_addrs;
@@ -3471,6 +3691,8 @@ string g_smtp_security;
 int g_smtp_max_send_attempts = 1;
 int64_t g_smtp_max_attached_data = INT64_C( 100000 );
 
+auto_ptr< smtp_spool > gap_smtp_spool;
+
 typedef map< string, external_client > external_client_container;
 typedef external_client_container::iterator external_client_iterator;
 typedef external_client_container::const_iterator external_client_const_iterator;
@@ -3662,6 +3884,8 @@ void read_server_configuration( )
          }
       }
 
+      g_compact_objects = atoi( reader.read_opt_attribute( c_attribute_compact_objects, "0" ).c_str( ) );
+
       g_max_sessions = atoi( reader.read_opt_attribute(
        c_attribute_max_sessions, to_string( c_max_sessions_default ) ).c_str( ) );
 
@@ -3701,11 +3925,29 @@ void read_server_configuration( )
 
       g_script_reconfig = ( lower( reader.read_opt_attribute( c_attribute_script_reconfig, c_false ) ) == c_true );
 
+      g_script_workers = atoi( reader.read_opt_attribute( c_attribute_script_workers, "0" ).c_str( ) );
+
       g_session_timeout = atoi( reader.read_opt_attribute( c_attribute_session_timeout, "0" ).c_str( ) );
 
+      g_session_workers = atoi( reader.read_opt_attribute( c_attribute_session_workers, "0" ).c_str( ) );
+
+      // NOTE: OpenSSL is used to verify signatures unless "secp256k1" has been specified (and if
+      // the secp256k1 verifier was not included in the build then OpenSSL will still be used).
+      string signature_verifier( lower( reader.read_opt_attribute( c_attribute_signature_verifier, "openssl" ) ) );
+
+      if( signature_verifier != "openssl" && signature_verifier != "secp256k1" )
+         throw runtime_error( "invalid signature_verifier '" + signature_verifier + "'" );
+#ifdef SSL_SUPPORT
+      set_signature_verifier( signature_verifier == "secp256k1"
+       ? e_signature_verifier_secp256k1 : e_signature_verifier_openssl );
+#endif
+
       g_max_storage_handlers = atoi( reader.read_opt_attribute(
        c_attribute_max_storage_handlers, to_string( c_max_storage_handlers_default ) ).c_str( ) ) + 1;
 
+      g_max_sql_group_connections = atoi( reader.read_opt_attribute(
+       c_attribute_max_sql_group_connections, to_string( c_max_sql_group_connections_default ) ).c_str( ) );
+
       // NOTE: Use "unformat_bytes" here as well so 10K (instead of 10000) can be used in the config file.
       g_files_area_item_max_num = ( size_t )unformat_bytes( reader.read_opt_attribute(
        c_attribute_files_area_item_max_num, to_string( c_files_area_item_max_num_default ) ).c_str( ) );
@@ -3786,6 +4028,16 @@ void read_server_configuration( )
    }
 }
 
+string encrypt_spooled_password( const string& password )
+{
+   return encrypt_data( password );
+}
+
+string decrypt_spooled_password( const string& password )
+{
+   return decrypt_data( password );
+}
+
 void fetch_instance_from_row_cache( class_base& instance, bool skip_after_fetch )
 {
    class_base_accessor instance_accessor( instance );
@@ -4171,6 +4423,16 @@ void init_globals( )
          g_using_ssl = true;
       }
 #endif
+
+      // NOTE: Outbound email is spooled (to be sent by its own thread) so that a session which
+      // sends many messages will not be held up by the SMTP server.
+      if( !g_smtp_server.empty( ) )
+      {
+         gap_smtp_spool.reset( new smtp_spool( c_smtp_spool_directory, g_smtp_max_send_attempts,
+          c_smtp_spool_retry_msecs, encrypt_spooled_password, decrypt_spooled_password ) );
+
+         gap_smtp_spool->start( );
+      }
    }
    catch( exception& x )
    {
@@ -4201,6 +4463,8 @@ void term_globals( )
       }
    }
 
+   gap_smtp_spool.reset( );
+
    term_files_area( );
 
    term_ciyam_ods( );
@@ -4221,6 +4485,42 @@ void check_timezone_info( )
       setup_timezones( );
 }
 
+void compact_storage_data( )
+{
+   static time_t last_compacted = 0;
+
+   // NOTE: Compaction is only performed if "compact_objects" has been configured and then only
+   // that many objects are moved (at most) per interval. Any ODS that is currently involved in a
+   // transaction or bulk operation will be skipped.
+   if( !g_compact_objects )
+      return;
+
+   time_t now = time( 0 );
+
+   if( now - last_compacted < c_compact_storage_interval_seconds )
+      return;
+
+   guard g( g_mutex );
+
+   last_compacted = now;
+
+   try
+   {
+      for( size_t i = 0; i < g_storage_handlers.size( ); i++ )
+      {
+         if( g_storage_handlers[ i ] && g_storage_handlers[ i ]->get_ods( ) )
+            g_storage_handlers[ i ]->get_ods( )->compact_data( g_compact_objects );
+      }
+
+      if( gap_ods.get( ) )
+         gap_ods->compact_data( g_compact_objects );
+   }
+   catch( exception& x )
+   {
+      TRACE_LOG( TRACE_ANYTHING, string( "compact_storage_data error: " ) + x.what( ) );
+   }
+}
+
 string get_string( const string& key )
 {
    string str( key );
@@ -4611,6 +4911,38 @@ int64_t get_smtp_max_attached_data( )
    return g_smtp_max_attached_data;
 }
 
+bool spool_smtp_message( const string& host,
+ const smtp_user_info& user_info, const vector< string >& recipients, const string& data )
+{
+   if( !gap_smtp_spool.get( ) )
+      return false;
+
+   gap_smtp_spool->spool_message( host, user_info, recipients, data );
+
+   return true;
+}
+
+string get_smtp_spool_stats( )
+{
+   if( !gap_smtp_spool.get( ) )
+      return "(mail spool not in use)";
+
+   smtp_spool_stats stats;
+   gap_smtp_spool->get_stats( stats );
+
+   string s( "queued: " + to_string( stats.num_queued ) + " (deferred: " + to_string( stats.num_deferred ) + ")" );
+
+   s += ", sent: " + to_string( stats.num_sent );
+   s += ", failed: " + to_string( stats.num_failed );
+   s += ", connects: " + to_string( stats.num_connects );
+   s += ", reused: " + to_string( stats.num_reused );
+
+   if( !stats.last_error.empty( ) )
+      s += ", last error: " + stats.last_error;
+
+   return s;
+}
+
 string list_externals( )
 {
    string s;
@@ -5096,6 +5428,62 @@ void term_session( )
       throw runtime_error( "unable to terminate session" );
 }
 
+bool can_detach_session( )
+{
+   guard g( g_mutex );
+
+   // NOTE: As ODS bulk locks are held by a specific thread a session that is holding one cannot
+   // be detached (nor can a captured session which needs to keep on waiting for its release).
+   return gtp_session && !gtp_session->is_captured
+    && !( ods::instance( ) && ods::instance( )->is_thread_bulk_locked( ) );
+}
+
+size_t detach_session( )
+{
+   guard g( g_mutex );
+
+   if( !gtp_session )
+      throw runtime_error( "unexpected null session in detach_session" );
+
+   size_t sess_id = gtp_session->id;
+
+   gtp_session->p_detached_ods = ods::instance( );
+   gtp_session->detached_module_directory = module_directory( );
+
+   ods::instance( 0, true );
+   module_directory( &g_empty_string );
+
+   gtp_session = 0;
+
+   return sess_id;
+}
+
+void attach_session( size_t sess_id )
+{
+   guard g( g_mutex );
+
+   gtp_session = 0;
+
+   for( size_t i = 0; i < g_max_sessions; i++ )
+   {
+      if( g_sessions[ i ] && g_sessions[ i ]->id == sess_id )
+      {
+         gtp_session = g_sessions[ i ];
+
+         ods::instance( gtp_session->p_detached_ods, true );
+         module_directory( &gtp_session->detached_module_directory );
+
+         gtp_session->p_detached_ods = 0;
+         gtp_session->detached_module_directory.erase( );
+
+         break;
+      }
+   }
+
+   if( !gtp_session )
+      throw runtime_error( "unable to attach session #" + to_string( sess_id ) );
+}
+
 size_t session_id( )
 {
    size_t rc = 0;
@@ -5401,6 +5789,21 @@ bool is_condemned_session( )
     || ( g_session_timeout && ( date_time::local( ) - gtp_session->dtm_last_cmd ) > g_session_timeout ) );
 }
 
+bool is_condemned_session( size_t sess_id )
+{
+   guard g( g_mutex );
+
+   for( size_t i = 0; i < g_max_sessions; i++ )
+   {
+      if( g_sessions[ i ] && g_sessions[ i ]->id == sess_id )
+         return ( g_condemned_sessions.count( sess_id )
+          && g_condemned_sessions[ sess_id ] <= date_time::local( ) )
+          || ( g_session_timeout && ( date_time::local( ) - g_sessions[ i ]->dtm_last_cmd ) > g_session_timeout );
+   }
+
+   return false;
+}
+
 void capture_session( size_t sess_id )
 {
    guard g( g_mutex );
@@ -5522,6 +5925,12 @@ bool get_script_reconfig( )
    return g_script_reconfig;
 }
 
+unsigned int get_script_workers( )
+{
+   guard g( g_mutex );
+   return g_script_workers;
+}
+
 string get_pem_password( )
 {
    guard g( g_mutex );
@@ -5612,6 +6021,12 @@ void set_session_timeout( unsigned int seconds )
    g_session_timeout = seconds;
 }
 
+unsigned int get_session_workers( )
+{
+   guard g( g_mutex );
+   return g_session_workers;
+}
+
 string get_session_blockchain( )
 {
    guard g( g_mutex );
@@ -6868,6 +7283,14 @@ void storage_cache_clear( )
    handler.clear_cache( );
 }
 
+size_t storage_class_change_version( const string& class_id )
+{
+   if( !gtp_session || !gtp_session->p_storage_handler )
+      return 0;
+
+   return gtp_session->p_storage_handler->get_class_change_version( class_id );
+}
+
 size_t storage_cache_limit( )
 {
    guard g( g_mutex );
@@ -9117,6 +9540,8 @@ string exec_bulk_ops( const string& module,
    bool in_trans = false;
    bool is_export = false;
 
+   date_time dtm_started( date_time::standard( ) );
+
    if( !export_fields.empty( ) )
    {
       is_export = true;
@@ -9186,14 +9611,25 @@ string exec_bulk_ops( const string& module,
 
          outf << "\n";
 
+         size_t num_exported = 0;
+
          if( instance_iterate( handle, "", key_info,
           fields_for_iteration, search_text, search_query, "", e_iter_direction_forwards, true ) )
          {
             do
             {
+               ++num_exported;
                outf << get_field_values( handle, "", fields, tz_name, false, true ) << "\n";
             } while( instance_iterate_next( handle, "" ) );
          }
+
+         outf.flush( );
+         if( !outf.good( ) )
+            throw runtime_error( "unexpected bad output stream for '" + filename + "'" );
+
+         // FUTURE: This should be handled as a string message.
+         response = "Exported " + to_string( num_exported ) + " record(s)"
+          + records_per_second( num_exported, dtm_started ) + ".";
       }
       else
       {
@@ -9201,6 +9637,11 @@ string exec_bulk_ops( const string& module,
          set_dtm( dtm );
          set_tz_name( tz_name );
 
+         // NOTE: The SQL inserts for created records are deferred so that they can be executed as
+         // multi-row inserts (any other SQL statement or query will cause these to be executed).
+         gtp_session->defer_sql_inserts = true;
+         gtp_session->failed_sql_inserts.clear( );
+
          string log_lines;
 
          vector< string > key_fields;
@@ -9237,6 +9678,7 @@ string exec_bulk_ops( const string& module,
          size_t num_destroyed = 0;
          size_t key_field_num = 0;
          size_t transaction_id = 0;
+         size_t num_records_in_tx = 0;
 
          while( getline( inpf, next ) )
          {
@@ -9581,6 +10023,8 @@ string exec_bulk_ops( const string& module,
                next_log_line += "\"" + log_field_value_pairs + "\"";
             }
 
+            gtp_session->deferred_sql_insert_line = line;
+
             op_apply_rc rc;
             op_instance_apply( handle, "", false, &rc );
 
@@ -9613,18 +10057,25 @@ string exec_bulk_ops( const string& module,
                log_lines += "\n";
             log_lines += next_log_line;
 
-            if( time( 0 ) - ts >= 10 )
+            // NOTE: Commit after a maximum number of records (or period of time) so that the
+            // locks and log lines being held for the transaction will not grow without bounds.
+            if( ++num_records_in_tx >= c_max_bulk_ops_records_per_tx || time( 0 ) - ts >= 10 )
             {
-               ts = time( 0 );
-
                transaction_log_command( log_lines );
                transaction_commit( );
 
                in_trans = false;
                log_lines.clear( );
 
-               // FUTURE: This message should be handled as a server string message.
-               handler.output_progress( "Processed " + to_string( line ) + " lines..." );
+               num_records_in_tx = 0;
+
+               if( time( 0 ) - ts >= 10 )
+               {
+                  ts = time( 0 );
+
+                  // FUTURE: This message should be handled as a server string message.
+                  handler.output_progress( "Processed " + to_string( line ) + " lines..." );
+               }
 
                if( is_condemned_session( ) )
                   break;
@@ -9645,8 +10096,13 @@ string exec_bulk_ops( const string& module,
          {
             transaction_log_command( log_lines );
             transaction_commit( );
+
+            in_trans = false;
          }
 
+         gtp_session->defer_sql_inserts = false;
+         gtp_session->deferred_sql_insert_line = 0;
+
          // FUTURE: These should be handled as string messages.
          if( num_created )
             outf << "Created " << num_created << " new record(s)." << endl;
@@ -9655,16 +10111,33 @@ string exec_bulk_ops( const string& module,
          if( num_destroyed )
             outf << "Removed " << num_destroyed << " existing record(s)." << endl;
 
-         response = "Processed " + to_string( line ) + " lines with " + to_string( errors ) + " error(s).";
+         response = "Processed " + to_string( line ) + " lines with " + to_string( errors ) + " error(s)"
+          + records_per_second( num_created + num_updated + num_destroyed, dtm_started ) + ".";
       }
 
       destroy_object_instance( handle );
    }
    catch( exception& x )
    {
+      // NOTE: If the exception was due to deferred SQL inserts failing then the line numbers
+      // of the records whose inserts failed are output (rather than that of the current line).
       if( !is_export )
-         // FUTURE: This message should be handled as a server string message.
-         outf << "Error: Processing line #" << line << " - " << x.what( ) << endl;
+      {
+         vector< pair< size_t, string > > failed_sql_inserts;
+         failed_sql_inserts.swap( gtp_session->failed_sql_inserts );
+
+         // FUTURE: These messages should be handled as server string messages.
+         if( failed_sql_inserts.empty( ) )
+            outf << "Error: Processing line #" << line << " - " << x.what( ) << endl;
+         else
+         {
+            for( size_t i = 0; i < failed_sql_inserts.size( ); i++ )
+               outf << "Error: Processing line #" << failed_sql_inserts[ i ].first << " - " << failed_sql_inserts[ i ].second << endl;
+         }
+      }
+
+      gtp_session->defer_sql_inserts = false;
+      gtp_session->deferred_sql_insert_line = 0;
 
       if( in_trans )
          transaction_rollback( );
@@ -9677,6 +10150,9 @@ string exec_bulk_ops( const string& module,
          // FUTURE: This message should be handled as a server string message.
          outf << "Error: Processing line #" << line << " - unknown exception caught" << endl;
 
+      gtp_session->defer_sql_inserts = false;
+      gtp_session->deferred_sql_insert_line = 0;
+
       if( in_trans )
          transaction_rollback( );
       destroy_object_instance( handle );
@@ -10168,6 +10644,9 @@ void transaction_commit( )
 
    bool is_using_blockchain = handler.is_using_blockchain( );
 
+   if( gtp_session->transactions.size( ) == 1 )
+      execute_deferred_sql_inserts( );
+
    // NOTE: Scope for guard object.
    {
       guard g( g_mutex );
@@ -10201,6 +10680,8 @@ void transaction_commit( )
 
          remove_tx_info_from_cache( );
 
+         handler.increment_class_change_versions( gtp_session->tx_key_info );
+
          gtp_session->tx_key_info.clear( );
          gtp_session->sql_undo_statements.clear( );
 
@@ -10283,6 +10764,8 @@ void transaction_rollback( )
 
       if( gtp_session->ap_db.get( ) && gtp_session->transactions.empty( ) )
       {
+         gtp_session->deferred_sql_inserts.clear( );
+
          TRACE_LOG( TRACE_SQLSTMTS, "ROLLBACK" );
          exec_sql( *gtp_session->ap_db, "ROLLBACK" );
 
@@ -11136,6 +11619,15 @@ void finish_instance_op( class_base& instance, bool apply_changes,
                   if( sql_stmts[ i ].empty( ) )
                      continue;
 
+                  if( gtp_session->defer_sql_inserts && sql_stmts[ i ].find( "INSERT INTO " ) == 0 )
+                  {
+                     gtp_session->deferred_sql_inserts.push_back(
+                      make_pair( sql_stmts[ i ], gtp_session->deferred_sql_insert_line ) );
+                     continue;
+                  }
+
+                  execute_deferred_sql_inserts( );
+
                   TRACE_LOG( TRACE_SQLSTMTS, sql_stmts[ i ] );
                   exec_sql( *gtp_session->ap_db, sql_stmts[ i ] );
 
@@ -11302,6 +11794,8 @@ void finish_instance_op( class_base& instance, bool apply_changes,
                   sql += " = " + all_column_values[ column_numbers[ unique_index_columns[ j ] ] ];
                }
 
+               execute_deferred_sql_inserts( );
+
                TRACE_LOG( TRACE_SQLSTMTS, sql );
 
                sql_dataset ds( *gtp_session->ap_db.get( ), sql );
@@ -11732,6 +12226,8 @@ bool perform_instance_iterate( class_base& instance,
             if( instance_accessor.p_sql_data( ) )
                delete instance_accessor.p_sql_data( );
 
+            execute_deferred_sql_inserts( );
+
             if( !group_keys.empty( ) )
             {
                vector< string > sql_stmts;
@@ -11743,8 +12239,24 @@ bool perform_instance_iterate( class_base& instance,
                   TRACE_LOG( TRACE_SQLSTMTS, sql_stmts.back( ) );
                }
 
-               instance_accessor.p_sql_data( ) = new sql_dataset_group(
-                *gtp_session->ap_db, sql_stmts, ( direction == e_iter_direction_backwards ), true );
+               // NOTE: If the server has been configured to permit it then the statements are executed
+               // concurrently (using a connection pool belonging to the storage) and the results merged
+               // (this is not done within a transaction as other connections won't see its changes).
+               sql_db_pool* p_db_pool = 0;
+               sql_query_pool* p_query_pool = 0;
+
+               if( sql_stmts.size( ) > 1 && gtp_session->transactions.empty( ) )
+               {
+                  p_db_pool = gtp_session->p_storage_handler->get_sql_db_pool( g_max_sql_group_connections );
+                  p_query_pool = gtp_session->p_storage_handler->get_sql_query_pool( );
+               }
+
+               if( p_db_pool && p_query_pool )
+                  instance_accessor.p_sql_data( ) = new sql_dataset_group( *p_db_pool, *p_query_pool,
+                   sql_stmts, ( direction == e_iter_direction_backwards ), true, ( row_limit > 0 ? row_limit : 0 ) );
+               else
+                  instance_accessor.p_sql_data( ) = new sql_dataset_group( *gtp_session->ap_db,
+                   sql_stmts, ( direction == e_iter_direction_backwards ), true, ( row_limit > 0 ? row_limit : 0 ) );
             }
             else
             {
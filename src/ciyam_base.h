@@ -34,6 +34,8 @@ class class_base;
 class command_handler;
 class ods_file_system;
 
+struct smtp_user_info;
+
 #  define TRACE_COMMANDS   0x00000001
 #  define TRACE_SQLSTMTS   0x00000002
 #  define TRACE_CLASSOPS   0x00000004
@@ -113,6 +115,10 @@ extern "C" void CIYAM_BASE_DECL_SPEC check_timezone_info( );
 
 typedef void ( *fp_check_timezone_info )( );
 
+extern "C" void CIYAM_BASE_DECL_SPEC compact_storage_data( );
+
+typedef void ( *fp_compact_storage_data )( );
+
 std::string CIYAM_BASE_DECL_SPEC get_string( const std::string& key );
 
 std::string CIYAM_BASE_DECL_SPEC get_string_message(
@@ -194,6 +200,11 @@ std::string CIYAM_BASE_DECL_SPEC get_smtp_security( );
 int CIYAM_BASE_DECL_SPEC get_smtp_max_send_attempts( );
 int64_t CIYAM_BASE_DECL_SPEC get_smtp_max_attached_data( );
 
+bool CIYAM_BASE_DECL_SPEC spool_smtp_message( const std::string& host, const smtp_user_info& user_info,
+ const std::vector< std::string >& recipients, const std::string& data );
+
+std::string CIYAM_BASE_DECL_SPEC get_smtp_spool_stats( );
+
 struct external_client
 {
    external_client( ) : port( 0 ), is_local( false ) { }
@@ -239,6 +250,13 @@ void CIYAM_BASE_DECL_SPEC init_session(
 
 void CIYAM_BASE_DECL_SPEC term_session( );
 
+// NOTE: A session can be detached from its thread (whilst it is waiting for its next command) and
+// then be attached to another thread in order to be resumed (which is used by session workers).
+bool CIYAM_BASE_DECL_SPEC can_detach_session( );
+
+size_t CIYAM_BASE_DECL_SPEC detach_session( );
+void CIYAM_BASE_DECL_SPEC attach_session( size_t sess_id );
+
 size_t CIYAM_BASE_DECL_SPEC session_id( );
 
 bool CIYAM_BASE_DECL_SPEC has_session_with_ip_addr( const std::string& ip_addr );
@@ -279,6 +297,7 @@ void CIYAM_BASE_DECL_SPEC condemn_this_session( );
 void CIYAM_BASE_DECL_SPEC condemn_all_other_sessions( int num_seconds, bool force_uncapture, bool wait_until_term );
 
 bool CIYAM_BASE_DECL_SPEC is_condemned_session( );
+bool CIYAM_BASE_DECL_SPEC is_condemned_session( size_t sess_id );
 
 void CIYAM_BASE_DECL_SPEC capture_session( size_t sess_id );
 void CIYAM_BASE_DECL_SPEC capture_all_other_sessions( );
@@ -299,6 +318,8 @@ void CIYAM_BASE_DECL_SPEC session_skip_is_constained( bool skip_fk_fetches );
 
 bool CIYAM_BASE_DECL_SPEC get_script_reconfig( );
 
+unsigned int CIYAM_BASE_DECL_SPEC get_script_workers( );
+
 std::string CIYAM_BASE_DECL_SPEC get_pem_password( );
 std::string CIYAM_BASE_DECL_SPEC get_rpc_password( );
 std::string CIYAM_BASE_DECL_SPEC get_sql_password( );
@@ -321,6 +342,8 @@ unsigned int CIYAM_BASE_DECL_SPEC get_num_sessions_for_blockchain( const std::st
 unsigned int CIYAM_BASE_DECL_SPEC get_session_timeout( );
 void CIYAM_BASE_DECL_SPEC set_session_timeout( unsigned int seconds );
 
+unsigned int CIYAM_BASE_DECL_SPEC get_session_workers( );
+
 void CIYAM_BASE_DECL_SPEC add_peer_file_hash_for_get( const std::string& hash );
 
 void CIYAM_BASE_DECL_SPEC store_repository_entry_record( const std::string& key,
@@ -412,6 +435,10 @@ void CIYAM_BASE_DECL_SPEC storage_cache_clear( );
 size_t CIYAM_BASE_DECL_SPEC storage_cache_limit( );
 size_t CIYAM_BASE_DECL_SPEC storage_cache_limit( size_t new_limit );
 
+// NOTE: The change version of a class is incremented whenever a transaction that has created,
+// updated or destroyed any of its instances has been committed.
+size_t CIYAM_BASE_DECL_SPEC storage_class_change_version( const std::string& class_id );
+
 void CIYAM_BASE_DECL_SPEC slice_storage_log( command_handler& cmd_handler,
  const std::string& name, const std::vector< std::string >& module_list );
 void CIYAM_BASE_DECL_SPEC splice_storage_log( command_handler& cmd_handler,
@@ -74,6 +74,7 @@
 #include "fcgi_view.h"
 #include "fcgi_utils.h"
 #include "fcgi_parser.h"
+#include "socket_pool.h"
 #include "crypt_stream.h"
 #include "fcgi_process.h"
 
@@ -95,7 +96,7 @@ namespace
 
 #include "ciyam_constants.h"
 
-const int c_num_handlers = 10;
+const int c_server_socket_wait_timeout = 5000;
 
 const size_t c_max_fcgi_input_size = 65536;
 const size_t c_max_param_input_size = 4096;
@@ -184,9 +185,9 @@ bool g_is_blockchain_application = false;
 
 size_t g_max_user_limit = 1;
 
-mutex g_session_mutex;
+mutex g_request_mutex;
 
-session_container g_sessions;
+session_table g_session_table( c_timeout_seconds );
 
 map< string, string > g_uuid_for_ip_addr;
 
@@ -198,233 +199,457 @@ string g_id_pwd;
 
 int g_unlock_fails = 0;
 
-string g_login_html;
-string g_footer_html;
-string g_openup_html;
-string g_signup_html;
-string g_unlock_html;
-string g_activate_html;
-string g_identity_html;
-string g_password_html;
-string g_ssl_signup_html;
-string g_no_identity_html;
-string g_authenticate_html;
-
-string g_login_password_html;
-string g_ciyam_interface_html;
-string g_login_persistent_html;
-string g_password_persistent_html;
-
 string g_display_login_info;
 string g_display_change_password;
 string g_display_sign_up_for_an_account;
 
-#ifdef USE_MULTIPLE_REQUEST_HANDLERS
-#  ifdef SSL_SUPPORT
-vector< pair< bool, ssl_socket* > > g_sockets;
-#  else
-vector< pair< bool, tcp_socket* > > g_sockets;
-#  endif
+namespace
+{
 
-mutex g_socket_mutex;
+enum interface_slot
+{
+   e_interface_slot_title,
+   e_interface_slot_direction,
+   e_interface_slot_form_content,
+   e_interface_slot_extra_content,
+   e_interface_slot_total
+};
 
-#  ifdef SSL_SUPPORT
-ssl_socket* get_tcp_socket( )
-#  else
-tcp_socket* get_tcp_socket( )
-#  endif
+mutex g_template_mutex;
+
+mutex g_html_forms_mutex;
+html_forms* gp_html_forms = 0;
+
+map< string, html_template > g_html_templates;
+
+// NOTE: An interface template is loaded once and then rendered without holding the template mutex
+// (a reference is held whilst it is being rendered so that a template which has been replaced by a
+// reload is only deleted after the last render that was using it has finished).
+struct interface_template
 {
-   guard g( g_socket_mutex );
+   interface_template( ) : num_refs( 0 ), is_current( true ) { }
 
-#  ifdef SSL_SUPPORT
-   ssl_socket* p_socket = 0;
-#  else
-   tcp_socket* p_socket = 0;
-#endif
+   size_t num_refs;
+   bool is_current;
 
-   if( g_sockets.empty( ) )
-      g_sockets.resize( c_num_handlers );
+   html_template tmpl;
+};
 
-   for( size_t i = 0; i < g_sockets.size( ); i++ )
-   {
-      if( !g_sockets[ i ].first )
-      {
-         g_sockets[ i ].first = true;
+map< string, interface_template* > g_interface_templates;
 
-         if( !g_sockets[ i ].second )
-#  ifdef SSL_SUPPORT
-            g_sockets[ i ].second = new ssl_socket;
-#  else
-            g_sockets[ i ].second = new tcp_socket;
-#  endif
-         p_socket = g_sockets[ i ].second;
-         break;
-      }
-   }
+void release_interface_template( interface_template* p_template )
+{
+   guard g( g_template_mutex );
 
-   return p_socket;
+   if( !--p_template->num_refs && !p_template->is_current )
+      delete p_template;
 }
 
-void release_socket( tcp_socket* p_socket )
+class interface_template_ref
 {
-   guard g( g_socket_mutex );
+   public:
+   interface_template_ref( const string& file_name );
+   ~interface_template_ref( ) { release_interface_template( p_template ); }
+
+   const html_template& operator *( ) const { return p_template->tmpl; }
+   const html_template* operator ->( ) const { return &p_template->tmpl; }
+
+   private:
+   interface_template* p_template;
+
+   interface_template_ref( const interface_template_ref& );
+   interface_template_ref& operator =( const interface_template_ref& );
+};
 
-   for( size_t i = 0; i < g_sockets.size( ); i++ )
+interface_template_ref::interface_template_ref( const string& file_name )
+{
+   guard g( g_template_mutex );
+
+   map< string, interface_template* >::iterator i = g_interface_templates.find( file_name );
+
+   if( i == g_interface_templates.end( ) )
    {
-      if( g_sockets[ i ].second == p_socket )
-      {
-         g_sockets[ i ].first = false;
-         break;
-      }
+      vector< string > placeholders;
+
+      placeholders.push_back( c_title );
+      placeholders.push_back( c_direction );
+      placeholders.push_back( c_form_content_comment );
+      placeholders.push_back( c_extra_content_comment );
+
+      auto_ptr< interface_template > ap_template( new interface_template );
+      ap_template->tmpl.load( file_name, placeholders );
+
+      i = g_interface_templates.insert( make_pair( file_name, ap_template.release( ) ) ).first;
    }
+
+   p_template = i->second;
+   ++p_template->num_refs;
 }
 
-void disconnect_socket( tcp_socket* p_socket )
+void clear_interface_templates( )
 {
-   guard g( g_socket_mutex );
+   map< string, interface_template* >::iterator i;
+   for( i = g_interface_templates.begin( ); i != g_interface_templates.end( ); ++i )
+   {
+      i->second->is_current = false;
+
+      if( !i->second->num_refs )
+         delete i->second;
+   }
+
+   g_interface_templates.clear( );
+}
+
+typedef vector< pair< string, string > > template_bindings;
 
-   for( size_t i = 0; i < g_sockets.size( ); i++ )
+bool load_html_template( const char* p_file_name,
+ string& html, const template_bindings& bindings, bool is_optional = false )
+{
+   if( is_optional && !file_exists( p_file_name ) )
    {
-      if( g_sockets[ i ].second == p_socket )
-      {
-         if( g_sockets[ i ].second && g_sockets[ i ].second->okay( ) )
-         {
-            g_sockets[ i ].second->close( );
-            delete g_sockets[ i ].second;
-         }
+      g_html_templates.erase( p_file_name );
 
-         g_sockets[ i ].first = false;
-         g_sockets[ i ].second = 0;
-         break;
-      }
+      bool had_html = !html.empty( );
+      html.erase( );
+
+      return had_html;
    }
+
+   vector< string > placeholders;
+   for( size_t i = 0; i < bindings.size( ); i++ )
+      placeholders.push_back( bindings[ i ].first );
+
+   html_template& tmpl( g_html_templates[ p_file_name ] );
+
+   // NOTE: The file is only read and compiled if it has not already been or has since been modified.
+   if( !tmpl.load( p_file_name, placeholders ) )
+      return false;
+
+   for( size_t i = 0; i < bindings.size( ); i++ )
+      tmpl.bind( i, bindings[ i ].second );
+
+   html = tmpl.text( );
+
+   return true;
 }
 
-void disconnect_sockets( bool released_only )
+void load_html_templates( )
 {
-   guard g( g_socket_mutex );
+   guard g( g_template_mutex );
 
-   for( size_t i = 0; i < g_sockets.size( ); i++ )
+   // NOTE: Interface templates will be loaded again when they are next rendered.
+   clear_interface_templates( );
+
+   // NOTE: The new forms start as a copy of the current ones as only those forms whose templates
+   // have been modified will be recompiled (and the current ones may still be in use).
+   auto_ptr< html_forms > ap_forms( new html_forms );
+
+   // NOTE: Scope for guard object.
    {
-      if( released_only && g_sockets[ i ].first )
-         continue;
+      guard g( g_html_forms_mutex );
 
-      if( g_sockets[ i ].second && g_sockets[ i ].second->okay( ) )
+      if( gp_html_forms )
       {
-         g_sockets[ i ].second->close( );
-         delete g_sockets[ i ].second;
+         *ap_forms = *gp_html_forms;
+         ap_forms->num_refs = 0;
       }
-
-      g_sockets[ i ].first = false;
-      g_sockets[ i ].second = 0;
    }
+
+   template_bindings bindings;
+
+   load_html_template( c_footer_file, ap_forms->footer_html, bindings );
+   load_html_template( c_ciyam_interface_file, ap_forms->ciyam_interface_html, bindings );
+
+   bindings.push_back( make_pair( c_login, GDS( c_display_login ) ) );
+   bindings.push_back( make_pair( c_user_id, GDS( c_display_user_id ) ) );
+   bindings.push_back( make_pair( c_password, GDS( c_display_password ) ) );
+
+   load_html_template( c_login_file, ap_forms->login_html, bindings );
+
+   bindings.clear( );
+   bindings.push_back( make_pair( c_user_name, GDS( c_display_user_name ) ) );
+   bindings.push_back( make_pair( c_account_type, GDS( c_display_account_type ) ) );
+   bindings.push_back( make_pair( c_send_request, GDS( c_display_send_request ) ) );
+   bindings.push_back( make_pair( c_account_type_0, GDS( c_display_account_type_0 ) ) );
+   bindings.push_back( make_pair( c_account_type_1, GDS( c_display_account_type_1 ) ) );
+   bindings.push_back( make_pair( c_account_type_2, GDS( c_display_account_type_2 ) ) );
+   bindings.push_back( make_pair( c_account_type_3, GDS( c_display_account_type_3 ) ) );
+   bindings.push_back( make_pair( c_open_up_introduction, GDS( c_display_open_up_openid_account_introduction ) ) );
+
+   load_html_template( c_openup_file, ap_forms->openup_html, bindings );
+
+   bindings.clear( );
+   bindings.push_back( make_pair( c_continue, GDS( c_display_continue ) ) );
+   bindings.push_back( make_pair( c_unlock_message, GDS( c_display_unlock_message ) ) );
+
+   load_html_template( c_unlock_file, ap_forms->unlock_html, bindings );
+
+   bindings.clear( );
+   bindings.push_back( make_pair( c_user_id, GDS( c_display_user_id ) ) );
+   bindings.push_back( make_pair( c_account_type, GDS( c_display_account_type ) ) );
+   bindings.push_back( make_pair( c_send_request, GDS( c_display_send_request ) ) );
+   bindings.push_back( make_pair( c_account_type_0, GDS( c_display_account_type_0 ) ) );
+   bindings.push_back( make_pair( c_account_type_1, GDS( c_display_account_type_1 ) ) );
+   bindings.push_back( make_pair( c_account_type_2, GDS( c_display_account_type_2 ) ) );
+   bindings.push_back( make_pair( c_account_type_3, GDS( c_display_account_type_3 ) ) );
+   bindings.push_back( make_pair( c_gpg_public_key, GDS( c_display_gpg_public_key ) ) );
+   bindings.push_back( make_pair( c_sign_up_introduction, GDS( c_display_sign_up_main_form_client_security_introduction ) ) );
+   bindings.push_back( make_pair( c_sign_up_extra_details, GDS( c_display_sign_up_main_form_client_security_extra_details ) ) );
+   bindings.push_back( make_pair( c_sign_up_gpg_expert_tip, GDS( c_display_sign_up_main_form_client_security_gpg_expert_tip ) ) );
+
+   load_html_template( c_signup_file, ap_forms->signup_html, bindings );
+
+   // NOTE: The user id in the activation form is only known when it is being output.
+   bindings.clear( );
+   bindings.push_back( make_pair( c_login, GDS( c_display_login ) ) );
+   bindings.push_back( make_pair( c_password, GDS( c_display_password ) ) );
+   bindings.push_back( make_pair( c_persistent, GDS( c_display_automatic_login ) ) );
+   bindings.push_back( make_pair( c_verify_password, GDS( c_display_verify_password ) ) );
+
+   load_html_template( c_activate_file, ap_forms->activate_html, bindings );
+
+   // NOTE: The identity entropy is the server id so is only known when the form is being output.
+   bindings.clear( );
+   bindings.push_back( make_pair( c_identity_introduction_1, GDS( c_display_identity_introduction_1 ) ) );
+   bindings.push_back( make_pair( c_identity_introduction_2, GDS( c_display_identity_introduction_2 ) ) );
+   bindings.push_back( make_pair( c_identity, GDS( c_display_identity ) ) );
+   bindings.push_back( make_pair( c_confirm_identity, GDS( c_display_confirm_identity ) ) );
+   bindings.push_back( make_pair( c_password, GDS( c_display_password ) ) );
+   bindings.push_back( make_pair( c_verify_password, GDS( c_display_verify_password ) ) );
+
+   load_html_template( c_identity_file, ap_forms->identity_html, bindings );
+
+   bindings.clear( );
+   bindings.push_back( make_pair( c_old_password, GDS( c_display_old_password ) ) );
+   bindings.push_back( make_pair( c_new_password, GDS( c_display_new_password ) ) );
+   bindings.push_back( make_pair( c_change_password, GDS( c_display_change_password ) ) );
+   bindings.push_back( make_pair( c_verify_new_password, GDS( c_display_verify_new_password ) ) );
+
+   load_html_template( c_password_file, ap_forms->password_html, bindings );
+
+   bindings.clear( );
+   bindings.push_back( make_pair( c_email, GDS( c_display_email ) ) );
+   bindings.push_back( make_pair( c_user_id, GDS( c_display_user_id ) ) );
+   bindings.push_back( make_pair( c_password, GDS( c_display_password ) ) );
+   bindings.push_back( make_pair( c_verify_password, GDS( c_display_verify_password ) ) );
+   bindings.push_back( make_pair( c_account_type, GDS( c_display_account_type ) ) );
+   bindings.push_back( make_pair( c_send_request, GDS( c_display_send_request ) ) );
+   bindings.push_back( make_pair( c_account_type_0, GDS( c_display_account_type_0 ) ) );
+   bindings.push_back( make_pair( c_account_type_1, GDS( c_display_account_type_1 ) ) );
+   bindings.push_back( make_pair( c_account_type_2, GDS( c_display_account_type_2 ) ) );
+   bindings.push_back( make_pair( c_account_type_3, GDS( c_display_account_type_3 ) ) );
+   bindings.push_back( make_pair( c_ssl_sign_up_introduction, GDS( c_display_ssl_sign_up_main_form ) ) );
+   bindings.push_back( make_pair( c_ssl_sign_up_extra_details, GDS( c_display_ssl_sign_up_main_form_extra_details ) ) );
+
+   load_html_template( c_ssl_signup_file, ap_forms->ssl_signup_html, bindings );
+
+   bindings.clear( );
+   bindings.push_back( make_pair( c_identity_missing, GDS( c_display_identity_missing_message ) ) );
+   bindings.push_back( make_pair( c_identity_retry_message,
+    string_message( GDS( c_display_click_here_to_retry ),
+    make_pair( c_display_click_here_to_retry_parm_href, "<a href=\"javascript:refresh( )\">" ), "</a>" ) ) );
+
+   load_html_template( c_no_identity_file, ap_forms->no_identity_html, bindings );
+
+   bindings.clear( );
+   bindings.push_back( make_pair( c_pin_name, GDS( c_display_pin ) ) );
+   bindings.push_back( make_pair( c_pin_message, GDS( c_display_pin_message ) ) );
+   bindings.push_back( make_pair( c_continue, GDS( c_display_continue ) ) );
+
+   load_html_template( c_authenticate_file, ap_forms->authenticate_html, bindings );
+
+   bindings.clear( );
+   bindings.push_back( make_pair( c_login, GDS( c_display_login ) ) );
+   bindings.push_back( make_pair( c_password, GDS( c_display_password ) ) );
+
+   load_html_template( c_login_password_file, ap_forms->login_password_html, bindings, true );
+
+   bindings.clear( );
+   bindings.push_back( make_pair( c_login, GDS( c_display_login ) ) );
+   bindings.push_back( make_pair( c_user_id, GDS( c_display_user_id ) ) );
+   bindings.push_back( make_pair( c_password, GDS( c_display_password ) ) );
+   bindings.push_back( make_pair( c_persistent, GDS( c_display_automatic_login ) ) );
+
+   load_html_template( c_login_persistent_file, ap_forms->login_persistent_html, bindings, true );
+
+   bindings.clear( );
+   bindings.push_back( make_pair( c_old_password, GDS( c_display_old_password ) ) );
+   bindings.push_back( make_pair( c_new_password, GDS( c_display_new_password ) ) );
+   bindings.push_back( make_pair( c_persistent, GDS( c_display_automatic_login ) ) );
+   bindings.push_back( make_pair( c_change_password, GDS( c_display_change_password ) ) );
+   bindings.push_back( make_pair( c_verify_new_password, GDS( c_display_verify_new_password ) ) );
+
+   load_html_template( c_password_persistent_file, ap_forms->password_persistent_html, bindings, true );
+
+   guard gf( g_html_forms_mutex );
+
+   html_forms* p_old_forms = gp_html_forms;
+   gp_html_forms = ap_forms.release( );
+
+   if( p_old_forms && !p_old_forms->num_refs )
+      delete p_old_forms;
 }
 
-void remove_sockets( )
+bool html_templates_have_changed( )
 {
-   guard g( g_socket_mutex );
+   guard g( g_template_mutex );
 
-   for( size_t i = 0; i < g_sockets.size( ); i++ )
+   map< string, html_template >::const_iterator ci;
+   for( ci = g_html_templates.begin( ); ci != g_html_templates.end( ); ++ci )
    {
-      if( g_sockets[ i ].second )
-      {
-         delete g_sockets[ i ].second;
-         g_sockets[ i ].second = 0;
-      }
+      if( ci->second.has_changed( ) )
+         return true;
+   }
+
+   map< string, interface_template* >::const_iterator ici;
+   for( ici = g_interface_templates.begin( ); ici != g_interface_templates.end( ); ++ici )
+   {
+      if( ici->second->tmpl.has_changed( ) )
+         return true;
    }
+
+   html_forms_ref forms;
+
+   return file_exists( c_login_password_file ) != !forms->login_password_html.empty( )
+    || file_exists( c_login_persistent_file ) != !forms->login_persistent_html.empty( )
+    || file_exists( c_password_persistent_file ) != !forms->password_persistent_html.empty( );
 }
-#endif
 
-size_t get_num_sessions( )
+void render_interface_html( const string& file_name, string& output, const vector< const string* >& values )
 {
-   guard g( g_session_mutex );
+   interface_template_ref tmpl( file_name );
+
+#ifdef DEBUG
+   clock_t start = clock( );
+#endif
 
-   return g_sessions.size( );
+   tmpl->render( output, values );
+
+   DEBUG_TRACE( "[rendered " + file_name + " in "
+    + to_string( ( clock( ) - start ) * 1000000 / CLOCKS_PER_SEC ) + " usecs]" );
 }
 
-void add_session_info( const string& session_id, session_info* p_session_info )
+}
+
+html_forms_ref::html_forms_ref( )
 {
-   guard g( g_session_mutex );
+   guard g( g_html_forms_mutex );
 
-   g_sessions.insert( session_value_type( session_id, p_session_info ) );
+   if( !gp_html_forms )
+      gp_html_forms = new html_forms;
+
+   p_forms = gp_html_forms;
+   ++p_forms->num_refs;
 }
 
-void destroy_session( const string& session_id )
+html_forms_ref::~html_forms_ref( )
 {
-   guard g( g_session_mutex );
+   guard g( g_html_forms_mutex );
 
-   session_iterator si = g_sessions.find( session_id );
-   if( si != g_sessions.end( ) )
-   {
-      delete si->second;
-      g_sessions.erase( si );
-   }
+   if( !--p_forms->num_refs && p_forms != gp_html_forms )
+      delete p_forms;
 }
 
-bool has_session_info( const string& session_id )
+#ifdef USE_MULTIPLE_REQUEST_HANDLERS
+#  ifdef SSL_SUPPORT
+socket_pool< ssl_socket > g_socket_pool( c_default_server_sockets );
+#  else
+socket_pool< tcp_socket > g_socket_pool( c_default_server_sockets );
+#  endif
+
+mutex g_socket_mutex;
+
+#  ifdef SSL_SUPPORT
+ssl_socket* get_tcp_socket( const tcp_socket* p_preferred )
+#  else
+tcp_socket* get_tcp_socket( const tcp_socket* p_preferred )
+#  endif
 {
-   guard g( g_session_mutex );
+   // NOTE: If there are more request handlers than server sockets then a request will wait for
+   // a socket to be released (rather than failing immediately as the service being too busy).
+   return g_socket_pool.obtain_socket( c_server_socket_wait_timeout, p_preferred );
+}
 
-   return ( g_sessions.count( session_id ) > 0 );
+void release_socket( tcp_socket* p_socket )
+{
+   g_socket_pool.release_socket( p_socket );
 }
 
-bool has_user_session_info( const string& user_id, const char* p_module = 0 )
+void disconnect_socket( tcp_socket* p_socket )
 {
-   guard g( g_session_mutex );
+   g_socket_pool.disconnect_socket( p_socket );
+}
 
-   for( session_iterator si = g_sessions.begin( ), end = g_sessions.end( ); si != end; ++si )
-   {
-      if( p_module && string( p_module ) != ( si->second )->user_module )
-         continue;
+void disconnect_sockets( bool released_only )
+{
+   g_socket_pool.disconnect_sockets( released_only );
+}
 
-      if( user_id == ( si->second )->user_id )
-         return true;
-   }
+void remove_sockets( )
+{
+   g_socket_pool.disconnect_sockets( false );
+}
+#endif
 
-   return false;
+size_t get_num_sessions( )
+{
+   return g_session_table.size( );
 }
 
-void destroy_user_session_info( const string& user_id, const char* p_module = 0 )
+void add_session_info( const string& session_id, session_info* p_session_info )
 {
-   guard g( g_session_mutex );
+   g_session_table.insert( session_id, p_session_info );
+}
 
-   session_iterator si, end;
-   for( si = g_sessions.begin( ), end = g_sessions.end( ); si != end; ++si )
-   {
-      if( p_module && string( p_module ) != ( si->second )->user_module )
-         continue;
+void destroy_session( const string& session_id )
+{
+   g_session_table.remove( session_id );
+}
 
-      if( user_id == ( si->second )->user_id )
-         break;
-   }
+bool has_session_info( const string& session_id )
+{
+   return g_session_table.contains( session_id );
+}
 
-   if( si != g_sessions.end( ) )
-   {
-      if( si->second->locked )
-         throw runtime_error( GDS( c_display_you_are_currently_logged_in ) );
+bool has_user_session_info( const string& user_id, const char* p_module = 0 )
+{
+   return g_session_table.has_user( user_id, p_module );
+}
 
-      delete si->second;
-      g_sessions.erase( si );
-   }
+void destroy_user_session_info( const string& user_id, const char* p_module = 0 )
+{
+   if( !g_session_table.remove_user( user_id, p_module ) )
+      throw runtime_error( GDS( c_display_you_are_currently_logged_in ) );
 }
 
 session_info* get_session_info( const string& session_id, bool lock_session = true )
 {
-   guard g( g_session_mutex );
+   return g_session_table.acquire( session_id, lock_session );
+}
 
-   session_iterator si = g_sessions.find( session_id );
+// NOTE: Holds the reference that was acquired for a session (releasing it when either another
+// session is being referenced or the object goes out of scope).
+class session_reference
+{
+   public:
+   session_reference( ) : p_session_info( 0 ) { }
 
-   if( si == g_sessions.end( ) )
-      return 0;
-   else if( si->second->locked )
-      return 0;
-   else
+   ~session_reference( ) { reset( ); }
+
+   void reset( session_info* p_new_session_info = 0 )
    {
-      if( lock_session )
-         si->second->locked = true;
-      return si->second;
+      if( p_session_info )
+         g_session_table.release( p_session_info );
+
+      p_session_info = p_new_session_info;
    }
-}
+
+   private:
+   session_info* p_session_info;
+
+   session_reference( const session_reference& );
+   session_reference& operator =( const session_reference& );
+};
 
 inline const string& data_or_nbsp( const string& input )
 {
@@ -564,52 +789,44 @@ void timeout_handler::on_start( )
    {
       msleep( 1000 );
 
-      guard g( g_session_mutex );
-
-      vector< session_iterator > dead_sessions;
+      vector< session_info* > expired_sessions;
 
-      time_t tm_now( time( 0 ) );
+      g_session_table.expire( time( 0 ), expired_sessions );
 
-      for( session_iterator si = g_sessions.begin( ), end = g_sessions.end( ); si != end; ++si )
+      for( size_t i = 0; i < expired_sessions.size( ); i++ )
       {
-         if( ( si->second )->locked )
-            continue;
+         session_info* p_session_info = expired_sessions[ i ];
 
-         if( tm_now - ( si->second )->tm_last_request > c_timeout_seconds )
+         // KLUDGE: For some unknown reason occasionally this code is being executed for
+         // anonymous sessions (this should be investigated further at some stage).
+         if( !p_session_info->user_id.empty( ) || !p_session_info->user_name.empty( ) )
          {
-            // KLUDGE: For some unknown reason occasionally this code is being executed for
-            // anonymous sessions (this should be investigated further at some stage).
-            if( !si->second->user_id.empty( ) || !si->second->user_name.empty( ) )
-            {
-               LOG_TRACE( "[timeout: "
-                + ( si->second->user_name.empty( ) ? si->second->user_id : si->second->user_name )
-                + " at " + date_time::local( ).as_string( true, false ) + " from " + si->second->ip_addr + "]" );
-            }
+            LOG_TRACE( "[timeout: "
+             + ( p_session_info->user_name.empty( ) ? p_session_info->user_id : p_session_info->user_name )
+             + " at " + date_time::local( ).as_string( true, false ) + " from " + p_session_info->ip_addr + "]" );
+         }
 
-            if( si->second->p_socket )
-            {
-               if( !g_is_blockchain_application )
-                  release_socket( si->second->p_socket );
-               else
-                  disconnect_socket( si->second->p_socket );
-            }
+         if( p_session_info->p_socket )
+         {
+            if( !g_is_blockchain_application )
+               release_socket( p_session_info->p_socket );
+            else
+               disconnect_socket( p_session_info->p_socket );
+         }
 
-            remove_session_temp_directory( si->second->session_id );
+         remove_session_temp_directory( p_session_info->session_id );
 
-            delete si->second;
-            dead_sessions.push_back( si );
-         }
+         g_session_table.release( p_session_info );
       }
 
-      for( size_t i = 0; i < dead_sessions.size( ); i++ )
-         g_sessions.erase( dead_sessions[ i ] );
-
 #ifdef USE_MULTIPLE_REQUEST_HANDLERS
       if( file_exists( c_stop_file ) )
          disconnect_sockets( true );
 #endif
-      if( g_sessions.empty( ) )
+      if( !g_session_table.size( ) )
       {
+         guard g( g_request_mutex );
+
 #ifdef USE_MULTIPLE_REQUEST_HANDLERS
          disconnect_sockets( false );
 #else
@@ -645,6 +862,10 @@ void timeout_handler::on_start( )
             module_index_iterator mii;
             for( mii = get_storage_info( ).modules_index.begin( ); mii != get_storage_info( ).modules_index.end( ); ++mii )
                read_module_info( mii->first, *mii->second, get_storage_info( ) );
+
+#ifdef USE_MULTIPLE_REQUEST_HANDLERS
+            g_socket_pool.set_max_sockets( get_storage_info( ).server_sockets );
+#endif
          }
 
          if( file_exists( c_extkeys_file ) )
@@ -653,6 +874,9 @@ void timeout_handler::on_start( )
             if( t != get_storage_info( ).extkeys_mod )
                init_extkeys( );
          }
+
+         if( html_templates_have_changed( ) )
+            load_html_templates( );
       }
 
 #ifdef _WIN32
@@ -745,8 +969,13 @@ void request_handler::process_request( )
    string session_id;
    string interface_file;
    session_info* p_session_info = 0;
+   session_reference session_ref;
    ostringstream form_content, extra_content;
 
+   // NOTE: The forms are referenced once per request so that a template reload (which is done
+   // by the timeout handler) cannot change or free them while this request is using them.
+   html_forms_ref forms;
+
    bool cookies_permitted = false;
 
    DEBUG_TRACE( "[process request]" );
@@ -823,6 +1052,7 @@ void request_handler::process_request( )
       if( !session_id.empty( ) && session_id != c_new_session )
       {
          p_session_info = get_session_info( session_id, false );
+         session_ref.reset( p_session_info );
 
          if( p_session_info )
          {
@@ -940,6 +1170,7 @@ void request_handler::process_request( )
          if( user.empty( ) || ( !user.empty( ) && hash == get_user_hash( user ) ) )
          {
             p_session_info = get_session_info( session_id, false );
+            session_ref.reset( p_session_info );
 
             if( !p_session_info )
             {
@@ -1051,7 +1282,7 @@ void request_handler::process_request( )
           && ( !using_anonymous || ( is_activation && file_exists( activation_file ) ) ) )
          {
             string login_html( !cookies_permitted || !get_storage_info( ).login_days
-             || g_login_persistent_html.empty( ) ? g_login_html : g_login_persistent_html );
+             || forms->login_persistent_html.empty( ) ? forms->login_html : forms->login_persistent_html );
 
             if( cmd != c_cmd_activate )
             {
@@ -1063,7 +1294,7 @@ void request_handler::process_request( )
                if( chksum != get_checksum( c_cmd_activate + user + data ) )
                   throw runtime_error( GDS( c_display_invalid_url ) );
 
-               string activate_html( g_activate_html );
+               string activate_html( forms->activate_html );
                str_replace( activate_html, c_user_id, user );
 
                string message( "<p><b>"
@@ -1128,6 +1359,7 @@ void request_handler::process_request( )
       {
          new_session = false;
          p_session_info = get_session_info( session_id );
+         session_ref.reset( p_session_info );
 
          if( p_session_info )
          {
@@ -1156,10 +1388,10 @@ void request_handler::process_request( )
                 << ": " << GDS( c_display_your_session_has_been_terminated ) << ".</p>\n";
 
             string login_html( !cookies_permitted || !get_storage_info( ).login_days
-             || g_login_persistent_html.empty( ) ? g_login_html : g_login_persistent_html );
+             || forms->login_persistent_html.empty( ) ? forms->login_html : forms->login_persistent_html );
 
             if( g_is_blockchain_application )
-               login_html = g_login_password_html;
+               login_html = forms->login_password_html;
 
             output_form( module_name, extra_content, login_html, osstr.str( ) );
 
@@ -1176,7 +1408,10 @@ void request_handler::process_request( )
       }
       else
       {
-         guard g( g_session_mutex );
+         // NOTE: The session table itself is not locked whilst a request is being processed but
+         // the module and storage info (which are updated here and can be reloaded by the timeout
+         // handler) are shared so request processing is still serialised.
+         guard g( g_request_mutex );
 
          bool was_unlock = false;
          bool is_meta_module = false;
@@ -1190,7 +1425,7 @@ void request_handler::process_request( )
 #ifndef USE_MULTIPLE_REQUEST_HANDLERS
             p_session_info->p_socket = &g_socket;
 #else
-            p_session_info->p_socket = get_tcp_socket( );
+            p_session_info->p_socket = get_tcp_socket( p_session_info->p_last_socket );
             if( !p_session_info->p_socket )
                throw runtime_error( GDS( c_display_service_busy_try_again_later ) );
 #endif
@@ -1417,46 +1652,24 @@ void request_handler::process_request( )
 
                            if( needs_to_unlock )
                            {
-                              string unlock_html( g_unlock_html );
+                              string unlock_html( forms->unlock_html );
 
                               output_form( module_name, extra_content,
                                unlock_html, "", false, GDS( c_display_system_unlock ) );
                            }
                            else if( is_meta_module )
                            {
-                              string identity_html( g_identity_html );
-
-                              str_replace( identity_html,
-                               c_identity_introduction_1, GDS( c_display_identity_introduction_1 ) );
-
-                              str_replace( identity_html,
-                               c_identity_introduction_2, GDS( c_display_identity_introduction_2 ) );
+                              string identity_html( forms->identity_html );
 
                               str_replace( identity_html, c_identity_entropy, server_id );
 
-                              str_replace( identity_html, c_identity, GDS( c_display_identity ) );
-                              str_replace( identity_html, c_confirm_identity, GDS( c_display_confirm_identity ) );
-
-                              str_replace( identity_html, c_password, GDS( c_display_password ) );
-                              str_replace( identity_html, c_verify_password, GDS( c_display_verify_password ) );
-
                               output_form( module_name, extra_content,
                                identity_html, "", false, GDS( c_display_confirm_identity ) );
                            }
                            else
                            {
-                              string no_identity_html( g_no_identity_html );
-
-                              str_replace( no_identity_html,
-                               c_identity_missing, GDS( c_display_identity_missing_message ) );
-
-                              str_replace( no_identity_html, c_identity_retry_message,
-                               string_message( GDS( c_display_click_here_to_retry ),
-                               make_pair( c_display_click_here_to_retry_parm_href,
-                               "<a href=\"javascript:refresh( )\">" ), "</a>" ) );
-
                               output_form( module_name, extra_content,
-                               no_identity_html, "", false, GDS( c_display_identity_missing ) );
+                               forms->no_identity_html, "", false, GDS( c_display_identity_missing ) );
                            }
 
                            g_id = old_id;
@@ -2706,10 +2919,10 @@ void request_handler::process_request( )
       if( !is_logged_in && !using_anonymous )
       {
          string login_html( !cookies_permitted || !get_storage_info( ).login_days
-          || g_login_persistent_html.empty( ) ? g_login_html : g_login_persistent_html );
+          || forms->login_persistent_html.empty( ) ? forms->login_html : forms->login_persistent_html );
 
          if( g_is_blockchain_application )
-            login_html = g_login_password_html;
+            login_html = forms->login_password_html;
 
          if( created_session && p_session_info->logged_in )
          {
@@ -2741,7 +2954,7 @@ void request_handler::process_request( )
              "<a href=\"javascript:refresh( )\">" ), "</a>" ) << "</p>\n";
          }
 
-         extra_content << g_footer_html;
+         extra_content << forms->footer_html;
          extra_content << "</div>\n";
       }
 
@@ -2810,55 +3023,24 @@ void request_handler::process_request( )
       }
    }
 
-   string interface_html;
-   if( interface_file.empty( ) )
-      interface_html = g_ciyam_interface_html;
-   else
-      interface_html = buffer_file( interface_file );
-
-   remove_utf8_bom( interface_html );
-
    string direction;
    if( is_vertical )
       direction = "vertical";
    else
       direction = "horizontal";
 
-   replace( interface_html, c_direction, direction );
-
-   string output;
-   size_t pos = interface_html.find( c_title );
-   if( pos != string::npos )
-   {
-      output += interface_html.substr( 0, pos );
-      output += title;
-      pos += strlen( c_title );
-   }
-   else
-      pos = 0;
-
-   size_t cpos = interface_html.find( c_form_content_comment, pos );
-
-   if( cpos != string::npos )
-   {
-      output += interface_html.substr( pos, cpos - pos );
-      output += form_content.str( );
-      cpos += strlen( c_form_content_comment );
-   }
-   else
-      cpos = pos;
-
-   size_t epos = interface_html.find( c_extra_content_comment, cpos );
+   string form_content_html( form_content.str( ) );
+   string extra_content_html( extra_content.str( ) );
 
-   if( epos != string::npos )
-   {
-      output += interface_html.substr( cpos, epos - cpos );
-      output += extra_content.str( );
+   vector< const string* > slot_values( e_interface_slot_total );
 
-      cpos = epos + strlen( c_extra_content_comment );
-   }
+   slot_values[ e_interface_slot_title ] = &title;
+   slot_values[ e_interface_slot_direction ] = &direction;
+   slot_values[ e_interface_slot_form_content ] = &form_content_html;
+   slot_values[ e_interface_slot_extra_content ] = &extra_content_html;
 
-   output += interface_html.substr( cpos );
+   string output;
+   render_interface_html( interface_file.empty( ) ? string( c_ciyam_interface_file ) : interface_file, output, slot_values );
 
    if( encrypt_data )
    {
@@ -2897,7 +3079,8 @@ void request_handler::process_request( )
    FCGX_FPrintF( p_out, "Content-Type: text/html; charset=UTF-8\n" );
    FCGX_FPrintF( p_out, "\r\n\r\n" );
 
-   FCGX_FPrintF( p_out, "%s\n", output.c_str( ) );
+   output += '\n';
+   FCGX_PutStr( output.data( ), output.size( ), p_out );
 
 #ifdef USE_MULTIPLE_REQUEST_HANDLERS
    FCGX_Finish_r( &request );
@@ -2909,6 +3092,8 @@ void request_handler::process_request( )
    if( p_session_info && p_session_info->p_socket && !g_is_blockchain_application )
    {
       release_socket( p_session_info->p_socket );
+
+      p_session_info->p_last_socket = p_session_info->p_socket;
       p_session_info->p_socket = 0;
    }
 #endif
@@ -2962,108 +3147,11 @@ int main( int argc, char* argv[ ] )
       init_strings( );
       init_extkeys( );
 
-      g_login_html = buffer_file( c_login_file );
-      g_footer_html = buffer_file( c_footer_file );
-      g_openup_html = buffer_file( c_openup_file );
-      g_signup_html = buffer_file( c_signup_file );
-      g_unlock_html = buffer_file( c_unlock_file );
-      g_activate_html = buffer_file( c_activate_file );
-      g_identity_html = buffer_file( c_identity_file );
-      g_password_html = buffer_file( c_password_file );
-      g_ssl_signup_html = buffer_file( c_ssl_signup_file );
-      g_no_identity_html = buffer_file( c_no_identity_file );
-      g_authenticate_html = buffer_file( c_authenticate_file );
-
-      g_ciyam_interface_html = buffer_file( c_ciyam_interface_file );
+      load_html_templates( );
 
       if( file_exists( c_id_file ) )
          g_id = buffer_file( c_id_file );
 
-      str_replace( g_login_html, c_login, GDS( c_display_login ) );
-      str_replace( g_login_html, c_user_id, GDS( c_display_user_id ) );
-      str_replace( g_login_html, c_password, GDS( c_display_password ) );
-
-      str_replace( g_openup_html, c_user_name, GDS( c_display_user_name ) );
-      str_replace( g_openup_html, c_account_type, GDS( c_display_account_type ) );
-      str_replace( g_openup_html, c_send_request, GDS( c_display_send_request ) );
-      str_replace( g_openup_html, c_account_type_0, GDS( c_display_account_type_0 ) );
-      str_replace( g_openup_html, c_account_type_1, GDS( c_display_account_type_1 ) );
-      str_replace( g_openup_html, c_account_type_2, GDS( c_display_account_type_2 ) );
-      str_replace( g_openup_html, c_account_type_3, GDS( c_display_account_type_3 ) );
-      str_replace( g_openup_html, c_open_up_introduction, GDS( c_display_open_up_openid_account_introduction ) );
-
-      str_replace( g_unlock_html, c_continue, GDS( c_display_continue ) );
-      str_replace( g_unlock_html, c_unlock_message, GDS( c_display_unlock_message ) );
-
-      str_replace( g_signup_html, c_user_id, GDS( c_display_user_id ) );
-      str_replace( g_signup_html, c_account_type, GDS( c_display_account_type ) );
-      str_replace( g_signup_html, c_send_request, GDS( c_display_send_request ) );
-      str_replace( g_signup_html, c_account_type_0, GDS( c_display_account_type_0 ) );
-      str_replace( g_signup_html, c_account_type_1, GDS( c_display_account_type_1 ) );
-      str_replace( g_signup_html, c_account_type_2, GDS( c_display_account_type_2 ) );
-      str_replace( g_signup_html, c_account_type_3, GDS( c_display_account_type_3 ) );
-      str_replace( g_signup_html, c_gpg_public_key, GDS( c_display_gpg_public_key ) );
-      str_replace( g_signup_html, c_sign_up_introduction, GDS( c_display_sign_up_main_form_client_security_introduction ) );
-      str_replace( g_signup_html, c_sign_up_extra_details, GDS( c_display_sign_up_main_form_client_security_extra_details ) );
-      str_replace( g_signup_html, c_sign_up_gpg_expert_tip, GDS( c_display_sign_up_main_form_client_security_gpg_expert_tip ) );
-
-      str_replace( g_activate_html, c_login, GDS( c_display_login ) );
-      str_replace( g_activate_html, c_password, GDS( c_display_password ) );
-      str_replace( g_activate_html, c_persistent, GDS( c_display_automatic_login ) );
-      str_replace( g_activate_html, c_verify_password, GDS( c_display_verify_password ) );
-
-      str_replace( g_password_html, c_old_password, GDS( c_display_old_password ) );
-      str_replace( g_password_html, c_new_password, GDS( c_display_new_password ) );
-      str_replace( g_password_html, c_change_password, GDS( c_display_change_password ) );
-      str_replace( g_password_html, c_verify_new_password, GDS( c_display_verify_new_password ) );
-
-      str_replace( g_ssl_signup_html, c_email, GDS( c_display_email ) );
-      str_replace( g_ssl_signup_html, c_user_id, GDS( c_display_user_id ) );
-      str_replace( g_ssl_signup_html, c_password, GDS( c_display_password ) );
-      str_replace( g_ssl_signup_html, c_verify_password, GDS( c_display_verify_password ) );
-      str_replace( g_ssl_signup_html, c_account_type, GDS( c_display_account_type ) );
-      str_replace( g_ssl_signup_html, c_send_request, GDS( c_display_send_request ) );
-      str_replace( g_ssl_signup_html, c_account_type_0, GDS( c_display_account_type_0 ) );
-      str_replace( g_ssl_signup_html, c_account_type_1, GDS( c_display_account_type_1 ) );
-      str_replace( g_ssl_signup_html, c_account_type_2, GDS( c_display_account_type_2 ) );
-      str_replace( g_ssl_signup_html, c_account_type_3, GDS( c_display_account_type_3 ) );
-      str_replace( g_ssl_signup_html, c_ssl_sign_up_introduction, GDS( c_display_ssl_sign_up_main_form ) );
-      str_replace( g_ssl_signup_html, c_ssl_sign_up_extra_details, GDS( c_display_ssl_sign_up_main_form_extra_details ) );
-
-      str_replace( g_authenticate_html, c_pin_name, GDS( c_display_pin ) );
-      str_replace( g_authenticate_html, c_pin_message, GDS( c_display_pin_message ) );
-      str_replace( g_authenticate_html, c_continue, GDS( c_display_continue ) );
-
-      if( file_exists( c_login_password_file ) )
-      {
-         g_login_password_html = buffer_file( c_login_password_file );
-
-         str_replace( g_login_password_html, c_login, GDS( c_display_login ) );
-         str_replace( g_login_password_html, c_password, GDS( c_display_password ) );
-      }
-
-      if( file_exists( c_login_persistent_file ) )
-      {
-         g_login_persistent_html = buffer_file( c_login_persistent_file );
-
-         str_replace( g_login_persistent_html, c_login, GDS( c_display_login ) );
-         str_replace( g_login_persistent_html, c_user_id, GDS( c_display_user_id ) );
-         str_replace( g_login_persistent_html, c_password, GDS( c_display_password ) );
-         str_replace( g_login_persistent_html, c_persistent, GDS( c_display_automatic_login ) );
-      }
-
-      if( file_exists( c_password_persistent_file ) )
-      {
-         g_password_persistent_html = buffer_file( c_password_persistent_file );
-
-         str_replace( g_password_persistent_html, c_old_password, GDS( c_display_old_password ) );
-         str_replace( g_password_persistent_html, c_new_password, GDS( c_display_new_password ) );
-         str_replace( g_password_persistent_html, c_persistent, GDS( c_display_automatic_login ) );
-         str_replace( g_password_persistent_html, c_change_password, GDS( c_display_change_password ) );
-         str_replace( g_password_persistent_html, c_change_password, GDS( c_display_change_password ) );
-         str_replace( g_password_persistent_html, c_verify_new_password, GDS( c_display_verify_new_password ) );
-      }
-
       g_display_login_info = GDS( c_display_login_info );
       g_display_change_password = GDS( c_display_change_password );
       g_display_sign_up_for_an_account = GDS( c_display_sign_up_for_an_account );
@@ -3072,6 +3160,10 @@ int main( int argc, char* argv[ ] )
 
       read_global_storage_info( );
 
+#ifdef USE_MULTIPLE_REQUEST_HANDLERS
+      g_socket_pool.set_max_sockets( get_storage_info( ).server_sockets );
+#endif
+
       DEBUG_TRACE( "[now starting handlers]" );
 
       // NOTE: Scope for timeout handler temporary object.
@@ -3094,7 +3186,7 @@ int main( int argc, char* argv[ ] )
 #  endif
          {
             // NOTE: Start all but one as separate threads - the main thread runs the final handler.
-            for( size_t i = 1; i < c_num_handlers; i++ )
+            for( size_t i = 1; i < get_storage_info( ).request_handlers; i++ )
             {
                request_handler* p_request_handler = new request_handler;
                p_request_handler->start( );
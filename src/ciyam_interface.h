@@ -33,6 +33,9 @@ const bool c_default_checkbox_bools = false;
 
 const size_t c_default_filesize_limit = 0;
 
+const size_t c_default_server_sockets = 10;
+const size_t c_default_request_handlers = 10;
+
 const char* const c_default_int_mask = "-##########";
 const char* const c_default_numeric_mask = "-##############.#####";
 
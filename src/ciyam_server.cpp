@@ -231,24 +231,28 @@ const char* const c_trace_flags_func_name = "trace_flags";
 const char* const c_init_globals_func_name = "init_globals";
 const char* const c_term_globals_func_name = "term_globals";
 const char* const c_init_auto_script_func_name = "init_auto_script";
+const char* const c_term_auto_script_func_name = "term_auto_script";
 const char* const c_log_trace_string_func_name = "log_trace_string";
 const char* const c_register_listener_func_name = "register_listener";
 const char* const c_init_ciyam_session_func_name = "init_ciyam_session";
 const char* const c_init_peer_sessions_func_name = "init_peer_sessions";
 const char* const c_check_timezone_info_func_name = "check_timezone_info";
 const char* const c_is_accepted_ip_addr_func_name = "is_accepted_ip_addr";
+const char* const c_compact_storage_data_func_name = "compact_storage_data";
 const char* const c_unregister_listener_func_name = "unregister_listener";
 #else
 const char* const c_trace_flags_func_name = "_trace_flags";
 const char* const c_init_globals_func_name = "_init_globals";
 const char* const c_term_globals_func_name = "_term_globals";
 const char* const c_init_auto_script_func_name = "_init_auto_script";
+const char* const c_term_auto_script_func_name = "_term_auto_script";
 const char* const c_log_trace_string_func_name = "_log_trace_string";
 const char* const c_register_listener_func_name = "_register_listener";
 const char* const c_init_ciyam_session_func_name = "_init_ciyam_session";
 const char* const c_init_peer_sessions_func_name = "_init_peer_sessions";
 const char* const c_check_timezone_info_func_name = "_check_timezone_info";
 const char* const c_is_accepted_ip_addr_func_name = "_is_accepted_ip_addr";
+const char* const c_compact_storage_data_func_name = "_compact_storage_data";
 const char* const c_unregister_listener_func_name = "_unregister_listener";
 #endif
 
@@ -507,6 +511,9 @@ int main( int argc, char* argv[ ] )
          fp_init_auto_script fp_init_auto_script_func;
          fp_init_auto_script_func = ( fp_init_auto_script )ap_dynamic_library->bind_to_function( c_init_auto_script_func_name );
 
+         fp_term_auto_script fp_term_auto_script_func;
+         fp_term_auto_script_func = ( fp_term_auto_script )ap_dynamic_library->bind_to_function( c_term_auto_script_func_name );
+
          fp_log_trace_string fp_log_trace_string_func;
          fp_log_trace_string_func = ( fp_log_trace_string )ap_dynamic_library->bind_to_function( c_log_trace_string_func_name );
 
@@ -522,6 +529,9 @@ int main( int argc, char* argv[ ] )
          fp_check_timezone_info fp_check_timezone_info_func;
          fp_check_timezone_info_func = ( fp_check_timezone_info )ap_dynamic_library->bind_to_function( c_check_timezone_info_func_name );
 
+         fp_compact_storage_data fp_compact_storage_data_func;
+         fp_compact_storage_data_func = ( fp_compact_storage_data )ap_dynamic_library->bind_to_function( c_compact_storage_data_func_name );
+
          fp_is_accepted_ip_addr fp_is_accepted_ip_addr_func;
          fp_is_accepted_ip_addr_func = ( fp_is_accepted_ip_addr )ap_dynamic_library->bind_to_function( c_is_accepted_ip_addr_func_name );
 
@@ -590,6 +600,11 @@ int main( int argc, char* argv[ ] )
                   {
                      reported_shutdown = true;
 
+                     // NOTE: The autoscript session will be waiting until its next script
+                     // is due so it needs to be told to finish now.
+                     if( g_start_autoscript )
+                        ( *fp_term_auto_script_func )( );
+
                      if( !g_is_quiet )
                         cout << "server shutdown (due to interrupt) now underway..." << endl;
                   }
@@ -607,6 +622,11 @@ int main( int argc, char* argv[ ] )
                    && ( !g_active_sessions || ( g_start_autoscript && g_active_sessions == 1 ) ) )
                      ( *fp_check_timezone_info_func )( );
 
+                  // NOTE: Storage compaction (if configured) is only performed when there are no active
+                  // sessions at all (as the autoscript session could be using storage at any time).
+                  if( !g_server_shutdown && !g_active_sessions )
+                     ( *fp_compact_storage_data_func )( );
+
                   // NOTE: Check for accepts and create new sessions.
 #ifdef SSL_SUPPORT
                   auto_ptr< ssl_socket > ap_socket( new ssl_socket( s.accept( address, c_accept_timeout ) ) );
@@ -624,6 +644,9 @@ int main( int argc, char* argv[ ] )
                {
                   g_server_shutdown = 1;
 
+                  if( g_start_autoscript )
+                     ( *fp_term_auto_script_func )( );
+
                   // NOTE: Wait for all active sessions and peer listeners to finish up before continuing.
                   while( g_active_sessions || g_active_listeners )
                      msleep( c_accept_timeout * 2 );
@@ -41,6 +41,7 @@
 #  include "pdf_gen.h"
 #endif
 #include "threads.h"
+#include "reactor.h"
 #include "progress.h"
 #include "pointers.h"
 #include "utilities.h"
@@ -84,6 +85,13 @@ const size_t c_request_timeout = 500;
 
 const int c_pdf_default_limit = 10000;
 
+// NOTE: A fetch cursor will query for this many pages of rows at a time.
+const size_t c_fetch_cursor_window_pages = 5;
+
+const int64_t c_fetch_cursor_max_idle_seconds = 600;
+
+const size_t c_fetch_cursors_memory_budget = 4194304; // i.e. 4MB
+
 const size_t c_max_key_append_chars = 7;
 
 const char* const c_unexpected_unknown_exception = "unexpected unknown exception caught";
@@ -894,6 +902,87 @@ void add_final_pdf_variables( const map< string, string >& variables,
       }
    }
 }
+
+// NOTE: Provides the rows of a fetch (which must already be positioned at its first record) to the
+// PDF generator on demand so that the variables for all records do not need to be held in memory.
+class pdf_fetch_row_source : public pdf_gen_row_source
+{
+   public:
+   pdf_fetch_row_source( size_t handle, const string& context,
+    const vector< string >& field_list, vector< summary_info >& summaries, const string& tz_name,
+    const map< string, string >& set_value_items, const set< string >& filter_set,
+    int num_limit, size_t& num_found, bool has_current )
+    :
+    handle( handle ),
+    context( context ),
+    field_list( field_list ),
+    summaries( summaries ),
+    tz_name( tz_name ),
+    set_value_items( set_value_items ),
+    filter_set( filter_set ),
+    num_limit( num_limit ),
+    num_found( num_found ),
+    has_current( has_current )
+   {
+   }
+
+   bool next_row( map< string, string >& variables )
+   {
+      while( has_current )
+      {
+         for( map< string, string >::const_iterator i = set_value_items.begin( ), end = set_value_items.end( ); i != end; ++i )
+         {
+            // NOTE: If a field to be set starts with @ then it is instead assumed to be a "variable".
+            if( !i->first.empty( ) && i->first[ 0 ] != '@' )
+            {
+               string method_name_and_args( "set " );
+               method_name_and_args += i->first + " ";
+               method_name_and_args += "\"" + escaped( i->second, "\"", c_nul ) + "\"";
+
+               execute_object_command( handle, context, method_name_and_args );
+            }
+         }
+
+         if( !set_value_items.empty( ) )
+            prepare_object_instance( handle, context, false );
+
+         if( ( !filter_set.empty( ) || instance_has_transient_filter_fields( handle, context ) )
+          && instance_filtered( handle, context ) )
+         {
+            has_current = instance_iterate_next( handle, context );
+            continue;
+         }
+
+         add_pdf_variables( handle, context, field_list, summaries, variables, tz_name, false, num_found );
+
+         if( g_server_shutdown || ( num_limit && ++num_found >= num_limit ) )
+         {
+            instance_iterate_stop( handle, context );
+            has_current = false;
+         }
+         else
+            has_current = instance_iterate_next( handle, context );
+
+         return true;
+      }
+
+      return false;
+   }
+
+   private:
+   size_t handle;
+   const string& context;
+   const vector< string >& field_list;
+   vector< summary_info >& summaries;
+   const string& tz_name;
+   const map< string, string >& set_value_items;
+   const set< string >& filter_set;
+
+   int num_limit;
+   size_t& num_found;
+
+   bool has_current;
+};
 #endif
 
 void parse_field_values( const string& module,
@@ -1189,6 +1278,60 @@ void read_log_transformation_info( const string& file_name, map< string, string
    }
 }
 
+// NOTE: A fetch cursor keeps a "perform_fetch" instance iteration open (after it has output
+// a page of rows) so that a request for the next page (identified by the client's cursor
+// token) can continue on from where the last page ended without performing a new query.
+struct fetch_cursor
+{
+   fetch_cursor( )
+    :
+    handle( 0 ),
+    num_limit( 0 ),
+    window_size( 0 ),
+    rows_iterated( 0 ),
+    output_bytes( 0 ),
+    change_version( 0 ),
+    last_used( 0 )
+   {
+   }
+
+   size_t estimated_memory( ) const
+   {
+      size_t remaining = window_size > rows_iterated ? window_size - rows_iterated : 0;
+      size_t average = rows_iterated ? output_bytes / rows_iterated : 0;
+
+      return sizeof( fetch_cursor ) + signature.size( ) + last_key.size( ) + last_output.size( ) + ( remaining * average );
+   }
+
+   bool can_continue( int limit ) const
+   {
+      // NOTE: The first row of the next page is the last row that had been output so only
+      // the rows after this need to remain within the window that was originally queried.
+      return num_limit == limit && rows_iterated + limit - 1 <= window_size;
+   }
+
+   size_t handle;
+   string owner;
+   string context;
+   string class_id;
+   string signature;
+
+   int num_limit;
+
+   size_t window_size;
+   size_t rows_iterated;
+   size_t output_bytes;
+
+   string last_key;
+   string last_output;
+
+   vector< string > default_values;
+
+   size_t change_version;
+
+   int64_t last_used;
+};
+
 class socket_command_handler : public command_handler
 {
    public:
@@ -1200,7 +1343,9 @@ class socket_command_handler : public command_handler
     :
     socket( socket ),
     lock_expires( 0 ),
-    restoring( false )
+    restoring( false ),
+    fetch_cursor_hits( 0 ),
+    fetch_cursor_misses( 0 )
    {
       locked = !get_rpc_password( ).empty( );
    }
@@ -1251,7 +1396,20 @@ class socket_command_handler : public command_handler
 
    auto_ptr< restorable< bool > > set_restoring( ) { return auto_ptr< restorable< bool > >( new restorable< bool >( restoring, true ) ); }
 
+   fetch_cursor* get_fetch_cursor( const string& token, const string& signature );
+
+   void park_fetch_cursor( const string& token, const fetch_cursor& cursor );
+
+   void release_fetch_cursor( const string& token );
+   void release_fetch_cursors( );
+
+   void expire_fetch_cursors( );
+   bool has_expired_fetch_cursors( ) const;
+
+   void count_fetch_cursor_use( bool was_continued );
+
    private:
+
    string preprocess_command_and_args( const string& cmd_and_args );
 
    void postprocess_command_and_args( const string& cmd_and_args );
@@ -1283,8 +1441,141 @@ class socket_command_handler : public command_handler
    string restore_error;
 
    map< string, string > transformations;
+
+   map< string, fetch_cursor > fetch_cursors;
+
+   size_t fetch_cursor_hits;
+   size_t fetch_cursor_misses;
 };
 
+fetch_cursor* socket_command_handler::get_fetch_cursor( const string& token, const string& signature )
+{
+   expire_fetch_cursors( );
+
+   map< string, fetch_cursor >::iterator i = fetch_cursors.find( token );
+
+   if( i == fetch_cursors.end( ) )
+      return 0;
+
+   // NOTE: A cursor is only continued for the same user that it had been opened for (as the
+   // session may be one that is shared by different users via the FCGI interface's socket pool)
+   // and provided that no changes to its class have been committed (by any session) since the
+   // query that it is continuing had been performed.
+   if( i->second.signature != signature || i->second.owner != get_uid( )
+    || i->second.change_version != storage_class_change_version( i->second.class_id ) )
+   {
+      release_fetch_cursor( token );
+      return 0;
+   }
+
+   i->second.last_used = unix_timestamp( );
+
+   return &i->second;
+}
+
+void socket_command_handler::park_fetch_cursor( const string& token, const fetch_cursor& cursor )
+{
+   map< string, fetch_cursor >::iterator i = fetch_cursors.find( token );
+
+   if( i != fetch_cursors.end( ) && i->second.handle != cursor.handle )
+      release_fetch_cursor( token );
+
+   fetch_cursors[ token ] = cursor;
+   fetch_cursors[ token ].owner = get_uid( );
+   fetch_cursors[ token ].last_used = unix_timestamp( );
+
+   expire_fetch_cursors( );
+}
+
+void socket_command_handler::release_fetch_cursor( const string& token )
+{
+   map< string, fetch_cursor >::iterator i = fetch_cursors.find( token );
+
+   if( i != fetch_cursors.end( ) )
+   {
+      size_t handle = i->second.handle;
+      string context( i->second.context );
+
+      fetch_cursors.erase( i );
+
+      // NOTE: The instance may have already been destroyed (such as if its module was unloaded).
+      try
+      {
+         instance_iterate_stop( handle, context );
+         destroy_object_instance( handle );
+      }
+      catch( ... )
+      {
+      }
+   }
+}
+
+void socket_command_handler::release_fetch_cursors( )
+{
+   while( !fetch_cursors.empty( ) )
+      release_fetch_cursor( fetch_cursors.begin( )->first );
+}
+
+void socket_command_handler::expire_fetch_cursors( )
+{
+   int64_t now = unix_timestamp( );
+
+   size_t total_memory = 0;
+
+   vector< string > expired;
+   multimap< int64_t, string > least_recently_used;
+
+   for( map< string, fetch_cursor >::iterator i = fetch_cursors.begin( ); i != fetch_cursors.end( ); ++i )
+   {
+      if( now - i->second.last_used > c_fetch_cursor_max_idle_seconds )
+         expired.push_back( i->first );
+      else
+      {
+         total_memory += i->second.estimated_memory( );
+         least_recently_used.insert( make_pair( i->second.last_used, i->first ) );
+      }
+   }
+
+   for( size_t i = 0; i < expired.size( ); i++ )
+      release_fetch_cursor( expired[ i ] );
+
+   // NOTE: If the estimated memory used by the cursors exceeds the budget then those
+   // that have been idle the longest are released until it no longer does (although
+   // the most recently used cursor is always kept).
+   while( total_memory > c_fetch_cursors_memory_budget && least_recently_used.size( ) > 1 )
+   {
+      string token( least_recently_used.begin( )->second );
+      least_recently_used.erase( least_recently_used.begin( ) );
+
+      total_memory -= fetch_cursors[ token ].estimated_memory( );
+      release_fetch_cursor( token );
+   }
+}
+
+bool socket_command_handler::has_expired_fetch_cursors( ) const
+{
+   int64_t now = unix_timestamp( );
+
+   for( map< string, fetch_cursor >::const_iterator i = fetch_cursors.begin( ); i != fetch_cursors.end( ); ++i )
+   {
+      if( now - i->second.last_used > c_fetch_cursor_max_idle_seconds )
+         return true;
+   }
+
+   return false;
+}
+
+void socket_command_handler::count_fetch_cursor_use( bool was_continued )
+{
+   if( was_continued )
+      ++fetch_cursor_hits;
+   else
+      ++fetch_cursor_misses;
+
+   TRACE_LOG( TRACE_SESSIONS, "fetch cursor hits: "
+    + to_string( fetch_cursor_hits ) + ", misses: " + to_string( fetch_cursor_misses ) );
+}
+
 string socket_command_handler::preprocess_command_and_args( const string& cmd_and_args )
 {
    string str( cmd_and_args );
@@ -1395,6 +1686,13 @@ void ciyam_session_command_functor::operator ( )( const string& command, const p
    if( command != c_cmd_ciyam_session_quit && !socket_handler.is_restoring( ) )
       socket.set_delay( );
 
+   // NOTE: Any commands that could change records (or the instances in use) will release
+   // all fetch cursors so that a following page will not be missing any recent changes.
+   if( command != c_cmd_ciyam_session_perform_fetch
+    && ( command.find( "perform_" ) == 0 || command.find( "storage_" ) == 0
+    || command.find( "module_" ) == 0 || command.find( "object_" ) == 0 ) )
+      socket_handler.release_fetch_cursors( );
+
    set_dtm( "" );
    set_grp( "" );
    set_uid( "" );
@@ -2414,6 +2712,8 @@ void ciyam_session_command_functor::operator ( )( const string& command, const p
          string search_text( get_parm_val( parameters, c_cmd_ciyam_session_perform_fetch_search_text ) );
          string search_query( get_parm_val( parameters, c_cmd_ciyam_session_perform_fetch_search_query ) );
          string extra_vars( get_parm_val( parameters, c_cmd_ciyam_session_perform_fetch_extra_vars ) );
+         string cursor( get_parm_val( parameters, c_cmd_ciyam_session_perform_fetch_cursor ) );
+         string cursor_next( get_parm_val( parameters, c_cmd_ciyam_session_perform_fetch_cursor_next ) );
          string key_info( get_parm_val( parameters, c_cmd_ciyam_session_perform_fetch_key_info ) );
          string limit( get_parm_val( parameters, c_cmd_ciyam_session_perform_fetch_limit ) );
          string set_values( get_parm_val( parameters, c_cmd_ciyam_session_perform_fetch_set_values ) );
@@ -2428,6 +2728,19 @@ void ciyam_session_command_functor::operator ( )( const string& command, const p
 
          string blockchain( get_raw_session_variable( get_special_var_name( e_special_var_blockchain ) ) );
 
+         // NOTE: The cursor signature consists of all the arguments other than the "dtm" and
+         // "key_info" so that a cursor will only be continued for an identical list request.
+         string cursor_signature;
+
+         if( !cursor.empty( ) )
+         {
+            cursor_signature = module + '\n' + mclass + '\n' + to_string( is_reverse )
+             + '\n' + uid + '\n' + grp + '\n' + tmp_dir + '\n' + tz_name + '\n' + filters
+             + '\n' + perms + '\n' + security_info + '\n' + search_text + '\n' + search_query
+             + '\n' + extra_vars + '\n' + limit + '\n' + set_values + '\n' + fields
+             + '\n' + to_string( minimal ) + '\n' + to_string( no_default_values ) + '\n' + map_file;
+         }
+
 #ifndef HPDF_SUPPORT
          if( create_pdf )
             throw runtime_error( "pdf generation has not been compiled into this server" );
@@ -2564,20 +2877,63 @@ void ciyam_session_command_functor::operator ( )( const string& command, const p
             }
          }
 
+         // NOTE: Cursors are not used for PDFs, summaries or filtered lists (as for the latter the
+         // number of rows that will be output from the rows remaining in the window is not known).
+         bool use_cursor = !cursor.empty( ) && !create_pdf
+          && summaries.empty( ) && filter_set.empty( ) && num_limit > 1
+          && ( key_info.empty( ) || key_info[ 0 ] != ' ' );
+
+         fetch_cursor* p_cursor = 0;
+
+         // NOTE: The "cursor_next" value is the key of the first row of the next page (which is
+         // required to match the last row that had been output for the cursor to be continued).
+         if( use_cursor && !cursor_next.empty( ) )
+         {
+            p_cursor = socket_handler.get_fetch_cursor( cursor, cursor_signature );
+
+            if( p_cursor && ( p_cursor->last_key != cursor_next || !p_cursor->can_continue( num_limit ) ) )
+            {
+               socket_handler.release_fetch_cursor( cursor );
+               p_cursor = 0;
+            }
+
+            socket_handler.count_fetch_cursor_use( p_cursor != 0 );
+         }
+         else if( !cursor.empty( ) )
+            socket_handler.release_fetch_cursor( cursor );
+
          // KLUDGE: Assume a dynamic instance is needed if a context has been supplied
          // as there is no simple way to otherwise determine this (maybe it's not even
          // worth worrying about trying to optimise this behaviour).
-         size_t handle = create_object_instance( module, mclass, 0,
+         size_t handle = p_cursor ? p_cursor->handle : create_object_instance( module, mclass, 0,
           !context.empty( ) || get_module_class_has_derivations( module, mclass ) );
 
+         string cursor_class_id;
+         size_t cursor_change_version = 0;
+
+         // NOTE: The class change version is obtained before querying so that a cursor will not
+         // be continued if any change to the class is committed after the query was performed.
+         if( p_cursor )
+         {
+            cursor_class_id = p_cursor->class_id;
+            cursor_change_version = p_cursor->change_version;
+         }
+         else if( use_cursor )
+         {
+            cursor_class_id = get_class_id( handle, context );
+            cursor_change_version = storage_class_change_version( cursor_class_id );
+         }
+
          vector< string > default_values;
 
-         if( no_default_values )
+         if( p_cursor )
+            default_values = p_cursor->default_values;
+         else if( no_default_values )
             get_field_values( handle, context, field_list, tz_name, true, false, &default_values );
 
          // NOTE: The purpose of "extra_vars" is to allow the setting of instance
          // variables that don't have a '@' prefix.
-         if( !extra_vars.empty( ) )
+         if( !p_cursor && !extra_vars.empty( ) )
          {
             vector< string > extras;
             split( extra_vars, extras );
@@ -2594,7 +2950,7 @@ void ciyam_session_command_functor::operator ( )( const string& command, const p
             }
          }
 
-         for( map< string, string >::iterator i = set_value_items.begin( ), end = set_value_items.end( ); i != end; ++i )
+         for( map< string, string >::iterator i = set_value_items.begin( ), end = set_value_items.end( ); !p_cursor && i != end; ++i )
          {
             // NOTE: If a field to be set starts with @ then it is instead assumed to be a "variable".
             if( !i->first.empty( ) && i->first[ 0 ] == '@' )
@@ -2611,6 +2967,8 @@ void ciyam_session_command_functor::operator ( )( const string& command, const p
             }
          }
 
+         bool handle_is_parked = false;
+
          try
          {
             set_dtm( dtm );
@@ -2728,16 +3086,52 @@ void ciyam_session_command_functor::operator ( )( const string& command, const p
                   }
                }
 #endif
-               if( !set_value_items.empty( ) )
+               if( !p_cursor && !set_value_items.empty( ) )
                   instance_set_variable( handle, context, get_special_var_name( e_special_var_skip_after_fetch ), "1" );
 
-               if( instance_iterate( handle, context,
-                key_info, normal_fields, search_text, search_query, security_info,
-                is_reverse ? e_iter_direction_backwards : e_iter_direction_forwards,
-                true, num_limit, e_sql_optimisation_none, !filter_set.empty( ) ? &filter_set : 0 ) )
+               bool found = false;
+
+               size_t rows_iterated = 0;
+               size_t output_bytes = 0;
+
+               string last_output;
+
+               // NOTE: Unless summaries are required (which need all rows in order to be sorted) a
+               // multi-row PDF has its rows fetched on demand as the document is being generated.
+               bool stream_pdf = create_pdf && summaries.empty( ) && num_limit != 1;
+
+               if( !p_cursor )
+               {
+                  // NOTE: If using a cursor then query for a window of several pages of rows.
+                  found = instance_iterate( handle, context,
+                   key_info, normal_fields, search_text, search_query, security_info,
+                   is_reverse ? e_iter_direction_backwards : e_iter_direction_forwards, true,
+                   use_cursor ? num_limit * c_fetch_cursor_window_pages : num_limit,
+                   e_sql_optimisation_none, !filter_set.empty( ) ? &filter_set : 0 );
+
+                  if( found && use_cursor && instance_has_transient_filter_fields( handle, context ) )
+                     use_cursor = false;
+               }
+               else
+               {
+                  // NOTE: As the next page starts with the last row of the previous page that
+                  // row's output is repeated and then the iteration is continued from there.
+                  socket.write_line( p_cursor->last_output, c_request_timeout, p_progress );
+
+                  ++num_found;
+
+                  rows_iterated = p_cursor->rows_iterated;
+                  output_bytes = p_cursor->output_bytes;
+
+                  found = instance_iterate_next( handle, context );
+               }
+
+               if( found && !stream_pdf )
                {
                   do
                   {
+                     ++rows_iterated;
+
                      for( map< string, string >::iterator i = set_value_items.begin( ), end = set_value_items.end( ); i != end; ++i )
                      {
                         // NOTE: If a field to be set starts with @ then it is instead assumed to be a "variable".
@@ -2784,7 +3178,15 @@ void ciyam_session_command_functor::operator ( )( const string& command, const p
                         }
 
                         if( summaries.empty( ) )
+                        {
                            socket.write_line( output, c_request_timeout, p_progress );
+
+                           if( use_cursor )
+                           {
+                              last_output = output;
+                              output_bytes += output.size( );
+                           }
+                        }
                         else
                         {
                            string prefix;
@@ -2801,7 +3203,36 @@ void ciyam_session_command_functor::operator ( )( const string& command, const p
 
                      if( g_server_shutdown || ( num_limit && ++num_found >= num_limit ) )
                      {
-                        instance_iterate_stop( handle, context );
+                        // NOTE: If using a cursor then the iteration is left open (unless no more
+                        // rows were queried) so that it can be continued for the following page.
+                        if( use_cursor && !g_server_shutdown
+                         && rows_iterated < ( p_cursor ? p_cursor->window_size : num_limit * c_fetch_cursor_window_pages ) )
+                        {
+                           fetch_cursor new_cursor;
+
+                           new_cursor.handle = handle;
+                           new_cursor.context = context;
+                           new_cursor.class_id = cursor_class_id;
+                           new_cursor.signature = cursor_signature;
+
+                           new_cursor.num_limit = num_limit;
+
+                           new_cursor.window_size = p_cursor ? p_cursor->window_size : num_limit * c_fetch_cursor_window_pages;
+                           new_cursor.rows_iterated = rows_iterated;
+                           new_cursor.output_bytes = output_bytes;
+
+                           new_cursor.last_key = instance_key_info( handle, context, true );
+                           new_cursor.last_output = last_output;
+                           new_cursor.default_values = default_values;
+
+                           new_cursor.change_version = cursor_change_version;
+
+                           socket_handler.park_fetch_cursor( cursor, new_cursor );
+                           handle_is_parked = true;
+                        }
+                        else
+                           instance_iterate_stop( handle, context );
+
                         break;
                      }
                   } while( instance_iterate_next( handle, context ) );
@@ -2810,20 +3241,34 @@ void ciyam_session_command_functor::operator ( )( const string& command, const p
                if( create_pdf )
                {
 #ifdef HPDF_SUPPORT
-                  if( !num_found )
+                  if( stream_pdf )
                   {
-                     add_pdf_variables( handle, context,
-                      field_list, summaries, pdf_gen_variables, tz_name, num_limit == 1, 0, false );
-                  }
+                     if( !found )
+                        add_pdf_variables( handle, context,
+                         field_list, summaries, pdf_gen_variables, tz_name, false, 0, false );
 
-                  if( summaries.empty( ) )
-                     generate_pdf_doc( format_file, output_file, pdf_gen_variables, p_pdf_progress );
+                     pdf_fetch_row_source row_source( handle, context, field_list, summaries,
+                      tz_name, set_value_items, filter_set, num_limit, num_found, found );
+
+                     generate_pdf_doc( format_file, output_file, pdf_gen_variables, row_source, p_pdf_progress );
+                  }
                   else
                   {
-                     map< string, string > pdf_final_variables;
-                     add_final_pdf_variables( pdf_gen_variables, summaries, pdf_final_variables );
+                     if( !num_found )
+                     {
+                        add_pdf_variables( handle, context,
+                         field_list, summaries, pdf_gen_variables, tz_name, num_limit == 1, 0, false );
+                     }
+
+                     if( summaries.empty( ) )
+                        generate_pdf_doc( format_file, output_file, pdf_gen_variables, p_pdf_progress );
+                     else
+                     {
+                        map< string, string > pdf_final_variables;
+                        add_final_pdf_variables( pdf_gen_variables, summaries, pdf_final_variables );
 
-                     generate_pdf_doc( format_file, output_file, pdf_final_variables, p_pdf_progress );
+                        generate_pdf_doc( format_file, output_file, pdf_final_variables, p_pdf_progress );
+                     }
                   }
 #endif
                }
@@ -2835,17 +3280,32 @@ void ciyam_session_command_functor::operator ( )( const string& command, const p
                }
             }
 
-            destroy_object_instance( handle );
+            if( !handle_is_parked )
+            {
+               if( p_cursor )
+                  socket_handler.release_fetch_cursor( cursor );
+               else
+                  destroy_object_instance( handle );
+            }
          }
          catch( exception& )
          {
             possibly_expected_error = true;
-            destroy_object_instance( handle );
+
+            if( p_cursor || handle_is_parked )
+               socket_handler.release_fetch_cursor( cursor );
+            else
+               destroy_object_instance( handle );
+
             throw;
          }
          catch( ... )
          {
-            destroy_object_instance( handle );
+            if( p_cursor || handle_is_parked )
+               socket_handler.release_fetch_cursor( cursor );
+            else
+               destroy_object_instance( handle );
+
             throw;
          }
       }
@@ -5480,6 +5940,52 @@ void ciyam_session_command_functor::operator ( )( const string& command, const p
          else
             response = get_system_variable( name_or_expr );
       }
+      else if( command == c_cmd_ciyam_session_system_variables )
+      {
+         string names( get_parm_val( parameters, c_cmd_ciyam_session_system_variables_names ) );
+         bool has_values( has_parm_val( parameters, c_cmd_ciyam_session_system_variables_values ) );
+         string values( get_parm_val( parameters, c_cmd_ciyam_session_system_variables_values ) );
+
+         vector< string > all_names;
+         split( names, all_names );
+
+         if( has_values )
+         {
+            vector< string > all_values;
+            split( values, all_values );
+
+            if( all_values.size( ) != all_names.size( ) )
+               throw runtime_error( "number of names and values for system_variables must match" );
+
+            vector< pair< string, string > > names_and_values;
+
+            for( size_t i = 0; i < all_names.size( ); i++ )
+               names_and_values.push_back( make_pair( all_names[ i ], all_values[ i ] ) );
+
+            set_system_variables( names_and_values );
+         }
+         else
+         {
+            vector< string > all_values;
+            get_raw_system_variables( all_names, all_values );
+
+            // NOTE: Output is in the same "name value" format that is used for wildcard expressions
+            // (which themselves are output as is) and any variable without a value is omitted.
+            for( size_t i = 0; i < all_names.size( ); i++ )
+            {
+               if( all_values[ i ].empty( ) )
+                  continue;
+
+               if( !response.empty( ) )
+                  response += '\n';
+
+               if( all_names[ i ].find_first_of( "?*" ) != string::npos )
+                  response += all_values[ i ];
+               else
+                  response += all_names[ i ] + ' ' + all_values[ i ];
+            }
+         }
+      }
       else if( command == c_cmd_ciyam_session_system_listeners )
       {
          ostringstream osstr;
@@ -5617,11 +6123,21 @@ void ciyam_session_command_functor::operator ( )( const string& command, const p
       }
       else if( command == c_cmd_ciyam_session_schedule )
       {
-         output_schedule( osstr );
-         output_response_lines( socket, osstr.str( ) );
+         bool stats( has_parm_val( parameters, c_cmd_ciyam_session_schedule_stats ) );
+         bool reload( has_parm_val( parameters, c_cmd_ciyam_session_schedule_reload ) );
+
+         if( reload )
+            notify_schedule_changed( );
+         else
+         {
+            output_schedule( osstr, stats );
+            output_response_lines( socket, osstr.str( ) );
+         }
       }
       else if( command == c_cmd_ciyam_session_smtpinfo )
          response = get_smtp_username( ) + "@" + get_smtp_suffix( );
+      else if( command == c_cmd_ciyam_session_mailstats )
+         response = get_smtp_spool_stats( );
       else if( command == c_cmd_ciyam_session_starttls )
       {
 #ifdef SSL_SUPPORT
@@ -5793,21 +6309,33 @@ void ciyam_session_command_functor::operator ( )( const string& command, const p
 class socket_command_processor : public command_processor
 {
    public:
-   socket_command_processor( tcp_socket& socket, command_handler& handler )
+   socket_command_processor( tcp_socket& socket, command_handler& handler, bool can_park = false )
     : command_processor( handler ),
     socket( socket ),
     handler( handler ),
+    socket_handler( dynamic_cast< socket_command_handler& >( handler ) ),
+    can_park( can_park ),
+    is_parked( false ),
     is_first_command( true )
    {
    }
 
+   bool was_parked( ) const { return is_parked; }
+
+   void unpark( ) { is_parked = false; }
+
    private:
    tcp_socket& socket;
    command_handler& handler;
 
+   socket_command_handler& socket_handler;
+
+   bool can_park;
+   bool is_parked;
+
    bool is_first_command;
 
-   bool is_still_processing( ) { return is_captured_session( ) || socket.okay( ); }
+   bool is_still_processing( ) { return !is_parked && ( is_captured_session( ) || socket.okay( ) ); }
 
    string get_cmd_and_args( );
 
@@ -5824,6 +6352,19 @@ string socket_command_processor::get_cmd_and_args( )
       TRACE_LOG( TRACE_SESSIONS, "started session (tid = " + to_string( current_thread_id( ) ) + ")" );
    }
 
+   // NOTE: Any fetch cursors that have been idle for too long are released here (as well as after
+   // each read timeout) so that abandoned cursors will not be kept for as long as the session is.
+   socket_handler.expire_fetch_cursors( );
+
+   // NOTE: Rather than blocking whilst waiting for its next command a session that can be parked
+   // will stop processing commands (so its thread can be released) until further input arrives.
+   if( can_park && !get_is_continuation( ) && !g_server_shutdown
+    && !socket.has_buffered_input( ) && !socket.has_input( ) && !is_condemned_session( ) && can_detach_session( ) )
+   {
+      is_parked = true;
+      return request;
+   }
+
    while( true )
    {
       progress* p_progress = 0;
@@ -5853,6 +6394,8 @@ string socket_command_processor::get_cmd_and_args( )
 
          if( !socket.had_timeout( ) )
             break;
+
+         socket_handler.expire_fetch_cursors( );
       }
       else
          break;
@@ -5885,6 +6428,33 @@ void socket_command_processor::output_command_usage( const string& wildcard_matc
    socket.write_line( c_response_okay, c_request_timeout );
 }
 
+// NOTE: The reactor is created when the first session is initialised (if the server has been
+// configured to use session workers) and is then never deleted (as is the case for sessions
+// that have their own threads the worker threads will simply end along with the process).
+reactor* gp_reactor = 0;
+
+reactor* get_session_reactor( )
+{
+   guard g( g_mutex );
+
+   static bool has_checked = false;
+
+   if( !has_checked )
+   {
+      has_checked = true;
+
+      size_t num_workers = get_session_workers( );
+
+      if( num_workers )
+      {
+         gp_reactor = new reactor( num_workers );
+         gp_reactor->start( );
+      }
+   }
+
+   return gp_reactor;
+}
+
 }
 
 #ifdef SSL_SUPPORT
@@ -5894,7 +6464,8 @@ ciyam_session::ciyam_session( tcp_socket* p_socket, const string& ip_addr )
 #endif
  :
  is_local( false ),
- pid_is_self( false )
+ pid_is_self( false ),
+ detached_id( 0 )
 {
    ap_socket.reset( p_socket );
 
@@ -5921,6 +6492,7 @@ ciyam_session::ciyam_session( auto_ptr< tcp_socket >& ap_socket, const string& i
  :
  is_local( false ),
  pid_is_self( false ),
+ detached_id( 0 ),
  ap_socket( ap_socket )
 {
    if( !( *this->ap_socket ) )
@@ -5945,29 +6517,49 @@ ciyam_session::~ciyam_session( )
 
 void ciyam_session::on_start( )
 {
-#ifdef DEBUG
-   cout << "started session..." << endl;
-#endif
+   bool is_parking = false;
+
    try
    {
-      socket_command_handler cmd_handler( *ap_socket );
+      if( !ap_processor.get( ) )
+      {
+#ifdef DEBUG
+         cout << "started session..." << endl;
+#endif
+         ap_cmd_handler.reset( new socket_command_handler( *ap_socket ) );
+
+         ap_cmd_handler->add_commands( 0,
+          ciyam_session_command_functor_factory, ARRAY_PTR_AND_SIZE( ciyam_session_command_definitions ) );
 
-      cmd_handler.add_commands( 0,
-       ciyam_session_command_functor_factory, ARRAY_PTR_AND_SIZE( ciyam_session_command_definitions ) );
+         ap_socket->write_line( string( c_protocol_version ) + '\n' + string( c_response_okay ), c_request_timeout );
 
-      ap_socket->write_line( string( c_protocol_version ) + '\n' + string( c_response_okay ), c_request_timeout );
+         init_session( *ap_cmd_handler );
 
-      init_session( cmd_handler );
+         ap_processor.reset( new socket_command_processor(
+          *ap_socket, *ap_cmd_handler, gp_reactor && !pid_is_self ) );
+      }
+      else
+      {
+         attach_session( detached_id );
+         static_cast< socket_command_processor* >( ap_processor.get( ) )->unpark( );
+      }
 
-      socket_command_processor processor( *ap_socket, cmd_handler );
-      processor.process_commands( );
+      ap_processor->process_commands( );
 
-      ap_socket->close( );
+      if( static_cast< socket_command_processor* >( ap_processor.get( ) )->was_parked( ) )
+      {
+         detached_id = detach_session( );
+         is_parking = true;
+      }
+      else
+      {
+         ap_socket->close( );
 
-      term_storage( cmd_handler );
-      module_unload_all( cmd_handler );
+         term_storage( *ap_cmd_handler );
+         module_unload_all( *ap_cmd_handler );
 
-      term_session( );
+         term_session( );
+      }
    }
    catch( exception& x )
    {
@@ -5988,10 +6580,25 @@ void ciyam_session::on_start( )
       term_session( );
    }
 
+   // NOTE: Once parked the session could be resumed by another worker at any time so must not be
+   // accessed after this call.
+   if( is_parking )
+      gp_reactor->park( ap_socket->get_socket( ), this );
+   else
+   {
 #ifdef DEBUG
-   cout << "finished session..." << endl;
+      cout << "finished session..." << endl;
 #endif
-   delete this;
+      delete this;
+   }
+}
+
+bool ciyam_session::needs_wake( )
+{
+   // NOTE: A parked session is also woken if it has any expired fetch cursors (which will then
+   // be released before the session is parked again).
+   return g_server_shutdown || is_condemned_session( detached_id )
+    || static_cast< socket_command_handler* >( ap_cmd_handler.get( ) )->has_expired_fetch_cursors( );
 }
 
 void ciyam_session::increment_session_count( )
@@ -6021,6 +6628,8 @@ void init_ciyam_session( tcp_socket* p_socket, const char* p_address )
    // shutting down.
    if( g_server_shutdown && !p_session->is_own_pid( ) )
       delete p_session;
-   else
+   else if( p_session->is_own_pid( ) || !get_session_reactor( ) )
       p_session->start( );
+   else
+      gp_reactor->dispatch( p_session );
 }
@@ -8,12 +8,14 @@
 #  define CIYAM_SESSION_H
 
 #  ifndef HAS_PRECOMPILED_STD_HEADERS
+#     include <memory>
 #     include <string>
 #  endif
 
 #  include "config.h"
 #  include "macros.h"
 #  include "sockets.h"
+#  include "reactor.h"
 #  include "threads.h"
 #  ifdef SSL_SUPPORT
 #     include "ssl_socket.h"
@@ -25,7 +27,13 @@
 #     define CIYAM_BASE_DECL_SPEC DYNAMIC_IMPORT
 #  endif
 
-class CIYAM_BASE_DECL_SPEC ciyam_session : public thread
+class command_handler;
+class command_processor;
+
+// NOTE: If the server has been configured to use session workers then (apart from those started
+// by the server itself which always have their own thread) sessions are handled by a reactor and
+// whilst waiting for their next command are detached from the worker thread that handled them.
+class CIYAM_BASE_DECL_SPEC ciyam_session : public thread, public reactor_handler
 {
    public:
 #  ifdef SSL_SUPPORT
@@ -42,17 +50,26 @@ class CIYAM_BASE_DECL_SPEC ciyam_session : public thread
 
    void on_start( );
 
+   void handle_ready( ) { on_start( ); }
+
+   bool needs_wake( );
+
    static void increment_session_count( );
    static void decrement_session_count( );
 
    private:
    bool is_local;
    bool pid_is_self;
+
+   size_t detached_id;
 #  ifdef SSL_SUPPORT
    std::auto_ptr< ssl_socket > ap_socket;
 #  else
    std::auto_ptr< tcp_socket > ap_socket;
 #  endif
+
+   std::auto_ptr< command_handler > ap_cmd_handler;
+   std::auto_ptr< command_processor > ap_processor;
 };
 
 #  ifdef SSL_SUPPORT
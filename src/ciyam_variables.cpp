@@ -10,6 +10,7 @@
 
 #ifndef HAS_PRECOMPILED_STD_HEADERS
 #  include <iostream>
+#  include <algorithm>
 #endif
 
 #define CIYAM_BASE_IMPL
@@ -22,6 +23,7 @@
 #include "utilities.h"
 #include "ciyam_base.h"
 #include "class_base.h"
+#include "variable_store.h"
 #include "ods_file_system.h"
 
 using namespace std;
@@ -31,8 +33,7 @@ namespace
 
 #include "ciyam_constants.h"
 
-const int c_max_lock_attempts = 20;
-const int c_lock_attempt_sleep_time = 200;
+const unsigned long c_max_lock_wait_msecs = 4000;
 
 const char c_persist_variable_prefix = '>';
 const char c_restore_variable_prefix = '<';
@@ -148,9 +149,25 @@ const char* const c_special_variable_package_install_extra = "@package_install_e
 const char* const c_special_variable_peer_is_synchronising = "@peer_is_synchronising";
 const char* const c_special_variable_total_child_field_in_parent = "@total_child_field_in_parent";
 
+// NOTE: The mutex is only used to serialise the storing and restoring of persistent variables
+// (all other variable access is only locking the variable store shard that holds the variable).
 mutex g_mutex;
 
-map< string, string > g_variables;
+variable_store g_variables;
+
+// NOTE: A "plain" variable name is one that can be read or written directly in the variable store
+// (i.e. has no persist/restore prefix, is not a wildcard expression and is not a virtual variable).
+bool is_plain_variable_name( const string& name )
+{
+   return !name.empty( )
+    && name[ 0 ] != c_persist_variable_prefix && name[ 0 ] != c_restore_variable_prefix
+    && name.find_first_of( "?*" ) == string::npos && name != c_special_variable_unix_timestamp;
+}
+
+bool is_special_variable_value( const string& value )
+{
+   return value == c_special_variable_increment || value == c_special_variable_decrement;
+}
 
 }
 
@@ -607,25 +624,9 @@ system_variable_lock::system_variable_lock( const string& name )
  :
  name( name )
 {
-   bool acquired = false;
-
-   for( size_t i = 0; i < c_max_lock_attempts; i++ )
-   {
-      // NOTE: Empty code block for scope purposes.
-      {
-         guard g( g_mutex );
-
-         if( set_system_variable( name, "<locked>", "" ) )
-         {
-            acquired = true;
-            break;
-         }
-      }
-
-      msleep( c_lock_attempt_sleep_time );
-   }
-
-   if( !acquired )
+   // NOTE: If the variable is already locked then will wait for its value to be changed (which
+   // will occur when the current lock holder's destructor clears it) rather than polling.
+   if( !g_variables.set_if_when_changed( name, "<locked>", "", c_max_lock_wait_msecs ) )
       throw runtime_error( "unable to acquire lock for system variable '" + name + "'" );
 }
 
@@ -636,8 +637,6 @@ system_variable_lock::~system_variable_lock( )
 
 string get_raw_system_variable( const string& name )
 {
-   guard g( g_mutex );
-
    string retval;
    string var_name( name );
 
@@ -657,12 +656,7 @@ string get_raw_system_variable( const string& name )
 
    // NOTE: The special system variable prefix is only intended for
    // testing purposes and is only applicable to unrestricted lists.
-   string sys_var_prefix;
-
-   if( g_variables.count( c_special_variable_sys_var_prefix ) )
-      sys_var_prefix = g_variables[ c_special_variable_sys_var_prefix ];
-
-   g_variables[ to_string( c_special_variable_unix_timestamp ) ] = to_string( unix_timestamp( ) ); 
+   string sys_var_prefix( g_variables.get( c_special_variable_sys_var_prefix ) );
 
    // NOTE: One or more persistent variables can have their values
    // either stored or restored depending upon the prefix used and
@@ -672,6 +666,8 @@ string get_raw_system_variable( const string& name )
    // just those whose values now differ (for the restore prefix).
    if( had_persist_prefix || had_restore_prefix )
    {
+      guard g( g_mutex );
+
       bool output_all_persistent_variables = false;
 
       if( var_name.empty( ) && had_persist_prefix )
@@ -685,10 +681,7 @@ string get_raw_system_variable( const string& name )
       if( !var_name.empty( ) && had_persist_prefix
        && var_name.find_first_of( "?*" ) == string::npos )
       {
-         string value;
-
-         if( g_variables.count( var_name ) )
-            value = g_variables[ var_name ];
+         string value( g_variables.get( var_name ) );
 
          if( value.empty( ) )
          {
@@ -722,13 +715,10 @@ string get_raw_system_variable( const string& name )
                ciyam_ods_file_system( ).fetch_from_text_file( next, value );
 
                if( !var_name.empty( ) )
-                  g_variables[ next ] = value;
+                  g_variables.set( next, value );
                else
                {
-                  string next_value;
-
-                  if( g_variables.count( next ) )
-                     next_value = g_variables[ next ];
+                  string next_value( g_variables.get( next ) );
 
                   if( output_all_persistent_variables || value != next_value )
                   {
@@ -740,8 +730,7 @@ string get_raw_system_variable( const string& name )
             }
             else
             {
-               if( g_variables.count( next ) )
-                  value = g_variables[ next ];
+               value = g_variables.get( next );
 
                if( value.empty( ) )
                   ciyam_ods_file_system( ).remove_file( next );
@@ -756,22 +745,29 @@ string get_raw_system_variable( const string& name )
       if( var_name == "*" )
          var_name = sys_var_prefix + var_name;
 
-      map< string, string >::const_iterator ci;
-      for( ci = g_variables.begin( ); ci != g_variables.end( ); ++ci )
+      vector< pair< string, string > > names_and_values;
+      g_variables.list( var_name, names_and_values );
+
+      // NOTE: As the unix timestamp variable is not actually stored it is inserted (in name order).
+      if( wildcard_match( var_name, c_special_variable_unix_timestamp ) )
       {
-         if( wildcard_match( var_name, ci->first ) )
-         {
-            if( !retval.empty( ) )
-               retval += "\n";
-            retval += ci->first + ' ' + ci->second;
-         }
+         pair< string, string > timestamp( c_special_variable_unix_timestamp, to_string( unix_timestamp( ) ) );
+
+         names_and_values.insert( lower_bound(
+          names_and_values.begin( ), names_and_values.end( ), timestamp ), timestamp );
+      }
+
+      for( size_t i = 0; i < names_and_values.size( ); i++ )
+      {
+         if( !retval.empty( ) )
+            retval += "\n";
+         retval += names_and_values[ i ].first + ' ' + names_and_values[ i ].second;
       }
    }
+   else if( var_name == c_special_variable_unix_timestamp )
+      retval = to_string( unix_timestamp( ) );
    else
-   {
-      if( g_variables.count( var_name ) )
-         retval = g_variables[ var_name ];
-   }
+      retval = g_variables.get( var_name );
 
    return retval;
 }
@@ -789,10 +785,33 @@ string get_system_variable( const string& name_or_expr )
    return expr.get_value( );
 }
 
-void set_system_variable( const string& name, const string& value )
+void get_raw_system_variables( const vector< string >& names, vector< string >& values )
 {
-   guard g( g_mutex );
+   values.clear( );
+   values.resize( names.size( ) );
 
+   vector< size_t > plain_indexes;
+   vector< string > plain_names, plain_values;
+
+   for( size_t i = 0; i < names.size( ); i++ )
+   {
+      if( !is_plain_variable_name( names[ i ] ) )
+         values[ i ] = get_raw_system_variable( names[ i ] );
+      else
+      {
+         plain_indexes.push_back( i );
+         plain_names.push_back( names[ i ] );
+      }
+   }
+
+   g_variables.get( plain_names, plain_values );
+
+   for( size_t i = 0; i < plain_indexes.size( ); i++ )
+      values[ plain_indexes[ i ] ] = plain_values[ i ];
+}
+
+void set_system_variable( const string& name, const string& value )
+{
    string val( value );
 
    bool persist = false;
@@ -802,33 +821,17 @@ void set_system_variable( const string& name, const string& value )
 
    string var_name( !persist ? name : name.substr( 1 ) );
 
-   if( val == string( c_special_variable_increment )
-    || val == string( c_special_variable_decrement ) )
-   {
-      int num_value = !g_variables.count( var_name )
-       ? 0 : from_string< int >( g_variables[ var_name ] );
-
-      if( val == string( c_special_variable_increment ) )
-         ++num_value;
-      else if( num_value > 0 )
-         --num_value;
-
-      if( num_value == 0 )
-         val.clear( );
-      else
-         val = to_string( num_value );
-   }
-
-   if( !val.empty( ) )
-      g_variables[ var_name ] = val;
+   if( val == string( c_special_variable_increment ) )
+      val = g_variables.adjust( var_name, 1 );
+   else if( val == string( c_special_variable_decrement ) )
+      val = g_variables.adjust( var_name, -1 );
    else
-   {
-      if( g_variables.count( var_name ) )
-         g_variables.erase( var_name );
-   }
+      g_variables.set( var_name, val );
 
    if( persist )
    {
+      guard g( g_mutex );
+
       ods::bulk_write bulk_write( ciyam_ods_instance( ) );
       scoped_ods_instance ods_instance( ciyam_ods_instance( ) );
 
@@ -843,37 +846,42 @@ void set_system_variable( const string& name, const string& value )
 
 bool set_system_variable( const string& name, const string& value, const string& current )
 {
-   guard g( g_mutex );
+   return g_variables.set_if( name, value, current );
+}
 
-   bool retval = false;
+void set_system_variables( const vector< pair< string, string > >& names_and_values )
+{
+   vector< pair< string, string > > plain_names_and_values;
 
-   if( !g_variables.count( name ) )
-   {
-      if( current.empty( ) )
-         retval = true;
-   }
-   else if( current == g_variables[ name ] )
+   // NOTE: Consecutive plain variables are set together (so that each variable store shard will
+   // only be locked once per batch) whereas any others are set individually and in their order.
+   for( size_t i = 0; i < names_and_values.size( ); i++ )
    {
-      retval = true;
-      g_variables.erase( name );
-   }
+      const string& name( names_and_values[ i ].first );
+      const string& value( names_and_values[ i ].second );
 
-   if( retval )
-   {
-      if( !value.empty( ) )
-         g_variables[ name ] = value;
+      if( is_plain_variable_name( name ) && !is_special_variable_value( value ) )
+         plain_names_and_values.push_back( names_and_values[ i ] );
       else
       {
-         if( g_variables.count( name ) )
-            g_variables.erase( name );
+         if( !plain_names_and_values.empty( ) )
+         {
+            g_variables.set( plain_names_and_values );
+            plain_names_and_values.clear( );
+         }
+
+         set_system_variable( name, value );
       }
    }
 
-   return retval;
+   if( !plain_names_and_values.empty( ) )
+      g_variables.set( plain_names_and_values );
 }
 
 void list_mutex_lock_ids_for_ciyam_variables( ostream& outs )
 {
    outs << "ciyam_variables::g_mutex = " << g_mutex.get_lock_id( ) << '\n';
+
+   g_variables.list_lock_ids( outs, "ciyam_variables::g_variables" );
 }
 
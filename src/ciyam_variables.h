@@ -9,6 +9,8 @@
 #  ifndef HAS_PRECOMPILED_STD_HEADERS
 #     include <iosfwd>
 #     include <string>
+#     include <vector>
+#     include <utility>
 #  endif
 
 #  include "macros.h"
@@ -34,11 +36,21 @@ struct CIYAM_BASE_DECL_SPEC system_variable_lock
 std::string CIYAM_BASE_DECL_SPEC get_raw_system_variable( const std::string& name );
 std::string CIYAM_BASE_DECL_SPEC get_system_variable( const std::string& name_or_expr );
 
+// NOTE: The bulk get and set functions are intended for scripts that need to access dozens of
+// variables (as each variable store shard is locked just once for all of the variables that it
+// holds rather than once per variable). Values are set in the order provided (so the last value
+// given for a duplicated name will be the one that is kept).
+void CIYAM_BASE_DECL_SPEC get_raw_system_variables(
+ const std::vector< std::string >& names, std::vector< std::string >& values );
+
 void CIYAM_BASE_DECL_SPEC set_system_variable( const std::string& name, const std::string& value );
 
 bool CIYAM_BASE_DECL_SPEC set_system_variable(
  const std::string& name, const std::string& value, const std::string& current );
 
+void CIYAM_BASE_DECL_SPEC set_system_variables(
+ const std::vector< std::pair< std::string, std::string > >& names_and_values );
+
 void CIYAM_BASE_DECL_SPEC list_mutex_lock_ids_for_ciyam_variables( std::ostream& outs );
 
 #endif
@@ -4432,24 +4432,36 @@ void send_email_message( const user_account& account,
    if( get_trace_flags( ) & TRACE_MAIL_OPS )
       p_progress = &progress;
 
-   int attempt = 0;
-   while( true )
+   string data( compose_smtp_message( user_info, recipients, subject,
+    message, html, p_extra_headers, p_file_names, p_image_names, p_image_path_prefix, p_progress ) );
+
+   // NOTE: If the mail spool is in use then the message will be sent by the spool's own thread
+   // (so the session is not held up) otherwise it is sent now (and retried if sending failed).
+   if( spool_smtp_message( get_smtp_server( ), user_info, recipients, data ) )
+   {
+      if( p_progress )
+         p_progress->output_progress( "message has been spooled" );
+   }
+   else
    {
-      try
+      int attempt = 0;
+      while( true )
       {
-         send_smtp_message( get_smtp_server( ), user_info, recipients, subject,
-          message, html, p_extra_headers, p_file_names, p_image_names, p_image_path_prefix, p_progress );
+         try
+         {
+            send_composed_smtp_message( get_smtp_server( ), user_info, recipients, data, p_progress );
 
-         break;
-      }
-      catch( exception& x )
-      {
-         if( ++attempt >= get_smtp_max_send_attempts( ) )
+            break;
+         }
+         catch( exception& x )
+         {
+            if( ++attempt >= get_smtp_max_send_attempts( ) )
+               throw;
+         }
+         catch( ... )
+         {
             throw;
-      }
-      catch( ... )
-      {
-         throw;
+         }
       }
    }
 }
@@ -81,6 +81,13 @@ template< typename T > inline T get_parm_val_from_string( const parameter_info&
    return from_string< T >( get_parm_val( parameters, parameter_name ) );
 }
 
+// NOTE: As a command's parameter slots will not change (after its syntax has been parsed) a functor
+// can look up the slot for a parameter once and then use this to get its (typed) value thereafter.
+template< typename T > inline T get_parm_val_from_slot( const parameter_info& parameters, size_t slot )
+{
+   return from_string< T >( parameters.get_slot_value( slot ) );
+}
+
 inline void string_getter( const std::string& val, std::string& dest )
 {
    dest = val;
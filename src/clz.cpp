@@ -18,13 +18,17 @@
 #  include <memory>
 #  include <fstream>
 #  include <iomanip>
+#  include <sstream>
 #  include <iostream>
+#  include <algorithm>
 #  include <stdexcept>
 #endif
 
 #include "clz.h"
 
+#include "threads.h"
 #include "utilities.h"
+#include "thread_pool.h"
 
 //#define DEBUG
 
@@ -855,7 +859,10 @@ void shrink_output( unsigned char* p_buffer, size_t& length, byte_pair* p_mark_a
       map< byte_pair, size_t > special_nums;
 
       for( set< byte_pair >::iterator si = specials.begin( ); si != specials.end( ); ++si )
-         special_nums[ *si ] = special_nums.size( ) - 1;
+      {
+         size_t special_num = special_nums.size( );
+         special_nums[ *si ] = special_num;
+      }
 
       size_t num = 0;
       size_t repeats = 0;
@@ -1573,14 +1580,14 @@ bool uncompress_numeric_pair( unsigned char* p_buffer, size_t& length, unsigned
       retval = false;
    else
    {
-      if( nibble1 >= 0 && nibble1 <= 9 )
+      if( nibble1 <= 9 )
          *( p_buffer + length++ ) = '0' + nibble1;
       else if( nibble1 >= 10 && nibble1 <= 13 )
          *( p_buffer + length++ ) = '+' + ( nibble1 - 10 );
       else if( nibble1 == 14 )
          *( p_buffer + length++ ) = ' ';
 
-      if( nibble2 >= 0 && nibble2 <= 9 )
+      if( nibble2 <= 9 )
          *( p_buffer + length++ ) = '0' + nibble2;
       else if( nibble2 >= 10 && nibble2 <= 13 )
          *( p_buffer + length++ ) = '+' + ( nibble2 - 10 );
@@ -1603,7 +1610,6 @@ size_t expand_input( istream& is, unsigned char* p_buffer, size_t max_length )
 
    bool had_marker = false;
    bool process_steps = false;
-   bool steps_are_multi = false;
 
    bool is_compressed_numeric = false;
    bool is_lower_dict_pattern = false;
@@ -1738,6 +1744,8 @@ size_t expand_input( istream& is, unsigned char* p_buffer, size_t max_length )
                   last_val = next_val;
                }
 
+               last_ch = *( p_buffer + length - 1 );
+
                if( length >= max_length )
                   break;
                else
@@ -1751,9 +1759,11 @@ size_t expand_input( istream& is, unsigned char* p_buffer, size_t max_length )
             for( size_t i = 0; i < num_repeats; i++ )
             {
                if( ascending )
-                  *( p_buffer + length ) = *( p_buffer + length++ - 1 ) + stepping_amount;
+                  *( p_buffer + length ) = *( p_buffer + length - 1 ) + stepping_amount;
                else
-                  *( p_buffer + length ) = *( p_buffer + length++ - 1 ) - stepping_amount;
+                  *( p_buffer + length ) = *( p_buffer + length - 1 ) - stepping_amount;
+
+               ++length;
             }
          }
          else
@@ -1762,17 +1772,25 @@ size_t expand_input( istream& is, unsigned char* p_buffer, size_t max_length )
             {
                if( ascending )
                {
-                  *( p_buffer + length ) = *( p_buffer + length++ - 2 ) + ( ( is_low && !is_both ) ? 0 : stepping_amount );
-                  *( p_buffer + length ) = *( p_buffer + length++ - 2 ) + ( ( is_low || is_both ) ? stepping_amount : 0 );
+                  *( p_buffer + length ) = *( p_buffer + length - 2 ) + ( ( is_low && !is_both ) ? 0 : stepping_amount );
+                  ++length;
+                  *( p_buffer + length ) = *( p_buffer + length - 2 ) + ( ( is_low || is_both ) ? stepping_amount : 0 );
+                  ++length;
                }
                else
                {
-                  *( p_buffer + length ) = *( p_buffer + length++ - 2 ) - ( ( is_low && !is_both ) ? 0 : stepping_amount );
-                  *( p_buffer + length ) = *( p_buffer + length++ - 2 ) - ( ( is_low || is_both ) ? stepping_amount : 0 );
+                  *( p_buffer + length ) = *( p_buffer + length - 2 ) - ( ( is_low && !is_both ) ? 0 : stepping_amount );
+                  ++length;
+                  *( p_buffer + length ) = *( p_buffer + length - 2 ) - ( ( is_low || is_both ) ? stepping_amount : 0 );
+                  ++length;
                }
             }
          }
 
+         // NOTE: A repeat that immediately follows a stepping pattern is a repeat of the
+         // last byte that the pattern produced.
+         last_ch = *( p_buffer + length - 1 );
+
          if( length >= max_length )
             break;
          else
@@ -1861,7 +1879,7 @@ size_t expand_input( istream& is, unsigned char* p_buffer, size_t max_length )
          {
             specials[ length++ ] = ( c_special_maxval - ch );
 
-            if( ( c_special_maxval - ch ) + 1 > num_specials )
+            if( ( size_t )( c_special_maxval - ch ) + 1 > num_specials )
                num_specials = ( c_special_maxval - ch ) + 1;
          }
       }
@@ -1900,10 +1918,7 @@ size_t expand_input( istream& is, unsigned char* p_buffer, size_t max_length )
                else if( ch == c_special_dict_pattern_upper )
                   is_upper_dict_pattern = true;
                else if( ch == c_special_step_pattern_fixed || ch == c_special_step_pattern_multi )
-               {
                   process_steps = true;
-                  steps_are_multi = ( ch == c_special_step_pattern_multi );
-               }
                else
                {
                   if( ch == c_special_char_double_repeat )
@@ -2647,7 +2662,9 @@ void decode_clz_data( istream& is, ostream& os )
    deque< string > pretty_outputs;
 #endif
 
-   unsigned char input_buffer[ c_max_encoded_chunk_size ];
+   // NOTE: As a single expansion can go past the maximum length (if the input is not valid)
+   // the buffer is made larger to ensure that this cannot result in writing beyond its end.
+   unsigned char input_buffer[ c_max_encoded_chunk_size * 2 ];
 
    while( true )
    {
@@ -2701,7 +2718,6 @@ cout << "meta_offsets.size( ) = " <<  meta_offsets.size( ) << endl;
 
             size_t num_repeats = 0;
             size_t next_offset = *si;
-            size_t last_repeat_offset = 0;
 
             size_t last_offset = bytes_read;
 
@@ -2862,7 +2878,11 @@ void encode_clz_data( istream& is, ostream& os )
    map< string, size_t > extra_patterns;
 
    unsigned char input_buffer[ c_max_pat_length + 2 ];
-   unsigned char output_buffer[ c_max_encoded_chunk_size ];
+
+   // NOTE: Some paths can append a back-ref repeat pair along with a short pattern when the
+   // chunk is already almost full so some extra space is reserved to prevent these from then
+   // writing beyond the end of the buffer.
+   unsigned char output_buffer[ c_max_encoded_chunk_size + c_max_pat_length + 2 ];
    unsigned char unencoded_buffer[ c_max_unencoded_chunk_size ];
 
    memset( input_buffer, 0, sizeof( input_buffer ) );
@@ -3326,8 +3346,6 @@ cout << "found pattern: " << hex << setw( 2 ) << setfill( '0' ) << ( int )byte1
             {
                bool was_replaced = false;
 
-               size_t old_output_offset = output_offset;
-
                // NOTE: One back-ref that immediately follows another is handled as a meta-pattern.
                if( last_back_ref_offset && last_back_ref_offset == output_offset - 2 )
                {
@@ -3444,6 +3462,528 @@ cout << "(now writing " << output_offset << " bytes)" << endl;
    }
 }
 
+namespace
+{
+
+const char* const c_framed_header_magic = "\x80""CZF";
+const char* const c_framed_trailer_magic = "\x80""CZI";
+
+const size_t c_framed_magic_length = 4;
+
+const size_t c_framed_header_size = 9;
+const size_t c_framed_trailer_size = 16;
+const size_t c_framed_block_header_size = 8;
+
+const size_t c_framed_blocks_per_thread = 4;
+
+const size_t c_max_framed_block_size = 67108864;
+
+const unsigned char c_framed_version = 1;
+
+const uint32_t c_framed_stored_flag = 0x80000000;
+
+struct framed_block_info
+{
+   framed_block_info( ) : raw_size( 0 ), encoded_size( 0 ), is_stored( false ), raw_offset( 0 ), encoded_offset( 0 ) { }
+
+   uint32_t raw_size;
+   uint32_t encoded_size;
+
+   bool is_stored;
+
+   int64_t raw_offset;
+   int64_t encoded_offset;
+};
+
+void write_uint32( ostream& os, uint32_t val )
+{
+   unsigned char buffer[ 4 ];
+
+   for( size_t i = 0; i < 4; i++ )
+      buffer[ i ] = ( unsigned char )( val >> ( 8 * ( 3 - i ) ) );
+
+   os.write( ( const char* )buffer, 4 );
+}
+
+void write_uint64( ostream& os, uint64_t val )
+{
+   write_uint32( os, ( uint32_t )( val >> 32 ) );
+   write_uint32( os, ( uint32_t )val );
+}
+
+uint32_t read_uint32( istream& is )
+{
+   unsigned char buffer[ 4 ];
+
+   if( !is.read( ( char* )buffer, 4 ) )
+      throw runtime_error( "unexpected end of framed clz data" );
+
+   uint32_t val = 0;
+
+   for( size_t i = 0; i < 4; i++ )
+      val = ( val << 8 ) | buffer[ i ];
+
+   return val;
+}
+
+uint64_t read_uint64( istream& is )
+{
+   uint64_t val = read_uint32( is );
+
+   return ( val << 32 ) | read_uint32( is );
+}
+
+void read_magic( istream& is, const char* p_magic )
+{
+   char buffer[ c_framed_magic_length ];
+
+   if( !is.read( buffer, c_framed_magic_length ) || memcmp( buffer, p_magic, c_framed_magic_length ) != 0 )
+      throw runtime_error( "invalid framed clz data" );
+}
+
+size_t read_framed_header( istream& is )
+{
+   read_magic( is, c_framed_header_magic );
+
+   char version;
+
+   if( !is.read( &version, 1 ) || ( unsigned char )version != c_framed_version )
+      throw runtime_error( "unsupported framed clz version" );
+
+   size_t block_size = read_uint32( is );
+
+   if( !block_size || block_size > c_max_framed_block_size )
+      throw runtime_error( "invalid framed clz block size" );
+
+   return block_size;
+}
+
+void write_block_sizes( ostream& os, const framed_block_info& info )
+{
+   write_uint32( os, info.raw_size );
+   write_uint32( os, info.encoded_size | ( info.is_stored ? c_framed_stored_flag : 0 ) );
+}
+
+void read_block_sizes( istream& is, framed_block_info& info, size_t block_size )
+{
+   info.raw_size = read_uint32( is );
+   info.encoded_size = read_uint32( is );
+
+   info.is_stored = ( info.encoded_size & c_framed_stored_flag );
+   info.encoded_size &= ~c_framed_stored_flag;
+
+   // NOTE: An empty block is only valid as the marker for the end of the blocks.
+   if( !info.raw_size && !info.encoded_size && !info.is_stored )
+      return;
+
+   // NOTE: As a block will be stored rather than encoded if encoding would not make it
+   // any smaller the encoded size can never be more than the raw size.
+   if( !info.raw_size || info.raw_size > block_size || !info.encoded_size
+    || info.encoded_size > info.raw_size || ( info.is_stored && info.encoded_size != info.raw_size ) )
+      throw runtime_error( "invalid framed clz block sizes" );
+}
+
+// NOTE: Blocks are processed in batches where each block is replaced with either its
+// encoded or decoded content. The calling thread will also process blocks so the pool
+// will only have "num_threads - 1" workers. When encoding each block is checked by it
+// being decoded again (which is far quicker than encoding) and if it does not decode
+// correctly (or is no smaller) then it will be stored instead.
+struct framed_batch
+{
+   framed_batch( bool encode, size_t num_threads )
+    :
+    encode( encode ),
+    next( 0 ),
+    num_threads( num_threads )
+   {
+      if( num_threads > 1 )
+      {
+         ap_workers.reset( new thread_pool( num_threads - 1 ) );
+         ap_workers->start( );
+      }
+   }
+
+   bool encode;
+
+   size_t next;
+   size_t num_threads;
+
+   string error;
+
+   mutex batch_mutex;
+
+   vector< string > blocks;
+   vector< char > stored;
+   vector< uint32_t > raw_sizes;
+
+   // NOTE: This is declared last so that the workers are joined before anything else is destroyed.
+   auto_ptr< thread_pool > ap_workers;
+
+   void process( );
+   void process_blocks( );
+};
+
+class framed_batch_job : public thread_pool_job
+{
+   public:
+   framed_batch_job( framed_batch& batch ) : batch( batch ) { }
+
+   void run( ) { batch.process_blocks( ); }
+
+   private:
+   framed_batch& batch;
+};
+
+void framed_batch::process( )
+{
+   next = 0;
+   error.erase( );
+
+   if( encode )
+      stored = vector< char >( blocks.size( ), 0 );
+
+   if( ap_workers.get( ) )
+   {
+      for( size_t i = 1; i < num_threads && i < blocks.size( ); i++ )
+         ap_workers->queue_job( new framed_batch_job( *this ) );
+   }
+
+   process_blocks( );
+
+   if( ap_workers.get( ) )
+      ap_workers->wait_until_idle( );
+
+   if( !error.empty( ) )
+      throw runtime_error( error );
+}
+
+void framed_batch::process_blocks( )
+{
+   while( true )
+   {
+      size_t i = 0;
+
+      // NOTE: Scope for guard object.
+      {
+         guard g( batch_mutex );
+
+         if( next >= blocks.size( ) || !error.empty( ) )
+            break;
+
+         i = next++;
+      }
+
+      try
+      {
+         if( encode )
+         {
+            istringstream iss( blocks[ i ] );
+            ostringstream oss;
+
+            encode_clz_data( iss, oss );
+
+            string encoded( oss.str( ) );
+
+            bool okay = ( encoded.size( ) < blocks[ i ].size( ) );
+
+            if( okay )
+            {
+               try
+               {
+                  istringstream check_iss( encoded );
+                  ostringstream check_oss;
+
+                  decode_clz_data( check_iss, check_oss );
+
+                  okay = ( check_oss.str( ) == blocks[ i ] );
+               }
+               catch( ... )
+               {
+                  okay = false;
+               }
+            }
+
+            if( !okay )
+               stored[ i ] = 1;
+            else
+               blocks[ i ] = encoded;
+         }
+         else if( !stored[ i ] )
+         {
+            istringstream iss( blocks[ i ] );
+            ostringstream oss;
+
+            decode_clz_data( iss, oss );
+
+            blocks[ i ] = oss.str( );
+
+            if( blocks[ i ].size( ) != raw_sizes[ i ] )
+               throw runtime_error( "framed clz block did not decode to its expected size" );
+         }
+      }
+      catch( exception& x )
+      {
+         guard g( batch_mutex );
+
+         if( error.empty( ) )
+            error = x.what( );
+      }
+   }
+}
+
+}
+
+bool is_clz_framed_data( istream& is )
+{
+   return is.peek( ) == ( unsigned char )c_framed_header_magic[ 0 ];
+}
+
+void decode_clz_framed_data( istream& is, ostream& os, size_t num_threads )
+{
+   if( !is_clz_framed_data( is ) )
+   {
+      decode_clz_data( is, os );
+      return;
+   }
+
+   // NOTE: The dictionaries must be initialised before any worker thread is started.
+   init_clz_info( );
+
+   if( !num_threads )
+      num_threads = 1;
+
+   size_t block_size = read_framed_header( is );
+
+   framed_batch batch( false, num_threads );
+
+   bool finished = false;
+
+   while( !finished )
+   {
+      batch.blocks.clear( );
+      batch.stored.clear( );
+      batch.raw_sizes.clear( );
+
+      while( batch.blocks.size( ) < num_threads * c_framed_blocks_per_thread )
+      {
+         framed_block_info info;
+
+         read_block_sizes( is, info, block_size );
+
+         // NOTE: The last block is followed by an empty block header (which is then
+         // followed by the block index that is not needed for sequential decoding).
+         if( !info.raw_size )
+         {
+            finished = true;
+            break;
+         }
+
+         string encoded( info.encoded_size, '\0' );
+
+         if( !is.read( &encoded[ 0 ], info.encoded_size ) )
+            throw runtime_error( "unexpected end of framed clz data" );
+
+         batch.blocks.push_back( encoded );
+         batch.stored.push_back( info.is_stored );
+         batch.raw_sizes.push_back( info.raw_size );
+      }
+
+      batch.process( );
+
+      for( size_t i = 0; i < batch.blocks.size( ); i++ )
+         os.write( batch.blocks[ i ].data( ), batch.blocks[ i ].size( ) );
+   }
+}
+
+void encode_clz_framed_data( istream& is, ostream& os, size_t num_threads, size_t block_size )
+{
+   if( !block_size || block_size > c_max_framed_block_size )
+      throw runtime_error( "invalid block size " + to_string( block_size ) + " for encode_clz_framed_data" );
+
+   init_clz_info( );
+
+   if( !num_threads )
+      num_threads = 1;
+
+   os.write( c_framed_header_magic, c_framed_magic_length );
+   os.put( ( char )c_framed_version );
+
+   write_uint32( os, block_size );
+
+   int64_t total_written = c_framed_header_size;
+
+   vector< framed_block_info > index;
+
+   framed_batch batch( true, num_threads );
+
+   string buffer( block_size, '\0' );
+
+   while( is )
+   {
+      batch.blocks.clear( );
+
+      while( batch.blocks.size( ) < num_threads * c_framed_blocks_per_thread )
+      {
+         is.read( &buffer[ 0 ], block_size );
+
+         size_t num_read = is.gcount( );
+
+         if( num_read )
+            batch.blocks.push_back( buffer.substr( 0, num_read ) );
+
+         if( num_read < block_size )
+            break;
+      }
+
+      vector< uint32_t > raw_sizes;
+
+      for( size_t i = 0; i < batch.blocks.size( ); i++ )
+         raw_sizes.push_back( batch.blocks[ i ].size( ) );
+
+      batch.process( );
+
+      for( size_t i = 0; i < batch.blocks.size( ); i++ )
+      {
+         framed_block_info info;
+
+         info.raw_size = raw_sizes[ i ];
+         info.encoded_size = batch.blocks[ i ].size( );
+
+         info.is_stored = batch.stored[ i ];
+
+         write_block_sizes( os, info );
+
+         os.write( batch.blocks[ i ].data( ), batch.blocks[ i ].size( ) );
+
+         total_written += c_framed_block_header_size + info.encoded_size;
+
+         index.push_back( info );
+      }
+   }
+
+   write_uint32( os, 0 );
+   write_uint32( os, 0 );
+
+   int64_t index_offset = total_written + c_framed_block_header_size;
+
+   for( size_t i = 0; i < index.size( ); i++ )
+      write_block_sizes( os, index[ i ] );
+
+   write_uint32( os, index.size( ) );
+   write_uint64( os, index_offset );
+
+   os.write( c_framed_trailer_magic, c_framed_magic_length );
+
+   if( !os.good( ) )
+      throw runtime_error( "unexpected error writing framed clz data" );
+}
+
+void decode_clz_framed_range( istream& is, ostream& os, int64_t offset, int64_t length, size_t num_threads )
+{
+   if( offset < 0 || length < 0 )
+      throw runtime_error( "invalid range for decode_clz_framed_range" );
+
+   init_clz_info( );
+
+   if( !num_threads )
+      num_threads = 1;
+
+   int64_t start = is.tellg( );
+
+   size_t block_size = read_framed_header( is );
+
+   is.seekg( 0, ios::end );
+   int64_t finish = is.tellg( );
+
+   if( finish - start < ( int64_t )( c_framed_header_size + c_framed_block_header_size + c_framed_trailer_size ) )
+      throw runtime_error( "invalid framed clz data" );
+
+   is.seekg( finish - c_framed_trailer_size );
+
+   size_t num_blocks = read_uint32( is );
+   int64_t index_offset = read_uint64( is );
+
+   read_magic( is, c_framed_trailer_magic );
+
+   if( index_offset + ( int64_t )( num_blocks * c_framed_block_header_size ) + ( int64_t )c_framed_trailer_size != finish - start )
+      throw runtime_error( "invalid framed clz block index" );
+
+   is.seekg( start + index_offset );
+
+   vector< framed_block_info > index( num_blocks );
+
+   int64_t raw_offset = 0;
+   int64_t encoded_offset = c_framed_header_size;
+
+   for( size_t i = 0; i < num_blocks; i++ )
+   {
+      read_block_sizes( is, index[ i ], block_size );
+
+      if( !index[ i ].raw_size || ( i < num_blocks - 1 && index[ i ].raw_size != block_size ) )
+         throw runtime_error( "invalid framed clz block index" );
+
+      index[ i ].raw_offset = raw_offset;
+      index[ i ].encoded_offset = encoded_offset + c_framed_block_header_size;
+
+      raw_offset += index[ i ].raw_size;
+      encoded_offset += c_framed_block_header_size + index[ i ].encoded_size;
+   }
+
+   if( encoded_offset + ( int64_t )c_framed_block_header_size != index_offset )
+      throw runtime_error( "invalid framed clz block index" );
+
+   if( offset > raw_offset )
+      throw runtime_error( "range offset " + to_string( offset ) + " is beyond the end of the framed clz data" );
+
+   if( length > raw_offset - offset )
+      length = raw_offset - offset;
+
+   if( !length )
+      return;
+
+   // NOTE: As every block (apart from the last) is the same size the first and last
+   // blocks that are needed can be found directly.
+   size_t first = offset / block_size;
+   size_t last = ( offset + length - 1 ) / block_size;
+
+   framed_batch batch( false, num_threads );
+
+   for( size_t i = first; i <= last; )
+   {
+      batch.blocks.clear( );
+      batch.stored.clear( );
+      batch.raw_sizes.clear( );
+
+      size_t batch_first = i;
+
+      for( ; i <= last && batch.blocks.size( ) < num_threads * c_framed_blocks_per_thread; i++ )
+      {
+         string encoded( index[ i ].encoded_size, '\0' );
+
+         is.seekg( start + index[ i ].encoded_offset );
+
+         if( !is.read( &encoded[ 0 ], index[ i ].encoded_size ) )
+            throw runtime_error( "unexpected end of framed clz data" );
+
+         batch.blocks.push_back( encoded );
+         batch.stored.push_back( index[ i ].is_stored );
+         batch.raw_sizes.push_back( index[ i ].raw_size );
+      }
+
+      batch.process( );
+
+      for( size_t j = 0; j < batch.blocks.size( ); j++ )
+      {
+         const framed_block_info& info( index[ batch_first + j ] );
+
+         int64_t from = max( offset, info.raw_offset ) - info.raw_offset;
+         int64_t to = min( offset + length, info.raw_offset + info.raw_size ) - info.raw_offset;
+
+         os.write( batch.blocks[ j ].data( ) + from, to - from );
+      }
+   }
+}
+
 #ifdef COMPILE_TESTBED_MAIN
 int main( int argc, char* argv[ ] )
 {
@@ -10,9 +10,27 @@
 #     include <iosfwd>
 #  endif
 
+#  include "ptypes.h"
+
+const size_t c_default_clz_block_size = 262144;
+
 void init_clz_info( );
 
 void decode_clz_data( std::istream& is, std::ostream& os );
 void encode_clz_data( std::istream& is, std::ostream& os );
 
+// NOTE: The "framed" format consists of a header followed by independently encoded blocks (so
+// that blocks can be encoded and decoded by a number of threads) and then a block index which
+// allows any range of bytes to be decoded (from a seekable stream) without decoding any blocks
+// that are outside of the range. As a normal clz stream can never begin with the first byte of
+// the framed header the decode function will also decode data in the original format.
+bool is_clz_framed_data( std::istream& is );
+
+void decode_clz_framed_data( std::istream& is, std::ostream& os, size_t num_threads = 1 );
+void encode_clz_framed_data( std::istream& is,
+ std::ostream& os, size_t num_threads = 1, size_t block_size = c_default_clz_block_size );
+
+void decode_clz_framed_range( std::istream& is,
+ std::ostream& os, int64_t offset, int64_t length, size_t num_threads = 1 );
+
 #endif
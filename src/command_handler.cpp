@@ -29,6 +29,7 @@ command_handler::~command_handler( )
    {
       delete i->second.p_parser;
       delete i->second.p_functor;
+      delete i->second.p_parameters;
    }
 }
 
@@ -86,11 +87,13 @@ void command_handler::add_command( const string& name, size_t group_num,
    auto_ptr< command_parser > ap_parser( new command_parser );
    ap_parser->parse_syntax( syntax.c_str( ) );
 
+   auto_ptr< command_parameters > ap_parameters( new command_parameters );
+
    command_items.push_back( command_item( dispatch_name, group_num, description ) );
    try
    {
       command_dispatchers.insert( make_pair( dispatch_name,
-       command_dispatcher( name, ap_parser.release( ), ap_functor.release( ) ) ) );
+       command_dispatcher( name, ap_parser.release( ), ap_functor.release( ), ap_parameters.release( ) ) ) );
 
       if( change_notify )
          perform_after_command_changes( );
@@ -139,6 +142,8 @@ void command_handler::remove_command( const string& name )
 
       delete i->second.p_parser;
       delete i->second.p_functor;
+      delete i->second.p_parameters;
+
       command_dispatchers.erase( i );
 
       if( !short_name.empty( ) )
@@ -187,14 +192,23 @@ void command_handler::do_execute_command( const string& cmd_and_args )
          if( short_commands.count( cmd ) )
             cmd = short_commands[ cmd ];
 
-         command_dispatcher_const_iterator ci = command_dispatchers.find( cmd );
+         command_dispatcher_iterator ci = command_dispatchers.find( cmd );
 
          if( ci == command_dispatchers.end( ) )
             handle_unknown_command( cmd );
          else
          {
             vector< string > arguments;
-            map< string, string > parameters;
+
+            command_parameters local_parameters;
+
+            command_parameters* p_parameters = ci->second.p_parameters;
+
+            if( !p_parameters )
+               p_parameters = &local_parameters;
+
+            restorable< command_parameters* > parameters_restorer( ci->second.p_parameters );
+            ci->second.p_parameters = 0;
 
             bool valid = true;
 
@@ -210,15 +224,8 @@ void command_handler::do_execute_command( const string& cmd_and_args )
                }
             }
 
-            if( valid && ci->second.p_parser->parse_command( arguments, parameters ) )
-            {
-               // NOTE: Place an empty pair of strings at the start of the map to help the "get_parm_val" function.
-               parameters.insert( make_pair( string( ), string( ) ) );
-
-               string name( ci->second.name );
-               string::size_type pos = name.find( '|' );
-               ci->second.p_functor->operator( )( name.substr( 0, pos ), parameters );
-            }
+            if( valid && ci->second.p_parser->parse_command( arguments, *p_parameters ) )
+               ci->second.p_functor->operator( )( ci->second.dispatch_name, *p_parameters );
             else
                handle_invalid_command( *ci->second.p_parser, s );
          }
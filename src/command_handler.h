@@ -15,6 +15,7 @@
 #  endif
 
 #  include "progress.h"
+#  include "command_parser.h"
 
 #  ifdef CIYAM_BASE_LIB
 #     ifdef CIYAM_BASE_IMPL
@@ -26,7 +27,6 @@
 #     define COMMAND_HANDLER_DECL_SPEC
 #  endif
 
-class command_parser;
 class command_handler;
 class command_processor;
 
@@ -42,7 +42,7 @@ struct command_definition
    const char* p_description;
 };
 
-typedef std::map< std::string, std::string > parameter_info;
+typedef command_parameters parameter_info;
 
 class command_functor
 {
@@ -60,20 +60,25 @@ class command_functor
    command_handler& handler;
 };
 
-inline bool has_parm_val( const parameter_info& parameters, const std::string& parameter_name )
+inline bool has_parm_val( const parameter_info& parameters, const char* p_parameter_name )
 {
-   return parameters.find( parameter_name ) != parameters.end( );
+   return parameters.has_value( p_parameter_name );
 }
 
-inline const std::string& get_parm_val( const parameter_info& parameters, const std::string& parameter_name )
+inline bool has_parm_val( const parameter_info& parameters, const std::string& parameter_name )
 {
-   std::map< std::string, std::string >::const_iterator ci = parameters.find( parameter_name );
+   return parameters.has_value( parameter_name );
+}
 
-   // NOTE: The parameters container is assumed to always have an empty pair of strings at its beginning.
-   if( ci == parameters.end( ) )
-      ci = parameters.begin( );
+// NOTE: If the parameter had not been provided then an empty string is returned.
+inline const std::string& get_parm_val( const parameter_info& parameters, const char* p_parameter_name )
+{
+   return parameters.get_value( p_parameter_name );
+}
 
-   return ci->second;
+inline const std::string& get_parm_val( const parameter_info& parameters, const std::string& parameter_name )
+{
+   return parameters.get_value( parameter_name );
 }
 
 typedef command_functor* command_functor_creator( const std::string& name, command_handler& handler );
@@ -94,19 +99,29 @@ struct command_item
    std::string description;
 };
 
+// NOTE: The parameters object is reused for each dispatch of the command (so that no memory
+// will need to be allocated for it after its first use) but is detached during the dispatch
+// so that if the same command is dispatched again (from its own functor) then a separate
+// parameters object will be used instead.
 struct command_dispatcher
 {
-   command_dispatcher( const std::string& name, command_parser* p_parser, command_functor* p_functor )
+   command_dispatcher( const std::string& name,
+    command_parser* p_parser, command_functor* p_functor, command_parameters* p_parameters )
     :
     name( name ),
     p_parser( p_parser ),
-    p_functor( p_functor )
+    p_functor( p_functor ),
+    p_parameters( p_parameters )
    {
+      dispatch_name = name.substr( 0, name.find( '|' ) );
    }
 
    std::string name;
+   std::string dispatch_name;
+
    command_parser* p_parser;
    command_functor* p_functor;
+   command_parameters* p_parameters;
 };
 
 class COMMAND_HANDLER_DECL_SPEC command_handler : public progress
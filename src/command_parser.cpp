@@ -12,6 +12,7 @@
 #ifndef HAS_PRECOMPILED_STD_HEADERS
 #  include <ctype.h>
 #  include <cassert>
+#  include <cstring>
 #  include <map>
 #  include <stack>
 #  include <sstream>
@@ -61,6 +62,7 @@ struct node
    node( )
     :
     id( 0 ),
+    slot( 0 ),
     is_alt( false ),
     is_okay( false ),
     p_next_node( 0 ),
@@ -72,6 +74,8 @@ struct node
    }
 
    size_t id;
+   size_t slot;
+
    bool is_alt;
    bool is_okay;
 
@@ -126,6 +130,22 @@ string get_next_sub_expression( string& expr, char divider )
    return sub_expr;
 }
 
+string get_slot_name( const node* p_node )
+{
+   string name( p_node->parameter );
+
+   // NOTE: For "opt" and "pat" types a value can follow the parameter name.
+   if( p_node->type == c_expr_type_opt || p_node->type == c_expr_type_pat )
+   {
+      string::size_type pos = name.find( c_exp_type_opt_value_separator );
+
+      if( pos != string::npos )
+         name.erase( pos );
+   }
+
+   return name;
+}
+
 bool all_list_values_are_not_empty( const string& input, char separator )
 {
    bool retval = true;
@@ -169,9 +189,10 @@ class command_parser::impl
    public:
    impl( )
     :
-    p_node( 0 ),
+    is_flat( false ),
     is_invalid( false ),
-    end_of_input( false )
+    end_of_input( false ),
+    p_node( 0 )
    {
       num_nodes = 0;
       error_pos = 0;
@@ -186,7 +207,7 @@ class command_parser::impl
 
    void parse_syntax( const char* p_input );
 
-   bool parse_command( const vector< string >& arguments, map< string, string >& parameters );
+   bool parse_command( const vector< string >& arguments, command_parameters& parameters );
 
    bool okay( ) { return !is_invalid; }
 
@@ -202,6 +223,8 @@ class command_parser::impl
 
    size_t get_num_nodes( ) const { return num_nodes; }
 
+   bool has_flat_matcher( ) const { return is_flat; }
+
    private:
    void do_clear( node* p_node );
    void do_parse_syntax( node* p_node, const char*& p_input );
@@ -213,6 +236,14 @@ class command_parser::impl
 
    void do_get_parameter_names( node* p_node, vector< string >& parameters, vector< string >* p_default_vals ) const;
 
+   void do_get_nodes( node* p_node, vector< node* >& nodes ) const;
+
+   void compile( );
+
+   bool is_flat_node( const node* p_node ) const;
+
+   bool parse_flat_command( size_t& argnum );
+
    void parse_syntax_expression( node* p_node );
 
    string::size_type search_for_pattern(
@@ -221,6 +252,7 @@ class command_parser::impl
    bool parse_command_expression( node* p_node, size_t& argnum );
    bool parse_separated_list_items( node* p_node, size_t& argnum, string& value );
 
+   bool is_flat;
    bool is_invalid;
    bool end_of_input;
 
@@ -235,10 +267,12 @@ class command_parser::impl
    stack< node* > match_node_stack;
 
    const vector< string >* p_arguments;
-   map< string, string >* p_parameters;
+   command_parameters* p_parameters;
 
-   typedef map< string, string >::iterator parameter_iterator;
-   typedef map< string, string >::value_type parameter_value_type;
+   vector< string > slot_names;
+
+   vector< node* > flat_nodes;
+   vector< char > flat_opts_done;
 };
 
 void command_parser::impl::clear( )
@@ -248,6 +282,11 @@ void command_parser::impl::clear( )
       do_clear( p_node );
       p_node = 0;
    }
+
+   is_flat = false;
+
+   slot_names.clear( );
+   flat_nodes.clear( );
 }
 
 void command_parser::impl::parse_syntax( const char* p_input )
@@ -291,6 +330,8 @@ void command_parser::impl::parse_syntax( const char* p_input )
       p_input_error = p_input_copy;
    }
 
+   compile( );
+
    if( p_input_error )
       error_pos = p_input_error - p_original_input;
 #ifdef DEBUG
@@ -302,16 +343,17 @@ void command_parser::impl::parse_syntax( const char* p_input )
 #endif
 }
 
-bool command_parser::impl::parse_command( const vector< string >& arguments, map< string, string >& parameters )
+bool command_parser::impl::parse_command( const vector< string >& arguments, command_parameters& parameters )
 {
    bool retval = false;
 
 #ifdef DEBUG
    cout << "\n**** begin parse_command ****" << endl;
 #endif
+   parameters.bind( slot_names );
+
    if( p_node )
    {
-      parameters.clear( );
       p_parameters = &parameters;
 #ifdef DEBUG
       cout << "\n[arguments]\n";
@@ -322,7 +364,11 @@ bool command_parser::impl::parse_command( const vector< string >& arguments, map
 
       size_t argnum = 0;
       p_arguments = &arguments;
-      retval = do_parse_command( p_node, argnum, false );
+
+      if( is_flat )
+         retval = parse_flat_command( argnum );
+      else
+         retval = do_parse_command( p_node, argnum, false );
       if( retval && argnum != arguments.size( ) )
          retval = false;
    }
@@ -747,11 +793,11 @@ bool command_parser::impl::do_parse_command( node* p_node, size_t& argnum, bool
    else
    {
       bool prefix_matched = false;
-      string input( ( *p_arguments )[ argnum ] );
+      const string& input( ( *p_arguments )[ argnum ] );
 
       // NOTE: If the node has a prefix that is found in the input then don't check
       // any optional branch nodes (as it is clear it should match with this node).
-      if( !p_node->prefix.empty( ) && input.find( p_node->prefix ) == 0 )
+      if( !p_node->prefix.empty( ) && input.compare( 0, p_node->prefix.size( ), p_node->prefix ) == 0 )
          prefix_matched = true;
 
       if( !prefix_matched && !p_node->opt_branch_nodes.empty( ) )
@@ -813,7 +859,10 @@ bool command_parser::impl::do_parse_command( node* p_node, size_t& argnum, bool
 #ifdef DEBUG
       cout << "*** has matched: " << matched << endl;
 #endif
-      deque< node* > alt_branch_nodes;
+      // NOTE: A vector is used (rather than a deque) as unlike a deque an empty vector
+      // does not allocate any memory (and this function is called very frequently).
+      size_t next_alt_branch = 0;
+      vector< node* > alt_branch_nodes;
 
       bool use_current_node = false;
       if( retval && p_node->p_match_node )
@@ -872,11 +921,10 @@ bool command_parser::impl::do_parse_command( node* p_node, size_t& argnum, bool
                argnum = old_argnum;
             }
 
-            if( retval || alt_branch_nodes.empty( ) )
+            if( retval || next_alt_branch >= alt_branch_nodes.size( ) )
                break;
 
-            p_next_node = alt_branch_nodes.front( );
-            alt_branch_nodes.pop_front( );
+            p_next_node = alt_branch_nodes[ next_alt_branch++ ];
          }
       }
       else if( !matched )
@@ -1062,6 +1110,178 @@ void command_parser::impl::do_get_parameter_names( node* p_node, vector< string
       do_get_parameter_names( p_node->p_next_node, parameters, p_default_vals );
 }
 
+void command_parser::impl::do_get_nodes( node* p_node, vector< node* >& nodes ) const
+{
+   nodes.push_back( p_node );
+
+   for( vector< node* >::size_type i = 0; i < p_node->opt_branch_nodes.size( ); i++ )
+      do_get_nodes( p_node->opt_branch_nodes[ i ], nodes );
+
+   if( p_node->p_match_node )
+      do_get_nodes( p_node->p_match_node, nodes );
+
+   if( p_node->p_next_node )
+      do_get_nodes( p_node->p_next_node, nodes );
+}
+
+void command_parser::impl::compile( )
+{
+   is_flat = false;
+
+   slot_names.clear( );
+   flat_nodes.clear( );
+
+   if( !p_node )
+      return;
+
+   vector< node* > nodes;
+   do_get_nodes( p_node, nodes );
+
+   for( size_t i = 0; i < nodes.size( ); i++ )
+      slot_names.push_back( get_slot_name( nodes[ i ] ) );
+
+   sort( slot_names.begin( ), slot_names.end( ) );
+   slot_names.erase( unique( slot_names.begin( ), slot_names.end( ) ), slot_names.end( ) );
+
+   for( size_t i = 0; i < nodes.size( ); i++ )
+      nodes[ i ]->slot = lower_bound( slot_names.begin( ), slot_names.end( ), get_slot_name( nodes[ i ] ) ) - slot_names.begin( );
+
+   if( is_invalid )
+      return;
+
+   // NOTE: If the syntax is just a sequence of nodes (that can each have optional branches
+   // with a single node) then it can be matched without recursion (see parse_flat_command).
+   for( node* p_next = p_node; p_next; p_next = p_next->p_next_node )
+   {
+      if( p_next->is_alt || p_next->p_match_node )
+      {
+         flat_nodes.clear( );
+         return;
+      }
+
+      for( size_t i = 0; i < p_next->opt_branch_nodes.size( ); i++ )
+      {
+         if( !is_flat_node( p_next->opt_branch_nodes[ i ] ) )
+         {
+            flat_nodes.clear( );
+            return;
+         }
+      }
+
+      flat_nodes.push_back( p_next );
+   }
+
+   is_flat = true;
+}
+
+bool command_parser::impl::is_flat_node( const node* p_node ) const
+{
+   return !p_node->is_alt && !p_node->p_match_node && !p_node->p_next_node
+    && p_node->opt_branch_nodes.empty( ) && !p_node->expression.empty( ) && !p_node->parameter.empty( );
+}
+
+// NOTE: This function must produce exactly the same results (including parameter values) as
+// "do_parse_command" does for syntaxes that were found to be "flat" (see "compile"). For such
+// syntaxes an optional branch node matches if its expression does and the only backtracking
+// occurs after a failure that follows a node with an empty expression (which is treated as a
+// success with the argument number being restored to where it was prior to that node).
+bool command_parser::impl::parse_flat_command( size_t& argnum )
+{
+   bool has_fallback = false;
+   size_t fallback_argnum = 0;
+
+   bool retval = false;
+
+   for( size_t n = 0; n < flat_nodes.size( ); n++ )
+   {
+      node* p_next = flat_nodes[ n ];
+
+      size_t old_argnum = argnum;
+
+      bool okay = true;
+      bool matched = false;
+
+      retval = false;
+
+      if( argnum == p_arguments->size( ) )
+      {
+         if( p_next->parameter.empty( ) && !p_next->p_next_node )
+            retval = true;
+
+         break;
+      }
+
+      const string& input( ( *p_arguments )[ argnum ] );
+
+      bool prefix_matched = ( !p_next->prefix.empty( )
+       && input.compare( 0, p_next->prefix.size( ), p_next->prefix ) == 0 );
+
+      if( !prefix_matched && !p_next->opt_branch_nodes.empty( ) )
+      {
+         okay = false;
+         flat_opts_done.assign( p_next->opt_branch_nodes.size( ), 0 );
+
+         for( vector< node* >::size_type i = 0; i < p_next->opt_branch_nodes.size( ); )
+         {
+            node* p_opt = p_next->opt_branch_nodes[ i ];
+
+            if( ( !flat_opts_done[ i ] || ( !p_opt->prefix.empty( )
+             && ( p_opt->type == c_expr_type_list || p_opt->type == c_expr_type_olist ) ) )
+             && argnum < p_arguments->size( ) && parse_command_expression( p_opt, argnum ) )
+            {
+               flat_opts_done[ i ] = 1;
+               okay = true;
+               i = 0;
+            }
+            else
+               i++;
+         }
+
+         if( okay && argnum == p_arguments->size( ) && argnum != old_argnum && p_next->expression.empty( ) )
+            retval = true;
+
+         if( !okay && argnum == old_argnum )
+            okay = true;
+      }
+
+      if( !p_next->parameter.empty( ) )
+         retval = false;
+
+      if( okay && p_next->expression.empty( ) )
+         retval = true;
+
+      if( okay && !retval && argnum < p_arguments->size( ) && parse_command_expression( p_next, argnum ) )
+      {
+         retval = true;
+         matched = true;
+      }
+
+      if( !retval )
+         break;
+
+      if( n + 1 < flat_nodes.size( ) )
+      {
+         // NOTE: Unless this node was matched a following node with an empty expression is skipped.
+         if( !matched && flat_nodes[ n + 1 ]->expression.empty( ) )
+            ++n;
+
+         if( n + 1 < flat_nodes.size( ) && flat_nodes[ n + 1 ]->expression.empty( ) )
+         {
+            has_fallback = true;
+            fallback_argnum = argnum;
+         }
+      }
+   }
+
+   if( !retval && has_fallback )
+   {
+      retval = true;
+      argnum = fallback_argnum;
+   }
+
+   return retval;
+}
+
 void command_parser::impl::parse_syntax_expression( node* p_node )
 {
    bool found_error = false;
@@ -1070,8 +1290,6 @@ void command_parser::impl::parse_syntax_expression( node* p_node )
 
    string expression( p_node->expression );
 
-   size_t num_subs = count( expression.begin( ), expression.end( ), c_sub_expression_divider );
-
    p_node->type = get_next_sub_expression( expression, c_sub_expression_divider );
 
    if( expression.empty( ) )
@@ -1194,7 +1412,9 @@ bool command_parser::impl::parse_command_expression( node* p_node, size_t& argnu
    separator_buffer[ 0 ] = p_node->separator;
    separator_buffer[ 1 ] = '\0';
 
-   string input( ( *p_arguments )[ argnum ] );
+   // NOTE: As most nodes that are checked will not match the input is only
+   // copied when a matched value needs to have its prefix removed from it.
+   const string& input( ( *p_arguments )[ argnum ] );
 
    string match_prefix( p_node->prefix );
 
@@ -1234,16 +1454,12 @@ bool command_parser::impl::parse_command_expression( node* p_node, size_t& argnu
             retval = true;
 
             string value;
-            string parameter( p_node->parameter );
-            string::size_type pos = parameter.find( c_exp_type_opt_value_separator );
+            string::size_type pos = p_node->parameter.find( c_exp_type_opt_value_separator );
 
             if( pos != string::npos )
-            {
-               value = parameter.substr( pos + 1 );
-               parameter.erase( pos );
-            }
+               value = p_node->parameter.substr( pos + 1 );
 
-            p_parameters->insert( parameter_value_type( parameter, value ) );
+            p_parameters->set_value( p_node->slot, value );
          }
       }
       else if( p_node->type == c_expr_type_pat )
@@ -1271,7 +1487,7 @@ bool command_parser::impl::parse_command_expression( node* p_node, size_t& argnu
 
             value += input.substr( start, length );
 
-            p_parameters->insert( parameter_value_type( parameter, value ) );
+            p_parameters->set_value( p_node->slot, value );
 
             if( !refs.empty( ) )
             {
@@ -1281,7 +1497,7 @@ bool command_parser::impl::parse_command_expression( node* p_node, size_t& argnu
                   if( refs.size( ) > 9 && i < 9 )
                      prefix += "0";
 
-                  p_parameters->insert( parameter_value_type( parameter + prefix + to_string( i + 1 ), refs[ i ] ) );
+                  p_parameters->set_extra_value( parameter + prefix + to_string( i + 1 ), refs[ i ] );
                }
             }
          }
@@ -1302,31 +1518,30 @@ bool command_parser::impl::parse_command_expression( node* p_node, size_t& argnu
                {
                   ++argnum;
                   retval = true;
-                  p_parameters->insert(
-                   parameter_value_type( p_node->parameter, ( *p_arguments )[ argnum++ ] ) );
+                  p_parameters->set_value( p_node->slot, ( *p_arguments )[ argnum++ ] );
                }
             }
          }
-         else if( !prefix_separator_is_whitespace && match_prefix == input.substr( 0, match_prefix.size( ) ) )
+         else if( !prefix_separator_is_whitespace && input.compare( 0, match_prefix.size( ), match_prefix ) == 0 )
          {
-            input.erase( 0, match_prefix.size( ) );
-            if( !input.empty( ) || argnum <= p_arguments->size( ) - 1 )
+            string value( input, match_prefix.size( ) );
+            if( !value.empty( ) || argnum <= p_arguments->size( ) - 1 )
             {
 #ifdef DEBUG
                cout << "val matched substr prefix '" << match_prefix << "'" << endl;
 #endif
-               if( p_node->type == c_expr_type_oval || !input.empty( ) )
+               if( p_node->type == c_expr_type_oval || !value.empty( ) )
                {
                   ++argnum;
                   retval = true;
-                  p_parameters->insert( parameter_value_type( p_node->parameter, input ) );
+                  p_parameters->set_value( p_node->slot, value );
                }
             }
          }
          else if( !prefix_separator_is_whitespace && !p_node->default_val.empty( ) )
          {
             retval = true;
-            p_parameters->insert( parameter_value_type( p_node->parameter, p_node->default_val ) );
+            p_parameters->set_value( p_node->slot, p_node->default_val );
          }
       }
       else if( p_node->type == c_expr_type_list || p_node->type == c_expr_type_olist )
@@ -1350,19 +1565,19 @@ bool command_parser::impl::parse_command_expression( node* p_node, size_t& argnu
                }
             }
          }
-         else if( !prefix_separator_is_whitespace && match_prefix == input.substr( 0, match_prefix.size( ) ) )
+         else if( !prefix_separator_is_whitespace && input.compare( 0, match_prefix.size( ), match_prefix ) == 0 )
          {
-            input.erase( 0, match_prefix.size( ) );
-            if( !input.empty( ) || argnum <= p_arguments->size( ) - 1 )
+            string list_input( input, match_prefix.size( ) );
+            if( !list_input.empty( ) || argnum <= p_arguments->size( ) - 1 )
             {
 #ifdef DEBUG
                cout << "list matched substr prefix '" << match_prefix << "'" << endl;
 #endif
-               if( p_node->type == c_expr_type_olist || all_list_values_are_not_empty( input, p_node->separator ) )
+               if( p_node->type == c_expr_type_olist || all_list_values_are_not_empty( list_input, p_node->separator ) )
                {
                   ++argnum;
                   retval = true;
-                  value = input;
+                  value = list_input;
                }
             }
          }
@@ -1375,19 +1590,7 @@ bool command_parser::impl::parse_command_expression( node* p_node, size_t& argnu
             if( !parse_separated_list_items( p_node, argnum, value ) )
                retval = false;
             else
-            {
-               parameter_iterator pi = p_parameters->find( p_node->parameter );
-               if( pi != p_parameters->end( ) )
-               {
-                  string tmp( pi->second );
-                  tmp += p_node->separator;
-                  tmp += value;
-                  value = tmp;
-                  p_parameters->erase( pi );
-               }
-
-               p_parameters->insert( parameter_value_type( p_node->parameter, value ) );
-            }
+               p_parameters->append_value( p_node->slot, p_node->separator, value );
          }
       }
    }
@@ -1439,7 +1642,7 @@ bool command_parser::impl::parse_command_expression( node* p_node, size_t& argnu
                cout << "non-prefixed parameter match..." << endl;
                cout << "value: [" << value << "]" << endl;
 #endif
-               p_parameters->insert( parameter_value_type( p_node->parameter, value ) );
+               p_parameters->set_value( p_node->slot, value );
             }
          }
       }
@@ -1513,6 +1716,134 @@ bool command_parser::impl::parse_separated_list_items( node* p_node, size_t& arg
    return retval;
 }
 
+void command_parameters::clear( )
+{
+   for( size_t i = 0; i < is_set.size( ); i++ )
+      is_set[ i ] = 0;
+
+   extra_values.clear( );
+}
+
+void command_parameters::bind( const vector< string >& names )
+{
+   // NOTE: If already bound to the same names then the existing slots are just cleared.
+   if( p_names == &names && values.size( ) == names.size( ) )
+      clear( );
+   else
+   {
+      p_names = &names;
+
+      is_set.assign( names.size( ), 0 );
+      values.resize( names.size( ) );
+
+      extra_values.clear( );
+   }
+}
+
+size_t command_parameters::get_slot( const char* p_name ) const
+{
+   size_t low = 0;
+   size_t high = values.size( );
+
+   while( low < high )
+   {
+      size_t mid = ( low + high ) / 2;
+
+      int rc = strcmp( ( *p_names )[ mid ].c_str( ), p_name );
+
+      if( rc == 0 )
+         return mid;
+      else if( rc < 0 )
+         low = mid + 1;
+      else
+         high = mid;
+   }
+
+   return string::npos;
+}
+
+const string& command_parameters::get_slot_value( size_t slot ) const
+{
+   static string empty;
+
+   if( !has_slot_value( slot ) )
+      return empty;
+
+   return values[ slot ];
+}
+
+bool command_parameters::has_value( const char* p_name ) const
+{
+   size_t slot = get_slot( p_name );
+
+   if( slot != string::npos )
+      return is_set[ slot ];
+
+   return !extra_values.empty( ) && extra_values.count( p_name );
+}
+
+const string& command_parameters::get_value( const char* p_name ) const
+{
+   static string empty;
+
+   size_t slot = get_slot( p_name );
+
+   if( slot != string::npos )
+      return is_set[ slot ] ? values[ slot ] : empty;
+
+   if( !extra_values.empty( ) )
+   {
+      map< string, string >::const_iterator ci = extra_values.find( p_name );
+
+      if( ci != extra_values.end( ) )
+         return ci->second;
+   }
+
+   return empty;
+}
+
+void command_parameters::get_values( map< string, string >& parameters ) const
+{
+   parameters.clear( );
+
+   for( size_t i = 0; i < values.size( ); i++ )
+   {
+      if( is_set[ i ] )
+         parameters.insert( make_pair( ( *p_names )[ i ], values[ i ] ) );
+   }
+
+   parameters.insert( extra_values.begin( ), extra_values.end( ) );
+}
+
+void command_parameters::set_value( size_t slot, const string& value )
+{
+   // NOTE: As the parser can backtrack the first value found for a parameter is kept.
+   if( !is_set[ slot ] )
+   {
+      is_set[ slot ] = 1;
+      values[ slot ] = value;
+   }
+}
+
+void command_parameters::append_value( size_t slot, char separator, const string& value )
+{
+   if( !is_set[ slot ] )
+   {
+      is_set[ slot ] = 1;
+      values[ slot ] = value;
+   }
+   else
+   {
+      values[ slot ] += separator;
+      values[ slot ] += value;
+   }
+}
+
+void command_parameters::set_extra_value( const string& name, const string& value )
+{
+   extra_values.insert( make_pair( name, value ) );
+}
+
 command_parser::command_parser( )
 {
    p_impl = new impl;
@@ -1534,6 +1865,17 @@ void command_parser::parse_syntax( const char* p_input )
 }
 
 bool command_parser::parse_command( const vector< string >& arguments, map< string, string >& parameters )
+{
+   command_parameters slot_parameters;
+
+   bool retval = p_impl->parse_command( arguments, slot_parameters );
+
+   slot_parameters.get_values( parameters );
+
+   return retval;
+}
+
+bool command_parser::parse_command( const vector< string >& arguments, command_parameters& parameters )
 {
    return p_impl->parse_command( arguments, parameters );
 }
@@ -1578,3 +1920,8 @@ size_t command_parser::get_num_nodes( ) const
    return p_impl->get_num_nodes( );
 }
 
+bool command_parser::has_flat_matcher( ) const
+{
+   return p_impl->has_flat_matcher( );
+}
+
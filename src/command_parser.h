@@ -14,6 +14,52 @@
 #     include <iosfwd>
 #  endif
 
+// NOTE: Parameter values are held in "slots" (one for each distinct parameter name in the
+// syntax) that are ordered by name so that a command can be parsed without needing to add
+// any map entries (and the slots of an object that is reused will retain their capacity).
+// Values for names that are not known until parsing (such as pattern sub-matches) are held
+// separately. The "set" and "append" functions are only expected to be used by the parser.
+class command_parameters
+{
+   public:
+   command_parameters( ) : p_names( 0 ) { }
+
+   void clear( );
+
+   void bind( const std::vector< std::string >& names );
+
+   size_t get_num_slots( ) const { return values.size( ); }
+
+   size_t get_slot( const char* p_name ) const;
+   size_t get_slot( const std::string& name ) const { return get_slot( name.c_str( ) ); }
+
+   const std::string& get_slot_name( size_t slot ) const { return ( *p_names )[ slot ]; }
+
+   bool has_slot_value( size_t slot ) const { return slot < is_set.size( ) && is_set[ slot ]; }
+   const std::string& get_slot_value( size_t slot ) const;
+
+   bool has_value( const char* p_name ) const;
+   bool has_value( const std::string& name ) const { return has_value( name.c_str( ) ); }
+
+   const std::string& get_value( const char* p_name ) const;
+   const std::string& get_value( const std::string& name ) const { return get_value( name.c_str( ) ); }
+
+   void get_values( std::map< std::string, std::string >& parameters ) const;
+
+   void set_value( size_t slot, const std::string& value );
+   void append_value( size_t slot, char separator, const std::string& value );
+
+   void set_extra_value( const std::string& name, const std::string& value );
+
+   private:
+   const std::vector< std::string >* p_names;
+
+   std::vector< char > is_set;
+   std::vector< std::string > values;
+
+   std::map< std::string, std::string > extra_values;
+};
+
 class command_parser
 {
    public:
@@ -27,6 +73,8 @@ class command_parser
    bool parse_command(
     const std::vector< std::string >& arguments, std::map< std::string, std::string >& parameters );
 
+   bool parse_command( const std::vector< std::string >& arguments, command_parameters& parameters );
+
    bool okay( );
 
    void dump_nodes( std::ostream& ostr ) const;
@@ -42,6 +90,8 @@ class command_parser
 
    size_t get_num_nodes( ) const;
 
+   bool has_flat_matcher( ) const;
+
    private:
    struct impl;
    impl* p_impl;
@@ -18,6 +18,7 @@ class command_processor
 {
    public:
    command_processor( command_handler& handler );
+   virtual ~command_processor( ) { }
 
    void process_commands( );
 
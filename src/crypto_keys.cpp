@@ -11,6 +11,7 @@
 #ifndef HAS_PRECOMPILED_STD_HEADERS
 #  include <cstring>
 #  include <map>
+#  include <list>
 #  include <memory>
 #  include <iomanip>
 #  include <sstream>
@@ -28,7 +29,10 @@
 
 #include "base64.h"
 #include "sha256.h"
+#include "threads.h"
+#include "secp256k1.h"
 #include "utilities.h"
+#include "thread_pool.h"
 #include "crypt_stream.h"
 
 #include <stdio.h>
@@ -307,12 +311,228 @@ inline uint64_t fix_endian( uint64_t x )
    return x;
 }
 
+const size_t c_default_public_key_cache_limit = 1000;
+
+signature_verifier g_signature_verifier = e_signature_verifier_openssl;
+
+// NOTE: The cache owns a copy of each EC_KEY (which is copied into the caller's EC_KEY when
+// found) and the least recently used key is removed whenever the limit would be exceeded.
+class public_key_cache
+{
+   public:
+   public_key_cache( ) : limit( c_default_public_key_cache_limit ) { }
+
+   ~public_key_cache( )
+   {
+      clear( );
+   }
+
+   size_t get_size( )
+   {
+      guard g( lock );
+
+      return entries.size( );
+   }
+
+   size_t get_limit( )
+   {
+      guard g( lock );
+
+      return limit;
+   }
+
+   void set_limit( size_t new_limit )
+   {
+      guard g( lock );
+
+      limit = new_limit;
+
+      while( entries.size( ) > limit )
+         remove_oldest( );
+   }
+
+   bool fetch( const string& encoded, EC_KEY* p_key, secp256k1_point& point )
+   {
+      guard g( lock );
+
+      map< string, entry >::iterator i = entries.find( encoded );
+
+      if( i == entries.end( ) || !EC_KEY_copy( p_key, i->second.p_key ) )
+         return false;
+
+      point = i->second.point;
+
+      used.splice( used.end( ), used, i->second.used_pos );
+
+      return true;
+   }
+
+   void store( const string& encoded, const EC_KEY* p_key, const secp256k1_point& point )
+   {
+      guard g( lock );
+
+      if( !limit || entries.count( encoded ) )
+         return;
+
+      EC_KEY* p_copy = EC_KEY_dup( p_key );
+
+      if( !p_copy )
+         return;
+
+      while( entries.size( ) >= limit )
+         remove_oldest( );
+
+      entry& new_entry( entries[ encoded ] );
+
+      new_entry.p_key = p_copy;
+      new_entry.point = point;
+      new_entry.used_pos = used.insert( used.end( ), encoded );
+   }
+
+   void clear( )
+   {
+      guard g( lock );
+
+      while( !entries.empty( ) )
+         remove_oldest( );
+   }
+
+   private:
+   struct entry
+   {
+      entry( ) : p_key( 0 ) { }
+
+      EC_KEY* p_key;
+      secp256k1_point point;
+
+      list< string >::iterator used_pos;
+   };
+
+   void remove_oldest( )
+   {
+      map< string, entry >::iterator i = entries.find( used.front( ) );
+
+      EC_KEY_free( i->second.p_key );
+
+      entries.erase( i );
+      used.pop_front( );
+   }
+
+   mutex lock;
+
+   size_t limit;
+
+   list< string > used;
+   map< string, entry > entries;
+};
+
+public_key_cache g_public_key_cache;
+
+// NOTE: The calling thread also verifies signatures so the pool will only have an extra
+// "num_threads - 1" workers (with each thread taking the next unverified signature).
+struct signature_batch
+{
+   signature_batch( const vector< signature_verification >& verifications )
+    :
+    next( 0 ),
+    verifications( verifications ),
+    results( verifications.size( ), 0 )
+   {
+   }
+
+   size_t next;
+
+   string error;
+
+   mutex batch_mutex;
+
+   const vector< signature_verification >& verifications;
+
+   vector< char > results;
+
+   void process( size_t num_threads );
+   void process_verifications( );
+};
+
+class signature_batch_job : public thread_pool_job
+{
+   public:
+   signature_batch_job( signature_batch& batch ) : batch( batch ) { }
+
+   void run( ) { batch.process_verifications( ); }
+
+   private:
+   signature_batch& batch;
+};
+
+void signature_batch::process( size_t num_threads )
+{
+   if( num_threads > verifications.size( ) )
+      num_threads = verifications.size( );
+
+   if( num_threads > 1 )
+   {
+      thread_pool workers( num_threads - 1 );
+      workers.start( );
+
+      for( size_t i = 1; i < num_threads; i++ )
+         workers.queue_job( new signature_batch_job( *this ) );
+
+      process_verifications( );
+
+      // NOTE: Joins the workers so none of them can still be using the batch after this.
+      workers.stop( );
+   }
+   else
+      process_verifications( );
+
+   if( !error.empty( ) )
+      throw runtime_error( error );
+}
+
+void signature_batch::process_verifications( )
+{
+   while( true )
+   {
+      size_t i = 0;
+
+      // NOTE: Scope for guard object.
+      {
+         guard g( batch_mutex );
+
+         if( next >= verifications.size( ) || !error.empty( ) )
+            break;
+
+         i = next++;
+      }
+
+      try
+      {
+         const signature_verification& verification( verifications[ i ] );
+
+         if( !verification.p_key )
+            throw runtime_error( "missing public key for signature verification" );
+
+         results[ i ] = verification.p_key->verify_signature( verification.msg, verification.sig );
+      }
+      catch( exception& x )
+      {
+         guard g( batch_mutex );
+
+         if( error.empty( ) )
+            error = x.what( );
+      }
+   }
+}
+
 }
 
 struct public_key::impl
 {
    EC_KEY* p_key;
 
+   secp256k1_point point;
+
    impl( )
    {
       p_key = EC_KEY_new_by_curve_name( NID_secp256k1 );
@@ -341,11 +561,22 @@ struct public_key::impl
       return nsize;
    }
 
+   void update_point( )
+   {
+      unsigned char bytes[ c_max_public_key_bytes ];
+
+      int size = get_public_key( bytes, false );
+
+      secp256k1_parse_public_key( bytes, size, point );
+   }
+
    bool verify_signature( const unsigned char hash[ c_sha256_digest_size ], vector< unsigned char >& signature )
    {
       bool okay = false;
 
-      if( ECDSA_verify( 0, &hash[ 0 ], c_sha256_digest_size, &signature[ 0 ], signature.size( ), p_key ) == 1 )
+      if( g_signature_verifier == e_signature_verifier_secp256k1 && has_secp256k1_verify( ) )
+         okay = secp256k1_verify_signature( point, &hash[ 0 ], signature.empty( ) ? 0 : &signature[ 0 ], signature.size( ) );
+      else if( ECDSA_verify( 0, &hash[ 0 ], c_sha256_digest_size, &signature[ 0 ], signature.size( ), p_key ) == 1 )
          okay = true;
 
       return okay;
@@ -372,9 +603,23 @@ public_key::public_key( const string& encoded, bool use_base64 )
       hex_decode( encoded, buf, c_max_public_key_bytes );
    }
 
-   const unsigned char* pbegin = &buf[ 0 ];
+   // NOTE: An oversized key cannot be valid (and nor would it have been fully decoded).
+   if( size <= c_max_public_key_bytes )
+   {
+      string encoded_bytes( ( const char* )buf, size );
 
-   o2i_ECPublicKey( &p_impl->p_key, &pbegin, size );
+      if( !g_public_key_cache.fetch( encoded_bytes, p_impl->p_key, p_impl->point ) )
+      {
+         const unsigned char* pbegin = &buf[ 0 ];
+
+         if( o2i_ECPublicKey( &p_impl->p_key, &pbegin, size ) )
+         {
+            secp256k1_parse_public_key( buf, size, p_impl->point );
+
+            g_public_key_cache.store( encoded_bytes, p_impl->p_key, p_impl->point );
+         }
+      }
+   }
 }
 
 public_key::~public_key( )
@@ -536,6 +781,8 @@ struct private_key::impl
          throw runtime_error( "unexpected failure for EC_KEY_regenerate_key in set_secret_byts" );
 
       BN_clear_free( &bn );
+
+      p_pub_impl->update_point( );
    }
 
    // NOTE: This function was sourced from the Bitcoin project.
@@ -776,6 +1023,48 @@ string private_key::construct_signature( const string& msg, bool use_base64 ) co
    return use_base64 ? base64::encode( &signature[ 0 ], signature.size( ) ) : hex_encode( &signature[ 0 ], signature.size( ) );
 }
 
+signature_verifier get_signature_verifier( )
+{
+   if( !has_secp256k1_verify( ) )
+      return e_signature_verifier_openssl;
+
+   return g_signature_verifier;
+}
+
+void set_signature_verifier( signature_verifier verifier )
+{
+   g_signature_verifier = verifier;
+}
+
+size_t get_public_key_cache_limit( )
+{
+   return g_public_key_cache.get_limit( );
+}
+
+void set_public_key_cache_limit( size_t limit )
+{
+   g_public_key_cache.set_limit( limit );
+}
+
+size_t get_public_key_cache_size( )
+{
+   return g_public_key_cache.get_size( );
+}
+
+void clear_public_key_cache( )
+{
+   g_public_key_cache.clear( );
+}
+
+void verify_signatures( const vector< signature_verification >& verifications, vector< bool >& results, size_t num_threads )
+{
+   signature_batch batch( verifications );
+
+   batch.process( num_threads );
+
+   results.assign( batch.results.begin( ), batch.results.end( ) );
+}
+
 string create_p2sh_address( const string& hex_script, bool use_override, address_prefix override )
 {
    size_t size = hex_script.size( ) / 2;
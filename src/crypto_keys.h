@@ -93,6 +93,54 @@ class private_key : public public_key
    private_key& operator =( const private_key& );
 };
 
+enum signature_verifier
+{
+   e_signature_verifier_openssl,
+   e_signature_verifier_secp256k1
+};
+
+// NOTE: OpenSSL is the default verifier. The "secp256k1" verifier (which is only available if
+// it was included in the build) will produce the same results as OpenSSL but is considerably
+// faster (if it is not available then OpenSSL is always used). If OpenSSL is being used with
+// multiple threads then its locking callbacks are expected to have already been set up (such
+// as is done via "init_ssl").
+signature_verifier get_signature_verifier( );
+void set_signature_verifier( signature_verifier verifier );
+
+// NOTE: Decoded public keys are cached (keyed by their encoded bytes) so that constructing a
+// "public_key" for a recently seen signer does not need to decode (or decompress) the point.
+// Setting the limit to zero will disable the cache (and any currently cached keys are freed).
+size_t get_public_key_cache_limit( );
+void set_public_key_cache_limit( size_t limit );
+
+size_t get_public_key_cache_size( );
+
+void clear_public_key_cache( );
+
+struct signature_verification
+{
+   signature_verification( ) : p_key( 0 ) { }
+
+   signature_verification( const public_key& key, const std::string& msg, const std::string& sig )
+    :
+    p_key( &key ),
+    msg( msg ),
+    sig( sig )
+   {
+   }
+
+   const public_key* p_key;
+
+   std::string msg;
+   std::string sig;
+};
+
+// NOTE: Verifies each message and (base64) signature against its key (i.e. the same as calling
+// "public_key::verify_signature" for each) with the work being shared by "num_threads" threads
+// (including the calling thread).
+void verify_signatures( const std::vector< signature_verification >& verifications,
+ std::vector< bool >& results, size_t num_threads = 1 );
+
 std::string create_p2sh_address( const std::string& hex_script,
  bool use_override = false, address_prefix override = e_address_prefix_btc_p2sh_testnet );
 
@@ -9,6 +9,7 @@
 #pragma hdrstop
 
 #ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <cstring>
 #  include <string>
 #  include <fstream>
 #  include <sstream>
@@ -16,6 +17,17 @@
 #  include <stdexcept>
 #endif
 
+#ifdef _WIN32
+#  ifndef STRICT
+#     define STRICT // Needed for "windows.h" by various Borland headers.
+#  endif
+#  define NOMINMAX
+#  include <windows.h>
+#else
+#  include <unistd.h>
+#  include <sys/time.h>
+#endif
+
 #include "clz.h"
 
 #include "utilities.h"
@@ -26,6 +38,12 @@ const char* const c_cz_ext = ".cz";
 
 const char* const c_quiet_opt = "-q";
 
+const char* const c_range_opt_prefix = "-r=";
+const char* const c_block_opt_prefix = "-b=";
+const char* const c_thread_opt_prefix = "-t=";
+
+const size_t c_default_bench_megabytes = 2;
+
 const char* const c_speed_fast = "fast";
 const char* const c_speed_slow = "slow";
 
@@ -306,8 +324,28 @@ g_simple_tests[ ] =
    { "zwyuxswqvoumtksirgqepcoan_m]l[kY", "zwyu\xf7\x1e" },
    { "zwyuxswqvoumtksirgqepcoan_m]l[kYjW", "zwyu\xf7\x1f" },
    { "zwyuxswqvoumtksirgqepcoan_m]l[kYjWiU", "zwyu\xf7\x1f""iU" },
+   { "abcddd", "a\xf6\x80\xf0" },
+   { "abcdddd", "a\xf6\x80\xf1\x03" },
+   { "dcbaaa", "d\xf6\x90\xf0" },
+   { "aabbccddeeee", "aa\xf6\xa2\xf0" },
 };
 
+size_t get_num_cpus( )
+{
+   long num = 0;
+
+#ifdef _WIN32
+   SYSTEM_INFO info;
+   ::GetSystemInfo( &info );
+
+   num = info.dwNumberOfProcessors;
+#else
+   num = ::sysconf( _SC_NPROCESSORS_ONLN );
+#endif
+
+   return num > 0 ? num : 1;
+}
+
 bool do_test( size_t length, speed inc )
 {
    bool okay = true;
@@ -387,6 +425,12 @@ bool do_tests( const string& test_info )
 
       if( os.str( ) != string( g_simple_tests[ i ].p_output ) )
          throw runtime_error( "failed test with input: " + string( g_simple_tests[ i ].p_input ) );
+
+      ostringstream osstr;
+      decode_clz_data( os, osstr );
+
+      if( osstr.str( ) != string( g_simple_tests[ i ].p_input ) )
+         throw runtime_error( "failed decode test with input: " + string( g_simple_tests[ i ].p_input ) );
    }
 
    string info( test_info );
@@ -437,23 +481,223 @@ bool do_tests( const string& test_info )
    return okay;
 }
 
+string generate_bench_data( size_t num_bytes )
+{
+   string data;
+   data.reserve( num_bytes + 128 );
+
+   unsigned int seed = 1;
+
+   while( data.size( ) < num_bytes )
+   {
+      seed = ( seed * 1103515245 ) + 12345;
+      size_t next = ( seed >> 16 ) & 0x7fff;
+
+      // NOTE: Use a mix of dictionary type words, numbers and repeated text so that
+      // the data is similar to what would typically be found in logs and backups.
+      if( next % 11 == 0 )
+         data += to_string( next * 7919 ) + ' ';
+      else if( next % 17 == 0 )
+         data += "[INFO] request completed\n";
+      else
+      {
+         size_t length = 2 + ( next % 7 );
+
+         for( size_t i = 0; i < length; i++ )
+         {
+            seed = ( seed * 1103515245 ) + 12345;
+            data += ( char )( 'a' + ( ( seed >> 16 ) % 26 ) );
+         }
+
+         data += ' ';
+      }
+   }
+
+   data.erase( num_bytes );
+
+   return data;
+}
+
+void output_rate( const string& name, size_t num_bytes, unsigned long usecs, unsigned long base_usecs )
+{
+   cout << "  " << name << ": " << ( usecs / 1000 ) << " msecs";
+
+   if( usecs )
+   {
+      cout << " (" << ( ( double )num_bytes / usecs ) << " MB/s";
+
+      if( base_usecs )
+         cout << ", x" << ( ( double )base_usecs / usecs );
+
+      cout << ")";
+   }
+
+   cout << endl;
+}
+
+bool do_bench( const string& bench_info, size_t max_threads, size_t block_size )
+{
+   bool okay = true;
+
+   size_t megabytes = c_default_bench_megabytes;
+
+   if( !bench_info.empty( ) )
+      megabytes = from_string< size_t >( bench_info.substr( bench_info[ 0 ] == ':' ? 1 : 0 ) );
+
+   if( !megabytes )
+      throw runtime_error( "invalid number of megabytes for bench" );
+
+   string data( generate_bench_data( megabytes * 1024 * 1024 ) );
+
+   cout << "Benchmarking framed clz with " << data.size( ) << " bytes and a block size of " << block_size << "..." << endl;
+
+   unsigned long base_encode_usecs = 0;
+   unsigned long base_decode_usecs = 0;
+
+   for( size_t num_threads = 1; ; num_threads *= 2 )
+   {
+      if( num_threads > max_threads )
+         num_threads = max_threads;
+
+      stringstream input( data );
+      stringstream encoded;
+
+      unsigned long start = get_usecs( );
+
+      encode_clz_framed_data( input, encoded, num_threads, block_size );
+
+      unsigned long encode_usecs = get_usecs( ) - start;
+
+      ostringstream decoded;
+
+      start = get_usecs( );
+
+      decode_clz_framed_data( encoded, decoded, num_threads );
+
+      unsigned long decode_usecs = get_usecs( ) - start;
+
+      if( num_threads == 1 )
+      {
+         base_encode_usecs = encode_usecs;
+         base_decode_usecs = decode_usecs;
+      }
+
+      cout << num_threads << " thread(s) (" << encoded.str( ).size( ) << " encoded bytes):" << endl;
+
+      output_rate( "encode", data.size( ), encode_usecs, base_encode_usecs );
+      output_rate( "decode", data.size( ), decode_usecs, base_decode_usecs );
+
+      if( decoded.str( ) != data )
+      {
+         cout << "*** failed to decode the framed data ***" << endl;
+         okay = false;
+         break;
+      }
+
+      // NOTE: Also check that a range which spans a block boundary is decoded correctly.
+      if( data.size( ) > block_size )
+      {
+         size_t offset = block_size - ( block_size / 3 );
+         size_t length = min( block_size, data.size( ) - offset );
+
+         ostringstream range;
+
+         encoded.clear( );
+         encoded.seekg( 0, ios::beg );
+
+         decode_clz_framed_range( encoded, range, offset, length, num_threads );
+
+         if( range.str( ) != data.substr( offset, length ) )
+         {
+            cout << "*** failed to decode the range " << offset << ", " << length << " ***" << endl;
+            okay = false;
+            break;
+         }
+      }
+
+      if( num_threads >= max_threads )
+         break;
+   }
+
+   if( okay )
+      cout << "[passed]" << endl;
+
+   return okay;
+}
+
 int main( int argc, char* argv[ ] )
 {
+   bool framed = false;
+
+   bool has_range = false;
+
+   int64_t range_offset = 0;
+   int64_t range_length = 0;
+
+   size_t num_threads = 1;
+   size_t block_size = c_default_clz_block_size;
+
    int first_arg = 1;
 
-   if( argc < 2 || argc > 3 || ( argc == 3 && argv[ 1 ] != string( c_quiet_opt ) ) )
+   try
    {
-      cout << "czip v0.1a\n";
-      cout << "Usage: czip [" << c_quiet_opt << "] <file>" << endl;
+      for( ; first_arg < argc - 1; first_arg++ )
+      {
+         string opt( argv[ first_arg ] );
 
+         // NOTE: The quiet option is still accepted although nothing else is output.
+         if( opt == c_quiet_opt )
+            continue;
+         else if( opt.find( c_thread_opt_prefix ) == 0 )
+         {
+            framed = true;
+            num_threads = from_string< size_t >( opt.substr( strlen( c_thread_opt_prefix ) ) );
+
+            if( !num_threads )
+               throw runtime_error( "invalid number of threads in '" + opt + "'" );
+         }
+         else if( opt.find( c_block_opt_prefix ) == 0 )
+         {
+            framed = true;
+            block_size = from_string< size_t >( opt.substr( strlen( c_block_opt_prefix ) ) );
+
+            if( !block_size )
+               throw runtime_error( "invalid block size in '" + opt + "'" );
+         }
+         else if( opt.find( c_range_opt_prefix ) == 0 )
+         {
+            has_range = true;
+
+            string range( opt.substr( strlen( c_range_opt_prefix ) ) );
+            string::size_type pos = range.find( ',' );
+
+            range_offset = from_string< int64_t >( range.substr( 0, pos ) );
+
+            if( pos == string::npos )
+               range_length = numeric_limits< int64_t >::max( );
+            else
+               range_length = from_string< int64_t >( range.substr( pos + 1 ) );
+         }
+         else
+            break;
+      }
+   }
+   catch( exception& e )
+   {
+      cerr << "error: " << e.what( ) << endl;
       return 1;
    }
 
-   bool quiet = false;
-   if( argc > 1 + first_arg && argv[ first_arg ] == string( c_quiet_opt ) )
+   if( first_arg != argc - 1 )
    {
-      ++first_arg;
-      quiet = true;
+      cout << "czip v0.1b\n";
+      cout << "Usage: czip [" << c_quiet_opt << "] [" << c_thread_opt_prefix << "<threads>] ["
+       << c_block_opt_prefix << "<block_size>] [" << c_range_opt_prefix << "<offset>[,<length>]] <file>\n\n";
+      cout << "Providing either the number of threads or the block size will use the framed format\n";
+      cout << "(when compressing) and a range can only be decoded (to stdout) from a framed file.\n";
+      cout << "Use <file> \"@test[:<speed>]\" to run tests or \"@bench[:<megabytes>]\" to benchmark." << endl;
+
+      return 1;
    }
 
    string file_to_remove;
@@ -466,6 +710,11 @@ int main( int argc, char* argv[ ] )
       if( file.find( "@test" ) == 0 )
          return do_tests( file.substr( 5 ) );
 
+      // NOTE: If the file name is "@bench" then compare the framed format performance
+      // using from one thread up to the number of threads given (or the number of CPUs).
+      if( file.find( "@bench" ) == 0 )
+         return !do_bench( file.substr( 6 ), num_threads > 1 ? num_threads : get_num_cpus( ), block_size );
+
       string::size_type pos = file.find( c_cz_ext );
 
       // NOTE: If <file>.cz exists then assume this was intended.
@@ -475,7 +724,21 @@ int main( int argc, char* argv[ ] )
          file += string( c_cz_ext );
       }
 
-      if( pos == string::npos )
+      if( has_range )
+      {
+         if( pos == string::npos || !file_exists( file ) )
+            throw runtime_error( "file '" + file + "' not found" );
+
+         ifstream is( file.c_str( ), ios::in | ios::binary );
+         if( !is )
+            throw runtime_error( "unable to open '" + file + "' for input" );
+
+         if( !is_clz_framed_data( is ) )
+            throw runtime_error( "file '" + file + "' is not in the framed format" );
+
+         decode_clz_framed_range( is, cout, range_offset, range_length, num_threads );
+      }
+      else if( pos == string::npos )
       {
          if( !file_exists( file ) )
             throw runtime_error( "file '" + file + "' not found" );
@@ -495,9 +758,29 @@ int main( int argc, char* argv[ ] )
                throw runtime_error( "unable to open '" + output_file + "' for input" );
 
             file_to_remove = output_file;
-            encode_clz_data( is, os );
+
+            if( framed )
+               encode_clz_framed_data( is, os, num_threads, block_size );
+            else
+            {
+               encode_clz_data( is, os );
+
+               os.close( );
+
+               // NOTE: As the original file will be removed the single stream output is first
+               // checked by decoding it (framed blocks are always checked when being encoded).
+               ifstream check_is( output_file.c_str( ), ios::in | ios::binary );
+               ostringstream check_os;
+
+               decode_clz_data( check_is, check_os );
+
+               if( check_os.str( ) != buffer_file( file ) )
+                  throw runtime_error( "file '" + output_file + "' did not decode back to '" + file + "'" );
+            }
          }
 
+         file_to_remove.erase( );
+
          file_remove( file );
       }
       else
@@ -522,9 +805,14 @@ int main( int argc, char* argv[ ] )
             if( !os )
                throw runtime_error( "unable to open '" + output_file + "' for input" );
 
-            decode_clz_data( is, os );
+            file_to_remove = output_file;
+
+            // NOTE: This will decode both framed and original format files.
+            decode_clz_framed_data( is, os, num_threads );
          }
 
+         file_to_remove.erase( );
+
          file_remove( file );
       }
    }
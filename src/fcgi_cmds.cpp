@@ -684,7 +684,8 @@ bool fetch_list_info( const string& module,
  const string& set_field_values, data_container& rows, const string& exclude_key_info,
  bool* p_prev, string* p_perms, const string* p_security_info, const string* p_extra_debug,
  const set< string >* p_exclude_keys, const string* p_pdf_spec_name, const string* p_pdf_link_filename,
- string* p_pdf_view_file_name, bool* p_can_delete_any, bool is_printable )
+ string* p_pdf_view_file_name, bool* p_can_delete_any, bool is_printable,
+ const string* p_cursor, const string* p_cursor_next )
 {
    bool okay = true;
 
@@ -745,6 +746,14 @@ bool fetch_list_info( const string& module,
          fetch_cmd += " -x=@embed=1";
    }
 
+   if( p_cursor && !p_cursor->empty( ) )
+   {
+      fetch_cmd += " -c=" + *p_cursor;
+
+      if( p_cursor_next && !p_cursor_next->empty( ) )
+         fetch_cmd += " \"-cn=" + *p_cursor_next + "\"";
+   }
+
    fetch_cmd += " \"" + key_info + "\"";
 
    if( row_limit > 0 )
@@ -1745,10 +1754,30 @@ bool populate_list_info( list_source& list,
    list.print_limited = false;
    list.can_delete_any = false;
 
+   // NOTE: Unless the list has a unique index (as then the "next" key info will not include
+   // the key of the row that it starts from) the server is asked to keep its iteration open
+   // so that a "next" page can be continued on from where the previous page had finished.
+   string cursor, cursor_next;
+
+   if( !is_printable && row_limit && !list.unique_index )
+   {
+      // NOTE: The session id and user id are included in the hash so that a cursor token cannot
+      // be used to continue a cursor that had been opened for a different session or user.
+      sha256 hash( sess_info.session_id + '\n' + sess_info.user_id + '\n' + old_key_info );
+      cursor = list.id + "_" + hash.get_digest_as_string( ).substr( 0, 16 );
+
+      if( next )
+      {
+         string::size_type pos = listinfo.rfind( ',' );
+         cursor_next = listinfo.substr( pos == string::npos ? 1 : pos + 1 );
+      }
+   }
+
    if( !fetch_list_info( list.module_id, mod_info, class_info, sess_info,
     is_reverse, row_limit, key_info, field_list, filters, search_text, search_query,
     set_field_values, list.row_data, "", &prev, &perms, p_security_info, 0, 0,
-    p_pdf_spec_name, p_pdf_link_filename, p_pdf_view_file_name, &list.can_delete_any, is_printable ) )
+    p_pdf_spec_name, p_pdf_link_filename, p_pdf_view_file_name, &list.can_delete_any,
+    is_printable, &cursor, &cursor_next ) )
       okay = false;
    else if( is_printable )
    {
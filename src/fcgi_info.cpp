@@ -20,16 +20,123 @@
 #include "fcgi_info.h"
 
 #include "sio.h"
+#include "sha256.h"
 #include "sockets.h"
 #ifdef SSL_SUPPORT
 #  include "ssl_socket.h"
 #endif
+#include "date_time.h"
 #include "utilities.h"
 #include "fcgi_utils.h"
 #include "ciyam_interface.h"
+#include "read_write_stream.h"
 
 using namespace std;
 
+// NOTE: These stream operators are used for the binary module info cache (and are not within
+// the anonymous namespace so that they will be found by the container stream templates).
+read_stream& operator >>( read_stream& rs, fld_info& fld )
+{
+   rs >> fld.name >> fld.field >> fld.ftype >> fld.extra >> fld.tab_id
+    >> fld.unique >> fld.indexed >> fld.mandatory >> fld.index_count
+    >> fld.pclass >> fld.pfield >> fld.pfname >> fld.pdname >> fld.pextra >> fld.modifiers;
+
+   return rs;
+}
+
+write_stream& operator <<( write_stream& ws, const fld_info& fld )
+{
+   ws << fld.name << fld.field << fld.ftype << fld.extra << fld.tab_id
+    << fld.unique << fld.indexed << fld.mandatory << fld.index_count
+    << fld.pclass << fld.pfield << fld.pfname << fld.pdname << fld.pextra << fld.modifiers;
+
+   return ws;
+}
+
+read_stream& operator >>( read_stream& rs, par_info& par )
+{
+   rs >> par.name >> par.field >> par.extra >> par.pclass >> par.pfield >> par.pextra
+    >> par.folder >> par.mandatory >> par.skey >> par.exclude_keys >> par.operations;
+
+   return rs;
+}
+
+write_stream& operator <<( write_stream& ws, const par_info& par )
+{
+   ws << par.name << par.field << par.extra << par.pclass << par.pfield << par.pextra
+    << par.folder << par.mandatory << par.skey << par.exclude_keys << par.operations;
+
+   return ws;
+}
+
+read_stream& operator >>( read_stream& rs, rest_info& rest )
+{
+   rs >> rest.name >> rest.field >> rest.ftype >> rest.extra >> rest.mandatory >> rest.operations;
+
+   return rs;
+}
+
+write_stream& operator <<( write_stream& ws, const rest_info& rest )
+{
+   ws << rest.name << rest.field << rest.ftype << rest.extra << rest.mandatory << rest.operations;
+
+   return ws;
+}
+
+read_stream& operator >>( read_stream& rs, enum_info& e )
+{
+   rs >> e.id >> e.name >> e.filters >> e.values;
+
+   return rs;
+}
+
+write_stream& operator <<( write_stream& ws, const enum_info& e )
+{
+   ws << e.id << e.name << e.filters << e.values;
+
+   return ws;
+}
+
+read_stream& operator >>( read_stream& rs, view_info& view )
+{
+   rs >> view.id >> view.cid >> view.name >> view.type >> view.perm >> view.vlink
+    >> view.module >> view.mclass >> view.bclass >> view.pdf_spec >> view.filename_field_id
+    >> view.static_instance_key >> view.extras >> view.modifiers >> view.fields >> view.file_ids >> view.tabs;
+
+   return rs;
+}
+
+write_stream& operator <<( write_stream& ws, const view_info& view )
+{
+   ws << view.id << view.cid << view.name << view.type << view.perm << view.vlink
+    << view.module << view.mclass << view.bclass << view.pdf_spec << view.filename_field_id
+    << view.static_instance_key << view.extras << view.modifiers << view.fields << view.file_ids << view.tabs;
+
+   return ws;
+}
+
+read_stream& operator >>( read_stream& rs, list_info& list )
+{
+   rs >> list.id >> list.cid >> list.pid >> list.name >> list.type >> list.perm >> list.extra
+    >> list.view >> list.module >> list.mclass >> list.bclass >> list.order
+    >> list.nclass >> list.nfield >> list.nexclude >> list.nextra >> list.dfenum >> list.dfield >> list.dvalue
+    >> list.pclass >> list.pfield >> list.pfldnm >> list.ufield >> list.filters >> list.pdf_spec
+    >> list.extras >> list.modifiers >> list.actions >> list.fields >> list.parents >> list.restricts;
+
+   return rs;
+}
+
+write_stream& operator <<( write_stream& ws, const list_info& list )
+{
+   ws << list.id << list.cid << list.pid << list.name << list.type << list.perm << list.extra
+    << list.view << list.module << list.mclass << list.bclass << list.order
+    << list.nclass << list.nfield << list.nexclude << list.nextra << list.dfenum << list.dfield << list.dvalue
+    << list.pclass << list.pfield << list.pfldnm << list.ufield << list.filters << list.pdf_spec
+    << list.extras << list.modifiers << list.actions << list.fields << list.parents << list.restricts;
+
+   return ws;
+}
+
 namespace
 {
 
@@ -144,12 +251,16 @@ const char* const c_attribute_module_prefix = "module_prefix";
 const char* const c_attribute_user_has_auth = "user_has_auth";
 const char* const c_attribute_checkbox_bools = "checkbox_bools";
 const char* const c_attribute_filesize_limit = "filesize_limit";
+const char* const c_attribute_server_sockets = "server_sockets";
 const char* const c_attribute_user_pin_value = "user_pin_value";
 const char* const c_attribute_print_list_opts = "print_list_opts";
+const char* const c_attribute_request_handlers = "request_handlers";
 const char* const c_attribute_user_gpg_install = "user_gpg_install";
 
 const char* const c_list_field_parent_extra_folder = "[folder]";
 
+const size_t c_num_session_shards = 16;
+
 template< typename T > void setup_modifiers( const string& modifiers, T& t )
 {
    if( !modifiers.empty( ) )
@@ -173,6 +284,214 @@ template< typename T > void setup_modifiers( const string& modifiers, T& t )
    }
 }
 
+// NOTE: The cache version needs to be incremented if any of the cached structures are changed.
+const int c_module_info_cache_version = 1;
+
+const char* const c_module_info_cache_ext = ".fcgi.bin";
+
+class cache_read_stream : public read_stream
+{
+   public:
+   cache_read_stream( const string& data ) : data( data ), pos( 0 ) { }
+
+   void read( unsigned char* p_buf, size_t len, read_write_type )
+   {
+      if( pos + len > data.size( ) )
+         throw runtime_error( "unexpected end of module info cache data" );
+
+      memcpy( p_buf, data.data( ) + pos, len );
+      pos += len;
+   }
+
+   bool is_finished( ) const { return pos == data.size( ); }
+
+   private:
+   const string& data;
+   size_t pos;
+};
+
+class cache_write_stream : public write_stream
+{
+   public:
+   void write( const unsigned char* p_buf, size_t len, read_write_type )
+   {
+      data.append( ( const char* )p_buf, len );
+   }
+
+   const string& get_data( ) const { return data; }
+
+   private:
+   string data;
+};
+
+void get_module_info_strings( module_info& info, vector< string* >& strings )
+{
+   strings.push_back( &info.id );
+   strings.push_back( &info.name );
+   strings.push_back( &info.perm );
+   strings.push_back( &info.title );
+
+   strings.push_back( &info.home_info );
+
+   strings.push_back( &info.sys_class_id );
+   strings.push_back( &info.sys_name_field_id );
+   strings.push_back( &info.sys_vendor_field_id );
+   strings.push_back( &info.sys_actions_field_id );
+   strings.push_back( &info.sys_message_field_id );
+   strings.push_back( &info.sys_reference_field_id );
+
+   strings.push_back( &info.user_class_id );
+   strings.push_back( &info.user_class_name );
+
+   strings.push_back( &info.user_info_view_id );
+
+   strings.push_back( &info.user_uid_field_id );
+   strings.push_back( &info.user_pwd_field_id );
+   strings.push_back( &info.user_hash_field_id );
+   strings.push_back( &info.user_name_field_id );
+   strings.push_back( &info.user_crypt_field_id );
+   strings.push_back( &info.user_email_field_id );
+
+   strings.push_back( &info.user_perm_field_id );
+   strings.push_back( &info.user_group_field_id );
+   strings.push_back( &info.user_mgrps_field_id );
+   strings.push_back( &info.user_other_field_id );
+   strings.push_back( &info.user_extra1_field_id );
+   strings.push_back( &info.user_extra2_field_id );
+   strings.push_back( &info.user_parent_field_id );
+   strings.push_back( &info.user_active_field_id );
+   strings.push_back( &info.user_slevel_field_id );
+   strings.push_back( &info.user_unique_field_id );
+   strings.push_back( &info.user_tz_name_field_id );
+   strings.push_back( &info.user_has_auth_field_id );
+   strings.push_back( &info.user_pin_value_field_id );
+   strings.push_back( &info.user_read_only_field_id );
+   strings.push_back( &info.user_gpg_install_proc_id );
+   strings.push_back( &info.user_change_pwd_tm_field_id );
+
+   strings.push_back( &info.user_select_perm );
+   strings.push_back( &info.user_select_field );
+   strings.push_back( &info.user_select_cfield );
+   strings.push_back( &info.user_select_ofield );
+   strings.push_back( &info.user_select_pfield );
+   strings.push_back( &info.user_select_str_key );
+   strings.push_back( &info.user_select_sl_field );
+   strings.push_back( &info.user_select_uo_field );
+
+   strings.push_back( &info.user_qlink_list_id );
+   strings.push_back( &info.user_qlink_class_id );
+   strings.push_back( &info.user_qlink_pfield_id );
+   strings.push_back( &info.user_qlink_url_field_id );
+   strings.push_back( &info.user_qlink_name_field_id );
+   strings.push_back( &info.user_qlink_test_field_id );
+   strings.push_back( &info.user_qlink_test_field_val );
+   strings.push_back( &info.user_qlink_order_field_id );
+   strings.push_back( &info.user_qlink_checksum_field_id );
+
+   strings.push_back( &info.user_qlink_permission );
+}
+
+void setup_view_containers( module_info& info )
+{
+   for( size_t i = 0; i < info.views.size( ); i++ )
+   {
+      // NOTE: These first two containers are provided in order to locate the
+      // "standard" class view and so must not consider the "print" versions.
+      if( info.views[ i ].type != c_view_type_print
+       && info.views[ i ].type != c_view_type_admin_print )
+      {
+         info.view_cids[ info.views[ i ].cid ] = info.views[ i ].id;
+         info.view_classes[ info.views[ i ].mclass ] = info.views[ i ].id;
+      }
+
+      info.view_info.insert( make_pair( info.views[ i ].id, &info.views[ i ] ) );
+   }
+}
+
+// NOTE: The cache is only used if both the modification time and the hash of the ".fcgi.sio"
+// source file are those that were recorded when the cache was written (any error that occurs
+// when reading it will simply result in the source file being parsed instead).
+bool read_module_info_cache( const string& cache_file_name,
+ time_t sio_mod, const string& sio_hash, module_info& info, storage_info& sinfo )
+{
+   if( !file_exists( cache_file_name ) )
+      return false;
+
+   try
+   {
+      string data( buffer_file( cache_file_name ) );
+
+      cache_read_stream rs( data );
+
+      int version;
+      int64_t mod;
+      string hash;
+
+      rs >> version >> mod >> hash;
+
+      if( version != c_module_info_cache_version || mod != ( int64_t )sio_mod || hash != sio_hash )
+         return false;
+
+      info.clear( );
+
+      vector< string* > strings;
+      get_module_info_strings( info, strings );
+
+      for( size_t i = 0; i < strings.size( ); i++ )
+         rs >> *strings[ i ];
+
+      vector< enum_info > enums;
+
+      rs >> info.user_select_is_strict >> info.allows_anonymous_access >> info.views >> info.lists >> enums;
+
+      if( !rs.is_finished( ) )
+         throw runtime_error( "unexpected trailing module info cache data" );
+
+      setup_view_containers( info );
+
+      for( size_t i = 0; i < enums.size( ); i++ )
+         sinfo.enums.insert( make_pair( enums[ i ].id, enums[ i ] ) );
+
+      return true;
+   }
+   catch( ... )
+   {
+      info.clear( );
+      return false;
+   }
+}
+
+void write_module_info_cache( const string& cache_file_name,
+ time_t sio_mod, const string& sio_hash, module_info& info, const vector< enum_info >& enums )
+{
+   cache_write_stream ws;
+
+   ws << c_module_info_cache_version << ( int64_t )sio_mod << sio_hash;
+
+   vector< string* > strings;
+   get_module_info_strings( info, strings );
+
+   for( size_t i = 0; i < strings.size( ); i++ )
+      ws << *strings[ i ];
+
+   ws << info.user_select_is_strict << info.allows_anonymous_access << info.views << info.lists << enums;
+
+   // NOTE: The cache is written to a temporary file which is then renamed so other processes
+   // will never read a partially written cache (if it cannot be written this is not an error).
+   try
+   {
+      string temp_file_name( cache_file_name + ".tmp" );
+
+      write_file( temp_file_name, ws.get_data( ) );
+
+      if( !file_rename( temp_file_name, cache_file_name ) )
+         file_remove( temp_file_name );
+   }
+   catch( ... )
+   {
+   }
+}
+
 }
 
 void module_info::clear( )
@@ -271,6 +590,8 @@ storage_info::storage_info( )
  encrypt_data( c_default_encrypt_data ),
  checkbox_bools( c_default_checkbox_bools ),
  filesize_limit( c_default_filesize_limit ),
+ server_sockets( c_default_server_sockets ),
+ request_handlers( c_default_request_handlers ),
  quick_link_limit( c_default_quick_link_limit )
 {
 }
@@ -295,6 +616,9 @@ void storage_info::clear( )
 
    filesize_limit = c_default_filesize_limit;
 
+   server_sockets = c_default_server_sockets;
+   request_handlers = c_default_request_handlers;
+
    quick_link_limit = c_default_quick_link_limit;
 
    url_opts.erase( );
@@ -348,6 +672,8 @@ session_info::session_info( storage_info& si )
  locked( false ),
  logged_in( false ),
  needs_pin( false ),
+ ref_count( 0 ),
+ was_removed( false ),
  change_pwd_tm( 0 ),
  checksum_serial( 0 ),
  pwd_encrypted( true ),
@@ -368,7 +694,8 @@ session_info::session_info( storage_info& si )
  quick_link_limit( si.quick_link_limit ),
  gmt_offset( 0 ),
  dtm_offset( 0 ),
- p_socket( 0 )
+ p_socket( 0 ),
+ p_last_socket( 0 )
 {
    tm_created = time( 0 );
    tm_last_request = tm_created;
@@ -393,12 +720,239 @@ bool session_info::is_default_other( ) const
    return default_other;
 }
 
+struct session_table::shard
+{
+   mutex lock;
+   session_container sessions;
+};
+
+session_table::session_table( int timeout_seconds )
+ :
+ timeout_seconds( timeout_seconds ),
+ expiries( time( 0 ) )
+{
+   for( size_t i = 0; i < c_num_session_shards; i++ )
+      shards.push_back( new shard );
+}
+
+session_table::~session_table( )
+{
+   for( size_t i = 0; i < shards.size( ); i++ )
+   {
+      for( session_iterator si = shards[ i ]->sessions.begin( ); si != shards[ i ]->sessions.end( ); ++si )
+         delete si->second;
+
+      delete shards[ i ];
+   }
+}
+
+size_t session_table::size( )
+{
+   size_t total = 0;
+
+   for( size_t i = 0; i < shards.size( ); i++ )
+   {
+      guard g( shards[ i ]->lock );
+      total += shards[ i ]->sessions.size( );
+   }
+
+   return total;
+}
+
+void session_table::insert( const string& session_id, session_info* p_session_info )
+{
+   time_t tm_last_request;
+
+   // NOTE: Scope for guard object.
+   {
+      shard& s( get_shard( session_id ) );
+      guard g( s.lock );
+
+      s.sessions.insert( session_value_type( session_id, p_session_info ) );
+
+      tm_last_request = p_session_info->tm_last_request;
+   }
+
+   schedule( session_id, tm_last_request + timeout_seconds + 1 );
+}
+
+bool session_table::contains( const string& session_id )
+{
+   shard& s( get_shard( session_id ) );
+   guard g( s.lock );
+
+   return ( s.sessions.count( session_id ) > 0 );
+}
+
+session_info* session_table::acquire( const string& session_id, bool lock_session )
+{
+   shard& s( get_shard( session_id ) );
+   guard g( s.lock );
+
+   session_iterator si = s.sessions.find( session_id );
+
+   if( si == s.sessions.end( ) || si->second->locked )
+      return 0;
+
+   if( lock_session )
+      si->second->locked = true;
+
+   ++si->second->ref_count;
+
+   return si->second;
+}
+
+void session_table::release( session_info* p_session_info )
+{
+   shard& s( get_shard( p_session_info->session_id ) );
+   guard g( s.lock );
+
+   if( p_session_info->ref_count )
+      --p_session_info->ref_count;
+
+   if( p_session_info->was_removed && !p_session_info->ref_count )
+      delete p_session_info;
+}
+
+void session_table::remove( const string& session_id )
+{
+   shard& s( get_shard( session_id ) );
+   guard g( s.lock );
+
+   session_iterator si = s.sessions.find( session_id );
+
+   if( si != s.sessions.end( ) )
+      remove_session( s, si );
+}
+
+bool session_table::has_user( const string& user_id, const char* p_module )
+{
+   for( size_t i = 0; i < shards.size( ); i++ )
+   {
+      guard g( shards[ i ]->lock );
+
+      for( session_iterator si = shards[ i ]->sessions.begin( ), end = shards[ i ]->sessions.end( ); si != end; ++si )
+      {
+         if( p_module && string( p_module ) != ( si->second )->user_module )
+            continue;
+
+         if( user_id == ( si->second )->user_id )
+            return true;
+      }
+   }
+
+   return false;
+}
+
+bool session_table::remove_user( const string& user_id, const char* p_module )
+{
+   for( size_t i = 0; i < shards.size( ); i++ )
+   {
+      guard g( shards[ i ]->lock );
+
+      for( session_iterator si = shards[ i ]->sessions.begin( ), end = shards[ i ]->sessions.end( ); si != end; ++si )
+      {
+         if( p_module && string( p_module ) != ( si->second )->user_module )
+            continue;
+
+         if( user_id == ( si->second )->user_id )
+         {
+            if( si->second->locked )
+               return false;
+
+            remove_session( *shards[ i ], si );
+
+            return true;
+         }
+      }
+   }
+
+   return true;
+}
+
+void session_table::expire( time_t now, vector< session_info* >& expired_sessions )
+{
+   guard g( wheel_mutex );
+
+   vector< string > session_ids;
+   expiries.advance( now, session_ids );
+
+   for( size_t i = 0; i < session_ids.size( ); i++ )
+   {
+      const string& session_id( session_ids[ i ] );
+
+      shard& s( get_shard( session_id ) );
+      guard g( s.lock );
+
+      session_iterator si = s.sessions.find( session_id );
+
+      if( si == s.sessions.end( ) )
+         continue;
+
+      session_info* p_session_info = si->second;
+
+      // NOTE: If the expiry is not after the current tick then the session will be checked
+      // again the next time this is called.
+      time_t expiry = now;
+
+      if( !p_session_info->locked )
+      {
+         if( now - p_session_info->tm_last_request <= timeout_seconds )
+            expiry = p_session_info->tm_last_request + timeout_seconds + 1;
+         else
+         {
+            s.sessions.erase( si );
+
+            ++p_session_info->ref_count;
+            p_session_info->was_removed = true;
+
+            expired_sessions.push_back( p_session_info );
+            continue;
+         }
+      }
+
+      expiries.add( session_id, expiry );
+   }
+}
+
+session_table::shard& session_table::get_shard( const string& session_id )
+{
+   // NOTE: Uses the FNV-1a hash of the session id to determine its shard.
+   uint32_t hash = 2166136261u;
+
+   for( size_t i = 0; i < session_id.size( ); i++ )
+   {
+      hash ^= ( unsigned char )session_id[ i ];
+      hash *= 16777619u;
+   }
+
+   return *shards[ hash % shards.size( ) ];
+}
+
+void session_table::schedule( const string& session_id, time_t expiry )
+{
+   guard g( wheel_mutex );
+   expiries.add( session_id, expiry );
+}
+
+void session_table::remove_session( shard& s, session_iterator si )
+{
+   session_info* p_session_info = si->second;
+
+   s.sessions.erase( si );
+
+   if( p_session_info->ref_count )
+      p_session_info->was_removed = true;
+   else
+      delete p_session_info;
+}
+
 storage_info& get_storage_info( )
 {
    return g_storage_info;
 }
 
-void read_storage_info( storage_info& info, vector< string > log_messages )
+void read_storage_info( storage_info& info, vector< string >& log_messages )
 {
    string filename( c_fcgi_sio );
 
@@ -479,6 +1033,16 @@ void read_storage_info( storage_info& info, vector< string > log_messages )
       if( !filesize_limit.empty( ) )
          info.filesize_limit = atol( filesize_limit.c_str( ) );
 
+      // NOTE: The number of request handlers is only applied when the interface is started
+      // whereas the number of server sockets can be changed (if the sio file is modified).
+      string request_handlers = reader.read_opt_attribute( c_attribute_request_handlers );
+      if( !request_handlers.empty( ) )
+         info.request_handlers = atoi( request_handlers.c_str( ) );
+
+      string server_sockets = reader.read_opt_attribute( c_attribute_server_sockets );
+      if( !server_sockets.empty( ) )
+         info.server_sockets = atoi( server_sockets.c_str( ) );
+
       info.storage_name = reader.read_attribute( c_attribute_storage_name );
       info.module_prefix = reader.read_attribute( c_attribute_module_prefix );
 
@@ -491,8 +1055,16 @@ void read_storage_info( storage_info& info, vector< string > log_messages )
             info.modules.push_back( module_info( ) );
             info.modules_index.insert( module_index_value_type( module_name, &info.modules.back( ) ) );
 
-            if( read_module_info( module_name, info.modules.back( ), info ) )
+            bool was_cached = false;
+            date_time dtm( date_time::standard( ) );
+
+            if( read_module_info( module_name, info.modules.back( ), info, &was_cached ) )
             {
+               int64_t msecs = ( int64_t )( ( date_time::standard( ) - dtm ) * 1000.0 );
+
+               log_messages.push_back( "loaded '" + module_name + "' module info"
+                + string( was_cached ? " (cached)" : "" ) + " in " + to_string( msecs ) + " msecs" );
+
                if( info.user_info_view_id.empty( ) && !info.modules.back( ).user_info_view_id.empty( ) )
                {
                   string module_ref( info.get_module_ref( module_name ) );
@@ -520,14 +1092,33 @@ void read_storage_info( storage_info& info, vector< string > log_messages )
    }
 }
 
-bool read_module_info( const string& name, module_info& info, storage_info& sinfo )
+bool read_module_info( const string& name, module_info& info, storage_info& sinfo, bool* p_was_cached )
 {
    string filename( name + c_fcgi_sio_ext );
 
-   ifstream inpf( filename.c_str( ) );
-   if( inpf )
+   if( file_exists( filename ) )
    {
-      sio_reader reader( inpf );
+      time_t sio_mod = last_modification_time( filename );
+
+      string source( buffer_file( filename ) );
+      string sio_hash( sha256( source ).get_digest_as_string( ) );
+
+      string cache_file_name( name + c_module_info_cache_ext );
+
+      if( read_module_info_cache( cache_file_name, sio_mod, sio_hash, info, sinfo ) )
+      {
+         info.sio_mod = sio_mod;
+
+         if( p_was_cached )
+            *p_was_cached = true;
+
+         return true;
+      }
+
+      vector< enum_info > enums;
+
+      istringstream inps( source );
+      sio_reader reader( inps );
 
       info.clear( );
 
@@ -837,6 +1428,8 @@ bool read_module_info( const string& name, module_info& info, storage_info& sinf
             // NOTE: In order for the fields in external classes to be correctly displayed
             // and edited enums are kept with the storage info rather than within a module.
             sinfo.enums.insert( make_pair( e.id, e ) );
+
+            enums.push_back( e );
          }
 
          reader.finish_section( c_section_enums );
@@ -946,19 +1539,7 @@ bool read_module_info( const string& name, module_info& info, storage_info& sinf
 
          reader.finish_section( c_section_views );
 
-         for( size_t i = 0; i < info.views.size( ); i++ )
-         {
-            // NOTE: These first two containers are provided in order to locate the
-            // "standard" class view and so must not consider the "print" versions.
-            if( info.views[ i ].type != c_view_type_print
-             && info.views[ i ].type != c_view_type_admin_print )
-            {
-               info.view_cids[ info.views[ i ].cid ] = info.views[ i ].id;
-               info.view_classes[ info.views[ i ].mclass ] = info.views[ i ].id;
-            }
-
-            info.view_info.insert( make_pair( info.views[ i ].id, &info.views[ i ] ) );
-         }
+         setup_view_containers( info );
       }
 
       if( reader.has_started_section( c_section_lists ) )
@@ -1197,8 +1778,9 @@ bool read_module_info( const string& name, module_info& info, storage_info& sinf
 
       reader.verify_finished_sections( );
 
-      inpf.close( );
-      info.sio_mod = last_modification_time( filename );
+      info.sio_mod = sio_mod;
+
+      write_module_info_cache( cache_file_name, sio_mod, sio_hash, info, enums );
 
       return true;
    }
@@ -21,12 +21,12 @@
 #  include "config.h"
 #  include "ptypes.h"
 #  include "threads.h"
+#  include "timer_wheel.h"
 #  include "ciyam_common.h"
 
+class tcp_socket;
 #  ifdef SSL_SUPPORT
 class ssl_socket;
-#  else
-class tcp_socket;
 #  endif
 
 const uint64_t c_state_modifier_00 = UINT64_C( 0x0000000000000100 );
@@ -460,6 +460,9 @@ struct storage_info
 
    size_t filesize_limit;
 
+   size_t server_sockets;
+   size_t request_handlers;
+
    size_t quick_link_limit;
 
    time_t sio_mod;
@@ -510,12 +513,18 @@ struct session_info
    bool logged_in;
    bool needs_pin;
 
+   size_t ref_count;
+   bool was_removed;
+
 #  ifdef SSL_SUPPORT
    ssl_socket* p_socket;
 #  else
    tcp_socket* p_socket;
 #  endif
 
+   // NOTE: This is only used as a hint for obtaining the same pooled socket for the next request.
+   const tcp_socket* p_last_socket;
+
    std::string ip_addr;
 
    std::string session_id;
@@ -601,6 +610,57 @@ typedef session_container::value_type session_value_type;
 typedef session_container::iterator session_iterator;
 typedef session_container::const_iterator session_const_iterator;
 
+// NOTE: Sessions are held in a number of shards (each with its own lock) with the shard being
+// determined by a hash of the session id. A session that is being used by a request is marked
+// as "locked" and each lookup holds a reference to the session so that any session which gets
+// removed from the table will not be deleted until all of its references have been released.
+// Expiry is handled by a timer wheel (with a tick per second) so rather than examining all of
+// the sessions every second only those whose expiry time has been reached are checked (those
+// that have been used since being scheduled are then simply rescheduled).
+class session_table
+{
+   public:
+   session_table( int timeout_seconds );
+   ~session_table( );
+
+   size_t size( );
+
+   void insert( const std::string& session_id, session_info* p_session_info );
+
+   bool contains( const std::string& session_id );
+
+   session_info* acquire( const std::string& session_id, bool lock_session );
+   void release( session_info* p_session_info );
+
+   void remove( const std::string& session_id );
+
+   bool has_user( const std::string& user_id, const char* p_module );
+   bool remove_user( const std::string& user_id, const char* p_module );
+
+   // NOTE: Expired sessions are removed from the table with a reference being held for each of
+   // them (so after performing any cleanup the caller must release each of these sessions).
+   void expire( time_t now, std::vector< session_info* >& expired_sessions );
+
+   private:
+   struct shard;
+
+   shard& get_shard( const std::string& session_id );
+
+   void schedule( const std::string& session_id, time_t expiry );
+
+   void remove_session( shard& s, session_iterator si );
+
+   int timeout_seconds;
+
+   std::vector< shard* > shards;
+
+   mutex wheel_mutex;
+   timer_wheel< std::string > expiries;
+
+   session_table( const session_table& );
+   session_table& operator =( const session_table& );
+};
+
 struct source
 {
    std::string id;
@@ -851,9 +911,9 @@ storage_info& get_storage_info( );
 
 inline bool is_blockchain_application( ) { return !get_storage_info( ).blockchain.empty( ); }
 
-void read_storage_info( storage_info& info, std::vector< std::string > log_messages );
+void read_storage_info( storage_info& info, std::vector< std::string >& log_messages );
 
-bool read_module_info( const std::string& name, module_info& info, storage_info& sinfo );
+bool read_module_info( const std::string& name, module_info& info, storage_info& sinfo, bool* p_was_cached = 0 );
 
 void sort_row_data_manually( data_container& row_data, bool remove_manual_links = false );
 
@@ -39,18 +39,6 @@ using namespace std;
 
 extern string g_id;
 
-extern string g_login_html;
-extern string g_footer_html;
-extern string g_openup_html;
-extern string g_signup_html;
-extern string g_password_html;
-extern string g_ssl_signup_html;
-extern string g_authenticate_html;
-
-extern string g_ciyam_interface_html;
-extern string g_login_persistent_html;
-extern string g_password_persistent_html;
-
 extern string g_display_login_info;
 extern string g_display_change_password;
 extern string g_display_sign_up_for_an_account;
@@ -165,6 +153,8 @@ void process_fcgi_request( module_info& mod_info, session_info* p_session_info,
  bool cookies_permitted, bool temp_session, bool using_anonymous, bool use_url_checksum, bool is_ssl, bool is_sign_in, bool is_in_edit,
  bool is_new_record, bool was_invalid, bool skip_force_fields, bool created_session, bool allow_module_switching, int vtab_num )
 {
+   html_forms_ref forms;
+
    int vtabc_num = 1;
    if( !vtabc.empty( ) )
       vtabc_num = atoi( vtabc.c_str( ) );
@@ -1079,6 +1069,9 @@ void process_fcgi_request( module_info& mod_info, session_info* p_session_info,
                   string new_file;
                   bool okay = false;
 
+                  // NOTE: Only the file name (on the first line) is needed here although "upload" will
+                  // also have written the file's hash (as "create_raw_file" would determine it) and its
+                  // size on the line that follows.
                   if( file_exists( new_file_info.c_str( ) ) )
                   {
                      ifstream inpf( new_file_info.c_str( ) );
@@ -1322,7 +1315,7 @@ void process_fcgi_request( module_info& mod_info, session_info* p_session_info,
       ostringstream osstr;
       if( had_send_or_recv_error || !mod_info.allows_anonymous_access )
       {
-         if( g_ciyam_interface_html.find( c_form_content_comment ) == string::npos )
+         if( forms->ciyam_interface_html.find( c_form_content_comment ) == string::npos )
          {
             if( !had_send_or_recv_error )
                osstr << "<p align=\"center\"><strong>"
@@ -1352,7 +1345,7 @@ void process_fcgi_request( module_info& mod_info, session_info* p_session_info,
       if( had_send_or_recv_error || !mod_info.allows_anonymous_access )
       {
          string login_html( !cookies_permitted || !get_storage_info( ).login_days
-          || g_login_persistent_html.empty( ) ? g_login_html : g_login_persistent_html );
+          || forms->login_persistent_html.empty( ) ? forms->login_html : forms->login_persistent_html );
 
          output_form( module_name, extra_content, login_html, osstr.str( ) );
       }
@@ -1379,7 +1372,7 @@ void process_fcgi_request( module_info& mod_info, session_info* p_session_info,
    else
    {
       string pwd_display_name;
-      if( cookies_permitted && get_storage_info( ).login_days && !g_login_persistent_html.empty( ) )
+      if( cookies_permitted && get_storage_info( ).login_days && !forms->login_persistent_html.empty( ) )
          pwd_display_name = g_display_login_info;
       else
          pwd_display_name = g_display_change_password;
@@ -2172,7 +2165,7 @@ void process_fcgi_request( module_info& mod_info, session_info* p_session_info,
          if( !input_data.count( c_param_newpwd ) )
          {
             string password_html( !cookies_permitted || !get_storage_info( ).login_days
-             || g_password_persistent_html.empty( ) ? g_password_html : g_password_persistent_html );
+             || forms->password_persistent_html.empty( ) ? forms->password_html : forms->password_persistent_html );
 
             string::size_type pos = password_html.find( c_checked );
             if( pos != string::npos )
@@ -2568,7 +2561,7 @@ void process_fcgi_request( module_info& mod_info, session_info* p_session_info,
 
          if( !has_completed )
          {
-            string signup_html( !is_ssl ? g_signup_html : g_ssl_signup_html );
+            string signup_html( !is_ssl ? forms->signup_html : forms->ssl_signup_html );
 
             str_replace( signup_html, c_error_message, error_message );
 
@@ -2639,7 +2632,7 @@ void process_fcgi_request( module_info& mod_info, session_info* p_session_info,
 
          if( !has_completed )
          {
-            string openup_html( g_openup_html );
+            string openup_html( forms->openup_html );
 
             str_replace( openup_html, c_error_message, error_message );
 
@@ -2665,7 +2658,7 @@ void process_fcgi_request( module_info& mod_info, session_info* p_session_info,
       {
          if( p_session_info->needs_pin )
          {
-            string authenticate_html( g_authenticate_html );
+            string authenticate_html( forms->authenticate_html );
 
             if( !pin.empty( ) )
             {
@@ -3136,7 +3129,7 @@ void process_fcgi_request( module_info& mod_info, session_info* p_session_info,
          extra_content_func += "auto_refresh_seconds = " + seconds + ";\nauto_refresh( );";
       }
 
-      if( g_ciyam_interface_html.find( c_form_content_comment ) != string::npos )
+      if( forms->ciyam_interface_html.find( c_form_content_comment ) != string::npos )
       {
          if( created_session )
             extra_content << "<p>Created session " << session_id << ".</p>\n";
@@ -3154,7 +3147,7 @@ void process_fcgi_request( module_info& mod_info, session_info* p_session_info,
       extra_content << "</div>\n</div>\n\n";
 
       if( cmd != c_cmd_pview && cmd != c_cmd_plist )
-         extra_content << g_footer_html;
+         extra_content << forms->footer_html;
 
       extra_content << "</div>\n";
 
@@ -41,8 +41,6 @@
 
 using namespace std;
 
-extern string g_footer_html;
-
 namespace
 {
 
@@ -460,6 +458,179 @@ void str_replace( string& src, const char* p_find, const string& replace )
    }
 }
 
+void html_template::compile( const string& text, const vector< string >& placeholders )
+{
+   segments.clear( );
+   literal_size = 0;
+
+   this->placeholders = placeholders;
+
+   string::size_type start = 0;
+   string::size_type offset = 0;
+
+   if( text.size( ) >= 3 && text[ 0 ] == ( char )0xef && text[ 1 ] == ( char )0xbb && text[ 2 ] == ( char )0xbf )
+      start = offset = 3;
+
+   // NOTE: Every placeholder contains "@@" so each occurrence of that marker is checked against
+   // the placeholders (the longest match is used so that a placeholder that is wrapped as a HTML
+   // comment will be preferred to just the "@@" name that it contains).
+   while( true )
+   {
+      string::size_type pos = text.find( "@@", offset );
+      if( pos == string::npos )
+         break;
+
+      size_t slot = string::npos;
+      string::size_type spos = pos, epos = pos + 2;
+
+      for( size_t i = 0; i < placeholders.size( ); i++ )
+      {
+         const string& placeholder( placeholders[ i ] );
+
+         string::size_type mpos = placeholder.find( "@@" );
+         if( mpos == string::npos || mpos > pos || pos - mpos < start )
+            continue;
+
+         if( text.compare( pos - mpos, placeholder.size( ), placeholder ) == 0
+          && ( slot == string::npos || placeholder.size( ) > epos - spos ) )
+         {
+            slot = i;
+            spos = pos - mpos;
+            epos = spos + placeholder.size( );
+         }
+      }
+
+      if( slot != string::npos )
+      {
+         if( spos > start )
+         {
+            segments.push_back( segment( text.substr( start, spos - start ), string::npos ) );
+            literal_size += spos - start;
+         }
+
+         segments.push_back( segment( "", slot ) );
+
+         start = epos;
+      }
+
+      offset = epos;
+   }
+
+   if( start < text.size( ) )
+   {
+      segments.push_back( segment( text.substr( start ), string::npos ) );
+      literal_size += text.size( ) - start;
+   }
+}
+
+bool html_template::load( const string& file_name, const vector< string >& placeholders )
+{
+   time_t t = last_modification_time( file_name );
+
+   if( !segments.empty( ) && t == mod_time
+    && file_name == this->file_name && placeholders == this->placeholders )
+      return false;
+
+   compile( buffer_file( file_name ), placeholders );
+
+   mod_time = t;
+   this->file_name = file_name;
+
+   return true;
+}
+
+bool html_template::has_changed( ) const
+{
+   if( file_name.empty( ) )
+      return false;
+
+   return file_exists( file_name ) && last_modification_time( file_name ) != mod_time;
+}
+
+bool html_template::has_slot( size_t slot ) const
+{
+   for( size_t i = 0; i < segments.size( ); i++ )
+   {
+      if( segments[ i ].slot == slot )
+         return true;
+   }
+
+   return false;
+}
+
+void html_template::bind( size_t slot, const string& value )
+{
+   for( size_t i = 0; i < segments.size( ); i++ )
+   {
+      if( segments[ i ].slot == slot )
+      {
+         segments[ i ].text = value;
+         segments[ i ].slot = string::npos;
+
+         literal_size += value.size( );
+      }
+   }
+
+   merge_literals( );
+}
+
+string html_template::text( ) const
+{
+   string output;
+   render( output, vector< const string* >( ) );
+
+   return output;
+}
+
+void html_template::render( string& output, const vector< const string* >& values ) const
+{
+   size_t size = literal_size;
+
+   for( size_t i = 0; i < segments.size( ); i++ )
+   {
+      size_t slot = segments[ i ].slot;
+
+      if( slot != string::npos )
+      {
+         if( slot < values.size( ) && values[ slot ] )
+            size += values[ slot ]->size( );
+         else
+            size += placeholders[ slot ].size( );
+      }
+   }
+
+   output.erase( );
+   output.reserve( size );
+
+   for( size_t i = 0; i < segments.size( ); i++ )
+   {
+      size_t slot = segments[ i ].slot;
+
+      if( slot == string::npos )
+         output += segments[ i ].text;
+      else if( slot < values.size( ) && values[ slot ] )
+         output += *values[ slot ];
+      else
+         output += placeholders[ slot ];
+   }
+}
+
+void html_template::merge_literals( )
+{
+   vector< segment > merged;
+
+   for( size_t i = 0; i < segments.size( ); i++ )
+   {
+      if( segments[ i ].slot == string::npos
+       && !merged.empty( ) && merged.back( ).slot == string::npos )
+         merged.back( ).text += segments[ i ].text;
+      else
+         merged.push_back( segments[ i ] );
+   }
+
+   segments.swap( merged );
+}
+
 string remove_key( const string& src )
 {
    string str( src );
@@ -1367,7 +1538,8 @@ void output_form( const string& module_name, ostream& os,
       os << msg << "\n";
    }
 
-   os << g_footer_html;
+   html_forms_ref forms;
+   os << forms->footer_html;
 
    os << "</div>\n";
 }
@@ -10,6 +10,7 @@
 #  ifndef HAS_PRECOMPILED_STD_HEADERS
 #     include <map>
 #     include <string>
+#     include <vector>
 #     include <iosfwd>
 #  endif
 
@@ -96,6 +97,94 @@ std::string double_escaped( const std::string& src, const std::string& chars );
 
 void str_replace( std::string& src, const char* p_find, const std::string& replace );
 
+// NOTE: An HTML template is compiled (once) into a sequence of literal segments and placeholder
+// slots so that a page can be rendered in a single pass (rather than performing repeated finds
+// and replaces over the whole page text). Slots are numbered according to the order of the
+// placeholders provided when compiling and any placeholder without a value is output verbatim.
+class html_template
+{
+   public:
+   html_template( ) : mod_time( 0 ), literal_size( 0 ) { }
+
+   void compile( const std::string& text, const std::vector< std::string >& placeholders );
+
+   bool load( const std::string& file_name, const std::vector< std::string >& placeholders );
+
+   bool has_changed( ) const;
+
+   bool empty( ) const { return segments.empty( ); }
+
+   bool has_slot( size_t slot ) const;
+
+   void bind( size_t slot, const std::string& value );
+
+   std::string text( ) const;
+
+   void render( std::string& output, const std::vector< const std::string* >& values ) const;
+
+   private:
+   struct segment
+   {
+      segment( const std::string& text, size_t slot ) : text( text ), slot( slot ) { }
+
+      std::string text;
+      size_t slot;
+   };
+
+   std::string file_name;
+
+   time_t mod_time;
+   size_t literal_size;
+
+   std::vector< segment > segments;
+   std::vector< std::string > placeholders;
+
+   void merge_literals( );
+};
+
+// NOTE: The HTML forms (which are compiled from their templates) can be reloaded by the timeout
+// handler whilst requests are being processed so a reload will create a new set of forms which
+// then becomes the current set. A request uses whichever set was current when it obtained its
+// "html_forms_ref" (with a replaced set being deleted once its last reference has been freed).
+struct html_forms
+{
+   html_forms( ) : num_refs( 0 ) { }
+
+   size_t num_refs;
+
+   std::string login_html;
+   std::string footer_html;
+   std::string openup_html;
+   std::string signup_html;
+   std::string unlock_html;
+   std::string activate_html;
+   std::string identity_html;
+   std::string password_html;
+   std::string ssl_signup_html;
+   std::string no_identity_html;
+   std::string authenticate_html;
+
+   std::string login_password_html;
+   std::string ciyam_interface_html;
+   std::string login_persistent_html;
+   std::string password_persistent_html;
+};
+
+class html_forms_ref
+{
+   public:
+   html_forms_ref( );
+   ~html_forms_ref( );
+
+   const html_forms* operator ->( ) const { return p_forms; }
+
+   private:
+   html_forms* p_forms;
+
+   html_forms_ref( const html_forms_ref& );
+   html_forms_ref& operator =( const html_forms_ref& );
+};
+
 std::string remove_key( const std::string& src );
 
 std::string string_message( const std::string& display_string,
@@ -10,6 +10,8 @@
 
 #ifndef HAS_PRECOMPILED_STD_HEADERS
 #  include <memory.h>
+#  include <map>
+#  include <set>
 #  include <fstream>
 #  include <iostream>
 #  include <stdexcept>
@@ -28,6 +30,23 @@ namespace
 
 const int c_hash_buf_size = 32;
 
+const char* const c_checkpoint_key_prefix = "hash_chain_checkpoint";
+
+// NOTE: Checkpoints are stored XOR'd with a pad derived from a key that requires the password
+// (otherwise anyone who could read the file would be able to determine all the unpublished hashes).
+void apply_checkpoint_pad( const unsigned char* p_key,
+ uint32_t position, const unsigned char* p_source, unsigned char* p_dest )
+{
+   unsigned char pad[ c_hash_buf_size ];
+
+   sha256 hash( p_key, c_hash_buf_size );
+   hash.update( ( const unsigned char* )&position, sizeof( uint32_t ) );
+   hash.copy_digest_to_buffer( pad );
+
+   for( size_t i = 0; i < c_hash_buf_size; i++ )
+      p_dest[ i ] = p_source[ i ] ^ pad[ i ];
+}
+
 }
 
 struct hash_chain::impl
@@ -40,11 +59,18 @@ struct hash_chain::impl
 
    string get_next_hashes_to_publish( const string& password, unsigned int num_hashes );
 
+   void write_internal_chain( );
+
    string name;
    uint32_t rounds;
 
    unsigned char buffer[ c_hash_buf_size ];
    unsigned char secretbuf[ c_hash_buf_size ];
+
+   bool has_checkpoints;
+   unsigned char verifier[ c_hash_buf_size ];
+
+   map< uint32_t, string > checkpoints;
 };
 
 hash_chain::impl::impl( const string& name, bool is_new, unsigned int size, bool use_secret )
@@ -53,8 +79,11 @@ hash_chain::impl::impl( const string& name, bool is_new, unsigned int size, bool
 {
    rounds = ( uint32_t )size;
 
+   has_checkpoints = false;
+
    memset( buffer, 0, c_hash_buf_size );
    memset( secretbuf, 0, c_hash_buf_size );
+   memset( verifier, 0, c_hash_buf_size );
 
    if( is_new )
    {
@@ -114,6 +143,29 @@ hash_chain::impl::impl( const string& name, bool is_new, unsigned int size, bool
       throw runtime_error( "unexpected error reading hash data from file '" + name + "'" );
 
    memcpy( secretbuf, buffer, c_hash_buf_size );
+
+   // NOTE: Checkpoints follow the original content (so a file without any is still valid and an
+   // older version will simply ignore them).
+   if( rounds && inpf.read( ( char* )verifier, c_hash_buf_size ) )
+   {
+      uint32_t num_checkpoints = 0;
+
+      if( !inpf.read( ( char* )&num_checkpoints, sizeof( uint32_t ) ) )
+         throw runtime_error( "unexpected error reading checkpoints from file '" + name + "'" );
+
+      for( uint32_t i = 0; i < num_checkpoints; i++ )
+      {
+         uint32_t position = 0;
+         char digest[ c_hash_buf_size ];
+
+         if( !inpf.read( ( char* )&position, sizeof( uint32_t ) ) || !inpf.read( digest, c_hash_buf_size ) )
+            throw runtime_error( "unexpected error reading checkpoint from file '" + name + "'" );
+
+         checkpoints.insert( make_pair( position, string( digest, c_hash_buf_size ) ) );
+      }
+
+      has_checkpoints = true;
+   }
 }
 
 bool hash_chain::impl::has_been_depleted( ) const
@@ -225,24 +277,88 @@ string hash_chain::impl::get_next_hashes_to_publish( const string& password, uns
    // defaulted to 1 in "check_and_update_if_good").
    sha256 hash( password );
    hash.update( secretbuf, c_hash_buf_size );
+   hash.copy_digest_to_buffer( buffer );
 
-   string retval;
-   for( uint32_t i = 0; i < rounds; i++ )
+   unsigned char key[ c_hash_buf_size ];
+   unsigned char check[ c_hash_buf_size ];
+
+   sha256 key_hash( c_checkpoint_key_prefix );
+   key_hash.update( buffer, c_hash_buf_size );
+   key_hash.copy_digest_to_buffer( key );
+
+   sha256 check_hash( key, c_hash_buf_size );
+   check_hash.copy_digest_to_buffer( check );
+
+   // NOTE: If the checkpoints were created with a different password then they are replaced.
+   if( !has_checkpoints || memcmp( check, verifier, c_hash_buf_size ) != 0 )
    {
-      hash.copy_digest_to_buffer( buffer );
-      hash.update( buffer, sizeof( buffer ) );
+      checkpoints.clear( );
+
+      has_checkpoints = true;
+      memcpy( verifier, check, c_hash_buf_size );
+   }
 
-      if( i >= rounds - num_hashes )
+   uint32_t first = rounds - num_hashes + 1;
+
+   // NOTE: Rather than always starting from the beginning of the chain the nearest checkpoint
+   // prior to the first hash to be published is used. New checkpoints are then added at halved
+   // distances from the start to the first hash so that (as each call will need hashes that are
+   // earlier in the chain than the previous call did) a logarithmic number of checkpoints makes
+   // the amortised cost of each call O(log n) rather than O(n).
+   uint32_t start = 0;
+
+   map< uint32_t, string >::iterator ci = checkpoints.upper_bound( first );
+
+   if( ci != checkpoints.begin( ) )
+   {
+      --ci;
+      start = ci->first;
+
+      apply_checkpoint_pad( key, start, ( const unsigned char* )ci->second.data( ), buffer );
+   }
+
+   set< uint32_t > new_positions;
+
+   for( uint32_t distance = ( first - start ) / 2; distance > 0; distance /= 2 )
+      new_positions.insert( first - distance );
+
+   string retval;
+   for( uint32_t position = start; ; )
+   {
+      if( position >= first )
       {
          if( !retval.empty( ) )
             retval += ',';
 
-         retval += hash.get_digest_as_string( );
+         retval += hex_encode( buffer, c_hash_buf_size );
+      }
+
+      if( position == rounds )
+         break;
+
+      hash.update( buffer, c_hash_buf_size );
+      hash.copy_digest_to_buffer( buffer );
+
+      if( new_positions.count( ++position ) )
+      {
+         unsigned char digest[ c_hash_buf_size ];
+         apply_checkpoint_pad( key, position, buffer, digest );
+
+         checkpoints[ position ] = string( ( const char* )digest, c_hash_buf_size );
       }
    }
 
    --rounds;
 
+   checkpoints.erase( checkpoints.upper_bound( rounds ), checkpoints.end( ) );
+
+   write_internal_chain( );
+
+   return retval;
+}
+
+void hash_chain::impl::write_internal_chain( )
+{
    ofstream outf( name.c_str( ), ios::out | ios::binary );
 
    if( !outf.write( ( const char* )&rounds, sizeof( uint32_t ) ) )
@@ -251,12 +367,26 @@ string hash_chain::impl::get_next_hashes_to_publish( const string& password, uns
    if( !outf.write( ( const char* )secretbuf, c_hash_buf_size ) )
       throw runtime_error( "unexpected error writing hash data to file '" + name + "'" );
 
+   if( has_checkpoints )
+   {
+      uint32_t num_checkpoints = checkpoints.size( );
+
+      if( !outf.write( ( const char* )verifier, c_hash_buf_size )
+       || !outf.write( ( const char* )&num_checkpoints, sizeof( uint32_t ) ) )
+         throw runtime_error( "unexpected error writing checkpoints to file '" + name + "'" );
+
+      for( map< uint32_t, string >::iterator i = checkpoints.begin( ); i != checkpoints.end( ); ++i )
+      {
+         if( !outf.write( ( const char* )&i->first, sizeof( uint32_t ) )
+          || !outf.write( i->second.data( ), c_hash_buf_size ) )
+            throw runtime_error( "unexpected error writing checkpoint to file '" + name + "'" );
+      }
+   }
+
    outf.flush( );
 
    if( !outf.good( ) )
       throw runtime_error( "unexpected bad output stream for hash chain '" + name + "'" );
-
-   return retval;
 }
 
 hash_chain::hash_chain( const string& name, bool is_new, unsigned int size, bool use_secret )
@@ -73,6 +73,7 @@
 #include "progress.h"
 #include "utilities.h"
 #include "fs_iterator.h"
+#include "thread_pool.h"
 #include "read_write_stream.h"
 
 //#define ODS_DEBUG
@@ -96,6 +97,8 @@ const char* const c_data_file_name_ext = ".dat";
 const char* const c_index_file_name_ext = ".idx";
 const char* const c_header_file_name_ext = ".hdr";
 const char* const c_tranlog_file_name_ext = ".tlg";
+const char* const c_free_data_file_name_ext = ".fre";
+const char* const c_checkpoint_file_name_ext = ".rcp";
 
 const char* const c_sav_file_name_ext = ".sav";
 const char* const c_lock_file_name_ext = ".lck";
@@ -141,6 +144,15 @@ const int c_trans_op_items_per_region = 10000;
 const int c_trans_data_max_cache_items = 500;
 const int c_trans_data_items_per_region = 10000;
 
+const size_t c_free_data_num_buckets = 48;
+const size_t c_free_data_max_examine = 64;
+
+const int64_t c_free_data_file_version = 1;
+
+const size_t c_free_data_stamp_items = 6;
+
+const int64_t c_compact_entries_per_object = 100;
+
 mutex g_ods_lock;
 
 #ifdef ODS_DEBUG
@@ -199,6 +211,11 @@ const uint64_t c_int_type_high_bits = c_int_type_low_bits << ( numeric_limits< u
 
 const int c_buffer_chunk_size = 1024;
 
+const size_t c_tranlog_segment_size = 4194304;
+
+const int64_t c_restore_progress_entries = 1000;
+const int64_t c_restore_checkpoint_entries = 100000;
+
 inline bool is_print( char ch ) { return ch >= ' ' && ch <= '~'; }
 
 string format_version( int16_t version )
@@ -577,6 +594,276 @@ struct log_entry_item
    int64_t index_entry_id;
 };
 
+struct restore_checkpoint
+{
+   restore_checkpoint( )
+    :
+    version( c_version ),
+    sequence( 0 ),
+    flags( 0 ),
+    init_time( 0 ),
+    entry_offs( 0 ),
+    index_transform_id( 0 )
+   {
+   }
+
+   bool changed_free_list( ) const { return flags & c_changed_free_list_flag; }
+
+   void set_changed_free_list( bool val )
+   {
+      if( val )
+         flags |= c_changed_free_list_flag;
+      else
+         flags &= ~c_changed_free_list_flag;
+   }
+
+   bool read( istream& is )
+   {
+      is.read( ( char* )&version, sizeof( version ) );
+      is.read( ( char* )&sequence, sizeof( sequence ) );
+      is.read( ( char* )&flags, sizeof( flags ) );
+      is.read( ( char* )&init_time, sizeof( init_time ) );
+      is.read( ( char* )&entry_offs, sizeof( entry_offs ) );
+      is.read( ( char* )&index_transform_id, sizeof( index_transform_id ) );
+
+      return is.good( ) && version == c_version;
+   }
+
+   void write( ostream& os ) const
+   {
+      os.write( ( const char* )&version, sizeof( version ) );
+      os.write( ( const char* )&sequence, sizeof( sequence ) );
+      os.write( ( const char* )&flags, sizeof( flags ) );
+      os.write( ( const char* )&init_time, sizeof( init_time ) );
+      os.write( ( const char* )&entry_offs, sizeof( entry_offs ) );
+      os.write( ( const char* )&index_transform_id, sizeof( index_transform_id ) );
+
+      os.flush( );
+
+      if( !os.good( ) )
+         THROW_ODS_ERROR( "unexpected bad restore_checkpoint write" );
+   }
+
+   static const int32_t c_changed_free_list_flag = 1;
+
+   int16_t version;
+   int16_t sequence;
+
+   int32_t flags;
+
+   int64_t init_time;
+   int64_t entry_offs;
+
+   int64_t index_transform_id;
+};
+
+// NOTE: Stream buffer used to read transaction logs during a restore. The log file is read in
+// large sequential segments by a separate thread so that the next segment is being read while
+// the entries in the current one are being applied. Seeking within the current segment simply
+// moves the get pointer whereas seeking outside of it will discard any prefetched segment.
+class tranlog_prefetch_buffer : public streambuf
+{
+   public:
+   tranlog_prefetch_buffer( const string& file_name )
+    :
+    is_running( false ),
+    is_reading( false ),
+    is_stopping( false ),
+    has_pending( false ),
+    current_offset( 0 ),
+    current_length( 0 ),
+    pending_offset( 0 ),
+    pending_length( 0 ),
+    current( c_tranlog_segment_size ),
+    pending( c_tranlog_segment_size ),
+    reader_pool( 1 )
+   {
+      inpf.open( file_name.c_str( ), ios::in | ios::binary );
+
+      setg( &current[ 0 ], &current[ 0 ], &current[ 0 ] );
+
+      if( inpf )
+      {
+         reader_pool.start( );
+         reader_pool.queue_job( new reader( *this ) );
+
+         is_running = true;
+      }
+   }
+
+   ~tranlog_prefetch_buffer( )
+   {
+      // NOTE: Scope for guard object.
+      {
+         guard g( buffer_mutex );
+
+         is_stopping = true;
+         work_condition.notify_all( );
+      }
+
+      // NOTE: Joins the reader thread (so it can't still be using the buffer after it has gone).
+      reader_pool.stop( );
+   }
+
+   bool is_open( ) const { return is_running; }
+
+   protected:
+   int_type underflow( )
+   {
+      if( gptr( ) < egptr( ) )
+         return traits_type::to_int_type( *gptr( ) );
+
+      if( !is_running || !take_segment( current_offset + current_length ) )
+         return traits_type::eof( );
+
+      return traits_type::to_int_type( *gptr( ) );
+   }
+
+   pos_type seekoff( off_type off, ios_base::seekdir dir, ios_base::openmode which )
+   {
+      int64_t position = current_offset + ( gptr( ) - eback( ) );
+
+      if( dir == ios_base::beg )
+         position = off;
+      else if( dir == ios_base::cur )
+         position += off;
+      else
+         return pos_type( off_type( -1 ) );
+
+      return seekpos( position, which );
+   }
+
+   pos_type seekpos( pos_type pos, ios_base::openmode which )
+   {
+      int64_t position = pos;
+
+      if( position < 0 || !( which & ios_base::in ) )
+         return pos_type( off_type( -1 ) );
+
+      if( position >= current_offset && position <= current_offset + ( int64_t )current_length )
+         setg( eback( ), eback( ) + ( position - current_offset ), egptr( ) );
+      else
+      {
+         current_offset = position;
+         current_length = 0;
+
+         setg( &current[ 0 ], &current[ 0 ], &current[ 0 ] );
+      }
+
+      return pos;
+   }
+
+   private:
+   class reader : public thread_pool_job
+   {
+      public:
+      reader( tranlog_prefetch_buffer& buffer ) : buffer( buffer ) { }
+
+      void run( )
+      {
+         buffer.read_segments( );
+      }
+
+      private:
+      tranlog_prefetch_buffer& buffer;
+   };
+
+   void read_segments( )
+   {
+      while( true )
+      {
+         int64_t offset = 0;
+
+         // NOTE: Scope for guard object.
+         {
+            guard g( buffer_mutex );
+
+            while( !is_stopping && !is_reading )
+               work_condition.wait( buffer_mutex );
+
+            if( is_stopping )
+               break;
+
+            offset = pending_offset;
+         }
+
+         inpf.clear( );
+         inpf.seekg( offset, ios::beg );
+         inpf.read( &pending[ 0 ], pending.size( ) );
+
+         size_t length = inpf.gcount( );
+
+         guard g( buffer_mutex );
+
+         pending_length = length;
+
+         is_reading = false;
+         done_condition.notify_all( );
+      }
+   }
+
+   void request_segment( int64_t offset )
+   {
+      while( is_reading )
+         done_condition.wait( buffer_mutex );
+
+      has_pending = true;
+      pending_offset = offset;
+
+      is_reading = true;
+      work_condition.notify_all( );
+   }
+
+   bool take_segment( int64_t offset )
+   {
+      guard g( buffer_mutex );
+
+      if( !has_pending || pending_offset != offset )
+         request_segment( offset );
+
+      while( is_reading )
+         done_condition.wait( buffer_mutex );
+
+      current.swap( pending );
+
+      has_pending = false;
+
+      current_offset = offset;
+      current_length = pending_length;
+
+      setg( &current[ 0 ], &current[ 0 ], &current[ 0 ] + current_length );
+
+      // NOTE: Unless the end of the file has been reached start reading the following segment.
+      if( current_length == current.size( ) )
+         request_segment( offset + current_length );
+
+      return current_length > 0;
+   }
+
+   ifstream inpf;
+
+   mutex buffer_mutex;
+
+   condition work_condition;
+   condition done_condition;
+
+   bool is_running;
+   bool is_reading;
+   bool is_stopping;
+   bool has_pending;
+
+   int64_t current_offset;
+   size_t current_length;
+
+   int64_t pending_offset;
+   size_t pending_length;
+
+   vector< char > current;
+   vector< char > pending;
+
+   thread_pool reader_pool;
+};
+
 }
 
 string ods_file_names( const string& name, char sep, bool include_tranlog )
@@ -1961,6 +2248,275 @@ class ods_trans_data_cache_buffer : public cache_base< trans_data_buffer >
    }
 };
 
+// NOTE: Free data extents are held by position (so adjacent extents can be merged when freed) and
+// also in buckets (according to the highest bit of their size) so that the smallest extent which
+// will fit an object can be found without needing to examine every extent. The map is only used
+// when the store is locked for exclusive write (as otherwise another process could be using it).
+//
+// An extent that has been freed is held as "pending" (and so is not able to be reused) until the
+// change that freed it has been flushed to the data and index files. This is so that a crash can
+// not leave an index entry still pointing to data that has already been overwritten by another
+// object which had reused its extent.
+class free_data_map
+{
+   public:
+   free_data_map( )
+    :
+    is_active( false ),
+    total_free( 0 ),
+    total_reused( 0 ),
+    total_reclaimed( 0 ),
+    total_relocated( 0 ),
+    next_compact_entry( 0 ),
+    buckets( c_free_data_num_buckets )
+   {
+   }
+
+   bool is_active;
+
+   int64_t total_free;
+   int64_t total_reused;
+   int64_t total_reclaimed;
+   int64_t total_relocated;
+
+   int64_t next_compact_entry;
+
+   size_t num_extents( ) const { return extents.size( ); }
+
+   int64_t largest_extent( ) const
+   {
+      for( size_t i = buckets.size( ); i > 0; i-- )
+      {
+         if( !buckets[ i - 1 ].empty( ) )
+            return buckets[ i - 1 ].rbegin( )->first;
+      }
+
+      return 0;
+   }
+
+   void clear( )
+   {
+      is_active = false;
+
+      total_free = 0;
+      next_compact_entry = 0;
+
+      extents.clear( );
+      pending.clear( );
+
+      for( size_t i = 0; i < buckets.size( ); i++ )
+         buckets[ i ].clear( );
+   }
+
+   // NOTE: Returns false (without adding anything) if the extent overlaps one that is already free.
+   bool add( int64_t pos, int64_t size )
+   {
+      if( size <= 0 )
+         return true;
+
+      map< int64_t, int64_t >::iterator i = extents.lower_bound( pos );
+
+      if( i != extents.end( ) && i->first < pos + size )
+         return false;
+
+      if( i != extents.begin( ) )
+      {
+         map< int64_t, int64_t >::iterator prior( i );
+         --prior;
+
+         if( prior->first + prior->second > pos )
+            return false;
+
+         total_free += size;
+
+         if( prior->first + prior->second == pos )
+         {
+            pos = prior->first;
+            size += prior->second;
+
+            erase( prior );
+         }
+      }
+      else
+         total_free += size;
+
+      if( i != extents.end( ) && i->first == pos + size )
+      {
+         size += i->second;
+         erase( i );
+      }
+
+      insert( pos, size );
+
+      return true;
+   }
+
+   void add_pending( int64_t pos, int64_t size )
+   {
+      if( size > 0 )
+         pending.push_back( make_pair( pos, size ) );
+   }
+
+   bool has_pending( ) const { return !pending.empty( ); }
+
+   // NOTE: Returns false if any pending extent overlaps one that is already free.
+   bool add_pending_extents( )
+   {
+      bool okay = true;
+
+      for( size_t i = 0; okay && i < pending.size( ); i++ )
+         okay = add( pending[ i ].first, pending[ i ].second );
+
+      pending.clear( );
+
+      return okay;
+   }
+
+   // NOTE: If "limit" is not negative then only an extent that ends at or before it will be used.
+   bool obtain( int64_t size, int64_t& pos, int64_t limit = -1 )
+   {
+      if( size <= 0 )
+         return false;
+
+      for( size_t b = bucket_for( size ); b < buckets.size( ); b++ )
+      {
+         size_t examined = 0;
+
+         set< pair< int64_t, int64_t > >::iterator i = buckets[ b ].lower_bound( make_pair( size, ( int64_t )0 ) );
+
+         for( ; i != buckets[ b ].end( ) && examined < c_free_data_max_examine; ++i, ++examined )
+         {
+            if( limit < 0 || i->second + size <= limit )
+            {
+               pos = i->second;
+
+               int64_t extent_size = i->first;
+
+               erase( extents.find( pos ) );
+
+               if( extent_size > size )
+                  insert( pos + size, extent_size - size );
+
+               total_free -= size;
+               total_reused += size;
+
+               return true;
+            }
+         }
+      }
+
+      return false;
+   }
+
+   // NOTE: If the last free extent ends at "end" then it is removed with its position being returned.
+   bool remove_last( int64_t end, int64_t& pos )
+   {
+      if( extents.empty( ) )
+         return false;
+
+      map< int64_t, int64_t >::iterator i = extents.end( );
+      --i;
+
+      if( i->first + i->second != end )
+         return false;
+
+      pos = i->first;
+      total_free -= i->second;
+
+      erase( i );
+
+      return true;
+   }
+
+   // NOTE: The extents are only read if the stamp (which is written before them) matches the
+   // header information as otherwise the data may have been changed since they were written.
+   bool read( istream& is, const header_info& hdr )
+   {
+      int64_t stamp[ c_free_data_stamp_items ];
+      int64_t expected[ c_free_data_stamp_items ];
+
+      is.read( ( char* )stamp, sizeof( stamp ) );
+      get_stamp( expected, hdr );
+
+      if( !is.good( ) || !equal( stamp, stamp + c_free_data_stamp_items, expected ) )
+         return false;
+
+      int64_t num = 0;
+      is.read( ( char* )&num, sizeof( num ) );
+
+      for( int64_t i = 0; i < num && is.good( ); i++ )
+      {
+         int64_t pos = 0, size = 0;
+
+         is.read( ( char* )&pos, sizeof( pos ) );
+         is.read( ( char* )&size, sizeof( size ) );
+
+         if( is.good( ) && ( pos < 0 || pos + size > hdr.total_size_of_data || !add( pos, size ) ) )
+            return false;
+      }
+
+      return is.good( );
+   }
+
+   void write( ostream& os, const header_info& hdr ) const
+   {
+      int64_t stamp[ c_free_data_stamp_items ];
+      get_stamp( stamp, hdr );
+
+      os.write( ( const char* )stamp, sizeof( stamp ) );
+
+      int64_t num = extents.size( );
+      os.write( ( const char* )&num, sizeof( num ) );
+
+      for( map< int64_t, int64_t >::const_iterator ci = extents.begin( ); ci != extents.end( ); ++ci )
+      {
+         os.write( ( const char* )&ci->first, sizeof( ci->first ) );
+         os.write( ( const char* )&ci->second, sizeof( ci->second ) );
+      }
+   }
+
+   private:
+   map< int64_t, int64_t > extents;
+   vector< set< pair< int64_t, int64_t > > > buckets;
+
+   vector< pair< int64_t, int64_t > > pending;
+
+   static void get_stamp( int64_t* p_stamp, const header_info& hdr )
+   {
+      p_stamp[ 0 ] = c_free_data_file_version;
+      p_stamp[ 1 ] = hdr.total_entries;
+      p_stamp[ 2 ] = hdr.transaction_id;
+      p_stamp[ 3 ] = hdr.total_size_of_data;
+      p_stamp[ 4 ] = hdr.data_transform_id;
+      p_stamp[ 5 ] = hdr.index_transform_id;
+   }
+
+   static size_t bucket_for( int64_t size )
+   {
+      size_t bucket = 0;
+
+      while( size > 1 && bucket < c_free_data_num_buckets - 1 )
+      {
+         size >>= 1;
+         ++bucket;
+      }
+
+      return bucket;
+   }
+
+   void insert( int64_t pos, int64_t size )
+   {
+      extents.insert( make_pair( pos, size ) );
+      buckets[ bucket_for( size ) ].insert( make_pair( size, pos ) );
+   }
+
+   void erase( map< int64_t, int64_t >::iterator i )
+   {
+      buckets[ bucket_for( i->second ) ].erase( make_pair( i->second, i->first ) );
+      extents.erase( i );
+   }
+};
+
 struct transaction_buffer
 {
    transaction_buffer( ) : tran_id( 0 ) { }
@@ -2002,6 +2558,8 @@ struct ods::impl
    string index_file_name;
    string header_file_name;
    string tranlog_file_name;
+   string free_data_file_name;
+   string checkpoint_file_name;
 
 #ifdef __GNUG__
    ref_count_ptr< flock > rp_lock;
@@ -2059,6 +2617,8 @@ struct ods::impl
    ref_count_ptr< mutex > rp_impl_lock;
    ref_count_ptr< mutex > rp_file_section;
 
+   ref_count_ptr< free_data_map > rp_free_data_map;
+
    void read_header_file_info( );
    void write_header_file_info( bool for_close = false );
 
@@ -2319,6 +2879,8 @@ ods::ods( const char* name, open_mode o_mode, write_mode w_mode, bool using_tran
    p_impl->index_file_name = string( name ) + c_index_file_name_ext;
    p_impl->header_file_name = string( name ) + c_header_file_name_ext;
    p_impl->tranlog_file_name = string( name ) + c_tranlog_file_name_ext;
+   p_impl->free_data_file_name = string( name ) + c_free_data_file_name_ext;
+   p_impl->checkpoint_file_name = string( name ) + c_checkpoint_file_name_ext;
 
 #ifdef __GNUG__
    p_impl->rp_lock = new flock;
@@ -2390,6 +2952,8 @@ ods::ods( const char* name, open_mode o_mode, write_mode w_mode, bool using_tran
    p_impl->rp_impl_lock = new mutex;
    p_impl->rp_file_section = new mutex;
 
+   p_impl->rp_free_data_map = new free_data_map;
+
    p_impl->rp_header_info = new header_info;
 
 #ifndef _WIN32
@@ -2442,6 +3006,10 @@ ods::ods( const char* name, open_mode o_mode, write_mode w_mode, bool using_tran
        && ( p_impl->rp_header_info->num_trans || p_impl->rp_header_info->num_writers ) )
          p_impl->is_corrupt = true;
 
+      // NOTE: A restore checkpoint file will only exist if a reconstruct had been interrupted.
+      if( w_mode == e_write_mode_exclusive && file_exists( p_impl->checkpoint_file_name ) )
+         p_impl->is_corrupt = true;
+
       if( p_impl->rp_header_info->init_tranlog )
       {
          if( !file_exists( p_impl->tranlog_file_name ) )
@@ -2551,6 +3119,21 @@ ods::~ods( )
             }
          }
       }
+
+      // NOTE: The free data map is saved by the last instance so that it will not need to be
+      // rebuilt (by scanning the index) when the store is next opened for exclusive write use.
+      if( okay && *p_impl->rp_instances.get_ref( ) == 1 && p_impl->rp_free_data_map->is_active )
+      {
+         ofstream outf( p_impl->free_data_file_name.c_str( ), ios::out | ios::binary );
+
+         if( outf )
+            p_impl->rp_free_data_map->write( outf, *p_impl->rp_header_info );
+
+         outf.close( );
+
+         if( !outf.good( ) )
+            file_remove( p_impl->free_data_file_name );
+      }
 #ifdef ODS_DEBUG
       if( *p_impl->rp_instances.get_ref( ) == 1 && p_impl->rp_header_file->is_locked_for_exclusive( ) )
          DEBUG_LOG( "********** releasing exclusive write use **********" );
@@ -2590,6 +3173,18 @@ bool ods::is_bulk_write_locked( ) const
    return ( *p_impl->rp_bulk_mode == impl::e_bulk_mode_write );
 }
 
+bool ods::is_thread_bulk_locked( ) const
+{
+   guard lock_impl( *p_impl->rp_impl_lock );
+
+   if( *p_impl->rp_bulk_mode == impl::e_bulk_mode_read )
+      return *p_impl->rp_bulk_read_thread_id == current_thread_id( );
+   else if( *p_impl->rp_bulk_mode == impl::e_bulk_mode_write )
+      return *p_impl->rp_bulk_write_thread_id == current_thread_id( );
+   else
+      return false;
+}
+
 bool ods::is_using_transaction_log( ) const
 {
    return p_impl->using_tranlog;
@@ -2685,6 +3280,8 @@ void ods::rewind_transactions( const string& label_or_txid )
    if( *p_impl->rp_bulk_level && *p_impl->rp_bulk_mode != impl::e_bulk_mode_write )
       THROW_ODS_ERROR( "cannot rewind transactions when bulk locked for dumping or reading" );
 
+   discard_free_data_map( );
+
    fstream fs;
    log_info tranlog_info;
 
@@ -3106,7 +3703,8 @@ void ods::destroy( const oid& id )
                            p_impl->rp_header_info->tranlog_offset = p_impl->tranlog_offset;
                      }
 
-                     if( index_entry.data.pos + index_entry.data.size
+                     if( !release_free_data( index_entry.data.pos, index_entry.data.size )
+                      && index_entry.data.pos + index_entry.data.size
                       == p_impl->rp_header_info->total_size_of_data )
                         p_impl->rp_header_info->total_size_of_data -= index_entry.data.size;
 
@@ -3266,6 +3864,8 @@ void ods::move_free_data_to_end( )
    if( *p_impl->rp_bulk_level && *p_impl->rp_bulk_mode != impl::e_bulk_mode_write )
       THROW_ODS_ERROR( "cannot move free data to end when bulk locked for dumping or reading" );
 
+   discard_free_data_map( );
+
    auto_ptr< ods::bulk_write > ap_bulk_write;
    if( !*p_impl->rp_bulk_level )
       ap_bulk_write.reset( new ods::bulk_write( *this ) );
@@ -3361,116 +3961,347 @@ void ods::move_free_data_to_end( )
                read_data_bytes( buffer, chunk );
                fs.write( buffer, chunk );
 
-               if( !fs.good( ) )
-                  THROW_ODS_ERROR( "unexpected bad tranlog data append" );
-            }
+               if( !fs.good( ) )
+                  THROW_ODS_ERROR( "unexpected bad tranlog data append" );
+            }
+
+            read_pos = next_pos + next_size;
+         }
+         else
+            read_pos = next_pos;
+
+         new_pos += next_size;
+      }
+
+      fs.flush( );
+      if( !fs.good( ) )
+         THROW_ODS_ERROR( "unexpected bad tranlog data append" );
+
+      int64_t offs = fs.tellg( );
+
+      fs.seekg( 0, ios::beg );
+
+      log_info tranlog_info;
+      tranlog_info.read( fs );
+
+      tranlog_info.append_offs = offs;
+
+      fs.seekg( 0, ios::beg );
+      tranlog_info.write( fs );
+
+      fs.close( );
+   }
+
+   set_read_data_pos( 0 );
+
+   int64_t new_pos = 0;
+   int64_t read_pos = 0;
+   int64_t actual_size = 0;
+
+   for( ci = entries.begin( ), end = entries.end( ); ci != end; ++ci )
+   {
+      int64_t next_id = ci->id;
+      int64_t next_pos = ci->pos;
+      int64_t next_size = ci->size;
+
+      if( next_pos < read_pos )
+         THROW_ODS_ERROR( "unexpected next_pos < read_pos at " STRINGIZE( __LINE__ ) );
+
+      adjust_read_data_pos( next_pos - read_pos );
+
+      if( next_pos != new_pos )
+      {
+         int64_t chunk = c_buffer_chunk_size;
+         char buffer[ c_buffer_chunk_size ];
+
+         set_write_data_pos( new_pos );
+
+         for( int64_t j = 0; j < next_size; j += chunk )
+         {
+            if( j + chunk > next_size )
+               chunk = next_size - j;
+
+            read_data_bytes( buffer, chunk );
+            write_data_bytes( buffer, chunk );
+         }
+
+         read_index_entry( index_entry, next_id );
+
+         index_entry.data.pos = new_pos;
+         write_index_entry( index_entry, next_id );
+
+         read_pos = next_pos + next_size;
+      }
+      else
+         read_pos = next_pos;
+
+      new_pos += next_size;
+      actual_size += next_size;
+   }
+
+   if( log_entry_offs )
+   {
+      fstream fs;
+      fs.open( p_impl->tranlog_file_name.c_str( ), ios::in | ios::out | ios::binary );
+
+      if( !fs )
+         THROW_ODS_ERROR( "unable to open transaction log '" + p_impl->tranlog_file_name + "' in move_free_data_to_end" );
+
+      log_entry tranlog_entry;
+
+      fs.seekg( log_entry_offs, ios::beg );
+      tranlog_entry.read( fs );
+
+      tranlog_entry.commit_offs = old_append_offs;
+      tranlog_entry.commit_items = num_moved;
+
+      fs.seekg( log_entry_offs, ios::beg );
+      tranlog_entry.write( fs );
+
+      fs.close( );
+
+      p_impl->rp_header_info->tranlog_offset = log_entry_offs;
+   }
+
+   ++p_impl->rp_header_info->data_transform_id;
+   ++p_impl->rp_header_info->index_transform_id;
+
+   p_impl->rp_header_info->total_size_of_data = actual_size;
+
+   data_and_index_write( );
+
+   p_impl->force_write_header_file_info( );
+}
+
+int64_t ods::compact_data( int64_t max_objects, int64_t max_entries )
+{
+   guard lock_write( write_lock );
+   guard lock_read( read_lock );
+
+   if( !okay )
+      THROW_ODS_ERROR( "database instance in bad state" );
+
+   if( p_impl->is_read_only )
+      THROW_ODS_ERROR( "attempt to compact data when database was opened for read only access" );
+
+   // NOTE: As this is intended to be called periodically it will simply do nothing (rather than
+   // wait or throw) if this instance is in a transaction or any bulk operation is in progress.
+   if( p_impl->trans_level || *p_impl->rp_bulk_level || max_objects <= 0 )
+      return 0;
+
+   if( max_entries <= 0 )
+      max_entries = max_objects * c_compact_entries_per_object;
+
+   guard lock_impl( *p_impl->rp_impl_lock );
+   ods::header_file_lock header_file_lock( *this );
+   ods::file_scope file_scope( *this );
+
+   if( !has_free_data_map( ) )
+      return 0;
+
+   free_data_map& fdm( *p_impl->rp_free_data_map );
+
+   trim_free_data( );
+
+   int64_t total_entries = p_impl->rp_header_info->total_entries;
+
+   if( !fdm.num_extents( ) || !total_entries )
+      return 0;
+
+   int64_t first = fdm.next_compact_entry;
+
+   if( first >= total_entries )
+      first = 0;
+
+   if( max_entries > total_entries )
+      max_entries = total_entries;
+
+   fdm.next_compact_entry = ( first + max_entries ) % total_entries;
+
+   ods_index_entry_pos entry;
+   vector< ods_index_entry_pos > entries;
+
+   ods_index_entry index_entry;
+
+   for( int64_t i = 0; i < max_entries; i++ )
+   {
+      int64_t num = ( first + i ) % total_entries;
+
+      read_index_entry( index_entry, num );
+
+      if( index_entry.data.size
+       && index_entry.lock_flag == ods_index_entry::e_lock_none
+       && index_entry.trans_flag == ods_index_entry::e_trans_none )
+      {
+         entry.id = num;
+         entry.pos = index_entry.data.pos;
+         entry.size = index_entry.data.size;
+
+         entries.push_back( entry );
+      }
+   }
+
+   // NOTE: Objects that are closest to the end of the data are the first to be moved.
+   sort( entries.rbegin( ), entries.rend( ) );
+
+   int64_t num_moved = 0;
+   int64_t log_entry_offs = 0;
+   int64_t old_append_offs = 0;
+
+   for( size_t i = 0; i < entries.size( ) && num_moved < max_objects; i++ )
+   {
+      int64_t id = entries[ i ].id;
+      int64_t old_pos = entries[ i ].pos;
+      int64_t size = entries[ i ].size;
+
+      if( p_impl->found_instance_currently_reading( id ) || p_impl->found_instance_currently_writing( id ) )
+         continue;
+
+      int64_t new_pos = 0;
+
+      if( !fdm.obtain( size, new_pos, old_pos ) )
+         continue;
 
-            read_pos = next_pos + next_size;
-         }
-         else
-            read_pos = next_pos;
+      if( !p_impl->rp_ods_index_cache_buffer->lock_entry( id, true ) )
+      {
+         fdm.total_reused -= size;
+         fdm.add( new_pos, size );
 
-         new_pos += next_size;
+         continue;
       }
 
-      fs.flush( );
-      if( !fs.good( ) )
-         THROW_ODS_ERROR( "unexpected bad tranlog data append" );
-
-      int64_t offs = fs.tellg( );
+      if( p_impl->using_tranlog )
+      {
+         if( !log_entry_offs )
+            log_entry_offs = append_log_entry( p_impl->rp_header_info->transaction_id++, &old_append_offs );
 
-      fs.seekg( 0, ios::beg );
+         fstream fs;
+         fs.open( p_impl->tranlog_file_name.c_str( ), ios::in | ios::out | ios::binary );
 
-      log_info tranlog_info;
-      tranlog_info.read( fs );
+         if( !fs )
+            THROW_ODS_ERROR( "unable to open transaction log '" + p_impl->tranlog_file_name + "' in compact_data" );
 
-      tranlog_info.append_offs = offs;
+         log_info tranlog_info;
+         tranlog_info.read( fs );
 
-      fs.seekg( 0, ios::beg );
-      tranlog_info.write( fs );
+         fs.seekg( tranlog_info.append_offs, ios::beg );
 
-      fs.close( );
-   }
+         log_entry_item tranlog_item;
 
-   set_read_data_pos( 0 );
+         tranlog_item.flags = c_log_entry_item_op_store;
+         tranlog_item.flags |= ( c_log_entry_item_type_non_transactional | c_log_entry_item_flag_has_old_pos );
 
-   int64_t new_pos = 0;
-   int64_t read_pos = 0;
-   int64_t actual_size = 0;
+         tranlog_item.index_entry_id = id;
 
-   for( ci = entries.begin( ), end = entries.end( ); ci != end; ++ci )
-   {
-      int64_t next_id = ci->id;
-      int64_t next_pos = ci->pos;
-      int64_t next_size = ci->size;
+         tranlog_item.data_pos = new_pos;
+         tranlog_item.data_opos = old_pos;
+         tranlog_item.data_size = size;
 
-      if( next_pos < read_pos )
-         THROW_ODS_ERROR( "unexpected next_pos < read_pos at " STRINGIZE( __LINE__ ) );
+         tranlog_item.write( fs );
 
-      adjust_read_data_pos( next_pos - read_pos );
+         set_read_data_pos( old_pos, true );
 
-      if( next_pos != new_pos )
-      {
          int64_t chunk = c_buffer_chunk_size;
          char buffer[ c_buffer_chunk_size ];
 
-         set_write_data_pos( new_pos );
-
-         for( int64_t j = 0; j < next_size; j += chunk )
+         for( int64_t j = 0; j < size; j += chunk )
          {
-            if( j + chunk > next_size )
-               chunk = next_size - j;
+            if( j + chunk > size )
+               chunk = size - j;
 
             read_data_bytes( buffer, chunk );
-            write_data_bytes( buffer, chunk );
+            fs.write( buffer, chunk );
          }
 
-         read_index_entry( index_entry, next_id );
+         fs.flush( );
+         if( !fs.good( ) )
+            THROW_ODS_ERROR( "unexpected bad tranlog data append" );
 
-         index_entry.data.pos = new_pos;
-         write_index_entry( index_entry, next_id );
+         tranlog_info.append_offs = fs.tellg( );
 
-         read_pos = next_pos + next_size;
+         fs.seekg( 0, ios::beg );
+         tranlog_info.write( fs );
+
+         fs.close( );
       }
-      else
-         read_pos = next_pos;
 
-      new_pos += next_size;
-      actual_size += next_size;
-   }
+      set_read_data_pos( old_pos, true );
+      set_write_data_pos( new_pos );
 
-   if( log_entry_offs )
-   {
-      fstream fs;
-      fs.open( p_impl->tranlog_file_name.c_str( ), ios::in | ios::out | ios::binary );
+      int64_t chunk = c_buffer_chunk_size;
+      char buffer[ c_buffer_chunk_size ];
 
-      if( !fs )
-         THROW_ODS_ERROR( "unable to open transaction log '" + p_impl->tranlog_file_name + "' in move_free_data_to_end" );
+      for( int64_t j = 0; j < size; j += chunk )
+      {
+         if( j + chunk > size )
+            chunk = size - j;
 
-      log_entry tranlog_entry;
+         read_data_bytes( buffer, chunk );
+         write_data_bytes( buffer, chunk );
+      }
 
-      fs.seekg( log_entry_offs, ios::beg );
-      tranlog_entry.read( fs );
+      read_index_entry( index_entry, id );
 
-      tranlog_entry.commit_offs = old_append_offs;
-      tranlog_entry.commit_items = num_moved;
+      index_entry.data.pos = new_pos;
+      write_index_entry( index_entry, id );
 
-      fs.seekg( log_entry_offs, ios::beg );
-      tranlog_entry.write( fs );
+      data_and_index_write( false );
 
-      fs.close( );
+      p_impl->rp_ods_index_cache_buffer->unlock_entry( id, true );
 
-      p_impl->rp_header_info->tranlog_offset = log_entry_offs;
+      release_free_data( old_pos, size );
+
+      ++num_moved;
+      ++fdm.total_relocated;
    }
 
-   ++p_impl->rp_header_info->data_transform_id;
-   ++p_impl->rp_header_info->index_transform_id;
+   if( num_moved )
+   {
+      if( log_entry_offs )
+         log_entry_commit( log_entry_offs, old_append_offs, num_moved );
 
-   p_impl->rp_header_info->total_size_of_data = actual_size;
+      ++p_impl->rp_header_info->data_transform_id;
+      ++p_impl->rp_header_info->index_transform_id;
 
-   data_and_index_write( );
+      // NOTE: Flush the relocated objects so that their old extents can now be reused.
+      data_and_index_write( );
+   }
 
-   p_impl->force_write_header_file_info( );
+   return num_moved;
+}
+
+void ods::dump_free_data( ostream& os )
+{
+   guard lock_write( write_lock );
+   guard lock_read( read_lock );
+   guard lock_impl( *p_impl->rp_impl_lock );
+
+   if( !okay )
+      THROW_ODS_ERROR( "database instance in bad state" );
+
+   ods::header_file_lock header_file_lock( *this );
+
+   auto_ptr< ods::file_scope > ap_file_scope;
+   if( !*p_impl->rp_bulk_level )
+      ap_file_scope.reset( new ods::file_scope( *this ) );
+
+   if( !has_free_data_map( ) )
+      os << "Free data map not in use (requires exclusive write access)." << endl;
+   else
+   {
+      free_data_map& fdm( *p_impl->rp_free_data_map );
+
+      int64_t total_size = p_impl->rp_header_info->total_size_of_data;
+
+      os << "Total Size of Data = " << total_size
+       << "\nFree Data Extents = " << fdm.num_extents( )
+       << "\nTotal Free Data = " << fdm.total_free
+       << "\nLargest Free Extent = " << fdm.largest_extent( )
+       << "\nFragmentation = " << ( total_size ? ( fdm.total_free * 100 / total_size ) : 0 ) << '%'
+       << "\nReused Bytes = " << fdm.total_reused
+       << "\nReclaimed Bytes = " << fdm.total_reclaimed
+       << "\nRelocated Objects = " << fdm.total_relocated << endl;
+   }
 }
 
 void ods::truncate_log( const char* p_ext )
@@ -4422,7 +5253,8 @@ void ods::transaction_commit( )
                {
                   if( index_entry.trans_flag == ods_index_entry::e_trans_delete )
                   {
-                     if( index_entry.data.pos + index_entry.data.size
+                     if( !release_free_data( index_entry.data.pos, index_entry.data.size )
+                      && index_entry.data.pos + index_entry.data.size
                       == p_impl->rp_header_info->total_size_of_data )
                         p_impl->rp_header_info->total_size_of_data -= index_entry.data.size;
 
@@ -4439,14 +5271,28 @@ void ods::transaction_commit( )
                   {
                      flags |= c_log_entry_item_op_store;
 
+                     int64_t freed_data_pos = index_entry.data.pos;
+                     int64_t freed_data_size = index_entry.data.size;
+
                      index_entry.data.size = op.data.size;
 
                      if( op.type == transaction_op::e_op_type_append )
                      {
-                        index_entry.data.pos = p_impl->rp_header_info->total_size_of_data;
-                        p_impl->rp_header_info->total_size_of_data += op.data.size;
+                        if( !obtain_free_data( op.data.size, index_entry.data.pos ) )
+                        {
+                           index_entry.data.pos = p_impl->rp_header_info->total_size_of_data;
+                           p_impl->rp_header_info->total_size_of_data += op.data.size;
+                        }
+                     }
+                     else
+                     {
+                        freed_data_pos += op.data.size;
+                        freed_data_size -= op.data.size;
                      }
 
+                     if( freed_data_size > 0 )
+                        release_free_data( freed_data_pos, freed_data_size );
+
                      set_write_data_pos( index_entry.data.pos );
 
                      set_read_trans_data_pos( op.data.pos );
@@ -4736,7 +5582,13 @@ void ods::data_and_index_write( bool flush )
    }
 
    if( flush )
+   {
       p_impl->rp_ods_index_cache_buffer->flush( );
+
+      // NOTE: Now that the data and index have been flushed any extents that were
+      // freed by the changes being flushed can be reused.
+      add_pending_free_data( );
+   }
 }
 
 int64_t ods::log_append_offset( )
@@ -4956,6 +5808,8 @@ void ods::rollback_dead_transactions( progress* p_progress )
 
    temp_set_value< bool > temp_is_restoring( p_impl->is_restoring, true );
 
+   discard_free_data_map( );
+
    auto_ptr< ods::bulk_write > ap_bulk_write;
    if( !*p_impl->rp_bulk_level )
       ap_bulk_write.reset( new ods::bulk_write( *this ) );
@@ -5029,6 +5883,8 @@ void ods::restore_from_transaction_log( bool force_reconstruct, progress* p_prog
 
    temp_set_value< bool > temp_is_restoring( p_impl->is_restoring, true );
 
+   discard_free_data_map( );
+
    auto_ptr< ods::bulk_write > ap_bulk_write;
    if( !*p_impl->rp_bulk_level )
       ap_bulk_write.reset( new ods::bulk_write( *this ) );
@@ -5039,18 +5895,8 @@ void ods::restore_from_transaction_log( bool force_reconstruct, progress* p_prog
    map< int16_t, pair< string, log_info > > sequenced_logs;
    map< int16_t, pair< string, log_info > >::iterator sli;
 
-   if( force_reconstruct )
-   {
-      p_impl->rp_header_info->total_entries = 0;
-      p_impl->rp_header_info->tranlog_offset = 0;
-      p_impl->rp_header_info->transaction_id = 0;
-      p_impl->rp_header_info->index_free_list = 0;
-      p_impl->rp_header_info->data_transform_id = 0;
-      p_impl->rp_header_info->index_transform_id = 0;
-      p_impl->rp_header_info->total_size_of_data = 0;
-   }
-
-   int64_t tranlog_offset = p_impl->rp_header_info->tranlog_offset;
+   int64_t init_time = 0;
+   int64_t tranlog_offset = force_reconstruct ? 0 : p_impl->rp_header_info->tranlog_offset;
 
    bool is_reconstruct = ( tranlog_offset == 0 );
 
@@ -5091,7 +5937,6 @@ void ods::restore_from_transaction_log( bool force_reconstruct, progress* p_prog
          sequenced_logs.insert( make_pair( tranlog_info.sequence, make_pair( fsi.get_name( ), tranlog_info ) ) );
       }
 
-      int64_t init_time = 0;
       int64_t last_time = 0;
       int16_t last_sequence = 0;
 
@@ -5114,43 +5959,135 @@ void ods::restore_from_transaction_log( bool force_reconstruct, progress* p_prog
       }
    }
 
+   restore_checkpoint checkpoint;
+   bool is_resuming = false;
+
+   // NOTE: A reconstruct will periodically write all changes followed by a checkpoint so if one
+   // had been interrupted then (as long as the header still matches the checkpoint) it resumes
+   // from the last checkpointed log entry rather than starting all over again.
+   if( is_reconstruct && file_exists( p_impl->checkpoint_file_name ) )
+   {
+      ifstream inpf( p_impl->checkpoint_file_name.c_str( ), ios::in | ios::binary );
+
+      if( inpf && checkpoint.read( inpf ) && checkpoint.init_time == init_time
+       && checkpoint.index_transform_id == p_impl->rp_header_info->index_transform_id
+       && sequenced_logs.count( checkpoint.sequence ) )
+         is_resuming = true;
+
+      inpf.close( );
+
+      if( !is_resuming )
+         file_remove( p_impl->checkpoint_file_name );
+   }
+
+   if( force_reconstruct && !is_resuming )
+   {
+      p_impl->rp_header_info->total_entries = 0;
+      p_impl->rp_header_info->tranlog_offset = 0;
+      p_impl->rp_header_info->transaction_id = 0;
+      p_impl->rp_header_info->index_free_list = 0;
+      p_impl->rp_header_info->data_transform_id = 0;
+      p_impl->rp_header_info->index_transform_id = 0;
+      p_impl->rp_header_info->total_size_of_data = 0;
+   }
+
    int64_t entry_num = 0;
 
-   bool had_any_entries = false;
-   bool changed_free_list = false;
+   // NOTE: An initial checkpoint is written before applying the first entry so that a reconstruct
+   // which is interrupted prior to the first periodic checkpoint will also be resumed.
+   int64_t last_checkpoint_num = is_resuming ? 0 : -c_restore_checkpoint_entries;
+
+   bool had_any_entries = is_resuming;
+   bool changed_free_list = is_resuming && checkpoint.changed_free_list( );
+
+#ifndef _WIN32
+   int64_t start_time = time( 0 );
+#else
+   int64_t start_time = _time64( 0 );
+#endif
 
    for( sli = sequenced_logs.begin( ); sli != sequenced_logs.end( ); ++sli )
    {
       tranlog_info = sli->second.second;
 
+      if( is_resuming && sli->first < checkpoint.sequence )
+         continue;
+
       if( tranlog_info.append_offs > tranlog_info.size_of( ) )
       {
          set< int64_t > committed_transactions;
 
-         fs.open( sli->second.first.c_str( ), ios::in | ios::binary );
+         tranlog_prefetch_buffer buffer( sli->second.first );
+         istream is( &buffer );
 
-         if( !fs )
+         if( !buffer.is_open( ) )
             THROW_ODS_ERROR( "unable to open transaction log '" + sli->second.first + "' in restore_from_transaction_log" );
 
-         fs.seekg( tranlog_info.size_of( ), ios::beg );
+         is.seekg( tranlog_info.size_of( ), ios::beg );
+
+         bool is_checkpoint_log = ( is_resuming && sli->first == checkpoint.sequence );
 
          if( is_reconstruct )
-            tranlog_offset = 0;
+            tranlog_offset = is_checkpoint_log ? checkpoint.entry_offs : 0;
 
          // NOTE: As transaction entry items are not necessarily processed "in order" each entry
          // in the log is processed to determine whether commit or rollback operations should be
          // performed.
          while( true )
          {
-            int64_t entry_offset = fs.tellg( );
+            int64_t entry_offset = is.tellg( );
+
+            if( entry_num && p_progress && ( entry_num % c_restore_progress_entries == 0 ) )
+            {
+#ifndef _WIN32
+               int64_t elapsed = time( 0 ) - start_time;
+#else
+               int64_t elapsed = _time64( 0 ) - start_time;
+#endif
+               string message( "processed " + to_string( entry_num ) + " log entries" );
+
+               if( elapsed > 0 )
+                  message += " (" + to_string( entry_num / elapsed ) + " entries/sec)";
+
+               p_progress->output_progress( message + "..." );
+            }
+
+            // NOTE: Checkpoints are only written between entries (and only when reconstructing as
+            // otherwise the header "tranlog_offset" already provides the point to restore from).
+            if( is_reconstruct && entry_offset > tranlog_offset
+             && entry_num - last_checkpoint_num >= c_restore_checkpoint_entries )
+            {
+               last_checkpoint_num = entry_num;
+
+               data_and_index_write( );
+
+               p_impl->rp_header_info->num_trans = 0;
+               p_impl->rp_header_info->num_writers = 0;
+
+               *p_impl->rp_has_changed = true;
+               p_impl->write_header_file_info( );
+
+               *p_impl->rp_has_changed = false;
 
-            if( entry_num && p_progress && ( entry_num % 1000 == 0 ) )
-               p_progress->output_progress( "processed " + to_string( entry_num ) + " log entries..." );
+               checkpoint.sequence = sli->first;
+               checkpoint.init_time = init_time;
+               checkpoint.entry_offs = tranlog_offset;
+               checkpoint.index_transform_id = p_impl->rp_header_info->index_transform_id;
+
+               checkpoint.set_changed_free_list( changed_free_list );
+
+               ofstream outf( p_impl->checkpoint_file_name.c_str( ), ios::out | ios::binary );
+
+               if( !outf )
+                  THROW_ODS_ERROR( "unable to open restore checkpoint file for output" );
+
+               checkpoint.write( outf );
+            }
 
             ++entry_num;
 
             log_entry tranlog_entry;
-            tranlog_entry.read( fs );
+            tranlog_entry.read( is );
 
             int64_t tx_id = tranlog_entry.tx_id;
 
@@ -5162,7 +6099,9 @@ void ods::restore_from_transaction_log( bool force_reconstruct, progress* p_prog
 
             int64_t next_offs = tranlog_entry.next_entry_offs;
 
-            if( entry_offset <= tranlog_offset )
+            // NOTE: If resuming from a checkpoint then the transform ids in the header had already
+            // been updated for the entries being skipped.
+            if( entry_offset <= tranlog_offset && !is_checkpoint_log )
             {
                p_impl->rp_header_info->data_transform_id = tranlog_entry.data_transform_id;
                p_impl->rp_header_info->index_transform_id = tranlog_entry.index_transform_id;
@@ -5181,11 +6120,10 @@ void ods::restore_from_transaction_log( bool force_reconstruct, progress* p_prog
 
                bool had_any_data = false;
 
-               while( fs.tellg( ) < next_offs )
+               while( is.tellg( ) < next_offs )
                {
                   log_entry_item tranlog_item;
-                  tranlog_item.read( fs );
-
+                  tranlog_item.read( is );
                   if( tranlog_item.has_tran_id( ) )
                      tx_id = tranlog_item.tx_id;
 
@@ -5225,7 +6163,7 @@ void ods::restore_from_transaction_log( bool force_reconstruct, progress* p_prog
                         // NOTE: If reconstructing then there is no need to write
                         // old data for transactions that had been rolled back.
                         if( !commit && is_reconstruct )
-                           fs.seekg( tranlog_item.data_size, ios::cur );
+                           is.seekg( tranlog_item.data_size, ios::cur );
                         else
                         {
                            had_any_data = true;
@@ -5240,7 +6178,7 @@ void ods::restore_from_transaction_log( bool force_reconstruct, progress* p_prog
                               if( j + chunk > tranlog_item.data_size )
                                  chunk = tranlog_item.data_size - j;
 
-                              fs.read( buffer, chunk );
+                              is.read( buffer, chunk );
                               write_data_bytes( buffer, chunk );
                            }
 
@@ -5260,7 +6198,7 @@ void ods::restore_from_transaction_log( bool force_reconstruct, progress* p_prog
                      }
                      else
                      {
-                        fs.seekg( tranlog_item.data_size, ios::cur );
+                        is.seekg( tranlog_item.data_size, ios::cur );
 
                         if( commit && tranlog_item.is_destroy( ) && tranlog_item.is_non_transactional( ) )
                            add_to_free_list = true;
@@ -5300,14 +6238,12 @@ void ods::restore_from_transaction_log( bool force_reconstruct, progress* p_prog
                if( !next_offs )
                   break;
 
-               fs.seekg( next_offs, ios::beg );
+               is.seekg( next_offs, ios::beg );
             }
 
-            if( fs.tellg( ) > tranlog_info.entry_offs )
+            if( is.tellg( ) > tranlog_info.entry_offs )
                break;
          }
-
-         fs.close( );
       }
    }
 
@@ -5358,6 +6294,9 @@ void ods::restore_from_transaction_log( bool force_reconstruct, progress* p_prog
 
       *p_impl->rp_has_changed = false;
    }
+
+   if( file_exists( p_impl->checkpoint_file_name ) )
+      file_remove( p_impl->checkpoint_file_name );
 }
 
 ods& operator >>( ods& o, storable_base& s )
@@ -5544,8 +6483,12 @@ ods& operator <<( ods& o, storable_base& s )
    ods_index_entry index_entry, old_index_entry;
 
    bool is_new_object = true;
+   bool uses_free_data = false;
    bool was_updated_in_place = false;
 
+   int64_t freed_data_pos = 0;
+   int64_t freed_data_size = 0;
+
    storable_base::write_scope write_scope( s, o );
 
    o.bytes_used = 0;
@@ -5709,8 +6652,21 @@ ods& operator <<( ods& o, storable_base& s )
             }
             else
             {
+               if( !is_new_object )
+               {
+                  freed_data_pos = index_entry.data.pos;
+                  freed_data_size = index_entry.data.size;
+               }
+
                if( !is_new_object && o.bytes_reserved <= index_entry.data.size )
+               {
                   was_updated_in_place = true;
+
+                  freed_data_pos += o.bytes_reserved;
+                  freed_data_size -= o.bytes_reserved;
+               }
+               else if( o.obtain_free_data( o.bytes_reserved, index_entry.data.pos ) )
+                  uses_free_data = true;
                else
                   index_entry.data.pos = old_total_size;
 
@@ -5735,8 +6691,13 @@ ods& operator <<( ods& o, storable_base& s )
 
                ++o.p_impl->rp_header_info->transaction_id;
 
-               if( !was_updated_in_place )
+               if( !was_updated_in_place && !uses_free_data )
                   o.p_impl->rp_header_info->total_size_of_data += o.bytes_reserved;
+
+               // NOTE: Any data that is no longer being used is now made available for reuse (this
+               // must occur after the new data has been allocated so it cannot occupy the same space).
+               if( freed_data_size > 0 )
+                  o.release_free_data( freed_data_pos, freed_data_size );
             }
 
             if( !skip_log_entry && o.p_impl->using_tranlog )
@@ -5865,6 +6826,123 @@ ods& operator <<( ods& o, storable_base& s )
    return o;
 }
 
+bool ods::has_free_data_map( )
+{
+   free_data_map& fdm( *p_impl->rp_free_data_map );
+
+   if( fdm.is_active )
+      return true;
+
+   if( p_impl->is_read_only || p_impl->is_restoring || !p_impl->rp_header_file->is_locked_for_exclusive( ) )
+      return false;
+
+   bool was_loaded = false;
+
+   // NOTE: The file is removed once it has been read (so that if the application were to terminate
+   // without closing the store then a file whose extents are no longer correct could not be used).
+   if( file_exists( p_impl->free_data_file_name ) )
+   {
+      ifstream inpf( p_impl->free_data_file_name.c_str( ), ios::in | ios::binary );
+
+      if( inpf )
+         was_loaded = fdm.read( inpf, *p_impl->rp_header_info );
+
+      inpf.close( );
+      file_remove( p_impl->free_data_file_name );
+   }
+
+   if( !was_loaded )
+   {
+      fdm.clear( );
+
+      vector< pair< int64_t, int64_t > > extents;
+
+      ods_index_entry index_entry;
+
+      for( int64_t i = 0; i < p_impl->rp_header_info->total_entries; i++ )
+      {
+         read_index_entry( index_entry, i );
+
+         if( index_entry.data.size && index_entry.trans_flag != ods_index_entry::e_trans_free_list )
+            extents.push_back( make_pair( index_entry.data.pos, index_entry.data.size ) );
+      }
+
+      sort( extents.begin( ), extents.end( ) );
+
+      int64_t next_pos = 0;
+
+      for( size_t i = 0; i < extents.size( ); i++ )
+      {
+         if( extents[ i ].first > next_pos )
+            fdm.add( next_pos, extents[ i ].first - next_pos );
+
+         next_pos = max( next_pos, extents[ i ].first + extents[ i ].second );
+      }
+
+      if( next_pos < p_impl->rp_header_info->total_size_of_data )
+         fdm.add( next_pos, p_impl->rp_header_info->total_size_of_data - next_pos );
+   }
+
+   fdm.is_active = true;
+
+   return true;
+}
+
+bool ods::obtain_free_data( int64_t size, int64_t& pos )
+{
+   return has_free_data_map( ) && p_impl->rp_free_data_map->obtain( size, pos );
+}
+
+bool ods::release_free_data( int64_t pos, int64_t size )
+{
+   if( !has_free_data_map( ) )
+      return false;
+
+   p_impl->rp_free_data_map->add_pending( pos, size );
+
+   return true;
+}
+
+void ods::add_pending_free_data( )
+{
+   free_data_map& fdm( *p_impl->rp_free_data_map );
+
+   if( !fdm.is_active || !fdm.has_pending( ) )
+      return;
+
+   // NOTE: If an extent was already (partly) free then the map can no longer be trusted so it is
+   // discarded (to be rebuilt from the index when next required).
+   if( !fdm.add_pending_extents( ) )
+      fdm.clear( );
+   else
+      trim_free_data( );
+}
+
+void ods::trim_free_data( )
+{
+   int64_t pos = 0;
+   int64_t& total_size = p_impl->rp_header_info->total_size_of_data;
+
+   if( p_impl->rp_free_data_map->remove_last( total_size, pos ) )
+   {
+      p_impl->rp_free_data_map->total_reclaimed += total_size - pos;
+
+      total_size = pos;
+
+      if( !*p_impl->rp_has_changed )
+      {
+         *p_impl->rp_has_changed = true;
+         ++p_impl->rp_header_info->num_writers;
+      }
+   }
+}
+
+void ods::discard_free_data_map( )
+{
+   p_impl->rp_free_data_map->clear( );
+   file_remove( p_impl->free_data_file_name );
+}
+
 void ods::read( unsigned char* p_buf, int64_t len )
 {
 #ifdef ODS_DEBUG
@@ -606,6 +606,8 @@ class ODS_DECL_SPEC ods
    bool is_bulk_read_locked( ) const;
    bool is_bulk_write_locked( ) const;
 
+   bool is_thread_bulk_locked( ) const;
+
    bool is_in_transaction( ) const { return get_transaction_level( ) > 0; }
 
    bool is_using_transaction_log( ) const;
@@ -641,9 +643,15 @@ class ODS_DECL_SPEC ods
 
    void move_free_data_to_end( );
 
+   // NOTE: Moves up to "max_objects" objects (from amongst the next "max_entries" index entries) into
+   // free data extents that precede them so the data can be compacted whilst the store is online. It
+   // will only move objects if the store has been locked for exclusive write access.
+   int64_t compact_data( int64_t max_objects, int64_t max_entries = 0 );
+
    void truncate_log( const char* p_ext = 0 );
 
    void dump_file_info( std::ostream& os );
+   void dump_free_data( std::ostream& os );
    void dump_free_list( std::ostream& os );
    void dump_index_entry( std::ostream& os, int64_t num );
    void dump_instance_data( std::ostream& os, int64_t num, bool only_pos_and_size );
@@ -779,6 +787,17 @@ class ODS_DECL_SPEC ods
    void read_data_bytes( char* p_dest, int64_t len );
    void write_data_bytes( const char* p_src, int64_t len );
 
+   bool has_free_data_map( );
+
+   bool obtain_free_data( int64_t size, int64_t& pos );
+   bool release_free_data( int64_t pos, int64_t size );
+
+   void add_pending_free_data( );
+
+   void trim_free_data( );
+
+   void discard_free_data_map( );
+
    int64_t data_read_buffer_num;
    int64_t data_read_buffer_offs;
    int64_t data_write_buffer_num;
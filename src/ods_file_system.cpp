@@ -60,7 +60,7 @@ const char* const c_pipe_separator = "|";
 const char* const c_colon_separator = ":";
 const char* const c_folder_separator = "/";
 
-const unsigned char c_ofs_items_per_node = 255;
+const uint16_t c_ofs_items_per_node = 1023;
 
 uint16_t c_ofs_object_flag_type_file = 0x8000;
 uint16_t c_ofs_object_flag_type_link = 0x4000;
@@ -128,10 +128,7 @@ read_stream& operator >>( read_stream& rs, ofs_object& o )
       size &= ~c_ofs_object_flag_type_vals;
    }
 
-   o.val.resize( size );
-
-   for( uint16_t i = 0; i < size; i++ )
-      rs >> o.val[ i ];
+   rs.read_bytes( o.val, size );
 
    if( has_file )
       rs >> o.o_file;
@@ -158,10 +155,7 @@ write_stream& operator <<( write_stream& ws, const ofs_object& o )
 
    ws << size;
 
-   size &= ~c_ofs_object_flag_type_vals;
-
-   for( uint16_t i = 0; i < size; i++ )
-      ws << o.val[ i ];
+   ws.write_bytes( o.val );
 
    if( has_file )
       ws << o.o_file;
@@ -169,6 +163,90 @@ write_stream& operator <<( write_stream& ws, const ofs_object& o )
    return ws;
 }
 
+// NOTE: When stored in a node the value is stored as the number of leading characters that are
+// shared with the value of the preceding item followed by just the remaining characters.
+inline uint16_t shared_prefix_length( const ofs_object& o, const ofs_object* p_prev )
+{
+   uint16_t length = 0;
+
+   if( p_prev )
+   {
+      size_t max_length = min( o.val.length( ), p_prev->val.length( ) );
+
+      while( length < max_length && o.val[ length ] == p_prev->val[ length ] )
+         ++length;
+   }
+
+   return length;
+}
+
+int64_t size_of_prefixed( const ofs_object& o, const ofs_object* p_prev )
+{
+   return size_of( o ) + sizeof( uint16_t ) - shared_prefix_length( o, p_prev );
+}
+
+void read_prefixed( read_stream& rs, ofs_object& o, const ofs_object* p_prev )
+{
+   uint16_t size, shared;
+
+   rs >> size >> shared;
+
+   bool has_file = false;
+
+   o.is_link = false;
+
+   if( size & c_ofs_object_flag_type_vals )
+   {
+      has_file = true;
+
+      if( size & c_ofs_object_flag_type_link )
+         o.is_link = true;
+
+      size &= ~c_ofs_object_flag_type_vals;
+   }
+
+   if( shared > size || ( shared && ( !p_prev || shared > p_prev->val.length( ) ) ) )
+      throw runtime_error( "unexpected invalid shared prefix length in read_prefixed for ofs_object" );
+
+   o.val.resize( size );
+
+   if( shared )
+      o.val.replace( 0, shared, p_prev->val, 0, shared );
+
+   if( size > shared )
+      rs.read_bytes( ( unsigned char* )&o.val[ shared ], size - shared );
+
+   if( has_file )
+      rs >> o.o_file;
+   else
+      o.o_file.get_id( ).set_new( );
+}
+
+void write_prefixed( write_stream& ws, const ofs_object& o, const ofs_object* p_prev )
+{
+   uint16_t size = o.val.length( );
+   uint16_t shared = shared_prefix_length( o, p_prev );
+
+   bool has_file = false;
+
+   if( !o.o_file.get_id( ).is_new( ) )
+   {
+      has_file = true;
+      size |= c_ofs_object_flag_type_file;
+
+      if( o.is_link )
+         size |= c_ofs_object_flag_type_link;
+   }
+
+   ws << size << shared;
+
+   if( o.val.length( ) > shared )
+      ws.write_bytes( ( const unsigned char* )o.val.data( ) + shared, o.val.length( ) - shared );
+
+   if( has_file )
+      ws << o.o_file;
+}
+
 ostream& operator <<( ostream& outf, const ofs_object& o )
 {
    outf << o.val;
@@ -13,6 +13,7 @@
 #  include <memory.h>
 #  include <cerrno>
 #  include <map>
+#  include <deque>
 #  include <memory>
 #  include <string>
 #  include <vector>
@@ -468,6 +469,77 @@ struct text_output_info
 
 typedef vector< ref_count_ptr< pdf_page > > page_container;
 
+// NOTE: When rows are being streamed this is the number of rows (beyond the furthest row that has
+// been reached) that will be made available before each page is laid out (so it must exceed the
+// maximum number of rows that could ever fit on a single page).
+const int c_stream_window_rows = 2000;
+
+class pdf_gen_row_stream
+{
+   public:
+   pdf_gen_row_stream( pdf_gen_row_source& source, map< string, string >& variables )
+    :
+    source( source ),
+    variables( variables ),
+    num_rows( 0 ),
+    first_row( 0 ),
+    finished( false )
+   {
+   }
+
+   void fetch_rows( int up_to_row )
+   {
+      while( !finished && num_rows <= up_to_row )
+      {
+         map< string, string > row_variables;
+
+         if( !source.next_row( row_variables ) )
+            finished = true;
+         else
+         {
+            vector< string > keys;
+
+            for( map< string, string >::iterator i = row_variables.begin( ); i != row_variables.end( ); ++i )
+            {
+               variables[ i->first ] = i->second;
+
+               // NOTE: Only variables that are prefixed by a row number will be discarded.
+               if( !i->first.empty( ) && i->first[ 0 ] >= '0' && i->first[ 0 ] <= '9' )
+                  keys.push_back( i->first );
+            }
+
+            row_keys.push_back( keys );
+
+            ++num_rows;
+         }
+      }
+   }
+
+   void discard_rows( int before_row )
+   {
+      while( first_row < before_row && !row_keys.empty( ) )
+      {
+         for( size_t i = 0; i < row_keys.front( ).size( ); i++ )
+            variables.erase( row_keys.front( )[ i ] );
+
+         row_keys.pop_front( );
+
+         ++first_row;
+      }
+   }
+
+   private:
+   pdf_gen_row_source& source;
+   map< string, string >& variables;
+
+   int num_rows;
+   int first_row;
+
+   bool finished;
+
+   deque< vector< string > > row_keys;
+};
+
 const size_t c_max_data_chars = 8192;
 
 const int c_default_character_trunc_limit = 15;
@@ -4473,8 +4545,8 @@ void determine_left_and_right_boundaries(
    group_boundaries[ group ].right = group_boundaries[ group ].left + total_width;
 }
 
-void generate_pdf_output( pdf_doc& doc, pdf_gen_format& format,
- const map< string, string >& variables, vector< string >& temp_image_files )
+void generate_pdf_output( pdf_doc& doc, pdf_gen_format& format, const map< string, string >& variables,
+ vector< string >& temp_image_files, pdf_gen_row_stream* p_row_stream = 0 )
 {
    page_container pages;
 
@@ -4681,6 +4753,34 @@ void generate_pdf_output( pdf_doc& doc, pdf_gen_format& format,
    bool has_left_and_right_boundaries = false;
    while( !finished )
    {
+      // NOTE: If rows are being streamed then make sure enough rows (beyond the furthest one
+      // that has been reached) are present for this page and discard those no longer needed.
+      if( p_row_stream )
+      {
+         int first_row_needed = 0;
+         int last_row_reached = 0;
+
+         bool is_first = true;
+         for( group_const_iterator gci = format.groups.begin( ); gci != format.groups.end( ); ++gci )
+         {
+            if( !gci->second.has_repeats )
+               continue;
+
+            int row = group_repeats[ gci->first ];
+
+            if( is_first || row < first_row_needed )
+               first_row_needed = row;
+
+            if( is_first || row > last_row_reached )
+               last_row_reached = row;
+
+            is_first = false;
+         }
+
+         p_row_stream->discard_rows( first_row_needed - 1 );
+         p_row_stream->fetch_rows( last_row_reached + c_stream_window_rows );
+      }
+
       auto_ptr< pdf_page > ap_page;
 
       if( format.ps != e_page_size_not_applicable )
@@ -6284,8 +6384,8 @@ void generate_pdf_output( pdf_doc& doc, pdf_gen_format& format,
    }
 }
 
-void generate_pdf_doc( const string& format_filename,
- const string& output_filename, const map< string, string >& variables, progress* p_progress )
+void generate_and_save_pdf_doc( const string& format_filename, const string& output_filename,
+ const map< string, string >& variables, pdf_gen_row_source* p_row_source, progress* p_progress )
 {
    if( p_progress )
    {
@@ -6300,7 +6400,16 @@ void generate_pdf_doc( const string& format_filename,
    doc.set_compression( );
 
    vector< string > temp_image_files;
-   generate_pdf_output( doc, format, variables, temp_image_files );
+
+   if( !p_row_source )
+      generate_pdf_output( doc, format, variables, temp_image_files );
+   else
+   {
+      map< string, string > all_variables( variables );
+      pdf_gen_row_stream row_stream( *p_row_source, all_variables );
+
+      generate_pdf_output( doc, format, all_variables, temp_image_files, &row_stream );
+   }
 
 #ifdef _WIN32
    bool has_wide_chars = false;
@@ -6346,3 +6455,14 @@ void generate_pdf_doc( const string& format_filename,
       file_remove( temp_image_files[ i ] );
 }
 
+void generate_pdf_doc( const string& format_filename,
+ const string& output_filename, const map< string, string >& variables, progress* p_progress )
+{
+   generate_and_save_pdf_doc( format_filename, output_filename, variables, 0, p_progress );
+}
+
+void generate_pdf_doc( const string& format_filename, const string& output_filename,
+ const map< string, string >& variables, pdf_gen_row_source& row_source, progress* p_progress )
+{
+   generate_and_save_pdf_doc( format_filename, output_filename, variables, &row_source, p_progress );
+}
@@ -14,9 +14,25 @@
 
 struct progress;
 
+// NOTE: For large reports the variables for repeating rows can be provided incrementally (rather
+// than all up front) by a row source. Each row's variables are expected to start with the (zero
+// padded) row number (i.e. "00000_data_Name") and rows are requested only as the pages are being
+// laid out (with rows that have already been output being discarded).
+class pdf_gen_row_source
+{
+   public:
+   virtual ~pdf_gen_row_source( ) { }
+
+   virtual bool next_row( std::map< std::string, std::string >& variables ) = 0;
+};
+
 void generate_pdf_doc(
  const std::string& format_filename, const std::string& output_filename,
  const std::map< std::string, std::string >& variables, progress* p_progress = 0 );
 
+void generate_pdf_doc(
+ const std::string& format_filename, const std::string& output_filename,
+ const std::map< std::string, std::string >& variables, pdf_gen_row_source& row_source, progress* p_progress = 0 );
+
 #endif
 
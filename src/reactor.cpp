@@ -0,0 +1,331 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef PRECOMPILE_H
+#  include "precompile.h"
+#endif
+#pragma hdrstop
+
+#ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <map>
+#  include <deque>
+#  include <memory>
+#  include <cstring>
+#  include <stdexcept>
+#endif
+
+#ifndef _WIN32
+#  include <unistd.h>
+#  include <sys/epoll.h>
+#endif
+
+#include "reactor.h"
+
+#include "threads.h"
+#include "utilities.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+namespace
+{
+
+const int c_max_events = 256;
+
+const int c_epoll_wait_timeout = 250;
+
+}
+
+struct reactor::impl
+{
+   class reactor_job : public thread_pool_job
+   {
+      public:
+      reactor_job( impl& r ) : r( r ) { }
+
+      void run( ) { r.wait_for_events( ); }
+
+      private:
+      impl& r;
+   };
+
+   class worker_job : public thread_pool_job
+   {
+      public:
+      worker_job( impl& r ) : r( r ) { }
+
+      void run( ) { r.perform_work( ); }
+
+      private:
+      impl& r;
+   };
+
+   impl( size_t num_workers, size_t wake_check_msecs )
+    :
+    epoll_fd( -1 ),
+    num_workers( num_workers ? num_workers : 1 ),
+    wake_check_msecs( wake_check_msecs ),
+    is_running( false ),
+    is_stopping( false )
+   {
+   }
+
+   int epoll_fd;
+
+   size_t num_workers;
+   unsigned long wake_check_msecs;
+
+   bool is_running;
+   bool is_stopping;
+
+   mutex reactor_mutex;
+
+   condition work_condition;
+
+   // NOTE: The reactor loop and every worker are each run as a job by the pool (and so
+   // they are all joined by "stop" before anything that they use can be destroyed).
+   auto_ptr< thread_pool > ap_pool;
+
+   map< SOCKET, reactor_handler* > parked;
+   deque< reactor_handler* > ready;
+
+   reactor_stats stats;
+
+   void wait_for_events( );
+   void perform_work( );
+
+   void unpark( map< SOCKET, reactor_handler* >::iterator i );
+};
+
+void reactor::impl::wait_for_events( )
+{
+#ifndef _WIN32
+   struct epoll_event events[ c_max_events ];
+
+   unsigned long last_wake_check = get_msecs( );
+
+   while( true )
+   {
+      int num_events = ::epoll_wait( epoll_fd, events, c_max_events, c_epoll_wait_timeout );
+
+      guard g( reactor_mutex );
+
+      if( is_stopping )
+         break;
+
+      for( int i = 0; i < num_events; i++ )
+      {
+         map< SOCKET, reactor_handler* >::iterator pi = parked.find( events[ i ].data.fd );
+
+         if( pi != parked.end( ) )
+            unpark( pi );
+      }
+
+      unsigned long now = get_msecs( );
+
+      if( now - last_wake_check >= wake_check_msecs )
+      {
+         last_wake_check = now;
+
+         map< SOCKET, reactor_handler* >::iterator pi = parked.begin( );
+
+         while( pi != parked.end( ) )
+         {
+            map< SOCKET, reactor_handler* >::iterator next( pi );
+            ++next;
+
+            if( pi->second->needs_wake( ) )
+            {
+               ++stats.num_woken;
+               unpark( pi );
+            }
+
+            pi = next;
+         }
+      }
+   }
+#endif
+}
+
+void reactor::impl::perform_work( )
+{
+   reactor_handler* p_handler = 0;
+
+   while( true )
+   {
+      // NOTE: Scope for guard object.
+      {
+         guard g( reactor_mutex );
+
+         if( p_handler )
+         {
+            --stats.num_busy;
+            p_handler = 0;
+         }
+
+         while( ready.empty( ) && !is_stopping )
+            work_condition.wait( reactor_mutex );
+
+         if( is_stopping )
+            break;
+
+         p_handler = ready.front( );
+         ready.pop_front( );
+
+         ++stats.num_busy;
+      }
+
+      // NOTE: A handler is expected to deal with its own errors (and once it has been called
+      // it may have already deleted itself) so any exception is just ignored here.
+      try
+      {
+         p_handler->handle_ready( );
+      }
+      catch( ... )
+      {
+      }
+   }
+}
+
+void reactor::impl::unpark( map< SOCKET, reactor_handler* >::iterator i )
+{
+#ifndef _WIN32
+   struct epoll_event event;
+   memset( &event, 0, sizeof( event ) );
+
+   ::epoll_ctl( epoll_fd, EPOLL_CTL_DEL, i->first, &event );
+#endif
+
+   ready.push_back( i->second );
+   parked.erase( i );
+
+   ++stats.num_dispatched;
+   work_condition.notify_one( );
+}
+
+reactor::reactor( size_t num_workers, size_t wake_check_msecs )
+{
+#ifdef _WIN32
+   throw runtime_error( "reactor is not currently supported for this platform" );
+#else
+   auto_ptr< impl > ap_impl( new impl( num_workers, wake_check_msecs ) );
+
+   ap_impl->epoll_fd = ::epoll_create( c_max_events );
+
+   if( ap_impl->epoll_fd < 0 )
+      throw runtime_error( "unable to create epoll instance in reactor::reactor" );
+
+   p_impl = ap_impl.release( );
+#endif
+}
+
+reactor::~reactor( )
+{
+   stop( );
+
+#ifndef _WIN32
+   ::close( p_impl->epoll_fd );
+#endif
+
+   delete p_impl;
+}
+
+void reactor::start( )
+{
+   guard g( p_impl->reactor_mutex );
+
+   if( !p_impl->is_running )
+   {
+      auto_ptr< thread_pool > ap_pool( new thread_pool( p_impl->num_workers + 1 ) );
+      ap_pool->start( );
+
+      ap_pool->queue_job( new impl::reactor_job( *p_impl ) );
+
+      for( size_t i = 0; i < p_impl->num_workers; i++ )
+         ap_pool->queue_job( new impl::worker_job( *p_impl ) );
+
+      p_impl->ap_pool = ap_pool;
+      p_impl->is_running = true;
+   }
+}
+
+void reactor::stop( )
+{
+   auto_ptr< thread_pool > ap_pool;
+
+   // NOTE: Scope for guard object.
+   {
+      guard g( p_impl->reactor_mutex );
+
+      if( !p_impl->is_running || p_impl->is_stopping )
+         return;
+
+      p_impl->is_stopping = true;
+      p_impl->work_condition.notify_all( );
+
+      ap_pool = p_impl->ap_pool;
+   }
+
+   // NOTE: The mutex must not be held here as the reactor loop and workers need to acquire it
+   // in order to find out that they are to finish.
+   ap_pool->stop( );
+
+   guard g( p_impl->reactor_mutex );
+
+   p_impl->is_running = false;
+   p_impl->is_stopping = false;
+}
+
+void reactor::park( SOCKET socket, reactor_handler* p_handler )
+{
+   guard g( p_impl->reactor_mutex );
+
+   bool okay = false;
+
+#ifndef _WIN32
+   struct epoll_event event;
+   memset( &event, 0, sizeof( event ) );
+
+   event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+   event.data.fd = socket;
+
+   if( ::epoll_ctl( p_impl->epoll_fd, EPOLL_CTL_ADD, socket, &event ) == 0 )
+   {
+      okay = true;
+      p_impl->parked.insert( make_pair( socket, p_handler ) );
+   }
+#endif
+
+   // NOTE: If the socket could not be added (which is most likely due to it no longer being
+   // valid) then the handler is dispatched immediately so that it can detect the situation.
+   if( !okay )
+   {
+      p_impl->ready.push_back( p_handler );
+
+      ++p_impl->stats.num_dispatched;
+      p_impl->work_condition.notify_one( );
+   }
+}
+
+void reactor::dispatch( reactor_handler* p_handler )
+{
+   guard g( p_impl->reactor_mutex );
+
+   p_impl->ready.push_back( p_handler );
+
+   ++p_impl->stats.num_dispatched;
+   p_impl->work_condition.notify_one( );
+}
+
+void reactor::get_stats( reactor_stats& stats ) const
+{
+   guard g( p_impl->reactor_mutex );
+
+   stats = p_impl->stats;
+
+   stats.num_parked = p_impl->parked.size( );
+   stats.num_queued = p_impl->ready.size( );
+   stats.num_workers = p_impl->num_workers;
+}
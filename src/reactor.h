@@ -0,0 +1,75 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef REACTOR_H
+#  define REACTOR_H
+
+#  include "sockets.h"
+
+class reactor_handler
+{
+   public:
+   virtual ~reactor_handler( ) { }
+
+   // NOTE: Called by a worker thread after the handler has been dispatched (either directly or
+   // due to its parked socket having become readable). A handler is responsible for itself so
+   // it must either park itself again (as the very last thing that it does) or delete itself.
+   virtual void handle_ready( ) = 0;
+
+   // NOTE: Called periodically by the reactor thread (whilst holding the reactor's mutex) for
+   // each parked handler to determine whether it should be dispatched even though its socket
+   // has not become readable (e.g. in order to force a shutdown).
+   virtual bool needs_wake( ) { return false; }
+};
+
+struct reactor_stats
+{
+   reactor_stats( )
+    :
+    num_busy( 0 ),
+    num_parked( 0 ),
+    num_queued( 0 ),
+    num_workers( 0 ),
+    num_woken( 0 ),
+    num_dispatched( 0 )
+   {
+   }
+
+   size_t num_busy;
+   size_t num_parked;
+   size_t num_queued;
+   size_t num_workers;
+
+   size_t num_woken;
+   size_t num_dispatched;
+};
+
+// NOTE: Rather than each connection having its own thread (that will spend nearly all of its time
+// blocked whilst waiting for the next request) handlers are "parked" whilst their sockets remain
+// idle (with the reactor thread waiting for any of them to become readable using "epoll") and a
+// fixed number of worker threads are used to perform the handling of ready sockets.
+class reactor
+{
+   public:
+   reactor( size_t num_workers, size_t wake_check_msecs = 1000 );
+   ~reactor( );
+
+   void start( );
+   void stop( );
+
+   void park( SOCKET socket, reactor_handler* p_handler );
+   void dispatch( reactor_handler* p_handler );
+
+   void get_stats( reactor_stats& stats ) const;
+
+   private:
+   struct impl;
+   impl* p_impl;
+
+   reactor( const reactor& );
+   reactor& operator =( const reactor& );
+};
+
+#endif
@@ -72,6 +72,8 @@ class ptf_read_buffered_stream : public read_stream
 
    void read( unsigned char* p_buf, size_t len, read_write_type type );
 
+   bool uses_native_format( ) const { return false; }
+
    private:
    read_buffer& rb;
 };
@@ -87,6 +89,8 @@ class ptf_write_buffered_stream : public write_stream
 
    void write( const unsigned char* p_buf, size_t len, read_write_type type );
 
+   bool uses_native_format( ) const { return false; }
+
    void flush( ) { wb.flush_data( ); }
 
    private:
@@ -49,6 +49,34 @@ class read_stream
 
    virtual void read_meta( std::string& ) { }
 
+   // NOTE: Streams that convert values into some other format (rather than just copying the bytes
+   // as they are held in memory) need to return false so containers of non-char primitives won't
+   // be read as a single block of bytes.
+   virtual bool uses_native_format( ) const { return true; }
+
+   // NOTE: Reads a block of raw bytes with just one call to "read" (rather than one per element).
+   void read_bytes( unsigned char* p_buf, size_t len )
+   {
+      if( len )
+         read( p_buf, len, e_read_write_type_none );
+   }
+
+   void read_bytes( std::string& str, size_t len )
+   {
+      str.resize( len );
+
+      if( len )
+         read( ( unsigned char* )&str[ 0 ], len, e_read_write_type_none );
+   }
+
+   void read_bytes( std::vector< unsigned char >& buf, size_t len )
+   {
+      buf.resize( len );
+
+      if( len )
+         read( &buf[ 0 ], len, e_read_write_type_none );
+   }
+
    read_stream& operator >>( bool& val )
    {
       read( ( unsigned char* )&val, sizeof( bool ), e_read_write_type_bool );
@@ -153,6 +181,27 @@ class write_stream
 
    virtual void write_meta( std::string& ) { }
 
+   virtual bool uses_native_format( ) const { return true; }
+
+   // NOTE: Writes a block of raw bytes with just one call to "write" (rather than one per element).
+   void write_bytes( const unsigned char* p_buf, size_t len )
+   {
+      if( len )
+         write( p_buf, len, e_read_write_type_none );
+   }
+
+   void write_bytes( const std::string& str )
+   {
+      if( !str.empty( ) )
+         write( ( const unsigned char* )str.data( ), str.size( ), e_read_write_type_none );
+   }
+
+   void write_bytes( const std::vector< unsigned char >& buf )
+   {
+      if( !buf.empty( ) )
+         write( &buf[ 0 ], buf.size( ), e_read_write_type_none );
+   }
+
    write_stream& operator <<( bool val )
    {
       write( ( const unsigned char* )&val, sizeof( bool ), e_read_write_type_bool );
@@ -252,8 +301,68 @@ class write_stream
 
 class read_write_stream : public read_stream, public write_stream
 {
+   public:
+   bool uses_native_format( ) const { return true; }
 };
 
+// NOTE: Vectors of primitives (other than "bool" as "std::vector< bool >" does not hold its elements
+// contiguously) are read and written as a single block of bytes when the stream will not be needing
+// to convert each element. As the "char" types are never converted these are always block copied.
+template< typename T > struct bulk_copy_type { enum { value = 0 }; };
+
+template< > struct bulk_copy_type< char > { enum { value = 1 }; };
+template< > struct bulk_copy_type< signed char > { enum { value = 1 }; };
+template< > struct bulk_copy_type< unsigned char > { enum { value = 1 }; };
+
+template< > struct bulk_copy_type< wchar_t > { enum { value = 2 }; };
+template< > struct bulk_copy_type< short > { enum { value = 2 }; };
+template< > struct bulk_copy_type< unsigned short > { enum { value = 2 }; };
+template< > struct bulk_copy_type< int > { enum { value = 2 }; };
+template< > struct bulk_copy_type< unsigned int > { enum { value = 2 }; };
+template< > struct bulk_copy_type< long > { enum { value = 2 }; };
+template< > struct bulk_copy_type< unsigned long > { enum { value = 2 }; };
+template< > struct bulk_copy_type< long_long > { enum { value = 2 }; };
+template< > struct bulk_copy_type< unsigned_long_long > { enum { value = 2 }; };
+template< > struct bulk_copy_type< float > { enum { value = 2 }; };
+template< > struct bulk_copy_type< double > { enum { value = 2 }; };
+template< > struct bulk_copy_type< long double > { enum { value = 2 }; };
+
+template< typename T, int C > struct bulk_vector_copier
+{
+   template< class A > static bool read( read_stream&, std::vector< T, A >&, size_t ) { return false; }
+   template< class A > static bool write( write_stream&, const std::vector< T, A >& ) { return false; }
+};
+
+template< typename T, int C > struct bulk_vector_copier_for_primitives
+{
+   template< class A > static bool read( read_stream& rs, std::vector< T, A >& ctr, size_t size )
+   {
+      if( C > 1 && !rs.uses_native_format( ) )
+         return false;
+
+      ctr.resize( size );
+
+      if( size )
+         rs.read_bytes( ( unsigned char* )&ctr[ 0 ], size * sizeof( T ) );
+
+      return true;
+   }
+
+   template< class A > static bool write( write_stream& ws, const std::vector< T, A >& ctr )
+   {
+      if( C > 1 && !ws.uses_native_format( ) )
+         return false;
+
+      if( !ctr.empty( ) )
+         ws.write_bytes( ( const unsigned char* )&ctr[ 0 ], ctr.size( ) * sizeof( T ) );
+
+      return true;
+   }
+};
+
+template< typename T > struct bulk_vector_copier< T, 1 > : bulk_vector_copier_for_primitives< T, 1 > { };
+template< typename T > struct bulk_vector_copier< T, 2 > : bulk_vector_copier_for_primitives< T, 2 > { };
+
 template< typename T1, typename T2 > read_stream& operator >>( read_stream& rs, std::pair< T1, T2 >& val )
 {
    rs >> val.first >> val.second;
@@ -312,6 +421,10 @@ template< typename T, class A > read_stream& operator >>( read_stream& rs, std::
 #  endif
 
    ctr.clear( );
+
+   if( bulk_vector_copier< T, bulk_copy_type< T >::value >::read( rs, ctr, size ) )
+      return rs;
+
    ctr.reserve( size );
 
    typename std::vector< T, A >::value_type v;
@@ -418,9 +531,10 @@ template< typename C, class T, class A > read_stream& operator >>( read_stream&
 #  endif
 
 #  ifdef USE_FAST_STRING_READ
-   ctr = std::basic_string< C, T, A >( size, 0 );
-   unsigned char* p_buf = ( unsigned char* )ctr.data( );
-   rs.read( p_buf, size * sizeof( typename T::char_type ) );
+   ctr.resize( size );
+
+   if( size )
+      rs.read_bytes( ( unsigned char* )&ctr[ 0 ], size * sizeof( typename T::char_type ) );
 #  else
    ctr.erase( );
    typename std::basic_string< C, T, A >::value_type v;
@@ -493,7 +607,7 @@ template< typename C, class T, class A > write_stream& operator <<( write_stream
    typename std::basic_string< C, T, A >::size_type size = ctr.size( );
    ws << size;
 
-   ws.write( ( unsigned char* )ctr.data( ), size * sizeof( typename T::char_type ) );
+   ws.write_bytes( ( const unsigned char* )ctr.data( ), size * sizeof( typename T::char_type ) );
 
    return ws;
 }
@@ -625,8 +739,11 @@ template< typename T, class A > write_stream& operator <<( write_stream& ws, con
    ws << dummy;
 #  endif
 
-   for( typename std::vector< T, A >::size_type i = 0; i < size; i++ )
-      ws << ctr[ i ];
+   if( !bulk_vector_copier< T, bulk_copy_type< T >::value >::write( ws, ctr ) )
+   {
+      for( typename std::vector< T, A >::size_type i = 0; i < size; i++ )
+         ws << ctr[ i ];
+   }
 
    return ws;
 }
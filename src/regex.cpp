@@ -10,9 +10,13 @@
 #pragma hdrstop
 
 #ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <memory.h>
+#  include <map>
+#  include <memory>
 #  include <sstream>
 #  include <fstream>
 #  include <iostream>
+#  include <algorithm>
 #  include <stdexcept>
 #endif
 
@@ -186,6 +190,449 @@ bool match_literal( const string& lit, const string& text, size_t pos )
    return true;
 }
 
+const size_t c_num_chars = 256;
+const size_t c_char_set_bytes = c_num_chars / 8;
+
+const size_t c_max_nfa_states = 8192;
+const size_t c_max_dfa_states = 1024;
+
+struct char_set
+{
+   char_set( bool optional = false ) : optional( optional ) { memset( chars, 0, sizeof( chars ) ); }
+
+   void add( unsigned char ch ) { chars[ ch / 8 ] |= ( 1 << ( ch % 8 ) ); }
+
+   void add_all( ) { memset( chars, 0xff, sizeof( chars ) ); }
+
+   void invert( )
+   {
+      for( size_t i = 0; i < c_char_set_bytes; i++ )
+         chars[ i ] = ~chars[ i ];
+   }
+
+   bool optional;
+   unsigned char chars[ c_char_set_bytes ];
+};
+
+struct nfa_state
+{
+   nfa_state( ) : target( -1 ), accepts( -1 ), at_finish( false ) { memset( chars, 0, sizeof( chars ) ); }
+
+   bool has_char( unsigned char ch ) const { return chars[ ch / 8 ] & ( 1 << ( ch % 8 ) ); }
+
+   unsigned char chars[ c_char_set_bytes ];
+
+   int target;
+   int accepts;
+
+   bool at_finish;
+
+   vector< int > next;
+};
+
+// NOTE: The automaton is constructed from the "parts" of one or more expressions (as a Thompson
+// NFA) and is then scanned using DFA states (each being the set of NFA states that are active)
+// which are only created when first needed (with their transitions being cached). Because the
+// matching performed by "do_search" is not the same as that of a conventional regex the NFA is
+// constructed to accept a superset of what "do_search" would match (e.g. a boundary is treated
+// as an optional non-word character) as it is only ever being used to determine whether or not
+// a match is possible. An expression that is to match at the start is not anchored by the NFA as
+// "do_search" can find such a match after the start (e.g. if a bounded repeat had been exceeded)
+// and so every expression can begin matching at any position. As "do_search" can also continue
+// (or finish) a match in ways that a conventional regex would not after a part that is repeated
+// only expressions whose parts (other than the last) match at most once are added (any other
+// expression will instead always be searched for by "do_search").
+struct automaton
+{
+   automaton( ) : num_expressions( 0 ), start_id( -1 ) { }
+
+   bool add_expression( const vector< part >& parts, bool match_at_finish, int id );
+
+   size_t scan( const string& text, vector< bool >& matched );
+
+   bool can_match( const string& text )
+   {
+      vector< bool > matched( 1 );
+      return scan( text, matched ) > 0;
+   }
+
+   int new_state( )
+   {
+      states.push_back( nfa_state( ) );
+      return states.size( ) - 1;
+   }
+
+   int append_unit( int from, const vector< char_set >& unit );
+
+   void closure( vector< int >& nfa_set );
+
+   void flush( );
+
+   int get_start( );
+   int get_next( int id, unsigned char ch );
+
+   int get_dfa_state( vector< int >& nfa_set, bool& flushed );
+
+   size_t num_expressions;
+
+   vector< nfa_state > states;
+
+   vector< int > starts;
+
+   int start_id;
+
+   map< vector< int >, int > dfa_ids;
+
+   vector< vector< int > > dfa_sets;
+   vector< int > dfa_transitions;
+
+   vector< vector< int > > dfa_accepts;
+   vector< vector< int > > dfa_finish_accepts;
+};
+
+bool automaton::add_expression( const vector< part >& parts, bool match_at_finish, int id )
+{
+   if( parts.empty( ) )
+      return false;
+
+   for( size_t i = 0; i < parts.size( ) - 1; i++ )
+   {
+      if( parts[ i ].max_matches != 1 )
+         return false;
+   }
+
+   size_t original_size = states.size( );
+
+   int start = new_state( );
+   int current = start;
+
+   int finish_skip = -1;
+
+   for( size_t i = 0; i < parts.size( ); i++ )
+   {
+      const part& p( parts[ i ] );
+
+      // NOTE: If the text finishes after having matched all but a final set then "do_search" will
+      // consider the expression to have been matched (so an alternative finish is being added).
+      if( i && i == parts.size( ) - 1 && p.type == e_part_type_set )
+         finish_skip = current;
+
+      vector< char_set > unit;
+
+      if( p.type == e_part_type_lit )
+      {
+         if( p.literal.empty( ) )
+         {
+            unit.push_back( char_set( ) );
+            unit.back( ).add_all( );
+         }
+
+         for( size_t j = 0; j < p.literal.size( ); j++ )
+         {
+            char ch = p.literal[ j ];
+
+            // NOTE: Back references cannot be handled by a DFA.
+            if( ch == '\\' )
+            {
+               states.resize( original_size );
+               return false;
+            }
+
+            if( ch != '\b' )
+            {
+               unit.push_back( char_set( ) );
+               unit.back( ).add( ( unsigned char )ch );
+            }
+            else
+            {
+               unit.push_back( char_set( true ) );
+
+               for( size_t c = 0; c < c_num_chars; c++ )
+               {
+                  if( !is_word_char( ( char )c ) )
+                     unit.back( ).add( ( unsigned char )c );
+               }
+            }
+         }
+      }
+      else
+      {
+         unit.push_back( char_set( ) );
+
+         for( size_t j = 0; j < p.matches.size( ); j++ )
+         {
+            if( p.matches[ j ].first == '\0' )
+               unit.back( ).add_all( );
+            else
+            {
+               for( int c = ( unsigned char )p.matches[ j ].first; c <= ( unsigned char )p.matches[ j ].second; c++ )
+                  unit.back( ).add( ( unsigned char )c );
+            }
+         }
+
+         if( p.inverted )
+            unit.back( ).invert( );
+      }
+
+      int min_matches = p.min_matches;
+      int max_matches = p.max_matches;
+
+      for( int j = 0; j < min_matches; j++ )
+         current = append_unit( current, unit );
+
+      if( !max_matches )
+      {
+         int loop = new_state( );
+         states[ current ].next.push_back( loop );
+
+         int finish = append_unit( loop, unit );
+         states[ finish ].next.push_back( loop );
+
+         current = loop;
+      }
+      else
+      {
+         for( int j = min_matches; j < max_matches; j++ )
+         {
+            int finish = append_unit( current, unit );
+
+            int join = new_state( );
+            states[ current ].next.push_back( join );
+            states[ finish ].next.push_back( join );
+
+            current = join;
+         }
+      }
+
+      if( states.size( ) > c_max_nfa_states )
+      {
+         states.resize( original_size );
+         return false;
+      }
+   }
+
+   states[ current ].accepts = id;
+   states[ current ].at_finish = match_at_finish;
+
+   if( finish_skip >= 0 )
+   {
+      int finish = new_state( );
+      states[ finish_skip ].next.push_back( finish );
+
+      states[ finish ].accepts = id;
+      states[ finish ].at_finish = true;
+   }
+
+   starts.push_back( start );
+
+   ++num_expressions;
+
+   flush( );
+
+   return true;
+}
+
+size_t automaton::scan( const string& text, vector< bool >& matched )
+{
+   size_t num_matched = 0;
+
+   if( !num_expressions )
+      return num_matched;
+
+   int id = get_start( );
+
+   for( size_t i = 0; ; i++ )
+   {
+      if( !dfa_accepts[ id ].empty( ) )
+      {
+         for( size_t j = 0; j < dfa_accepts[ id ].size( ); j++ )
+         {
+            int accepts = dfa_accepts[ id ][ j ];
+
+            if( !matched[ accepts ] )
+            {
+               ++num_matched;
+               matched[ accepts ] = true;
+            }
+         }
+
+         if( num_matched == num_expressions )
+            break;
+      }
+
+      if( i == text.size( ) )
+      {
+         for( size_t j = 0; j < dfa_finish_accepts[ id ].size( ); j++ )
+         {
+            int accepts = dfa_finish_accepts[ id ][ j ];
+
+            if( !matched[ accepts ] )
+            {
+               ++num_matched;
+               matched[ accepts ] = true;
+            }
+         }
+
+         break;
+      }
+
+      id = get_next( id, ( unsigned char )text[ i ] );
+   }
+
+   return num_matched;
+}
+
+int automaton::append_unit( int from, const vector< char_set >& unit )
+{
+   int current = from;
+
+   for( size_t i = 0; i < unit.size( ); i++ )
+   {
+      int edge = new_state( );
+      int target = new_state( );
+
+      states[ current ].next.push_back( edge );
+
+      if( unit[ i ].optional )
+         states[ current ].next.push_back( target );
+
+      memcpy( states[ edge ].chars, unit[ i ].chars, c_char_set_bytes );
+      states[ edge ].target = target;
+
+      current = target;
+   }
+
+   return current;
+}
+
+void automaton::closure( vector< int >& nfa_set )
+{
+   vector< bool > found( states.size( ) );
+   vector< int > pending( nfa_set );
+
+   nfa_set.clear( );
+
+   while( !pending.empty( ) )
+   {
+      int next = pending.back( );
+      pending.pop_back( );
+
+      if( found[ next ] )
+         continue;
+
+      found[ next ] = true;
+
+      // NOTE: Only states that can consume a character or accept are required in DFA states.
+      if( states[ next ].target >= 0 || states[ next ].accepts >= 0 )
+         nfa_set.push_back( next );
+
+      for( size_t i = 0; i < states[ next ].next.size( ); i++ )
+         pending.push_back( states[ next ].next[ i ] );
+   }
+
+   sort( nfa_set.begin( ), nfa_set.end( ) );
+}
+
+void automaton::flush( )
+{
+   start_id = -1;
+
+   dfa_ids.clear( );
+   dfa_sets.clear( );
+   dfa_transitions.clear( );
+
+   dfa_accepts.clear( );
+   dfa_finish_accepts.clear( );
+}
+
+int automaton::get_start( )
+{
+   if( start_id < 0 )
+   {
+      bool flushed;
+      vector< int > nfa_set( starts );
+
+      closure( nfa_set );
+      start_id = get_dfa_state( nfa_set, flushed );
+   }
+
+   return start_id;
+}
+
+int automaton::get_next( int id, unsigned char ch )
+{
+   int next_id = dfa_transitions[ ( id * c_num_chars ) + ch ];
+
+   if( next_id < 0 )
+   {
+      vector< int > nfa_set;
+      const vector< int >& current_set( dfa_sets[ id ] );
+
+      for( size_t i = 0; i < current_set.size( ); i++ )
+      {
+         const nfa_state& state( states[ current_set[ i ] ] );
+
+         if( state.target >= 0 && state.has_char( ch ) )
+            nfa_set.push_back( state.target );
+      }
+
+      nfa_set.insert( nfa_set.end( ), starts.begin( ), starts.end( ) );
+
+      closure( nfa_set );
+
+      bool flushed;
+      next_id = get_dfa_state( nfa_set, flushed );
+
+      if( !flushed )
+         dfa_transitions[ ( id * c_num_chars ) + ch ] = next_id;
+   }
+
+   return next_id;
+}
+
+int automaton::get_dfa_state( vector< int >& nfa_set, bool& flushed )
+{
+   flushed = false;
+
+   map< vector< int >, int >::iterator i = dfa_ids.find( nfa_set );
+
+   if( i != dfa_ids.end( ) )
+      return i->second;
+
+   // NOTE: In order to limit memory usage all cached DFA states are discarded once the maximum
+   // has been reached (they will be recreated if and when needed).
+   if( dfa_sets.size( ) >= c_max_dfa_states )
+   {
+      flush( );
+      flushed = true;
+   }
+
+   int id = dfa_sets.size( );
+
+   dfa_ids.insert( make_pair( nfa_set, id ) );
+   dfa_sets.push_back( nfa_set );
+
+   dfa_transitions.resize( dfa_transitions.size( ) + c_num_chars, -1 );
+
+   dfa_accepts.push_back( vector< int >( ) );
+   dfa_finish_accepts.push_back( vector< int >( ) );
+
+   for( size_t j = 0; j < nfa_set.size( ); j++ )
+   {
+      const nfa_state& state( states[ nfa_set[ j ] ] );
+
+      if( state.accepts >= 0 )
+      {
+         if( state.at_finish )
+            dfa_finish_accepts.back( ).push_back( state.accepts );
+         else
+            dfa_accepts.back( ).push_back( state.accepts );
+      }
+   }
+
+   return id;
+}
+
 #ifdef DEBUG
 void dump_state( const string& msg, char ch, char last_ch, bool ch_used, bool is_range,
  bool is_matches, bool had_empty, bool had_range, bool is_in_set, bool was_in_set, bool had_escape,
@@ -216,7 +663,7 @@ void dump_state( const string& msg, char ch, char last_ch, bool ch_used, bool is
 
 struct regex::impl
 {
-   impl( const string& expr );
+   impl( const string& expr, bool use_dfa );
 
    string get_expr( ) const { return expr; }
 
@@ -251,9 +698,12 @@ struct regex::impl
    vector< string > refs;
 
    map< int, string > node_refs;
+
+   bool has_dfa;
+   automaton dfa;
 };
 
-regex::impl::impl( const string& expr )
+regex::impl::impl( const string& expr, bool use_dfa )
  :
  expr( expr ),
  min_size( 0 ),
@@ -263,7 +713,8 @@ regex::impl::impl( const string& expr )
  prefix_at_boundary( false ),
  last_unlimited_part( 0 ),
  min_size_from_finish( 0 ),
- max_size_from_finish( 0 )
+ max_size_from_finish( 0 ),
+ has_dfa( false )
 {
    part next_part;
 
@@ -902,6 +1353,9 @@ regex::impl::impl( const string& expr )
 
    if( max_size )
       --max_size;
+
+   if( use_dfa )
+      has_dfa = dfa.add_expression( parts, match_at_finish, 0 );
 #ifdef DEBUG
    cout << "min_size = " << min_size << endl;
    cout << "max_size = " << max_size << endl;
@@ -912,7 +1366,10 @@ regex::impl::impl( const string& expr )
 string::size_type regex::impl::search(
  const string& text, string::size_type* p_length, vector< string >* p_refs )
 {
-   if( parts.empty( ) || ( min_size && text.length( ) < min_size ) )
+   if( parts.empty( ) || ( min_size && text.length( ) < ( size_t )min_size ) )
+      return string::npos;
+
+   if( has_dfa && !dfa.can_match( text ) )
       return string::npos;
 
 #ifdef DEBUG
@@ -930,7 +1387,7 @@ string::size_type regex::impl::search(
       if( test_part.min_matches )
       {
          string literal;
-         for( size_t i = 0; i < test_part.min_matches; i++ )
+         for( int i = 0; i < test_part.min_matches; i++ )
             literal += test_part.literal;
 
          if( !match_literal( literal, text, 0 ) )
@@ -944,10 +1401,8 @@ string::size_type regex::impl::search(
 
       if( test_part.min_matches )
       {
-         bool okay = true;
-
          string literal;
-         for( size_t i = 0; i < test_part.min_matches; i++ )
+         for( int i = 0; i < test_part.min_matches; i++ )
             literal += test_part.literal;
 
          if( !match_literal( literal, text, text.length( ) - literal_size( literal ) ) )
@@ -1117,7 +1572,7 @@ string::size_type regex::impl::do_search(
             bool old_okay = okay;
             size_t old_finishes( finishes );
 
-            if( j == matched_last_part )
+            if( ( int )j == matched_last_part )
                already_matched = true;
             else
             {
@@ -1303,7 +1758,7 @@ string::size_type regex::impl::do_search(
                node_refs[ ref_starts ] = text.substr( ref_started, ref_finished - ref_started );
             }
 
-            bool was_last_part = ( matched_last_part == parts.size( ) - 1 );
+            bool was_last_part = ( matched_last_part == ( int )parts.size( ) - 1 );
             matched_last_part = -1;
 
             bool force_repeat = false;
@@ -1536,7 +1991,7 @@ string::size_type regex::impl::do_search(
                if( j != parts.size( ) - 1 || finishes != text.length( ) - 1
                 || ( parts[ j ].type == e_part_type_lit && parts[ j ].literal != "\b" )
                 || ( parts[ j ].type == e_part_type_set && parts[ j ].inverted
-                && ( text.size( ) < parts[ j ].min_matches
+                && ( text.size( ) < ( size_t )parts[ j ].min_matches
                 || !match_set( text, text.size( ) - parts[ j ].min_matches, parts[ j ] ) ) ) )
                {
                   okay = false;
@@ -1674,13 +2129,13 @@ void regex::impl::dump( ostream& os )
    os << endl;
 }
 
-regex::regex( const string& expr )
+regex::regex( const string& expr, bool use_dfa )
 {
 #ifdef DEBUG
    try
    {
 #endif
-      p_impl = new regex::impl( expr );
+      p_impl = new regex::impl( expr, use_dfa );
 #ifdef DEBUG
    }
    catch( exception& x )
@@ -1721,6 +2176,85 @@ void regex::dump( ostream& os )
    p_impl->dump( os );
 }
 
+struct multi_regex::impl
+{
+   ~impl( )
+   {
+      for( size_t i = 0; i < regexes.size( ); i++ )
+         delete regexes[ i ];
+   }
+
+   automaton dfa;
+
+   vector< bool > has_dfa;
+   vector< regex* > regexes;
+};
+
+multi_regex::multi_regex( )
+{
+   p_impl = new impl;
+}
+
+multi_regex::~multi_regex( )
+{
+   delete p_impl;
+}
+
+size_t multi_regex::add( const string& expr )
+{
+   auto_ptr< regex > ap_regex( new regex( expr, false ) );
+
+   regex::impl& r( *ap_regex->p_impl );
+
+   size_t index = p_impl->regexes.size( );
+
+   p_impl->has_dfa.push_back( p_impl->dfa.add_expression( r.parts, r.match_at_finish, index ) );
+   p_impl->regexes.push_back( ap_regex.release( ) );
+
+   return index;
+}
+
+size_t multi_regex::size( ) const
+{
+   return p_impl->regexes.size( );
+}
+
+const regex& multi_regex::get_regex( size_t index ) const
+{
+   if( index >= p_impl->regexes.size( ) )
+      throw runtime_error( "invalid index #" + to_string( index ) + " in multi_regex::get_regex" );
+
+   return *p_impl->regexes[ index ];
+}
+
+size_t multi_regex::search( const string& text, vector< regex_match >& matches )
+{
+   size_t num_matched = 0;
+
+   vector< bool > possible( p_impl->regexes.size( ) );
+
+   p_impl->dfa.scan( text, possible );
+
+   for( size_t i = 0; i < p_impl->regexes.size( ); i++ )
+   {
+      if( p_impl->has_dfa[ i ] && !possible[ i ] )
+         continue;
+
+      regex_match match;
+
+      match.index = i;
+      match.pos = p_impl->regexes[ i ]->search( text, &match.length, &match.refs );
+
+      if( match.pos != string::npos )
+      {
+         ++num_matched;
+         matches.push_back( match );
+      }
+   }
+
+   return num_matched;
+}
+
 #ifdef COMPILE_TESTBED_MAIN
 int main( )
 {
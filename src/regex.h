@@ -29,10 +29,19 @@ const char* const c_regex_floating_point_number = "[-+]?[0-9]+\\.[0-9]+";
 // supported and alternations (such as: one|two|three) are also not supported (the latter could
 // be added without too much difficulty). The design choices were made in order to do the least
 // number of comparisons while still supporting non-trivial expressions.
+//
+// Unless "use_dfa" is false (or the expression contains back references or repeats a part other
+// than its last) the expression is also compiled into an automaton whose DFA states are built
+// lazily (and cached) as text is scanned. A single pass of this DFA is able to determine that no
+// match is possible (which is the usual outcome when searching through large amounts of text) so
+// that the matching described above is only performed when the DFA has found that a match might
+// be possible (and so the results are always those of the matching described above).
 class regex
 {
+   friend class multi_regex;
+
    public:
-   regex( const std::string& expr );
+   regex( const std::string& expr, bool use_dfa = true );
    ~regex( );
 
    std::string get_expr( ) const;
@@ -48,6 +57,49 @@ class regex
    private:
    struct impl;
    impl* p_impl;
+
+   regex( const regex& );
+   regex& operator =( const regex& );
+};
+
+struct regex_match
+{
+   regex_match( ) : index( 0 ), pos( std::string::npos ), length( 0 ) { }
+
+   size_t index;
+
+   std::string::size_type pos;
+   std::string::size_type length;
+
+   std::vector< std::string > refs;
+};
+
+// NOTE: Used to search for many expressions in the same text. The DFAs for all the expressions
+// are combined so that only one pass through the text is required in order to determine which
+// of the expressions could match (and only those are then searched for in order to determine
+// their match positions, lengths and refs).
+class multi_regex
+{
+   public:
+   multi_regex( );
+   ~multi_regex( );
+
+   size_t add( const std::string& expr );
+
+   size_t size( ) const;
+
+   const regex& get_regex( size_t index ) const;
+
+   // NOTE: Appends a "regex_match" for each expression that was matched (in the same order that
+   // expressions were added) and returns the number of expressions that were matched.
+   size_t search( const std::string& text, std::vector< regex_match >& matches );
+
+   private:
+   struct impl;
+   impl* p_impl;
+
+   multi_regex( const multi_regex& );
+   multi_regex& operator =( const multi_regex& );
 };
 
 #endif
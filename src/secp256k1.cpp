@@ -0,0 +1,865 @@
+// Copyright (c) 2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef PRECOMPILE_H
+#  include "precompile.h"
+#endif
+#pragma hdrstop
+
+#ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <cstring>
+#endif
+
+#include "secp256k1.h"
+
+#include "ptypes.h"
+#include "threads.h"
+
+using namespace std;
+
+#ifdef HAS_SECP256K1_VERIFY
+
+// NOTE: Field elements (mod p) and scalars (mod n) are held as four 64 bit limbs (least
+// significant first) and are always kept fully reduced. As both p and n are just below
+// 2^256 reduction is performed by "folding" the high half of a product back into the
+// low half (after multiplying it by 2^256 mod p or 2^256 mod n). Points are held using
+// Jacobian coordinates (x = X/Z^2, y = Y/Z^3) so that no inversions are required when
+// verifying (with the "r" value being compared against X after being multiplied by Z^2).
+// A table of multiples of G for each 4 bit window is created (once) so that u1 * G only
+// requires additions whilst u2 * Q uses a simple 4 bit fixed window.
+
+namespace
+{
+
+__extension__ typedef unsigned __int128 uint128;
+
+const size_t c_num_limbs = 4;
+const size_t c_num_windows = 64;
+const size_t c_window_size = 16;
+
+const uint64_t c_fold_p = 0x1000003d1ULL;
+
+const uint64_t c_p[ c_num_limbs ] =
+{
+   0xfffffffefffffc2fULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL
+};
+
+const uint64_t c_n[ c_num_limbs ] =
+{
+   0xbfd25e8cd0364141ULL, 0xbaaedce6af48a03bULL, 0xfffffffffffffffeULL, 0xffffffffffffffffULL
+};
+
+const uint64_t c_fold_n[ 3 ] = { 0x402da1732fc9bebfULL, 0x4551231950b75fc4ULL, 0x1ULL };
+
+const uint64_t c_gx[ c_num_limbs ] =
+{
+   0x59f2815b16f81798ULL, 0x029bfcdb2dce28d9ULL, 0x55a06295ce870b07ULL, 0x79be667ef9dcbbacULL
+};
+
+const uint64_t c_gy[ c_num_limbs ] =
+{
+   0x9c47d08ffb10d4b8ULL, 0xfd17b448a6855419ULL, 0x5da4fbfc0e1108a8ULL, 0x483ada7726a3c465ULL
+};
+
+struct u256
+{
+   uint64_t v[ c_num_limbs ];
+};
+
+typedef u256 field;
+typedef u256 scalar;
+
+struct affine_point
+{
+   field x;
+   field y;
+};
+
+struct jacobian_point
+{
+   field x;
+   field y;
+   field z;
+
+   bool is_infinity;
+};
+
+mutex g_mutex;
+
+bool g_has_table = false;
+
+affine_point g_g_table[ c_num_windows ][ c_window_size ];
+
+inline void set_limbs( u256& r, const uint64_t* p_limbs )
+{
+   for( size_t i = 0; i < c_num_limbs; i++ )
+      r.v[ i ] = p_limbs[ i ];
+}
+
+inline void set_small( u256& r, uint64_t val )
+{
+   r.v[ 0 ] = val;
+   r.v[ 1 ] = r.v[ 2 ] = r.v[ 3 ] = 0;
+}
+
+inline bool is_zero( const u256& a )
+{
+   return ( a.v[ 0 ] | a.v[ 1 ] | a.v[ 2 ] | a.v[ 3 ] ) == 0;
+}
+
+inline bool is_equal( const u256& a, const u256& b )
+{
+   return a.v[ 0 ] == b.v[ 0 ] && a.v[ 1 ] == b.v[ 1 ] && a.v[ 2 ] == b.v[ 2 ] && a.v[ 3 ] == b.v[ 3 ];
+}
+
+inline bool is_less( const u256& a, const uint64_t* p_limbs )
+{
+   for( size_t i = c_num_limbs; i > 0; i-- )
+   {
+      if( a.v[ i - 1 ] != p_limbs[ i - 1 ] )
+         return a.v[ i - 1 ] < p_limbs[ i - 1 ];
+   }
+
+   return false;
+}
+
+// NOTE: Returns the borrow.
+inline uint64_t sub_limbs( u256& r, const u256& a, const uint64_t* p_limbs )
+{
+   uint64_t borrow = 0;
+
+   for( size_t i = 0; i < c_num_limbs; i++ )
+   {
+      uint128 t = ( uint128 )a.v[ i ] - p_limbs[ i ] - borrow;
+
+      r.v[ i ] = ( uint64_t )t;
+      borrow = ( uint64_t )( t >> 64 ) & 1;
+   }
+
+   return borrow;
+}
+
+void from_bytes( u256& r, const unsigned char* p_bytes )
+{
+   for( size_t i = 0; i < c_num_limbs; i++ )
+   {
+      uint64_t val = 0;
+
+      for( size_t j = 0; j < 8; j++ )
+         val = ( val << 8 ) | p_bytes[ ( ( c_num_limbs - 1 - i ) * 8 ) + j ];
+
+      r.v[ i ] = val;
+   }
+}
+
+void to_bytes( unsigned char* p_bytes, const u256& a )
+{
+   for( size_t i = 0; i < c_num_limbs; i++ )
+   {
+      uint64_t val = a.v[ i ];
+
+      for( size_t j = 0; j < 8; j++ )
+         p_bytes[ ( ( c_num_limbs - 1 - i ) * 8 ) + ( 7 - j ) ] = ( unsigned char )( val >> ( j * 8 ) );
+   }
+}
+
+void mul_limbs( uint64_t t[ c_num_limbs * 2 ], const u256& a, const u256& b )
+{
+   memset( t, 0, sizeof( uint64_t ) * c_num_limbs * 2 );
+
+   for( size_t i = 0; i < c_num_limbs; i++ )
+   {
+      uint128 carry = 0;
+
+      for( size_t j = 0; j < c_num_limbs; j++ )
+      {
+         carry += ( uint128 )a.v[ i ] * b.v[ j ] + t[ i + j ];
+
+         t[ i + j ] = ( uint64_t )carry;
+         carry >>= 64;
+      }
+
+      t[ i + c_num_limbs ] = ( uint64_t )carry;
+   }
+}
+
+// NOTE: Adds 2^256 - p (which is the same as subtracting p) with the carry being ignored.
+inline void add_fold_p( field& r )
+{
+   uint128 t = ( uint128 )r.v[ 0 ] + c_fold_p;
+   r.v[ 0 ] = ( uint64_t )t;
+
+   for( size_t i = 1; i < c_num_limbs; i++ )
+   {
+      t = ( t >> 64 ) + r.v[ i ];
+      r.v[ i ] = ( uint64_t )t;
+   }
+}
+
+void fe_reduce( field& r, const uint64_t t[ c_num_limbs * 2 ] )
+{
+   uint64_t m[ c_num_limbs ];
+
+   uint128 acc = 0;
+
+   for( size_t i = 0; i < c_num_limbs; i++ )
+   {
+      acc += ( uint128 )t[ i + c_num_limbs ] * c_fold_p + t[ i ];
+
+      m[ i ] = ( uint64_t )acc;
+      acc >>= 64;
+   }
+
+   acc = ( uint128 )( uint64_t )acc * c_fold_p + m[ 0 ];
+   r.v[ 0 ] = ( uint64_t )acc;
+
+   for( size_t i = 1; i < c_num_limbs; i++ )
+   {
+      acc = ( acc >> 64 ) + m[ i ];
+      r.v[ i ] = ( uint64_t )acc;
+   }
+
+   if( acc >> 64 )
+      add_fold_p( r );
+
+   if( !is_less( r, c_p ) )
+      add_fold_p( r );
+}
+
+inline void fe_mul( field& r, const field& a, const field& b )
+{
+   uint64_t t[ c_num_limbs * 2 ];
+
+   mul_limbs( t, a, b );
+   fe_reduce( r, t );
+}
+
+inline void fe_sqr( field& r, const field& a )
+{
+   fe_mul( r, a, a );
+}
+
+inline void fe_add( field& r, const field& a, const field& b )
+{
+   uint128 t = 0;
+
+   for( size_t i = 0; i < c_num_limbs; i++ )
+   {
+      t += ( uint128 )a.v[ i ] + b.v[ i ];
+
+      r.v[ i ] = ( uint64_t )t;
+      t >>= 64;
+   }
+
+   if( t || !is_less( r, c_p ) )
+      add_fold_p( r );
+}
+
+inline void fe_sub( field& r, const field& a, const field& b )
+{
+   if( sub_limbs( r, a, b.v ) )
+   {
+      // NOTE: Adds p by subtracting 2^256 - p (with the borrow being ignored).
+      uint128 t = ( uint128 )r.v[ 0 ] - c_fold_p;
+      r.v[ 0 ] = ( uint64_t )t;
+
+      uint64_t borrow = ( uint64_t )( t >> 64 ) & 1;
+
+      for( size_t i = 1; i < c_num_limbs; i++ )
+      {
+         t = ( uint128 )r.v[ i ] - borrow;
+
+         r.v[ i ] = ( uint64_t )t;
+         borrow = ( uint64_t )( t >> 64 ) & 1;
+      }
+   }
+}
+
+void fe_pow( field& r, const field& a, const u256& exponent )
+{
+   field result;
+   set_small( result, 1 );
+
+   for( size_t i = c_num_limbs * 64; i > 0; i-- )
+   {
+      fe_sqr( result, result );
+
+      if( ( exponent.v[ ( i - 1 ) / 64 ] >> ( ( i - 1 ) % 64 ) ) & 1 )
+         fe_mul( result, result, a );
+   }
+
+   r = result;
+}
+
+void fe_inv( field& r, const field& a )
+{
+   u256 exponent;
+
+   u256 two;
+   set_small( two, 2 );
+
+   set_limbs( exponent, c_p );
+   sub_limbs( exponent, exponent, two.v );
+
+   fe_pow( r, a, exponent );
+}
+
+// NOTE: Returns false if "a" is not a quadratic residue.
+bool fe_sqrt( field& r, const field& a )
+{
+   // NOTE: As p = 3 mod 4 the square root is a^((p + 1) / 4).
+   u256 exponent, p_plus_one;
+   set_limbs( p_plus_one, c_p );
+
+   // NOTE: The lowest limb of p cannot overflow when incremented.
+   ++p_plus_one.v[ 0 ];
+
+   for( size_t i = 0; i < c_num_limbs; i++ )
+      exponent.v[ i ] = ( p_plus_one.v[ i ] >> 2 ) | ( i < c_num_limbs - 1 ? p_plus_one.v[ i + 1 ] << 62 : 0 );
+
+   fe_pow( r, a, exponent );
+
+   field check;
+   fe_sqr( check, r );
+
+   return is_equal( check, a );
+}
+
+// NOTE: Folds the high half back into the low half until the value is less than n.
+void sc_reduce( scalar& r, const uint64_t t[ c_num_limbs * 2 ] )
+{
+   uint64_t u[ c_num_limbs * 2 ];
+   memcpy( u, t, sizeof( u ) );
+
+   while( u[ 4 ] | u[ 5 ] | u[ 6 ] | u[ 7 ] )
+   {
+      uint64_t hi[ c_num_limbs ] = { u[ 4 ], u[ 5 ], u[ 6 ], u[ 7 ] };
+
+      u[ 4 ] = u[ 5 ] = u[ 6 ] = u[ 7 ] = 0;
+
+      for( size_t i = 0; i < c_num_limbs; i++ )
+      {
+         uint128 carry = 0;
+
+         for( size_t j = 0; j < 3; j++ )
+         {
+            carry += ( uint128 )hi[ i ] * c_fold_n[ j ] + u[ i + j ];
+
+            u[ i + j ] = ( uint64_t )carry;
+            carry >>= 64;
+         }
+
+         for( size_t k = i + 3; carry && k < c_num_limbs * 2; k++ )
+         {
+            carry += u[ k ];
+
+            u[ k ] = ( uint64_t )carry;
+            carry >>= 64;
+         }
+      }
+   }
+
+   for( size_t i = 0; i < c_num_limbs; i++ )
+      r.v[ i ] = u[ i ];
+
+   while( !is_less( r, c_n ) )
+      sub_limbs( r, r, c_n );
+}
+
+inline void sc_mul( scalar& r, const scalar& a, const scalar& b )
+{
+   uint64_t t[ c_num_limbs * 2 ];
+
+   mul_limbs( t, a, b );
+   sc_reduce( r, t );
+}
+
+void sc_inv( scalar& r, const scalar& a )
+{
+   u256 exponent;
+
+   u256 two;
+   set_small( two, 2 );
+
+   set_limbs( exponent, c_n );
+   sub_limbs( exponent, exponent, two.v );
+
+   scalar result;
+   set_small( result, 1 );
+
+   for( size_t i = c_num_limbs * 64; i > 0; i-- )
+   {
+      sc_mul( result, result, result );
+
+      if( ( exponent.v[ ( i - 1 ) / 64 ] >> ( ( i - 1 ) % 64 ) ) & 1 )
+         sc_mul( result, result, a );
+   }
+
+   r = result;
+}
+
+inline size_t nibble( const scalar& a, size_t window )
+{
+   return ( a.v[ window / 16 ] >> ( ( window % 16 ) * 4 ) ) & 0x0f;
+}
+
+bool is_on_curve( const field& x, const field& y )
+{
+   field lhs, rhs, seven;
+
+   set_small( seven, 7 );
+
+   fe_sqr( lhs, y );
+
+   fe_sqr( rhs, x );
+   fe_mul( rhs, rhs, x );
+   fe_add( rhs, rhs, seven );
+
+   return is_equal( lhs, rhs );
+}
+
+void set_affine( jacobian_point& r, const affine_point& a )
+{
+   r.x = a.x;
+   r.y = a.y;
+
+   set_small( r.z, 1 );
+
+   r.is_infinity = false;
+}
+
+void to_affine( affine_point& r, const jacobian_point& a )
+{
+   field zinv, zinv2, zinv3;
+
+   fe_inv( zinv, a.z );
+   fe_sqr( zinv2, zinv );
+   fe_mul( zinv3, zinv2, zinv );
+
+   fe_mul( r.x, a.x, zinv2 );
+   fe_mul( r.y, a.y, zinv3 );
+}
+
+void point_double( jacobian_point& r, const jacobian_point& a )
+{
+   if( a.is_infinity || is_zero( a.y ) )
+   {
+      r.is_infinity = true;
+      return;
+   }
+
+   field a2, b, c, d, e, f, t;
+
+   fe_sqr( a2, a.x );
+   fe_sqr( b, a.y );
+   fe_sqr( c, b );
+
+   // NOTE: d = 2 * ((x + b)^2 - a2 - c)
+   fe_add( t, a.x, b );
+   fe_sqr( t, t );
+   fe_sub( t, t, a2 );
+   fe_sub( t, t, c );
+   fe_add( d, t, t );
+
+   // NOTE: e = 3 * a2 and f = e^2
+   fe_add( e, a2, a2 );
+   fe_add( e, e, a2 );
+   fe_sqr( f, e );
+
+   field z;
+   fe_mul( z, a.y, a.z );
+
+   // NOTE: x3 = f - 2 * d
+   fe_sub( r.x, f, d );
+   fe_sub( r.x, r.x, d );
+
+   // NOTE: y3 = e * (d - x3) - 8 * c
+   fe_add( c, c, c );
+   fe_add( c, c, c );
+   fe_add( c, c, c );
+
+   fe_sub( t, d, r.x );
+   fe_mul( t, e, t );
+   fe_sub( r.y, t, c );
+
+   // NOTE: z3 = 2 * y * z
+   fe_add( r.z, z, z );
+
+   r.is_infinity = false;
+}
+
+// NOTE: The values u1, s1, u2 and s2 are the x and y values of each point after they have
+// been scaled to the same z (so that the following is common to both types of addition).
+void finish_add( jacobian_point& r, const jacobian_point& a,
+ const field& u1, const field& s1, const field& u2, const field& s2, const field& z )
+{
+   field h, rr;
+
+   fe_sub( h, u2, u1 );
+   fe_sub( rr, s2, s1 );
+
+   if( is_zero( h ) )
+   {
+      if( is_zero( rr ) )
+         point_double( r, a );
+      else
+         r.is_infinity = true;
+
+      return;
+   }
+
+   field h2, h3, u1h2, t;
+
+   fe_sqr( h2, h );
+   fe_mul( h3, h2, h );
+   fe_mul( u1h2, u1, h2 );
+
+   // NOTE: x3 = rr^2 - h3 - 2 * u1h2
+   fe_sqr( t, rr );
+   fe_sub( t, t, h3 );
+   fe_sub( t, t, u1h2 );
+   fe_sub( t, t, u1h2 );
+
+   field y;
+
+   // NOTE: y3 = rr * (u1h2 - x3) - s1 * h3
+   fe_sub( y, u1h2, t );
+   fe_mul( y, rr, y );
+
+   fe_mul( h3, s1, h3 );
+   fe_sub( r.y, y, h3 );
+
+   r.x = t;
+
+   fe_mul( r.z, z, h );
+
+   r.is_infinity = false;
+}
+
+void point_add( jacobian_point& r, const jacobian_point& a, const jacobian_point& b )
+{
+   if( a.is_infinity )
+   {
+      r = b;
+      return;
+   }
+
+   if( b.is_infinity )
+   {
+      r = a;
+      return;
+   }
+
+   field z1z1, z2z2, u1, u2, s1, s2, z;
+
+   fe_sqr( z1z1, a.z );
+   fe_sqr( z2z2, b.z );
+
+   fe_mul( u1, a.x, z2z2 );
+   fe_mul( u2, b.x, z1z1 );
+
+   fe_mul( s1, a.y, b.z );
+   fe_mul( s1, s1, z2z2 );
+
+   fe_mul( s2, b.y, a.z );
+   fe_mul( s2, s2, z1z1 );
+
+   fe_mul( z, a.z, b.z );
+
+   jacobian_point result;
+   finish_add( result, a, u1, s1, u2, s2, z );
+
+   r = result;
+}
+
+void point_add_affine( jacobian_point& r, const jacobian_point& a, const affine_point& b )
+{
+   if( a.is_infinity )
+   {
+      set_affine( r, b );
+      return;
+   }
+
+   field z1z1, u2, s2;
+
+   fe_sqr( z1z1, a.z );
+
+   fe_mul( u2, b.x, z1z1 );
+
+   fe_mul( s2, b.y, a.z );
+   fe_mul( s2, s2, z1z1 );
+
+   jacobian_point result;
+   finish_add( result, a, a.x, a.y, u2, s2, a.z );
+
+   r = result;
+}
+
+void build_g_table( )
+{
+   jacobian_point base;
+
+   set_limbs( base.x, c_gx );
+   set_limbs( base.y, c_gy );
+   set_small( base.z, 1 );
+
+   base.is_infinity = false;
+
+   for( size_t i = 0; i < c_num_windows; i++ )
+   {
+      jacobian_point next( base );
+
+      for( size_t j = 1; j < c_window_size; j++ )
+      {
+         to_affine( g_g_table[ i ][ j ], next );
+         point_add( next, next, base );
+      }
+
+      for( size_t j = 0; j < 4; j++ )
+         point_double( base, base );
+   }
+}
+
+bool parse_der_integer( const unsigned char*& p, const unsigned char* p_end, scalar& s )
+{
+   if( p_end - p < 2 || p[ 0 ] != 0x02 )
+      return false;
+
+   size_t length = p[ 1 ];
+
+   p += 2;
+
+   // NOTE: As OpenSSL will only accept a signature if its re-encoding is identical the
+   // length must be in its short form and the value must be both positive and minimal.
+   if( !length || length > c_secp256k1_coordinate_size + 1 || ( size_t )( p_end - p ) < length )
+      return false;
+
+   if( p[ 0 ] & 0x80 )
+      return false;
+
+   if( length > 1 && !p[ 0 ] && !( p[ 1 ] & 0x80 ) )
+      return false;
+
+   // NOTE: A value that needs all 33 bytes will be too large (so is rejected here).
+   if( length == c_secp256k1_coordinate_size + 1 )
+   {
+      if( p[ 0 ] )
+         return false;
+
+      ++p;
+      --length;
+   }
+
+   unsigned char buf[ c_secp256k1_coordinate_size ];
+
+   memset( buf, 0, sizeof( buf ) );
+   memcpy( buf + sizeof( buf ) - length, p, length );
+
+   p += length;
+
+   from_bytes( s, buf );
+
+   return true;
+}
+
+}
+
+bool has_secp256k1_verify( )
+{
+   return true;
+}
+
+bool secp256k1_parse_public_key( const unsigned char* p_encoded, size_t length, secp256k1_point& point )
+{
+   point.is_valid = false;
+
+   if( !p_encoded || !length )
+      return false;
+
+   unsigned char type = p_encoded[ 0 ];
+
+   field x, y;
+
+   if( ( type == 0x02 || type == 0x03 ) && length == c_secp256k1_coordinate_size + 1 )
+   {
+      from_bytes( x, p_encoded + 1 );
+
+      if( !is_less( x, c_p ) )
+         return false;
+
+      field rhs, seven;
+      set_small( seven, 7 );
+
+      fe_sqr( rhs, x );
+      fe_mul( rhs, rhs, x );
+      fe_add( rhs, rhs, seven );
+
+      if( !fe_sqrt( y, rhs ) )
+         return false;
+
+      if( ( y.v[ 0 ] & 1 ) != ( type & 1 ) )
+      {
+         field zero;
+         set_small( zero, 0 );
+
+         fe_sub( y, zero, y );
+      }
+   }
+   else if( ( type == 0x04 || type == 0x06 || type == 0x07 ) && length == ( c_secp256k1_coordinate_size * 2 ) + 1 )
+   {
+      from_bytes( x, p_encoded + 1 );
+      from_bytes( y, p_encoded + 1 + c_secp256k1_coordinate_size );
+
+      if( !is_less( x, c_p ) || !is_less( y, c_p ) || !is_on_curve( x, y ) )
+         return false;
+
+      // NOTE: The "hybrid" form also includes the parity of y (which must be correct).
+      if( type != 0x04 && ( y.v[ 0 ] & 1 ) != ( type & 1 ) )
+         return false;
+   }
+   else
+      return false;
+
+   to_bytes( point.x, x );
+   to_bytes( point.y, y );
+
+   point.is_valid = true;
+
+   return true;
+}
+
+bool secp256k1_verify_signature( const secp256k1_point& point,
+ const unsigned char* p_digest, const unsigned char* p_signature, size_t signature_length )
+{
+   if( !point.is_valid || !p_digest || !p_signature )
+      return false;
+
+   const unsigned char* p = p_signature;
+   const unsigned char* p_end = p_signature + signature_length;
+
+   if( signature_length < 2 || p[ 0 ] != 0x30 || ( p[ 1 ] & 0x80 ) || p[ 1 ] != signature_length - 2 )
+      return false;
+
+   p += 2;
+
+   scalar r, s;
+
+   if( !parse_der_integer( p, p_end, r ) || !parse_der_integer( p, p_end, s ) || p != p_end )
+      return false;
+
+   if( is_zero( r ) || is_zero( s ) || !is_less( r, c_n ) || !is_less( s, c_n ) )
+      return false;
+
+   // NOTE: Scope for guard object.
+   {
+      guard g( g_mutex );
+
+      if( !g_has_table )
+      {
+         build_g_table( );
+         g_has_table = true;
+      }
+   }
+
+   scalar z, w, u1, u2;
+
+   from_bytes( z, p_digest );
+
+   if( !is_less( z, c_n ) )
+      sub_limbs( z, z, c_n );
+
+   sc_inv( w, s );
+
+   sc_mul( u1, z, w );
+   sc_mul( u2, r, w );
+
+   affine_point q;
+
+   from_bytes( q.x, point.x );
+   from_bytes( q.y, point.y );
+
+   jacobian_point q_table[ c_window_size ];
+
+   set_affine( q_table[ 1 ], q );
+
+   for( size_t i = 2; i < c_window_size; i++ )
+      point_add_affine( q_table[ i ], q_table[ i - 1 ], q );
+
+   jacobian_point result;
+   result.is_infinity = true;
+
+   for( size_t i = c_num_windows; i > 0; i-- )
+   {
+      for( size_t j = 0; j < 4; j++ )
+         point_double( result, result );
+
+      size_t digit = nibble( u2, i - 1 );
+
+      if( digit )
+         point_add( result, result, q_table[ digit ] );
+   }
+
+   for( size_t i = 0; i < c_num_windows; i++ )
+   {
+      size_t digit = nibble( u1, i );
+
+      if( digit )
+         point_add_affine( result, result, g_g_table[ i ][ digit ] );
+   }
+
+   if( result.is_infinity )
+      return false;
+
+   // NOTE: Rather than converting X to affine "r" is multiplied by Z^2 (and as x mod n
+   // is compared then r + n also needs to be checked if it is less than p).
+   field z2, rz2;
+
+   fe_sqr( z2, result.z );
+   fe_mul( rz2, r, z2 );
+
+   if( is_equal( rz2, result.x ) )
+      return true;
+
+   u256 p_minus_n;
+   set_limbs( p_minus_n, c_p );
+   sub_limbs( p_minus_n, p_minus_n, c_n );
+
+   if( is_less( r, p_minus_n.v ) )
+   {
+      field rn;
+
+      u256 n;
+      set_limbs( n, c_n );
+
+      fe_add( rn, r, n );
+      fe_mul( rz2, rn, z2 );
+
+      if( is_equal( rz2, result.x ) )
+         return true;
+   }
+
+   return false;
+}
+
+#else
+
+bool has_secp256k1_verify( )
+{
+   return false;
+}
+
+bool secp256k1_parse_public_key( const unsigned char*, size_t, secp256k1_point& point )
+{
+   point.is_valid = false;
+
+   return false;
+}
+
+bool secp256k1_verify_signature( const secp256k1_point&, const unsigned char*, const unsigned char*, size_t )
+{
+   return false;
+}
+
+#endif
@@ -0,0 +1,46 @@
+// Copyright (c) 2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SECP256K1_H
+#  define SECP256K1_H
+
+#  ifndef HAS_PRECOMPILED_STD_HEADERS
+#     include <cstddef>
+#  endif
+
+#  include "config.h"
+
+// NOTE: The verifier is only included if "use_secp256k1" has been set in "config.info" and
+// as the field arithmetic requires 128 bit integers these also need to be available. If not
+// included then the functions below are still declared but verification will always fail
+// (and "has_secp256k1_verify" will return false so that callers can use OpenSSL instead).
+#  if defined( SECP256K1_SUPPORT ) && defined( __GNUC__ ) && defined( __SIZEOF_INT128__ )
+#     define HAS_SECP256K1_VERIFY
+#  endif
+
+const size_t c_secp256k1_digest_size = 32;
+const size_t c_secp256k1_coordinate_size = 32;
+
+struct secp256k1_point
+{
+   secp256k1_point( ) : is_valid( false ) { }
+
+   bool is_valid;
+
+   unsigned char x[ c_secp256k1_coordinate_size ];
+   unsigned char y[ c_secp256k1_coordinate_size ];
+};
+
+bool has_secp256k1_verify( );
+
+// NOTE: Accepts the same (compressed, uncompressed and hybrid) encodings as OpenSSL does.
+bool secp256k1_parse_public_key( const unsigned char* p_encoded, size_t length, secp256k1_point& point );
+
+// NOTE: The signature must be a strict DER encoding (as is required by OpenSSL) and the digest
+// must be "c_secp256k1_digest_size" bytes (with the result being identical to ECDSA_verify).
+bool secp256k1_verify_signature( const secp256k1_point& point,
+ const unsigned char* p_digest, const unsigned char* p_signature, size_t signature_length );
+
+#endif
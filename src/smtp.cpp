@@ -161,8 +161,10 @@ bool get_response( string& text, tcp_socket& socket,
             if( prefix != c_smtp_prefix_info && prefix != c_smtp_prefix_okay
              && prefix != c_smtp_prefix_auth && prefix != c_smtp_prefix_user && prefix != c_smtp_prefix_data )
                okay = false;
-            // NOTE: If the prefix is followed by a "space" then no further lines are expected.
-            else if( response[ c_smtp_prefix_length ] == ' ' )
+
+            // NOTE: If the prefix is followed by a "space" then no further lines are expected (which
+            // also applies to error replies so that a rejection need not wait for a read timeout).
+            if( response[ c_smtp_prefix_length ] == ' ' )
                break;
          }
          else
@@ -306,15 +308,11 @@ string transform_header_to_utf_8_if_required( const string& header )
       return header.substr( 0, start + 1 ) + "=?utf-8?B?" + base64::encode( header.substr( start + 1 ) ) + "?=";
 }
 
-void send_message( const string& host_and_port,
- const smtp_user_info& user_info, const vector< string >& recipients,
- const string& subject, const string* p_message = 0, const vector< string >* p_extra_headers = 0,
- const vector< string >* p_file_names = 0, const string* p_html = 0, const vector< string >* p_image_names = 0,
- const string* p_image_path_prefix = 0, progress* p_progress = 0 )
+void split_host_and_port( const string& host_and_port, string& host, int& port )
 {
-   int port = c_smtp_default_port;
+   port = c_smtp_default_port;
 
-   string host( host_and_port );
+   host = host_and_port;
 
    string::size_type pos = host.find( ':' );
    if( pos != string::npos )
@@ -322,10 +320,24 @@ void send_message( const string& host_and_port,
       port = atoi( host.substr( pos + 1 ).c_str( ) );
       host.erase( pos );
    }
+}
 
-   if( p_progress )
-      p_progress->output_progress( "host = " + host + ", port = " + to_string( port ) );
+string envelope_address( const string& address )
+{
+   string::size_type pos = address.find( '<' );
+
+   if( pos == string::npos )
+      return "<" + address + ">\r\n";
+   else
+      return address.substr( pos ) + "\r\n";
+}
 
+string compose_message( const smtp_user_info& user_info,
+ const vector< string >& recipients, const string& subject, const string* p_message = 0,
+ const vector< string >* p_extra_headers = 0, const vector< string >* p_file_names = 0,
+ const string* p_html = 0, const vector< string >* p_image_names = 0,
+ const string* p_image_path_prefix = 0, progress* p_progress = 0 )
+{
    if( p_file_names )
    {
       int64_t num_bytes = INT64_C( 0 );
@@ -351,387 +363,491 @@ void send_message( const string& host_and_port,
          throw runtime_error( "maximum allowed attached file data exceeded" );
    }
 
-#ifdef SSL_SUPPORT
-   ssl_socket socket;
-#else
-   tcp_socket socket;
-#endif
-   bool okay = socket.open( );
-   if( okay )
-   {
-      ip_address address( host.c_str( ), port );
+   string from_header( "From: " );
+   from_header += user_info.address;
 
-      if( p_progress )
-         p_progress->output_progress( "connecting..." );
+   string to_header, cc_header;
 
-      if( socket.connect( address ) )
+   bool is_to = true;
+   bool is_cc = false;
+   for( size_t i = 0; i < recipients.size( ); i++ )
+   {
+      // NOTE: A "blank" recipient is used to separate the "To" header from the "Cc" one (any
+      // further "blank" recipient will cause subsequent recipients to be considered as "Bcc").
+      if( recipients[ i ].empty( ) )
       {
-#ifdef USE_NO_DELAY
-         socket.set_no_delay( );
-#endif
-#ifdef SSL_SUPPORT
-         // NOTE: For SSL all protocol is secure (unlike STARTTLS).
-         // FUTURE: After a successful SSL connection the server certificate should
-         // be checked (at the very least make sure that it is the host requested).
-         if( user_info.use_ssl )
-            socket.ssl_connect( );
-#endif
-         string str( "(connected now reading greeting)" );
+         if( !is_cc )
+         {
+            is_to = false;
+            is_cc = true;
+         }
+         else
+            is_cc = false;
 
-         // NOTE: Read (and ignore) the connection message...
-         if( !get_response( str, socket, c_initial_timeout, p_progress ) )
-            throw runtime_error( str );
+         continue;
+      }
 
-         if( user_info.auth_type == e_smtp_auth_type_none )
-         {
-            str = string( "HELO " );
-            str += user_info.domain;
-            socket.write_line( str );
+      if( is_to )
+      {
+         if( !to_header.empty( ) )
+            to_header += ", ";
+         else
+            to_header = "To: ";
 
-            if( !get_response( str, socket, c_initial_timeout, p_progress ) )
-               throw runtime_error( str );
-         }
+         to_header += recipients[ i ];
+      }
+      else if( is_cc )
+      {
+         if( !cc_header.empty( ) )
+            cc_header += ", ";
          else
-         {
-            str = string( "EHLO " );
-            str += user_info.domain;
-            socket.write_line( str );
+            cc_header = "Cc: ";
 
-            if( !get_response( str, socket, c_initial_timeout, p_progress ) )
-               throw runtime_error( str );
+         cc_header += recipients[ i ];
+      }
+   }
 
-#ifdef SSL_SUPPORT
-            // NOTE: For STARTTLS the initial EHLO is unsecure (enabling it to be
-            // compatible with non-secure SMTP) and therefore needs to be re-sent
-            // after the connection is secured.
-            if( !user_info.use_ssl && user_info.use_tls )
-            {
-               str = "STARTTLS";
-               socket.write_line( str );
+   string subject_header( "Subject: " );
+   subject_header += subject;
 
-               if( !get_response( str, socket, c_initial_timeout, p_progress ) )
-                  throw runtime_error( str );
+   string str( transform_header_to_utf_8_if_required( from_header ) );
+   str += string( "\r\n" );
 
-               // FUTURE: After a successful SSL connection the server certificate should
-               // be checked (at the very least make sure that it is the host requested).
-               socket.ssl_connect( );
+   str += transform_header_to_utf_8_if_required( subject_header );
+   str += string( "\r\n" );
 
-               str = string( "EHLO " );
-               str += user_info.domain;
-               socket.write_line( str );
+   str += transform_header_to_utf_8_if_required( to_header );
+   str += string( "\r\n" );
 
-               if( !get_response( str, socket, c_initial_timeout, p_progress ) )
-                  throw runtime_error( str );
-            }
-#endif
-            if( user_info.auth_type == e_smtp_auth_type_plain )
-            {
-               str = string( "AUTH PLAIN " );
+   if( !cc_header.empty( ) )
+   {
+      str += transform_header_to_utf_8_if_required( cc_header );
+      str += string( "\r\n" );
+   }
 
-               string auth_str( user_info.username );
-               auth_str += '\0';
-               auth_str += user_info.username;
-               auth_str += '\0';
-               auth_str += user_info.password;
+   date_time dt( date_time::standard( ) );
 
-               str += base64::encode( auth_str );
-            }
-            else if( user_info.auth_type == e_smtp_auth_type_login )
-               str = string( "AUTH LOGIN" );
-            else if( user_info.auth_type == e_smtp_auth_type_cram_md5 )
-               str = string( "AUTH CRAM-MD5" );
-            else
-               throw runtime_error( "unexpected smtp_auth_type in send_message" );
+   if( user_info.p_dt )
+      dt = *user_info.p_dt;
 
-            socket.write_line( str );
+   string date_header( "Date: " );
+   date_header += dt.weekday_name( ).substr( 0, 3 );
+   date_header += ", " + to_string( ( int )dt.get_day( ) ) + " " + dt.month_name( ).substr( 0, 3 );
+   date_header += " " + to_string( dt.get_year( ) );
+   date_header += " " + dt.get_time( ).as_string( e_time_format_hhmmss, true );
 
-            // NOTE: Don't allow progress tracking to see the password.
-            str.erase( );
+   if( user_info.utc_offset >= 0 )
+      date_header += " +";
+   else
+      date_header += " -";
 
-            if( !get_response( str, socket, c_initial_timeout, p_progress ) )
-               throw runtime_error( str );
+   if( abs( user_info.utc_offset ) < 10 )
+      date_header += "0";
+   date_header += to_string( ( int )user_info.utc_offset );
 
-            if( user_info.auth_type != e_smtp_auth_type_plain )
-            {
-               if( user_info.auth_type == e_smtp_auth_type_login )
-               {
-                  str = base64::encode( user_info.username );
-                  socket.write_line( str );
-
-                  if( !get_response( str, socket, c_initial_timeout, p_progress ) )
-                     throw runtime_error( str );
-
-                  str = base64::encode( user_info.password );
-                  socket.write_line( str );
-
-                  // NOTE: Don't allow progress tracking to see the password.
-                  str.erase( );
-
-                  if( !get_response( str, socket, c_initial_timeout, p_progress ) )
-                     throw runtime_error( str );
-               }
-               else if( user_info.auth_type == e_smtp_auth_type_cram_md5 )
-               {
-                  str = determine_challenge_response( str, user_info.username, user_info.password );
-                  socket.write_line( str );
-
-                  // NOTE: Don't allow progress tracking to see the password.
-                  str.erase( );
-
-                  if( !get_response( str, socket, c_initial_timeout, p_progress ) )
-                     throw runtime_error( str );
-               }
-            }
-         }
+   int minutes = ( int )( ( user_info.utc_offset - ( int )user_info.utc_offset ) * 60.0 );
 
-         str = string( "MAIL FROM:" );
-         string from_header( "From: " );
+   if( abs( minutes ) < 10 )
+      date_header += "0";
+   date_header += to_string( minutes );
 
-         string::size_type pos = user_info.address.find( '<' );
-         if( pos == string::npos )
-            str += "<" + user_info.address + ">\r\n";
-         else
-            str += user_info.address.substr( pos ) + "\r\n";
+   if( user_info.p_tz_abbr && !user_info.p_tz_abbr->empty( ) )
+      date_header += " (" + *user_info.p_tz_abbr + ")";
 
-         socket.write_line( str );
+   str += date_header;
+   str += string( "\r\n" );
 
-         from_header += user_info.address;
+   // NOTE: It is being assumed that if extra headers were supplied
+   // then Message-ID is amongst them.
+   if( !p_extra_headers )
+   {
+      string message_id_header( "Message-ID: <" );
+      message_id_header += uuid( ).as_string( ) + ">";
 
-         if( !get_response( str, socket, c_initial_timeout, p_progress ) )
-            throw runtime_error( str );
+      str += message_id_header;
+      str += string( "\r\n" );
+   }
+   else
+   {
+      for( size_t i = 0; i < p_extra_headers->size( ); i++ )
+      {
+         if( !( *p_extra_headers )[ i ].empty( ) )
+         {
+            str += transform_header_to_utf_8_if_required( ( *p_extra_headers )[ i ] );
+            str += string( "\r\n" );
+         }
+      }
+   }
 
-         string to_header, cc_header;
+   auto_ptr< mime_encoder > ap_mime;
 
-         bool is_to = true;
-         bool is_cc = false;
-         for( size_t i = 0; i < recipients.size( ); i++ )
+   bool has_html = ( p_html && !p_html->empty( ) );
+   bool has_files = ( p_file_names && !p_file_names->empty( ) );
+   bool has_images = ( p_image_names && !p_image_names->empty( ) );
+   bool has_message = ( p_message && !p_message->empty( ) );
+
+   const char* p_charset = 0;
+   if( user_info.p_charset )
+      p_charset = user_info.p_charset->c_str( );
+
+   string extracted_message;
+   if( has_html && !has_message )
+   {
+      extracted_message = extract_text_from_html( *p_html );
+      p_message = &extracted_message;
+      has_message = true;
+   }
+
+   // NOTE: If there is HTML or attached files then format the message as MIME.
+   if( has_html || has_files )
+   {
+      ap_mime.reset( new mime_encoder( ) );
+
+      if( has_html )
+      {
+         if( has_images )
          {
-            // NOTE: A "blank" recipient is used to separate the "To" header from the "Cc" one (any
-            // further "blank" recipient will cause subsequent recipients to be considered as "Bcc").
-            if( recipients[ i ].empty( ) )
+            ap_mime->create_child( "related" );
+
+            if( !has_message )
+               ap_mime->get_child( ).add_html( *p_html, p_charset );
+            else
             {
-               if( !is_cc )
-               {
-                  is_to = false;
-                  is_cc = true;
-               }
-               else
-                  is_cc = false;
-
-               continue;
+               ap_mime->get_child( ).create_child( "alternative" );
+               ap_mime->get_child( ).get_child( ).add_text( *p_message, p_charset );
+               ap_mime->get_child( ).get_child( ).add_html( *p_html, p_charset );
             }
 
-            str = string( "RCPT TO:" );
+            const char* p_path_prefix = 0;
+            if( p_image_path_prefix )
+               p_path_prefix = ( *p_image_path_prefix ).c_str( );
 
-            pos = recipients[ i ].find( '<' );
-            if( pos == string::npos )
-               str += "<" + recipients[ i ] + ">\r\n";
+            for( size_t i = 0; i < p_image_names->size( ); i++ )
+               ap_mime->get_child( ).add_image( ( *p_image_names )[ i ], p_path_prefix );
+         }
+         else
+         {
+            if( !has_message )
+               ap_mime->add_html( *p_html, p_charset );
             else
-               str += recipients[ i ].substr( pos ) + "\r\n";
+            {
+               ap_mime->create_child( "related" );
+               ap_mime->get_child( ).create_child( "alternative" );
+               ap_mime->get_child( ).get_child( ).add_text( *p_message, p_charset );
+               ap_mime->get_child( ).get_child( ).add_html( *p_html, p_charset );
+            }
+         }
+      }
+      else if( has_message )
+         ap_mime->add_text( *p_message, p_charset );
 
-            socket.write_line( str );
+      if( has_files )
+      {
+         for( size_t i = 0; i < p_file_names->size( ); i++ )
+            ap_mime->add_file( ( *p_file_names )[ i ] );
+      }
 
-            if( !get_response( str, socket, c_initial_timeout, p_progress ) )
-               throw runtime_error( str );
+      str += ap_mime->get_data( );
+   }
+   else if( p_message )
+   {
+      // NOTE: Limit the lines to one less than the maximum as a fullstop escape character
+      // may be required at the start of one or more lines.
+      string message_text( split_input_into_lines( *p_message, c_max_chars_per_line - 1 ) );
 
-            if( is_to )
-            {
-               if( !to_header.empty( ) )
-                  to_header += ", ";
-               else
-                  to_header = "To: ";
+      str += string( "\r\n" );
+      str += escape_fullstops_if_required( message_text );
+      str += string( "\r\n" );
+   }
 
-               to_header += recipients[ i ];
-            }
-            else if( is_cc )
-            {
-               if( !cc_header.empty( ) )
-                  cc_header += ", ";
-               else
-                  cc_header = "Cc: ";
+   return str;
+}
 
-               cc_header += recipients[ i ];
-            }
-         }
+}
 
-         str = string( "DATA\r\n" );
-         socket.write_line( str );
+struct smtp_connection::impl
+{
+   impl( const string& host_and_port, const smtp_user_info& user_info, progress* p_progress )
+    :
+    user_info( user_info ),
+    p_progress( p_progress ),
+    num_sent( 0 )
+   {
+      split_host_and_port( host_and_port, host, port );
+   }
 
-         if( !get_response( str, socket, c_initial_timeout, p_progress ) )
-            throw runtime_error( str );
+   string host;
+   int port;
 
-         string subject_header( "Subject: " );
-         subject_header += subject;
+   smtp_user_info user_info;
 
-         str = transform_header_to_utf_8_if_required( from_header );
-         str += string( "\r\n" );
+   progress* p_progress;
 
-         str += transform_header_to_utf_8_if_required( subject_header );
-         str += string( "\r\n" );
+   size_t num_sent;
 
-         str += transform_header_to_utf_8_if_required( to_header );
-         str += string( "\r\n" );
+#ifdef SSL_SUPPORT
+   ssl_socket socket;
+#else
+   tcp_socket socket;
+#endif
+};
 
-         if( !cc_header.empty( ) )
-         {
-            str += transform_header_to_utf_8_if_required( cc_header );
-            str += string( "\r\n" );
-         }
+smtp_connection::smtp_connection( const string& host, const smtp_user_info& user_info, progress* p_progress )
+{
+   p_impl = new impl( host, user_info, p_progress );
+}
 
-         date_time dt( date_time::standard( ) );
+smtp_connection::~smtp_connection( )
+{
+   if( p_impl->socket.okay( ) )
+      p_impl->socket.close( );
 
-         if( user_info.p_dt )
-            dt = *user_info.p_dt;
+   delete p_impl;
+}
 
-         string date_header( "Date: " );
-         date_header += dt.weekday_name( ).substr( 0, 3 );
-         date_header += ", " + to_string( ( int )dt.get_day( ) ) + " " + dt.month_name( ).substr( 0, 3 );
-         date_header += " " + to_string( dt.get_year( ) );
-         date_header += " " + dt.get_time( ).as_string( e_time_format_hhmmss, true );
+bool smtp_connection::is_open( ) const
+{
+   return p_impl->socket.okay( );
+}
 
-         if( user_info.utc_offset >= 0 )
-            date_header += " +";
-         else
-            date_header += " -";
+size_t smtp_connection::get_num_sent( ) const
+{
+   return p_impl->num_sent;
+}
+
+void smtp_connection::open( )
+{
+   if( is_open( ) )
+      return;
+
+   string& host( p_impl->host );
+   int port = p_impl->port;
 
-         if( abs( user_info.utc_offset ) < 10 )
-            date_header += "0";
-         date_header += to_string( ( int )user_info.utc_offset );
+   const smtp_user_info& user_info( p_impl->user_info );
 
-         int minutes = ( int )( ( user_info.utc_offset - ( int )user_info.utc_offset ) * 60.0 );
+   progress* p_progress = p_impl->p_progress;
 
-         if( abs( minutes ) < 10 )
-            date_header += "0";
-         date_header += to_string( minutes );
+#ifdef SSL_SUPPORT
+   ssl_socket& socket( p_impl->socket );
+#else
+   tcp_socket& socket( p_impl->socket );
+#endif
 
-         if( user_info.p_tz_abbr && !user_info.p_tz_abbr->empty( ) )
-            date_header += " (" + *user_info.p_tz_abbr + ")";
+   if( p_progress )
+      p_progress->output_progress( "host = " + host + ", port = " + to_string( port ) );
 
-         str += date_header;
-         str += string( "\r\n" );
+   if( !socket.open( ) )
+      throw runtime_error( "unable to open socket" );
+
+   try
+   {
+      ip_address address( host.c_str( ), port );
 
-         // NOTE: It is being assumed that if extra headers were supplied
-         // then Message-ID is amongst them.
-         if( !p_extra_headers )
+      if( p_progress )
+         p_progress->output_progress( "connecting..." );
+
+      if( !socket.connect( address ) )
+         throw runtime_error( "unable to connect to '" + host + "' on port #" + to_string( port ) );
+
+#ifdef USE_NO_DELAY
+      socket.set_no_delay( );
+#endif
+#ifdef SSL_SUPPORT
+      // NOTE: For SSL all protocol is secure (unlike STARTTLS).
+      // FUTURE: After a successful SSL connection the server certificate should
+      // be checked (at the very least make sure that it is the host requested).
+      if( user_info.use_ssl )
+         socket.ssl_connect( );
+#endif
+      string str( "(connected now reading greeting)" );
+
+      // NOTE: Read (and ignore) the connection message...
+      if( !get_response( str, socket, c_initial_timeout, p_progress ) )
+         throw runtime_error( str );
+
+      if( user_info.auth_type == e_smtp_auth_type_none )
+      {
+         str = string( "HELO " );
+         str += user_info.domain;
+         socket.write_line( str );
+
+         if( !get_response( str, socket, c_initial_timeout, p_progress ) )
+            throw runtime_error( str );
+      }
+      else
+      {
+         str = string( "EHLO " );
+         str += user_info.domain;
+         socket.write_line( str );
+
+         if( !get_response( str, socket, c_initial_timeout, p_progress ) )
+            throw runtime_error( str );
+
+#ifdef SSL_SUPPORT
+         // NOTE: For STARTTLS the initial EHLO is unsecure (enabling it to be
+         // compatible with non-secure SMTP) and therefore needs to be re-sent
+         // after the connection is secured.
+         if( !user_info.use_ssl && user_info.use_tls )
          {
-            string message_id_header( "Message-ID: <" );
-            message_id_header += uuid( ).as_string( ) + ">";
+            str = "STARTTLS";
+            socket.write_line( str );
 
-            str += message_id_header;
-            str += string( "\r\n" );
+            if( !get_response( str, socket, c_initial_timeout, p_progress ) )
+               throw runtime_error( str );
+
+            // FUTURE: After a successful SSL connection the server certificate should
+            // be checked (at the very least make sure that it is the host requested).
+            socket.ssl_connect( );
+
+            str = string( "EHLO " );
+            str += user_info.domain;
+            socket.write_line( str );
+
+            if( !get_response( str, socket, c_initial_timeout, p_progress ) )
+               throw runtime_error( str );
          }
-         else
+#endif
+         if( user_info.auth_type == e_smtp_auth_type_plain )
          {
-            for( size_t i = 0; i < p_extra_headers->size( ); i++ )
-            {
-               if( !( *p_extra_headers )[ i ].empty( ) )
-               {
-                  str += transform_header_to_utf_8_if_required( ( *p_extra_headers )[ i ] );
-                  str += string( "\r\n" );
-               }
-            }
+            str = string( "AUTH PLAIN " );
+
+            string auth_str( user_info.username );
+            auth_str += '\0';
+            auth_str += user_info.username;
+            auth_str += '\0';
+            auth_str += user_info.password;
+
+            str += base64::encode( auth_str );
          }
+         else if( user_info.auth_type == e_smtp_auth_type_login )
+            str = string( "AUTH LOGIN" );
+         else if( user_info.auth_type == e_smtp_auth_type_cram_md5 )
+            str = string( "AUTH CRAM-MD5" );
+         else
+            throw runtime_error( "unexpected smtp_auth_type in smtp_connection::open" );
 
-         auto_ptr< mime_encoder > ap_mime;
+         socket.write_line( str );
 
-         bool has_html = ( p_html && !p_html->empty( ) );
-         bool has_files = ( p_file_names && !p_file_names->empty( ) );
-         bool has_images = ( p_image_names && !p_image_names->empty( ) );
-         bool has_message = ( p_message && !p_message->empty( ) );
+         // NOTE: Don't allow progress tracking to see the password.
+         str.erase( );
 
-         const char* p_charset = 0;
-         if( user_info.p_charset )
-            p_charset = user_info.p_charset->c_str( );
+         if( !get_response( str, socket, c_initial_timeout, p_progress ) )
+            throw runtime_error( str );
 
-         string extracted_message;
-         if( has_html && !has_message )
+         if( user_info.auth_type != e_smtp_auth_type_plain )
          {
-            extracted_message = extract_text_from_html( *p_html );
-            p_message = &extracted_message;
-            has_message = true;
-         }
+            if( user_info.auth_type == e_smtp_auth_type_login )
+            {
+               str = base64::encode( user_info.username );
+               socket.write_line( str );
 
-         // NOTE: If there is HTML or attached files then format the message as MIME.
-         if( has_html || has_files )
-         {
-            ap_mime.reset( new mime_encoder( ) );
+               if( !get_response( str, socket, c_initial_timeout, p_progress ) )
+                  throw runtime_error( str );
 
-            if( has_html )
-            {
-               if( has_images )
-               {
-                  ap_mime->create_child( "related" );
-
-                  if( !has_message )
-                     ap_mime->get_child( ).add_html( *p_html, p_charset );
-                  else
-                  {
-                     ap_mime->get_child( ).create_child( "alternative" );
-                     ap_mime->get_child( ).get_child( ).add_text( *p_message, p_charset );
-                     ap_mime->get_child( ).get_child( ).add_html( *p_html, p_charset );
-                  }
-
-                  const char* p_path_prefix = 0;
-                  if( p_image_path_prefix )
-                     p_path_prefix = ( *p_image_path_prefix ).c_str( );
-
-                  for( size_t i = 0; i < p_image_names->size( ); i++ )
-                     ap_mime->get_child( ).add_image( ( *p_image_names )[ i ], p_path_prefix );
-               }
-               else
-               {
-                  if( !has_message )
-                     ap_mime->add_html( *p_html, p_charset );
-                  else
-                  {
-                     ap_mime->create_child( "related" );
-                     ap_mime->get_child( ).create_child( "alternative" );
-                     ap_mime->get_child( ).get_child( ).add_text( *p_message, p_charset );
-                     ap_mime->get_child( ).get_child( ).add_html( *p_html, p_charset );
-                  }
-               }
-            }
-            else if( has_message )
-               ap_mime->add_text( *p_message, p_charset );
+               str = base64::encode( user_info.password );
+               socket.write_line( str );
 
-            if( has_files )
-            {
-               for( size_t i = 0; i < p_file_names->size( ); i++ )
-                  ap_mime->add_file( ( *p_file_names )[ i ] );
+               // NOTE: Don't allow progress tracking to see the password.
+               str.erase( );
+
+               if( !get_response( str, socket, c_initial_timeout, p_progress ) )
+                  throw runtime_error( str );
             }
+            else if( user_info.auth_type == e_smtp_auth_type_cram_md5 )
+            {
+               str = determine_challenge_response( str, user_info.username, user_info.password );
+               socket.write_line( str );
 
-            str += ap_mime->get_data( );
-         }
-         else if( p_message )
-         {
-            // NOTE: Limit the lines to one less than the maximum as a fullstop escape character
-            // may be required at the start of one or more lines.
-            string message_text( split_input_into_lines( *p_message, c_max_chars_per_line - 1 ) );
+               // NOTE: Don't allow progress tracking to see the password.
+               str.erase( );
 
-            str += string( "\r\n" );
-            str += escape_fullstops_if_required( message_text );
-            str += string( "\r\n" );
+               if( !get_response( str, socket, c_initial_timeout, p_progress ) )
+                  throw runtime_error( str );
+            }
          }
+      }
+   }
+   catch( ... )
+   {
+      socket.close( );
+      throw;
+   }
+}
+
+void smtp_connection::send( const vector< string >& recipients, const string& data )
+{
+   if( !is_open( ) )
+      throw runtime_error( "unexpected send attempt for SMTP connection that is not open" );
+
+   progress* p_progress = p_impl->p_progress;
+
+#ifdef SSL_SUPPORT
+   ssl_socket& socket( p_impl->socket );
+#else
+   tcp_socket& socket( p_impl->socket );
+#endif
+
+   // NOTE: If any part of the message is not accepted then the connection is closed (rather than
+   // trying to resynchronise) so the caller can tell by "is_open" that it cannot be used again.
+   try
+   {
+      string str( "MAIL FROM:" );
+      str += envelope_address( p_impl->user_info.address );
+
+      if( socket.write_line( str ) <= 0 )
+         throw runtime_error( "unable to write to SMTP server" );
+
+      if( !get_response( str, socket, c_initial_timeout, p_progress ) )
+         throw runtime_error( str );
+
+      for( size_t i = 0; i < recipients.size( ); i++ )
+      {
+         if( recipients[ i ].empty( ) )
+            continue;
+
+         str = string( "RCPT TO:" );
+         str += envelope_address( recipients[ i ] );
 
-         str += string( ".\r\n" );
          socket.write_line( str );
 
          if( !get_response( str, socket, c_initial_timeout, p_progress ) )
             throw runtime_error( str );
+      }
 
-         str = "QUIT\r\n";
-         socket.write_line( str );
+      str = string( "DATA\r\n" );
+      socket.write_line( str );
 
-         // NOTE: Read (and ignore) the disconnection message...
-         get_response( str, socket, c_final_response_timeout, p_progress );
-      }
-      else
-         throw runtime_error( "unable to connect to '" + host + "' on port #" + to_string( port ) );
+      if( !get_response( str, socket, c_initial_timeout, p_progress ) )
+         throw runtime_error( str );
+
+      str = data;
+      str += string( ".\r\n" );
+      socket.write_line( str );
+
+      if( !get_response( str, socket, c_initial_timeout, p_progress ) )
+         throw runtime_error( str );
    }
-   else
-      throw runtime_error( "unable to open socket" );
+   catch( ... )
+   {
+      socket.close( );
+      throw;
+   }
+
+   ++p_impl->num_sent;
 }
 
+void smtp_connection::close( )
+{
+   if( is_open( ) )
+   {
+      string str( "QUIT\r\n" );
+      p_impl->socket.write_line( str );
+
+      // NOTE: Read (and ignore) the disconnection message...
+      get_response( str, p_impl->socket, c_final_response_timeout, p_impl->p_progress );
+
+      p_impl->socket.close( );
+   }
 }
 
 string html_to_text( const string& html )
@@ -739,22 +855,42 @@ string html_to_text( const string& html )
    return extract_text_from_html( html );
 }
 
+string compose_smtp_message( const smtp_user_info& user_info,
+ const vector< string >& recipients, const string& subject, const string& message,
+ const string& html, const vector< string >* p_extra_headers, const vector< string >* p_file_names,
+ const vector< string >* p_image_names, const string* p_image_path_prefix, progress* p_progress )
+{
+   return compose_message( user_info, recipients, subject,
+    &message, p_extra_headers, p_file_names, &html, p_image_names, p_image_path_prefix, p_progress );
+}
+
+void send_composed_smtp_message( const string& host, const smtp_user_info& user_info,
+ const vector< string >& recipients, const string& data, progress* p_progress )
+{
+   smtp_connection connection( host, user_info, p_progress );
+
+   connection.open( );
+   connection.send( recipients, data );
+   connection.close( );
+}
+
 void send_smtp_message( const string& host,
  const smtp_user_info& user_info, const vector< string >& recipients, const string& subject )
 {
-   send_message( host, user_info, recipients, subject );
+   send_composed_smtp_message( host, user_info, recipients, compose_message( user_info, recipients, subject ) );
 }
 
 void send_smtp_message( const string& host,
  const smtp_user_info& user_info, const vector< string >& recipients, const string& subject, const string& message )
 {
-   send_message( host, user_info, recipients, subject, &message );
+   send_composed_smtp_message( host, user_info, recipients, compose_message( user_info, recipients, subject, &message ) );
 }
 
 void send_smtp_message( const string& host, const smtp_user_info& user_info,
  const vector< string >& recipients, const string& subject, const string& message, const vector< string >& file_names )
 {
-   send_message( host, user_info, recipients, subject, &message, 0, &file_names );
+   send_composed_smtp_message( host, user_info,
+    recipients, compose_message( user_info, recipients, subject, &message, 0, &file_names ) );
 }
 
 void send_smtp_message( const string& host, const smtp_user_info& user_info,
@@ -762,7 +898,6 @@ void send_smtp_message( const string& host, const smtp_user_info& user_info,
  const string& html, const vector< string >* p_extra_headers, const vector< string >* p_file_names,
  const vector< string >* p_image_names, const string* p_image_path_prefix, progress* p_progress )
 {
-   send_message( host, user_info, recipients, subject,
-    &message, p_extra_headers, p_file_names, &html, p_image_names, p_image_path_prefix, p_progress );
+   send_composed_smtp_message( host, user_info, recipients, compose_smtp_message( user_info, recipients,
+    subject, message, html, p_extra_headers, p_file_names, p_image_names, p_image_path_prefix, p_progress ), p_progress );
 }
-
@@ -114,8 +114,42 @@ struct smtp_user_info
    int64_t max_attachment_bytes;
 };
 
+// NOTE: An SMTP connection can be used to send any number of messages (each sent as its own
+// mail transaction) so that the connection setup and authentication only needs to occur once.
+class smtp_connection
+{
+   public:
+   smtp_connection( const std::string& host, const smtp_user_info& user_info, progress* p_progress = 0 );
+   ~smtp_connection( );
+
+   bool is_open( ) const;
+
+   size_t get_num_sent( ) const;
+
+   void open( );
+
+   void send( const std::vector< std::string >& recipients, const std::string& data );
+
+   void close( );
+
+   private:
+   struct impl;
+   impl* p_impl;
+
+   smtp_connection( const smtp_connection& );
+   smtp_connection& operator =( const smtp_connection& );
+};
+
 std::string html_to_text( const std::string& html );
 
+std::string compose_smtp_message( const smtp_user_info& user_info,
+ const std::vector< std::string >& recipients, const std::string& subject, const std::string& message,
+ const std::string& html, const std::vector< std::string >* p_extra_headers, const std::vector< std::string >* p_file_names,
+ const std::vector< std::string >* p_image_names, const std::string* p_image_path_prefix = 0, progress* p_progress = 0 );
+
+void send_composed_smtp_message( const std::string& host, const smtp_user_info& user_info,
+ const std::vector< std::string >& recipients, const std::string& data, progress* p_progress = 0 );
+
 void send_smtp_message( const std::string& host,
  const smtp_user_info& user_info, const std::vector< std::string >& recipients, const std::string& subject );
 
@@ -0,0 +1,702 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef PRECOMPILE_H
+#  include "precompile.h"
+#endif
+#pragma hdrstop
+
+#ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <map>
+#  include <memory>
+#  include <fstream>
+#  include <sstream>
+#  include <iomanip>
+#  include <stdexcept>
+#endif
+
+#include "smtp_spool.h"
+
+#include "smtp.h"
+#include "threads.h"
+#include "utilities.h"
+#include "fs_iterator.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+namespace
+{
+
+const char* const c_spool_file_ext = ".msg";
+const char* const c_spool_temp_file_ext = ".tmp";
+const char* const c_spool_failed_file_ext = ".bad";
+
+const int c_spool_file_seq_digits = 12;
+
+const size_t c_max_batch_size = 100;
+const size_t c_max_messages_per_connection = 100;
+
+const unsigned long c_max_wait_msecs = 1000;
+const unsigned long c_max_retry_msecs = 3600000;
+const unsigned long c_idle_connection_msecs = 10000;
+
+struct spool_item
+{
+   spool_item( )
+    :
+    attempts( 0 ),
+    due( 0 ),
+    is_sending( false )
+   {
+   }
+
+   string file_name;
+
+   string host;
+   smtp_user_info user_info;
+
+   vector< string > recipients;
+
+   size_t attempts;
+   unsigned long due;
+
+   bool is_sending;
+
+   string connection_key( ) const
+   {
+      ostringstream osstr;
+
+      osstr << host << '\n' << user_info.domain << '\n' << user_info.username << '\n' << user_info.password
+       << '\n' << user_info.use_ssl << user_info.use_tls << ( int )user_info.auth_type;
+
+      return osstr.str( );
+   }
+};
+
+struct cached_connection
+{
+   cached_connection( )
+    :
+    p_connection( 0 ),
+    last_used( 0 )
+   {
+   }
+
+   smtp_connection* p_connection;
+   unsigned long last_used;
+};
+
+string spool_file_name( const string& directory, size_t seq, const char* p_ext = c_spool_file_ext )
+{
+   ostringstream osstr;
+   osstr << directory << '/' << setw( c_spool_file_seq_digits ) << setfill( '0' ) << seq << p_ext;
+
+   return osstr.str( );
+}
+
+void write_spool_file( const spool_item& item, const string& data, smtp_spool_crypt_func p_encrypt )
+{
+   string temp_file_name( item.file_name + c_spool_temp_file_ext );
+
+   ofstream outf( temp_file_name.c_str( ), ios::out | ios::binary );
+   if( !outf )
+      throw runtime_error( "unable to open '" + temp_file_name + "' for output" );
+
+   const smtp_user_info& user_info( item.user_info );
+
+   outf << item.host << '\n'
+    << user_info.domain << '\n'
+    << user_info.address << '\n'
+    << user_info.username << '\n'
+    << ( p_encrypt ? ( *p_encrypt )( user_info.password ) : user_info.password ) << '\n'
+    << user_info.use_ssl << ' ' << user_info.use_tls << ' ' << ( int )user_info.auth_type << '\n'
+    << item.recipients.size( ) << '\n';
+
+   for( size_t i = 0; i < item.recipients.size( ); i++ )
+      outf << item.recipients[ i ] << '\n';
+
+   outf << data;
+
+   outf.close( );
+
+   if( !outf.good( ) )
+   {
+      file_remove( temp_file_name );
+      throw runtime_error( "unable to write spool file '" + temp_file_name + "'" );
+   }
+
+   // NOTE: The file is only given its final name once it has been completely written so that a
+   // partially written message will never be found (and sent) if the process were terminated.
+   if( !file_rename( temp_file_name, item.file_name ) )
+   {
+      file_remove( temp_file_name );
+      throw runtime_error( "unable to rename spool file '" + temp_file_name + "'" );
+   }
+}
+
+bool read_spool_file( spool_item& item, string* p_data, smtp_spool_crypt_func p_decrypt )
+{
+   ifstream inpf( item.file_name.c_str( ), ios::in | ios::binary );
+   if( !inpf )
+      return false;
+
+   smtp_user_info& user_info( item.user_info );
+
+   string password, flags, num_recipients;
+
+   getline( inpf, item.host );
+   getline( inpf, user_info.domain );
+   getline( inpf, user_info.address );
+   getline( inpf, user_info.username );
+   getline( inpf, password );
+   getline( inpf, flags );
+   getline( inpf, num_recipients );
+
+   if( !inpf.good( ) )
+      return false;
+
+   user_info.password = p_decrypt ? ( *p_decrypt )( password ) : password;
+
+   int auth_type = 0;
+
+   istringstream isstr( flags );
+   isstr >> user_info.use_ssl >> user_info.use_tls >> auth_type;
+
+   user_info.auth_type = ( smtp_auth_type )auth_type;
+
+   item.recipients.resize( atoi( num_recipients.c_str( ) ) );
+
+   for( size_t i = 0; i < item.recipients.size( ); i++ )
+      getline( inpf, item.recipients[ i ] );
+
+   if( !inpf.good( ) )
+      return false;
+
+   if( p_data )
+   {
+      ostringstream osstr;
+      osstr << inpf.rdbuf( );
+
+      *p_data = osstr.str( );
+   }
+
+   return true;
+}
+
+void close_connection( smtp_connection* p_connection )
+{
+   try
+   {
+      p_connection->close( );
+   }
+   catch( ... )
+   {
+   }
+
+   delete p_connection;
+}
+
+}
+
+struct smtp_spool::impl
+{
+   class sender : public thread_pool_job
+   {
+      public:
+      sender( impl& spool ) : spool( spool ) { }
+
+      void run( )
+      {
+         spool.send_messages( );
+      }
+
+      private:
+      impl& spool;
+   };
+
+   impl( const string& directory, size_t max_attempts,
+    size_t retry_msecs, smtp_spool_crypt_func p_encrypt, smtp_spool_crypt_func p_decrypt )
+    :
+    directory( directory ),
+    max_attempts( max_attempts ? max_attempts : 1 ),
+    retry_msecs( retry_msecs ),
+    p_encrypt( p_encrypt ),
+    p_decrypt( p_decrypt ),
+    next_seq( 1 ),
+    is_running( false ),
+    is_stopping( false )
+   {
+   }
+
+   string directory;
+
+   size_t max_attempts;
+   unsigned long retry_msecs;
+
+   smtp_spool_crypt_func p_encrypt;
+   smtp_spool_crypt_func p_decrypt;
+
+   size_t next_seq;
+
+   bool is_running;
+   bool is_stopping;
+
+   // NOTE: The sender runs (until stopped) as the only job of a single thread pool so that "stop"
+   // can join its thread (and so it can't still be touching the spool once it has been deleted).
+   auto_ptr< thread_pool > ap_sender_pool;
+
+   mutex spool_mutex;
+
+   condition work_condition;
+   condition state_condition;
+
+   map< size_t, spool_item > items;
+   map< string, cached_connection > connections;
+
+   smtp_spool_stats stats;
+
+   void load_spooled_items( );
+
+   unsigned long retry_delay( size_t attempts ) const;
+
+   void send_messages( );
+   void send_batch( const string& key, const vector< size_t >& batch, smtp_connection* p_connection );
+};
+
+void smtp_spool::impl::load_spooled_items( )
+{
+   if( !file_exists( directory ) )
+      create_dir( directory );
+
+   file_filter ff;
+   fs_iterator fs( directory, &ff );
+
+   while( fs.has_next( ) )
+   {
+      string name( fs.get_name( ) );
+      string::size_type pos = name.find( '.' );
+
+      if( pos != c_spool_file_seq_digits )
+         continue;
+
+      size_t seq = atoi( name.substr( 0, pos ).c_str( ) );
+
+      if( seq >= next_seq )
+         next_seq = seq + 1;
+
+      string ext( name.substr( pos ) );
+
+      if( ext == c_spool_temp_file_ext )
+         file_remove( fs.get_full_name( ) );
+      else if( ext == c_spool_file_ext )
+      {
+         spool_item item;
+         item.file_name = spool_file_name( directory, seq );
+
+         if( read_spool_file( item, 0, p_decrypt ) )
+            items.insert( make_pair( seq, item ) );
+         else
+            file_rename( item.file_name, spool_file_name( directory, seq, c_spool_failed_file_ext ) );
+      }
+   }
+}
+
+unsigned long smtp_spool::impl::retry_delay( size_t attempts ) const
+{
+   unsigned long delay = retry_msecs;
+
+   for( size_t i = 1; i < attempts && delay < c_max_retry_msecs; i++ )
+      delay *= 2;
+
+   return delay < c_max_retry_msecs ? delay : c_max_retry_msecs;
+}
+
+void smtp_spool::impl::send_messages( )
+{
+   while( true )
+   {
+      string key;
+      vector< size_t > batch;
+
+      smtp_connection* p_connection = 0;
+      vector< smtp_connection* > idle_connections;
+
+      bool stopping = false;
+
+      // NOTE: Scope for guard object.
+      {
+         guard g( spool_mutex );
+
+         while( !is_stopping )
+         {
+            unsigned long now = get_msecs( );
+            unsigned long wait_msecs = c_max_wait_msecs;
+
+            map< string, cached_connection >::iterator ci = connections.begin( );
+
+            while( ci != connections.end( ) )
+            {
+               unsigned long idle_msecs = now - ci->second.last_used;
+
+               if( idle_msecs >= c_idle_connection_msecs )
+               {
+                  idle_connections.push_back( ci->second.p_connection );
+                  connections.erase( ci++ );
+               }
+               else
+               {
+                  if( c_idle_connection_msecs - idle_msecs < wait_msecs )
+                     wait_msecs = c_idle_connection_msecs - idle_msecs;
+
+                  ++ci;
+               }
+            }
+
+            // NOTE: The batch consists of the oldest due message followed by any others that are
+            // also due and which would be sent using the same server and account.
+            for( map< size_t, spool_item >::iterator i = items.begin( ); i != items.end( ); ++i )
+            {
+               spool_item& item( i->second );
+
+               if( item.is_sending )
+                  continue;
+
+               if( item.due > now )
+               {
+                  if( item.due - now < wait_msecs )
+                     wait_msecs = item.due - now;
+
+                  continue;
+               }
+
+               if( batch.empty( ) )
+                  key = item.connection_key( );
+               else if( item.connection_key( ) != key )
+                  continue;
+
+               item.is_sending = true;
+               batch.push_back( i->first );
+
+               if( batch.size( ) >= c_max_batch_size )
+                  break;
+            }
+
+            if( !batch.empty( ) || !idle_connections.empty( ) )
+               break;
+
+            work_condition.wait( spool_mutex, wait_msecs ? wait_msecs : 1 );
+         }
+
+         if( is_stopping )
+         {
+            stopping = true;
+
+            for( size_t i = 0; i < batch.size( ); i++ )
+               items[ batch[ i ] ].is_sending = false;
+
+            batch.clear( );
+
+            map< string, cached_connection >::iterator ci;
+            for( ci = connections.begin( ); ci != connections.end( ); ++ci )
+               idle_connections.push_back( ci->second.p_connection );
+
+            connections.clear( );
+         }
+         else if( !batch.empty( ) )
+         {
+            map< string, cached_connection >::iterator ci = connections.find( key );
+
+            if( ci != connections.end( ) )
+            {
+               p_connection = ci->second.p_connection;
+               connections.erase( ci );
+            }
+         }
+      }
+
+      for( size_t i = 0; i < idle_connections.size( ); i++ )
+         close_connection( idle_connections[ i ] );
+
+      if( stopping )
+         break;
+
+      if( !batch.empty( ) )
+         send_batch( key, batch, p_connection );
+   }
+}
+
+void smtp_spool::impl::send_batch( const string& key, const vector< size_t >& batch, smtp_connection* p_connection )
+{
+   auto_ptr< smtp_connection > ap_connection( p_connection );
+
+   string connect_error;
+
+   for( size_t i = 0; i < batch.size( ); i++ )
+   {
+      spool_item* p_item = 0;
+
+      // NOTE: Scope for guard object.
+      {
+         guard g( spool_mutex );
+
+         if( is_stopping )
+         {
+            for( size_t j = i; j < batch.size( ); j++ )
+               items[ batch[ j ] ].is_sending = false;
+
+            break;
+         }
+
+         // NOTE: As only this thread will change or remove an item that is being sent it is safe
+         // to keep using the item (map elements don't move when other elements are inserted).
+         p_item = &items[ batch[ i ] ];
+      }
+
+      string data, error;
+
+      bool was_sent = false;
+      bool was_reused = false;
+      bool is_permanent = false;
+
+      spool_item file_item;
+      file_item.file_name = p_item->file_name;
+
+      if( !connect_error.empty( ) )
+         error = connect_error;
+      else if( !read_spool_file( file_item, &data, 0 ) )
+      {
+         error = "unable to read spool file '" + p_item->file_name + "'";
+         is_permanent = true;
+      }
+      else
+      {
+         // NOTE: If sending fails using a connection that had already been used then one more
+         // attempt is made with a new connection (as the server may have closed the old one).
+         for( size_t attempt = 0; attempt < 2 && !was_sent; attempt++ )
+         {
+            bool is_new_connection = false;
+
+            try
+            {
+               if( ap_connection.get( ) && ( !ap_connection->is_open( )
+                || ap_connection->get_num_sent( ) >= c_max_messages_per_connection ) )
+                  close_connection( ap_connection.release( ) );
+
+               if( !ap_connection.get( ) )
+               {
+                  is_new_connection = true;
+                  ap_connection.reset( new smtp_connection( p_item->host, p_item->user_info ) );
+
+                  try
+                  {
+                     ap_connection->open( );
+                  }
+                  catch( exception& x )
+                  {
+                     connect_error = x.what( );
+                     throw;
+                  }
+
+                  guard g( spool_mutex );
+                  ++stats.num_connects;
+               }
+
+               ap_connection->send( p_item->recipients, data );
+
+               was_sent = true;
+               was_reused = !is_new_connection;
+            }
+            catch( exception& x )
+            {
+               error = x.what( );
+            }
+            catch( ... )
+            {
+               error = "unexpected unknown exception caught";
+            }
+
+            if( !was_sent )
+            {
+               ap_connection.reset( );
+
+               if( is_new_connection )
+                  break;
+            }
+         }
+
+         // NOTE: A 5xx reply indicates a permanent failure so the message will not be retried.
+         if( !was_sent && connect_error.empty( ) && !error.empty( ) && error[ 0 ] == '5' )
+            is_permanent = true;
+      }
+
+      guard g( spool_mutex );
+
+      if( was_sent )
+      {
+         file_remove( p_item->file_name );
+         items.erase( batch[ i ] );
+
+         ++stats.num_sent;
+
+         if( was_reused )
+            ++stats.num_reused;
+      }
+      else
+      {
+         stats.last_error = error;
+
+         if( is_permanent || ++p_item->attempts >= max_attempts )
+         {
+            file_rename( p_item->file_name, spool_file_name( directory, batch[ i ], c_spool_failed_file_ext ) );
+            items.erase( batch[ i ] );
+
+            ++stats.num_failed;
+         }
+         else
+         {
+            p_item->is_sending = false;
+            p_item->due = get_msecs( ) + retry_delay( p_item->attempts );
+         }
+      }
+
+      state_condition.notify_all( );
+   }
+
+   if( ap_connection.get( ) && ap_connection->is_open( ) )
+   {
+      guard g( spool_mutex );
+
+      cached_connection& connection( connections[ key ] );
+
+      connection.p_connection = ap_connection.release( );
+      connection.last_used = get_msecs( );
+   }
+}
+
+smtp_spool::smtp_spool( const string& directory, size_t max_attempts,
+ size_t retry_msecs, smtp_spool_crypt_func p_encrypt, smtp_spool_crypt_func p_decrypt )
+{
+   auto_ptr< impl > ap_impl( new impl( directory, max_attempts, retry_msecs, p_encrypt, p_decrypt ) );
+
+   ap_impl->load_spooled_items( );
+
+   p_impl = ap_impl.release( );
+}
+
+smtp_spool::~smtp_spool( )
+{
+   stop( );
+
+   delete p_impl;
+}
+
+void smtp_spool::start( )
+{
+   guard g( p_impl->spool_mutex );
+
+   if( !p_impl->is_running )
+   {
+      p_impl->ap_sender_pool.reset( new thread_pool( 1 ) );
+      p_impl->ap_sender_pool->start( );
+
+      p_impl->ap_sender_pool->queue_job( new impl::sender( *p_impl ) );
+
+      p_impl->is_running = true;
+   }
+}
+
+void smtp_spool::stop( )
+{
+   // NOTE: Scope for guard object.
+   {
+      guard g( p_impl->spool_mutex );
+
+      if( !p_impl->is_running || p_impl->is_stopping )
+         return;
+
+      p_impl->is_stopping = true;
+      p_impl->work_condition.notify_all( );
+   }
+
+   // NOTE: The lock must not be held whilst joining as the sender needs it in order to finish.
+   p_impl->ap_sender_pool->stop( );
+
+   guard g( p_impl->spool_mutex );
+
+   p_impl->ap_sender_pool.reset( );
+
+   p_impl->is_running = false;
+   p_impl->is_stopping = false;
+}
+
+void smtp_spool::spool_message( const string& host,
+ const smtp_user_info& user_info, const vector< string >& recipients, const string& data )
+{
+   spool_item item;
+
+   item.host = host;
+   item.recipients = recipients;
+
+   item.user_info.domain = user_info.domain;
+   item.user_info.address = user_info.address;
+   item.user_info.username = user_info.username;
+   item.user_info.password = user_info.password;
+   item.user_info.use_ssl = user_info.use_ssl;
+   item.user_info.use_tls = user_info.use_tls;
+   item.user_info.auth_type = user_info.auth_type;
+
+   size_t seq = 0;
+
+   // NOTE: Scope for guard object.
+   {
+      guard g( p_impl->spool_mutex );
+      seq = p_impl->next_seq++;
+   }
+
+   item.file_name = spool_file_name( p_impl->directory, seq );
+
+   write_spool_file( item, data, p_impl->p_encrypt );
+
+   guard g( p_impl->spool_mutex );
+
+   p_impl->items.insert( make_pair( seq, item ) );
+   p_impl->work_condition.notify_one( );
+}
+
+void smtp_spool::get_stats( smtp_spool_stats& stats ) const
+{
+   guard g( p_impl->spool_mutex );
+
+   stats = p_impl->stats;
+
+   stats.num_queued = p_impl->items.size( );
+   stats.num_deferred = 0;
+
+   for( map< size_t, spool_item >::const_iterator ci = p_impl->items.begin( ); ci != p_impl->items.end( ); ++ci )
+   {
+      if( ci->second.attempts )
+         ++stats.num_deferred;
+   }
+}
+
+bool smtp_spool::wait_until_empty( size_t timeout_msecs )
+{
+   guard g( p_impl->spool_mutex );
+
+   unsigned long start = get_msecs( );
+
+   while( !p_impl->items.empty( ) )
+   {
+      unsigned long elapsed = get_msecs( ) - start;
+
+      if( elapsed >= timeout_msecs )
+         break;
+
+      p_impl->state_condition.wait( p_impl->spool_mutex, timeout_msecs - elapsed );
+   }
+
+   return p_impl->items.empty( );
+}
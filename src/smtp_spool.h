@@ -0,0 +1,79 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SMTP_SPOOL_H
+#  define SMTP_SPOOL_H
+
+#  ifndef HAS_PRECOMPILED_STD_HEADERS
+#     include <string>
+#     include <vector>
+#  endif
+
+struct smtp_user_info;
+
+struct smtp_spool_stats
+{
+   smtp_spool_stats( )
+    :
+    num_queued( 0 ),
+    num_deferred( 0 ),
+    num_sent( 0 ),
+    num_failed( 0 ),
+    num_connects( 0 ),
+    num_reused( 0 )
+   {
+   }
+
+   size_t num_queued;
+   size_t num_deferred;
+
+   size_t num_sent;
+   size_t num_failed;
+
+   size_t num_connects;
+   size_t num_reused;
+
+   std::string last_error;
+};
+
+typedef std::string ( *smtp_spool_crypt_func )( const std::string& );
+
+// NOTE: Outbound messages are written to files in the spool directory (so that they will not be
+// lost if the process is stopped before they have been sent) and are then sent by a dedicated
+// thread. Messages that are due are sent in batches that share the same server and account so
+// an open (and authenticated) connection is reused until it has been idle for a short period.
+// If sending fails then a message will be retried (with an exponentially increasing delay) up
+// until the maximum number of attempts at which point its file is renamed with a ".bad" suffix.
+//
+// If encrypt and decrypt functions are provided then these are applied to the account password
+// that is stored in each spool file.
+class smtp_spool
+{
+   public:
+   smtp_spool( const std::string& directory,
+    size_t max_attempts = 1, size_t retry_msecs = 30000,
+    smtp_spool_crypt_func p_encrypt = 0, smtp_spool_crypt_func p_decrypt = 0 );
+
+   ~smtp_spool( );
+
+   void start( );
+   void stop( );
+
+   void spool_message( const std::string& host, const smtp_user_info& user_info,
+    const std::vector< std::string >& recipients, const std::string& data );
+
+   void get_stats( smtp_spool_stats& stats ) const;
+
+   bool wait_until_empty( size_t timeout_msecs );
+
+   private:
+   struct impl;
+   impl* p_impl;
+
+   smtp_spool( const smtp_spool& );
+   smtp_spool& operator =( const smtp_spool& );
+};
+
+#endif
@@ -0,0 +1,195 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SOCKET_POOL_H
+#  define SOCKET_POOL_H
+
+#  ifndef HAS_PRECOMPILED_STD_HEADERS
+#     include <set>
+#     include <deque>
+#     include <algorithm>
+#  endif
+
+#  include "threads.h"
+#  include "sockets.h"
+
+// NOTE: A pool of persistent sockets (of type T which must be a "tcp_socket" or derived from it)
+// that are handed out to one user at a time. A released socket is kept (and stays connected if
+// it had been) so it can be reused without needing to reconnect. Idle sockets are reused LIFO
+// (as the most recently used is the most likely to still be connected) and if the pool has been
+// exhausted then "obtain_socket" will wait (for up to the timeout) for another to be released.
+template< typename T > class socket_pool
+{
+   public:
+   socket_pool( size_t max_sockets = 1 )
+    :
+    max_sockets( max_sockets ? max_sockets : 1 )
+   {
+   }
+
+   ~socket_pool( )
+   {
+      disconnect_sockets( false );
+   }
+
+   size_t get_max_sockets( ) const
+   {
+      guard g( pool_mutex );
+      return max_sockets;
+   }
+
+   void set_max_sockets( size_t new_max_sockets )
+   {
+      guard g( pool_mutex );
+
+      max_sockets = new_max_sockets ? new_max_sockets : 1;
+
+      while( !idle_sockets.empty( ) && idle_sockets.size( ) + busy_sockets.size( ) > max_sockets )
+      {
+         destroy_socket( idle_sockets.front( ) );
+         idle_sockets.pop_front( );
+      }
+
+      pool_condition.notify_all( );
+   }
+
+   size_t num_idle_sockets( ) const
+   {
+      guard g( pool_mutex );
+      return idle_sockets.size( );
+   }
+
+   size_t num_busy_sockets( ) const
+   {
+      guard g( pool_mutex );
+      return busy_sockets.size( );
+   }
+
+   // NOTE: If a preferred socket is provided (such as the last one used by the same client) and
+   // it is currently idle then it will be handed out (so any server side state that was left for
+   // that client, such as a fetch cursor, is more likely to be found by its next request).
+   T* obtain_socket( size_t timeout = 0, const tcp_socket* p_preferred = 0 )
+   {
+      guard g( pool_mutex );
+
+      T* p_socket = 0;
+
+      if( p_preferred )
+      {
+         typename std::deque< T* >::iterator i = std::find( idle_sockets.begin( ), idle_sockets.end( ), p_preferred );
+
+         if( i != idle_sockets.end( ) )
+         {
+            p_socket = *i;
+            idle_sockets.erase( i );
+         }
+      }
+
+      while( !p_socket )
+      {
+         if( !idle_sockets.empty( ) )
+         {
+            p_socket = idle_sockets.back( );
+            idle_sockets.pop_back( );
+         }
+         else if( busy_sockets.size( ) < max_sockets )
+            p_socket = new T;
+         else if( !timeout || !pool_condition.wait( pool_mutex, timeout ) )
+         {
+            // NOTE: A notification may have been missed if the wait timed out just as a socket
+            // had been released so check for an idle socket once more before giving up.
+            if( idle_sockets.empty( ) )
+               break;
+
+            timeout = 0;
+         }
+      }
+
+      if( p_socket )
+         busy_sockets.insert( p_socket );
+
+      return p_socket;
+   }
+
+   void release_socket( tcp_socket* p_socket )
+   {
+      guard g( pool_mutex );
+
+      typename std::set< T* >::iterator i = busy_sockets.find( static_cast< T* >( p_socket ) );
+
+      if( i != busy_sockets.end( ) )
+      {
+         busy_sockets.erase( i );
+
+         if( idle_sockets.size( ) + busy_sockets.size( ) < max_sockets )
+            idle_sockets.push_back( static_cast< T* >( p_socket ) );
+         else
+            destroy_socket( static_cast< T* >( p_socket ) );
+
+         pool_condition.notify_one( );
+      }
+   }
+
+   void disconnect_socket( tcp_socket* p_socket )
+   {
+      guard g( pool_mutex );
+
+      typename std::set< T* >::iterator i = busy_sockets.find( static_cast< T* >( p_socket ) );
+
+      if( i != busy_sockets.end( ) )
+      {
+         busy_sockets.erase( i );
+         destroy_socket( static_cast< T* >( p_socket ) );
+
+         pool_condition.notify_one( );
+      }
+   }
+
+   void disconnect_sockets( bool released_only )
+   {
+      guard g( pool_mutex );
+
+      for( size_t i = 0; i < idle_sockets.size( ); i++ )
+         destroy_socket( idle_sockets[ i ] );
+
+      idle_sockets.clear( );
+
+      // NOTE: Sockets that are in use are only closed (rather than destroyed) as their users are
+      // still holding them (these will then be destroyed when they are released or disconnected).
+      if( !released_only )
+      {
+         typename std::set< T* >::iterator i;
+         for( i = busy_sockets.begin( ); i != busy_sockets.end( ); ++i )
+         {
+            if( ( *i )->okay( ) )
+               ( *i )->close( );
+         }
+      }
+
+      pool_condition.notify_all( );
+   }
+
+   private:
+   size_t max_sockets;
+
+   mutable mutex pool_mutex;
+   condition pool_condition;
+
+   std::deque< T* > idle_sockets;
+   std::set< T* > busy_sockets;
+
+   void destroy_socket( T* p_socket )
+   {
+      if( p_socket->okay( ) )
+         p_socket->close( );
+
+      delete p_socket;
+   }
+
+   socket_pool( const socket_pool& );
+   socket_pool& operator =( const socket_pool& );
+};
+
+#endif
@@ -17,6 +17,7 @@
 #  include <iostream>
 #  include <stdexcept>
 #  ifndef _WIN32
+#     include <poll.h>
 #     include <fcntl.h>
 #     include <netdb.h>
 #     include <stdarg.h>
@@ -189,15 +190,7 @@ bool tcp_socket::connect( const ip_address& addr, size_t timeout )
       {
          ::connect( socket, ( const sockaddr* )&addr, sizeof( sockaddr ) );
 
-         fd_set fdset;
-         struct timeval tv;
-
-         tv.tv_sec = timeout / 1000;
-         tv.tv_usec = ( timeout % 1000 ) * 1000;
-         
-         FD_ZERO( &fdset );
-         FD_SET( socket, &fdset );
-         if( ::select( socket + 1, 0, &fdset, 0, &tv ) == 1 )
+         if( can_output( timeout ) )
          {
             int so_error = 1;
             socklen_t len = sizeof( so_error );
@@ -312,6 +305,19 @@ bool tcp_socket::set_reuse_addr( )
 bool tcp_socket::has_input( size_t timeout ) const
 {
    bool okay;
+#ifndef _WIN32
+   // NOTE: A "poll" is used rather than a "select" as the latter cannot handle descriptors
+   // whose values are FD_SETSIZE or greater (which a server with many connections will use).
+   struct pollfd pfd;
+
+   pfd.fd = socket;
+   pfd.events = POLLIN;
+   pfd.revents = 0;
+
+   // NOTE: This function will indicate success even if the "poll" return code has
+   // an error as it is expected that the error will occur during the receive itself.
+   okay = ::poll( &pfd, 1, ( int )timeout ) != 0;
+#else
    fd_set rfds;
    struct timeval tv;
 
@@ -326,12 +332,24 @@ bool tcp_socket::has_input( size_t timeout ) const
    okay = ::select( socket + 1, &rfds, 0, 0, &tv ) != 0;
 
    FD_CLR( socket, &rfds );
+#endif
    return okay;
 }
 
 bool tcp_socket::can_output( size_t timeout ) const
 {
    bool okay;
+#ifndef _WIN32
+   struct pollfd pfd;
+
+   pfd.fd = socket;
+   pfd.events = POLLOUT;
+   pfd.revents = 0;
+
+   // NOTE: This function will indicate success even if the "poll" return code has
+   // an error as it is expected that the error will occur during the send operation.
+   okay = ::poll( &pfd, 1, ( int )timeout ) != 0;
+#else
    fd_set wfds;
    struct timeval tv;
 
@@ -346,6 +364,7 @@ bool tcp_socket::can_output( size_t timeout ) const
    okay = ::select( socket + 1, 0, &wfds, 0, &tv ) != 0;
 
    FD_CLR( socket, &wfds );
+#endif
 
    return okay;
 }
@@ -781,16 +800,17 @@ void file_transfer( const string& name,
          if( pos != string::npos )
             next.erase( pos );
 
-         if( !base64::valid_characters( next ) )
+         size_t len = 0;
+         decoded.resize( max_line_size );
+
+         // NOTE: The data is validated whilst being decoded (rather than requiring two passes).
+         if( !base64::decode_if_valid( next.data( ), next.length( ), ( unsigned char* )&decoded[ 0 ], &len ) )
          {
             not_base64 = true;
             unexpected_data = next;
             break;
          }
 
-         decoded.resize( max_line_size );
-         size_t len = base64::decode( next, ( unsigned char* )&decoded[ 0 ], max_line_size );
-
          decoded.erase( len );
 
          size_t offset = 0;
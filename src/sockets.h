@@ -84,6 +84,10 @@ class tcp_socket
    bool has_input( size_t timeout = 0 ) const;
    bool can_output( size_t timeout = 0 ) const;
 
+   // NOTE: Derived classes that read ahead must override this in order to indicate whether
+   // any input remains buffered (as "has_input" will only detect input from the socket).
+   virtual bool has_buffered_input( ) const { return false; }
+
    virtual int recv( unsigned char* buf, int buflen, size_t timeout = 0 );
    virtual int send( const unsigned char* buf, int buflen, size_t timeout = 0 );
 
@@ -104,6 +108,8 @@ class tcp_socket
 
    bool okay( ) const { return socket != INVALID_SOCKET; }
 
+   SOCKET get_socket( ) const { return socket; }
+
    operator bool_type( ) const
    {
       if( socket == INVALID_SOCKET )
@@ -134,7 +140,6 @@ class tcp_socket
 
    protected:
    bool timed_out;
-   SOCKET get_socket( ) const { return socket; }
 
    // FUTURE: Need to add a member in order to detect the "would block" status before allowing these to be public.
    bool set_blocking( );
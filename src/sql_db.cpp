@@ -12,12 +12,14 @@
 #ifndef HAS_PRECOMPILED_STD_HEADERS
 #  include <fstream>
 #  include <iostream>
+#  include <algorithm>
 #endif
 
 #include "sql_db.h"
 
 #include "pointers.h"
 #include "utilities.h"
+#include "thread_pool.h"
 
 #ifdef RDBMS_SQLITE
 #  include "sqlite3.h"
@@ -32,6 +34,107 @@
 
 using namespace std;
 
+namespace
+{
+
+struct concurrent_query_info
+{
+   concurrent_query_info( sql_db_pool& db_pool, sql_query_pool& query_pool,
+    const vector< string >& sql_queries, vector< ref_count_ptr< sql_dataset > >& sql_datasets )
+    :
+    db_pool( db_pool ),
+    query_pool( query_pool ),
+    num_pending( sql_queries.size( ) ),
+    sql_queries( sql_queries ),
+    sql_datasets( sql_datasets )
+   {
+   }
+
+   sql_db_pool& db_pool;
+   sql_query_pool& query_pool;
+
+   size_t num_pending;
+
+   string error_message;
+
+   const vector< string >& sql_queries;
+   vector< ref_count_ptr< sql_dataset > >& sql_datasets;
+};
+
+class concurrent_query_job : public thread_pool_job
+{
+   public:
+   concurrent_query_job( concurrent_query_info& info, size_t query_num ) : info( info ), query_num( query_num ) { }
+
+   void run( );
+
+   private:
+   concurrent_query_info& info;
+
+   size_t query_num;
+};
+
+void concurrent_query_job::run( )
+{
+   bool skip = false;
+
+   // NOTE: Empty scope for guard object.
+   {
+      guard g( info.query_pool.get_query_mutex( ) );
+
+      if( !info.error_message.empty( ) )
+         skip = true;
+   }
+
+   string error_message;
+
+   sql_db* p_db = 0;
+   sql_dataset* p_dataset = 0;
+
+   if( !skip )
+   {
+      try
+      {
+         p_db = info.db_pool.obtain_connection( );
+
+         // NOTE: As the query result is fully buffered by the dataset the connection
+         // is able to be returned to the pool as soon as the dataset was constructed.
+         p_dataset = new sql_dataset( *p_db, info.sql_queries[ query_num ] );
+
+         info.db_pool.release_connection( p_db );
+      }
+      catch( exception& x )
+      {
+         if( p_db )
+            info.db_pool.release_connection( p_db );
+
+         error_message = x.what( );
+      }
+      catch( ... )
+      {
+         if( p_db )
+            info.db_pool.release_connection( p_db );
+
+         error_message = "unexpected unknown exception executing concurrent query";
+      }
+   }
+
+   // NOTE: The group is waiting on the (long lived) query pool condition rather than on anything
+   // that belongs to the query info (which will no longer exist once the group has been notified)
+   // so the info is not touched after "num_pending" has reached zero.
+   guard g( info.query_pool.get_query_mutex( ) );
+
+   if( p_dataset )
+      info.sql_datasets[ query_num ] = p_dataset;
+   else if( !error_message.empty( ) && info.error_message.empty( ) )
+      info.error_message = error_message;
+
+   if( !--info.num_pending )
+      info.query_pool.get_query_condition( ).notify_all( );
+}
+
+}
+
 sql_db::sql_db( const string& name )
  :
  p_db( 0 )
@@ -79,6 +182,102 @@ sql_db::~sql_db( )
    p_db = 0;
 }
 
+sql_db_pool::sql_db_pool( const string& name, const string& uid, size_t max_connections )
+ :
+ name( name ),
+ uid( uid ),
+ max_connections( max_connections ),
+ num_connections( 0 )
+{
+   if( !max_connections )
+      throw runtime_error( "unexpected zero max_connections in sql_db_pool" );
+}
+
+sql_db_pool::~sql_db_pool( )
+{
+   for( size_t i = 0; i < available.size( ); i++ )
+      delete available[ i ];
+}
+
+sql_db* sql_db_pool::obtain_connection( )
+{
+   // NOTE: Empty scope for guard object.
+   {
+      guard g( pool_mutex );
+
+      while( available.empty( ) && num_connections >= max_connections )
+         pool_condition.wait( pool_mutex );
+
+      if( !available.empty( ) )
+      {
+         sql_db* p_db = available.back( );
+         available.pop_back( );
+
+         return p_db;
+      }
+
+      ++num_connections;
+   }
+
+   try
+   {
+      return new sql_db( name, uid );
+   }
+   catch( ... )
+   {
+      guard g( pool_mutex );
+
+      --num_connections;
+      pool_condition.notify_one( );
+
+      throw;
+   }
+}
+
+void sql_db_pool::release_connection( sql_db* p_db )
+{
+   guard g( pool_mutex );
+
+   available.push_back( p_db );
+   pool_condition.notify_one( );
+}
+
+sql_query_pool::sql_query_pool( size_t num_threads )
+ :
+ thread_pool( num_threads )
+{
+   start( );
+}
+
+sql_query_pool::~sql_query_pool( )
+{
+   stop( );
+}
+
+void sql_query_pool::on_thread_start( )
+{
+   sql_thread_init( );
+}
+
+void sql_query_pool::on_thread_finish( )
+{
+   sql_thread_end( );
+}
+
+void sql_thread_init( )
+{
+#ifdef RDBMS_MYSQL
+   mysql_thread_init( );
+#endif
+}
+
+void sql_thread_end( )
+{
+#ifdef RDBMS_MYSQL
+   mysql_thread_end( );
+#endif
+}
+
 void exec_sql( sql_db& db, const string& sql )
 {
    sql_dataset ds( db );
@@ -393,32 +592,150 @@ string sql_dataset::as_string( int col ) const
 
 struct sql_dataset_group::impl
 {
-   impl( sql_db& db, const vector< string >& sql_queries, bool is_reverse, bool ignore_first )
+   impl( const vector< string >& sql_queries, bool is_reverse, bool ignore_first, size_t row_limit )
     :
     is_new( true ),
-    next_dataset( -1 ),
     is_reverse( is_reverse ),
-    ignore_first( ignore_first )
+    ignore_first( ignore_first ),
+    row_limit( row_limit ),
+    rows_returned( 0 ),
+    next_dataset( -1 )
    {
-      for( size_t i = 0; i < sql_queries.size( ); i++ )
-         sql_datasets.push_back( ref_count_ptr< sql_dataset >( new sql_dataset( db, sql_queries[ i ] ) ) );
+      current_values.resize( sql_queries.size( ) );
    }
 
+   void execute_queries( sql_db& db, const vector< string >& sql_queries );
+   void execute_queries( sql_db_pool& db_pool, sql_query_pool& query_pool, const vector< string >& sql_queries );
+
+   bool is_before( size_t lhs, size_t rhs ) const;
+
+   bool fetch_next( size_t dataset );
+
+   struct dataset_order
+   {
+      dataset_order( const impl& group ) : group( group ) { }
+
+      // NOTE: The heap functions put the "greatest" element first so the ordering is inverted.
+      bool operator ( )( size_t lhs, size_t rhs ) const { return group.is_before( rhs, lhs ); }
+
+      const impl& group;
+   };
+
    bool is_new;
    bool is_reverse;
    bool ignore_first;
 
+   size_t row_limit;
+   size_t rows_returned;
+
    int next_dataset;
-   vector< string > next_values;
 
-   vector< bool > has_more;
+   vector< size_t > merge_heap;
+   vector< vector< string > > current_values;
+
    vector< ref_count_ptr< sql_dataset > > sql_datasets;
 };
 
+void sql_dataset_group::impl::execute_queries( sql_db& db, const vector< string >& sql_queries )
+{
+   for( size_t i = 0; i < sql_queries.size( ); i++ )
+      sql_datasets.push_back( ref_count_ptr< sql_dataset >( new sql_dataset( db, sql_queries[ i ] ) ) );
+}
+
+void sql_dataset_group::impl::execute_queries(
+ sql_db_pool& db_pool, sql_query_pool& query_pool, const vector< string >& sql_queries )
+{
+   sql_datasets.resize( sql_queries.size( ) );
+
+   concurrent_query_info info( db_pool, query_pool, sql_queries, sql_datasets );
+
+   // NOTE: As the query pool workers are shared with other groups this will only wait until its
+   // own queries have been executed (any other group's jobs that finish will also notify so the
+   // pending count is checked again each time).
+   if( !sql_queries.empty( ) )
+   {
+      guard g( query_pool.get_query_mutex( ) );
+
+      for( size_t i = 0; i < sql_queries.size( ); i++ )
+         query_pool.queue_job( new concurrent_query_job( info, i ) );
+
+      while( info.num_pending )
+         query_pool.get_query_condition( ).wait( query_pool.get_query_mutex( ) );
+   }
+
+   if( !info.error_message.empty( ) )
+      throw sql_exception( info.error_message );
+}
+
+bool sql_dataset_group::impl::is_before( size_t lhs, size_t rhs ) const
+{
+   const vector< string >& lhs_values( current_values[ lhs ] );
+   const vector< string >& rhs_values( current_values[ rhs ] );
+
+   size_t num_values = min( lhs_values.size( ), rhs_values.size( ) );
+
+   for( size_t i = ( ignore_first ? 1 : 0 ); i < num_values; i++ )
+   {
+      int rc = lhs_values[ i ].compare( rhs_values[ i ] );
+
+      if( rc != 0 )
+         return is_reverse ? ( rc > 0 ) : ( rc < 0 );
+   }
+
+   // NOTE: For equal values the dataset that was provided first comes first.
+   return lhs < rhs;
+}
+
+bool sql_dataset_group::impl::fetch_next( size_t dataset )
+{
+   sql_dataset& ds( *sql_datasets[ dataset ] );
+
+   vector< string >& values( current_values[ dataset ] );
+   values.clear( );
+
+   if( !ds.next( ) )
+      return false;
+
+   int field_count = ds.get_fieldcount( );
+
+   values.reserve( field_count );
+
+   for( int i = 0; i < field_count; i++ )
+      values.push_back( ds.as_string( i ) );
+
+   return true;
+}
+
 sql_dataset_group::sql_dataset_group( sql_db& db,
- const vector< string >& sql_queries, bool is_reverse, bool ignore_first_column_for_ordering )
+ const vector< string >& sql_queries, bool is_reverse, bool ignore_first_column_for_ordering, size_t row_limit )
 {
-   p_impl = new impl( db, sql_queries, is_reverse, ignore_first_column_for_ordering );
+   p_impl = new impl( sql_queries, is_reverse, ignore_first_column_for_ordering, row_limit );
+
+   try
+   {
+      p_impl->execute_queries( db, sql_queries );
+   }
+   catch( ... )
+   {
+      delete p_impl;
+      throw;
+   }
+}
+
+sql_dataset_group::sql_dataset_group( sql_db_pool& db_pool, sql_query_pool& query_pool,
+ const vector< string >& sql_queries, bool is_reverse, bool ignore_first_column_for_ordering, size_t row_limit )
+{
+   p_impl = new impl( sql_queries, is_reverse, ignore_first_column_for_ordering, row_limit );
+
+   try
+   {
+      p_impl->execute_queries( db_pool, query_pool, sql_queries );
+   }
+   catch( ... )
+   {
+      delete p_impl;
+      throw;
+   }
 }
 
 sql_dataset_group::~sql_dataset_group( )
@@ -428,81 +745,43 @@ sql_dataset_group::~sql_dataset_group( )
 
 bool sql_dataset_group::next( )
 {
-   bool has_next = false;
+   impl::dataset_order order( *p_impl );
+   vector< size_t >& merge_heap( p_impl->merge_heap );
 
-   if( !p_impl->is_new )
+   if( p_impl->is_new )
    {
-      if( p_impl->next_dataset < 0 || p_impl->next_dataset >= p_impl->sql_datasets.size( ) )
-         throw runtime_error( "unexpected next_dataset out of range" );
+      p_impl->is_new = false;
 
-      p_impl->has_more[ p_impl->next_dataset ] = p_impl->sql_datasets[ p_impl->next_dataset ]->next( );
+      for( size_t i = 0; i < p_impl->sql_datasets.size( ); i++ )
+      {
+         if( p_impl->fetch_next( i ) )
+            merge_heap.push_back( i );
+      }
 
-      p_impl->next_values.clear( );
+      make_heap( merge_heap.begin( ), merge_heap.end( ), order );
    }
-
-   for( size_t i = 0; i < p_impl->sql_datasets.size( ); i++ )
+   else if( p_impl->next_dataset >= 0 )
    {
-      bool is_next = false;
-      bool next = p_impl->is_new ? p_impl->sql_datasets[ i ]->next( ) : p_impl->has_more[ i ];
-
-      if( p_impl->is_new )
-         p_impl->has_more.push_back( next );
-
-      if( next )
+      if( p_impl->fetch_next( p_impl->next_dataset ) )
       {
-         size_t field_count = ( size_t )p_impl->sql_datasets[ i ]->get_fieldcount( );
+         merge_heap.push_back( p_impl->next_dataset );
+         push_heap( merge_heap.begin( ), merge_heap.end( ), order );
+      }
+   }
 
-         has_next = true;
+   p_impl->next_dataset = -1;
 
-         if( p_impl->next_values.empty( ) )
-         {
-            is_next = true;
-            p_impl->next_dataset = i;
-         }
-         else
-         {
-            size_t start = 0;
-
-            if( p_impl->ignore_first )
-               ++start;
-
-            for( size_t j = start; j < field_count; j++ )
-            {
-               string value( p_impl->sql_datasets[ i ]->as_string( j ) );
-
-               if( j >= p_impl->next_values.size( ) )
-                  break;
-
-               if( ( !p_impl->is_reverse && value < p_impl->next_values[ j ] )
-                || ( p_impl->is_reverse && value > p_impl->next_values[ j ] ) )
-               {
-                  is_next = true;
-                  p_impl->next_dataset = i;
-               }
-
-               if( is_next
-                || ( ( !p_impl->is_reverse && value > p_impl->next_values[ j ] )
-                || ( p_impl->is_reverse && value < p_impl->next_values[ j ] ) ) )
-                  break;
-            }
-         }
+   if( merge_heap.empty( ) || ( p_impl->row_limit && p_impl->rows_returned >= p_impl->row_limit ) )
+      return false;
 
-         if( is_next )
-         {
-            for( size_t j = 0; j < field_count; j++ )
-            {
-               if( j == 0 )
-                  p_impl->next_values.clear( );
+   pop_heap( merge_heap.begin( ), merge_heap.end( ), order );
 
-               p_impl->next_values.push_back( p_impl->sql_datasets[ i ]->as_string( j ) );
-            }
-         }
-      }
-   }
+   p_impl->next_dataset = merge_heap.back( );
+   merge_heap.pop_back( );
 
-   p_impl->is_new = false;
+   ++p_impl->rows_returned;
 
-   return has_next;
+   return true;
 }
 
 int sql_dataset_group::get_fieldcount( ) const
@@ -510,7 +789,7 @@ int sql_dataset_group::get_fieldcount( ) const
    if( p_impl->next_dataset < 0 || p_impl->next_dataset >= p_impl->sql_datasets.size( ) )
       throw runtime_error( "unexpected next_dataset out of range" );
 
-   return p_impl->sql_datasets[ p_impl->next_dataset ]->get_fieldcount( );
+   return p_impl->current_values[ p_impl->next_dataset ].size( );
 }
 
 string sql_dataset_group::as_string( int col ) const
@@ -518,7 +797,12 @@ string sql_dataset_group::as_string( int col ) const
    if( p_impl->next_dataset < 0 || p_impl->next_dataset >= p_impl->sql_datasets.size( ) )
       throw runtime_error( "unexpected next_dataset out of range" );
 
-   return p_impl->sql_datasets[ p_impl->next_dataset ]->as_string( col );
+   const vector< string >& values( p_impl->current_values[ p_impl->next_dataset ] );
+
+   if( col < 0 || col >= values.size( ) )
+      throw sql_exception( "Column is out of range" );
+
+   return values[ col ];
 }
 
 #ifdef RDBMS_SQLITE
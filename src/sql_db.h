@@ -15,7 +15,9 @@
 #     include <stdexcept>
 #  endif
 
+#  include "threads.h"
 #  include "progress.h"
+#  include "thread_pool.h"
 
 #  define RDBMS_MYSQL
 
@@ -59,6 +61,62 @@ class sql_db
 #  endif
 };
 
+// NOTE: A pool of connections to the same database that are used in order to be able to
+// execute SQL queries concurrently (connections are created as they are first required).
+class sql_db_pool
+{
+   public:
+   sql_db_pool( const std::string& name, const std::string& uid, size_t max_connections );
+   ~sql_db_pool( );
+
+   size_t get_max_connections( ) const { return max_connections; }
+
+   sql_db* obtain_connection( );
+   void release_connection( sql_db* p_db );
+
+   private:
+   std::string name;
+   std::string uid;
+
+   size_t max_connections;
+   size_t num_connections;
+
+   std::vector< sql_db* > available;
+
+   mutex pool_mutex;
+   condition pool_condition;
+
+   sql_db_pool( const sql_db_pool& );
+   sql_db_pool& operator =( const sql_db_pool& );
+};
+
+// NOTE: Worker threads (each prepared for "sql_db" use) which execute the queries for a concurrent
+// "sql_dataset_group". It is intended to be kept alive along with the "sql_db_pool" whose connections
+// are used by the queries and can be shared by any number of groups (with each group only waiting
+// for its own queries to be executed).
+class sql_query_pool : public thread_pool
+{
+   public:
+   sql_query_pool( size_t num_threads );
+   ~sql_query_pool( );
+
+   mutex& get_query_mutex( ) { return query_mutex; }
+   condition& get_query_condition( ) { return query_condition; }
+
+   protected:
+   void on_thread_start( );
+   void on_thread_finish( );
+
+   private:
+   mutex query_mutex;
+   condition query_condition;
+};
+
+// NOTE: Any thread (other than the main one) that will make use of a "sql_db" connection
+// needs to call these functions when it starts and before it finishes.
+void sql_thread_init( );
+void sql_thread_end( );
+
 void exec_sql( sql_db& db, const std::string& sql );
 
 void exec_sql_from_file( sql_db& db,
@@ -131,7 +189,13 @@ class sql_dataset_group : public sql_data
    public:
    sql_dataset_group( sql_db& db,
     const std::vector< std::string >& sql_queries,
-    bool is_reverse = false, bool ignore_first_column_for_ordering = true );
+    bool is_reverse = false, bool ignore_first_column_for_ordering = true, size_t row_limit = 0 );
+
+   // NOTE: Executes the queries concurrently (using the query pool workers) with connections that
+   // are obtained from the connection pool.
+   sql_dataset_group( sql_db_pool& db_pool, sql_query_pool& query_pool,
+    const std::vector< std::string >& sql_queries,
+    bool is_reverse = false, bool ignore_first_column_for_ordering = true, size_t row_limit = 0 );
 
    ~sql_dataset_group( );
 
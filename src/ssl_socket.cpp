@@ -262,6 +262,11 @@ void ssl_socket::ssl_connect( )
 #endif
 }
 
+bool ssl_socket::has_buffered_input( ) const
+{
+   return secure && SSL_pending( p_ssl ) > 0;
+}
+
 int ssl_socket::recv( unsigned char* buf, int buflen, size_t timeout )
 {
    if( !secure )
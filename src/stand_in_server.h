@@ -0,0 +1,189 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef STAND_IN_SERVER_H
+#  define STAND_IN_SERVER_H
+
+#  ifndef HAS_PRECOMPILED_STD_HEADERS
+#     include <memory>
+#     include <string>
+#     include <vector>
+#     include <stdexcept>
+#  endif
+
+#  include "threads.h"
+#  include "sockets.h"
+#  include "utilities.h"
+
+const int c_stand_in_accept_timeout = 250;
+
+// NOTE: A local stand-in for an actual server that is used by the socket based test programs.
+// Each accepted connection is passed to "accept_session" which by default will start a thread
+// that calls "handle_session" (and then closes the socket). Sessions should check "is_stopping"
+// whenever a read times out. The "stop" function closes the listener and then joins the accept
+// thread along with every session thread (and as it is not called by the destructor it must be
+// called by the owner before the server is destroyed).
+class stand_in_server
+{
+   public:
+   stand_in_server( int port ) : port( port ), stopping( false ) { }
+
+   virtual ~stand_in_server( )
+   {
+      for( size_t i = 0; i < sessions.size( ); i++ )
+         delete sessions[ i ];
+   }
+
+   void start( )
+   {
+      if( !listener.open( ) )
+         throw std::runtime_error( "unable to open listener socket" );
+
+      listener.set_reuse_addr( );
+
+      if( !listener.bind( ip_address( port ) ) || !listener.listen( ) )
+         throw std::runtime_error( "unable to listen on port " + to_string( port ) );
+
+      ap_acceptor.reset( new acceptor( *this ) );
+      ap_acceptor->start( true );
+   }
+
+   void stop( )
+   {
+      // NOTE: Scope for guard object.
+      {
+         guard g( server_mutex );
+         stopping = true;
+      }
+
+      if( ap_acceptor.get( ) )
+      {
+         ap_acceptor->join( );
+         ap_acceptor.reset( );
+      }
+
+      listener.close( );
+
+      reap_sessions( true );
+   }
+
+   bool is_stopping( ) const
+   {
+      guard g( server_mutex );
+      return stopping;
+   }
+
+   protected:
+   virtual void accept_session( tcp_socket* p_socket )
+   {
+      std::auto_ptr< session > ap_session( new session( *this, p_socket ) );
+
+      guard g( server_mutex );
+
+      sessions.push_back( ap_session.get( ) );
+      ap_session.release( )->start( true );
+   }
+
+   virtual void handle_session( tcp_socket& socket ) = 0;
+
+   private:
+   class acceptor : public thread
+   {
+      public:
+      acceptor( stand_in_server& server ) : server( server ) { }
+
+      void on_start( )
+      {
+         while( !server.is_stopping( ) )
+         {
+            ip_address address;
+            std::auto_ptr< tcp_socket > ap_socket( new tcp_socket( server.listener.accept( address, c_stand_in_accept_timeout ) ) );
+
+            if( *ap_socket )
+            {
+               ap_socket->set_no_delay( );
+               server.accept_session( ap_socket.release( ) );
+            }
+
+            server.reap_sessions( false );
+         }
+      }
+
+      private:
+      stand_in_server& server;
+   };
+
+   class session : public thread
+   {
+      public:
+      session( stand_in_server& server, tcp_socket* p_socket ) : server( server ), ap_socket( p_socket ), finished( false ) { }
+
+      void on_start( )
+      {
+         try
+         {
+            server.handle_session( *ap_socket );
+         }
+         catch( ... )
+         {
+         }
+
+         ap_socket->close( );
+
+         guard g( server.server_mutex );
+         finished = true;
+      }
+
+      bool has_finished( ) const { return finished; }
+
+      private:
+      stand_in_server& server;
+      std::auto_ptr< tcp_socket > ap_socket;
+
+      bool finished;
+   };
+
+   void reap_sessions( bool all )
+   {
+      std::vector< session* > reaped;
+
+      // NOTE: Scope for guard object.
+      {
+         guard g( server_mutex );
+
+         for( size_t i = 0; i < sessions.size( ); )
+         {
+            if( all || sessions[ i ]->has_finished( ) )
+            {
+               reaped.push_back( sessions[ i ] );
+               sessions.erase( sessions.begin( ) + i );
+            }
+            else
+               ++i;
+         }
+      }
+
+      for( size_t i = 0; i < reaped.size( ); i++ )
+      {
+         reaped[ i ]->join( );
+         delete reaped[ i ];
+      }
+   }
+
+   int port;
+   bool stopping;
+
+   tcp_socket listener;
+
+   mutable mutex server_mutex;
+
+   std::auto_ptr< acceptor > ap_acceptor;
+   std::vector< session* > sessions;
+
+   stand_in_server( const stand_in_server& );
+   stand_in_server& operator =( const stand_in_server& );
+};
+
+#endif
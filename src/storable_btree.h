@@ -26,6 +26,24 @@
 
 using namespace btree;
 
+// NOTE: An item type can provide overloads of these functions (which are also given the item that
+// precedes it in the node or zero if it is the first) so that it can store its key compressed as a
+// prefix length shared with the preceding item's key followed by just the rest of its own key.
+template< typename T > inline int64_t size_of_prefixed( const T& t, const T* )
+{
+   return size_of( const_cast< T& >( t ) );
+}
+
+template< typename T > inline void read_prefixed( read_stream& rs, T& t, const T* )
+{
+   rs >> t;
+}
+
+template< typename T > inline void write_prefixed( write_stream& ws, const T& t, const T* )
+{
+   ws << const_cast< T& >( t );
+}
+
 // NOTE: This approach is necessary to force template instanciation to occur (at least with BCB).
 template< typename T > class storable_node_base;
 template< typename T > int64_t size_of( const storable_node_base< T >& s );
@@ -41,21 +59,22 @@ template< typename T > class storable_node_base : public bt_node< T >, public st
    friend read_stream& operator >> < T >( read_stream& rs, storable_node_base< T >& s );
    friend write_stream& operator << < T >( write_stream& ws, const storable_node_base< T >& s );
 
-   static const uint8_t c_version = 1;
+   // NOTE: Version 1 nodes have an 8 bit item count and items that are stored in full whereas
+   // version 2 nodes have a 16 bit item count and items that are stored "prefixed" (see above).
+   static const uint8_t c_version = 2;
+   static const uint8_t c_version_with_full_items = 1;
+
    static const size_t c_round_to_value = STORABLE_BTREE_NODE_SIZE;
 };
 
 template< typename T > int64_t size_of( const storable_node_base< T >& s )
 {
-   uint8_t num = s.size( );
+   uint16_t num = s.size( );
 
-   size_t total = ( sizeof( uint8_t ) * 2 ) + sizeof( typename storable_node_base< T >::node_data );
+   size_t total = sizeof( uint8_t ) + sizeof( uint16_t ) + sizeof( typename storable_node_base< T >::node_data );
 
-   for( uint8_t i = 0; i < num; i++ )
-   {
-      T& t = const_cast< T& >( s.get_item_data( i ) );
-      total += size_of( t ) + sizeof( oid );
-   }
+   for( uint16_t i = 0; i < num; i++ )
+      total += size_of_prefixed( s.get_item_data( i ), i ? &s.get_item_data( i - 1 ) : 0 ) + sizeof( oid );
 
    return total;
 }
@@ -67,19 +86,35 @@ template< typename T > read_stream& operator >>( read_stream& rs, storable_node_
 
    s.reset( );
 
-   uint8_t ver, num;
-   rs >> ver >> num;
+   uint8_t ver;
+   uint16_t num;
+
+   rs >> ver;
+
+   if( ver == storable_node_base< T >::c_version_with_full_items )
+   {
+      uint8_t old_num;
+      rs >> old_num;
 
-   // FUTURE: If the persistent data structure is extended then the version should be used in
-   // order to handle legacy objects.
-   if( ver != storable_node_base< T >::c_version )
+      num = old_num;
+   }
+   else if( ver == storable_node_base< T >::c_version )
+      rs >> num;
+   else
       throw std::runtime_error( "found unexpected storable_node_base version: " + to_string( ver ) );
 
    rs >> s.data.flags >> s.data.padding >> s.data.dge_link >> s.data.lft_link >> s.data.rgt_link;
 
-   for( uint8_t i = 0; i < num; i++ )
+   s.reserve_items( num );
+
+   for( uint16_t i = 0; i < num; i++ )
    {
-      rs >> t >> link;
+      if( ver == storable_node_base< T >::c_version_with_full_items )
+         rs >> t;
+      else
+         read_prefixed( rs, t, i ? &s.get_item_data( i - 1 ) : 0 );
+
+      rs >> link;
       s.append_item( t, link );
    }
 
@@ -89,15 +124,15 @@ template< typename T > read_stream& operator >>( read_stream& rs, storable_node_
 template< typename T > write_stream& operator <<( write_stream& ws, const storable_node_base< T >& s )
 {
    uint8_t ver = storable_node_base< T >::c_version;
-   uint8_t num = s.size( );
+   uint16_t num = s.size( );
 
    ws << ver << num
     << s.data.flags << s.data.padding << s.data.dge_link << s.data.lft_link << s.data.rgt_link;
 
-   for( uint8_t i = 0; i < num; i++ )
+   for( uint16_t i = 0; i < num; i++ )
    {
-      T& t = const_cast< T& >( s.get_item_data( i ) );
-      ws << t << s.get_item_link( i );
+      write_prefixed( ws, s.get_item_data( i ), i ? &s.get_item_data( i - 1 ) : 0 );
+      ws << s.get_item_link( i );
    }
 
    return ws;
@@ -269,7 +304,10 @@ template< typename T, typename L = std::less< T > > class storable_btree_base
    friend read_stream& operator >> < T, L >( read_stream& rs, storable_btree_base< T, L >& s );
    friend write_stream& operator << < T, L >( write_stream& ws, const storable_btree_base< T, L >& s );
 
-   static const uint8_t c_version = 1;
+   // NOTE: Version 1 has an 8 bit items per node value whereas version 2 has a 16 bit one.
+   static const uint8_t c_version = 2;
+   static const uint8_t c_version_with_small_nodes = 1;
+
    static const size_t c_round_to_value = STORABLE_BTREE_SIZE;
 
    private:
@@ -284,20 +322,28 @@ template< typename T, typename L = std::less< T > > class storable_btree_base
 
 template< typename T, typename L > int64_t size_of( const storable_btree_base< T, L >& bt )
 {
-   size_t total = ( sizeof( uint8_t ) * 2 ) + sizeof( typename storable_btree_base< T, L >::state_t );
+   size_t total = sizeof( uint8_t ) + sizeof( uint16_t ) + sizeof( typename storable_btree_base< T, L >::state_t );
 
    return total;
 }
 
 template< typename T, typename L > read_stream& operator >>( read_stream& rs, storable_btree_base< T, L >& s )
 {
-   uint8_t ver, items_per_node;
+   uint8_t ver;
+   uint16_t items_per_node;
 
-   rs >> ver >> items_per_node;
+   rs >> ver;
 
-   // FUTURE: If the persistent data structure is extended then the version should be used in
-   // order to handle legacy objects.
-   if( ver != storable_btree_base< T, L >::c_version )
+   if( ver == storable_btree_base< T, L >::c_version_with_small_nodes )
+   {
+      uint8_t old_items_per_node;
+      rs >> old_items_per_node;
+
+      items_per_node = old_items_per_node;
+   }
+   else if( ver == storable_btree_base< T, L >::c_version )
+      rs >> items_per_node;
+   else
       throw std::runtime_error( "found unexpected storable_btree_base version: " + to_string( ver ) );
 
    rs >> s.state.num_levels
@@ -315,7 +361,7 @@ template< typename T, typename L >
  write_stream& operator <<( write_stream& ws, const storable_btree_base< T, L >& s )
 {
    uint8_t ver = storable_btree_base< T, L >::c_version;
-   uint8_t items_per_node = s.get_node_manager( ).get_items_per_node( );
+   uint16_t items_per_node = s.get_node_manager( ).get_items_per_node( );
 
    ws << ver << items_per_node << s.state.num_levels
     << s.state.node_fill_factor << s.state.allow_duplicates
@@ -0,0 +1,522 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef PRECOMPILE_H
+#  include "precompile.h"
+#endif
+#pragma hdrstop
+
+#ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <cstdlib>
+#  include <string>
+#  include <vector>
+#  include <iostream>
+#  include <stdexcept>
+#endif
+
+#include "base64.h"
+#include "utilities.h"
+
+using namespace std;
+
+// NOTE: This program checks that base64 encoding, decoding and validation produces the same
+// results as the original implementation (a copy of which is included here) for every "simd"
+// level that is supported by the CPU (including with the streaming encoder and decoder) and
+// then outputs the throughput (in MB/s) of the original implementation and of each level. The
+// "-test" option instead checks some known values (along with every supported level) and as it
+// will not output timings (or which levels are supported) its results will be the same for all
+// runs.
+
+const size_t c_default_megabytes = 16;
+
+const size_t c_max_check_length = 300;
+const size_t c_num_invalid_checks = 20000;
+
+const char c_fillchar = '=';
+
+const char* const c_level_names[ ] = { "scalar", "ssse3", "avx2" };
+
+const char* const c_invalid_chars = "=.-_ \n*\x80";
+
+const char* const c_test_option = "-test";
+
+// NOTE: The test vectors from RFC 4648 followed by some invalid values.
+const char* const c_test_values[ ] = { "", "f", "fo", "foo", "foob", "fooba", "foobar" };
+const char* const c_invalid_values[ ] = { "Zg=", "Zg=a", "Z===", "Zm9v YmFy", "Zm9vYg==Zm9v", "Zm9v*mFy" };
+
+namespace
+{
+
+const string g_b64_table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+unsigned int g_seed = 1;
+
+unsigned int next_random( )
+{
+   g_seed = ( g_seed * 1103515245 ) + 12345;
+
+   return ( g_seed >> 16 ) & 0x7fff;
+}
+
+string random_data( size_t length )
+{
+   string data( length, '\0' );
+
+   for( size_t i = 0; i < length; i++ )
+      data[ i ] = ( char )next_random( );
+
+   return data;
+}
+
+char original_get_b64_char_value( char c )
+{
+   if( c >= 'a' )
+      return c - 'a' + 26;
+
+   if( c >= 'A' )
+      return c - 'A';
+
+   if( c >= '0' )
+      return c - '0' + 52;
+
+   return c == '+' ? 62 : 63;
+}
+
+void original_encode( const unsigned char* p_dat, size_t length, char* p_enc )
+{
+   char c;
+   string::size_type i, o = 0;
+   string::size_type len = length;
+
+   for( i = 0; i < len; ++i )
+   {
+      c = ( p_dat[ i ] >> 2 ) & 0x3f;
+      p_enc[ o++ ] = g_b64_table[ c ];
+
+      c = ( p_dat[ i ] << 4 ) & 0x3f;
+
+      if( ++i < len )
+         c |= ( p_dat[ i ] >> 4 ) & 0x0f;
+
+      p_enc[ o++ ] = g_b64_table[ c ];
+
+      if( i < len )
+      {
+         c = ( p_dat[ i ] << 2 ) & 0x3f;
+         if( ++i < len )
+            c |= ( p_dat[ i ] >> 6 ) & 0x03;
+
+         p_enc[ o++ ] = g_b64_table[ c ];
+      }
+      else
+      {
+         ++i;
+         p_enc[ o++ ] = c_fillchar;
+      }
+
+      if( i < len )
+      {
+         c = p_dat[ i ] & 0x3f;
+         p_enc[ o++ ] = g_b64_table[ c ];
+      }
+      else
+         p_enc[ o++ ] = c_fillchar;
+   }
+}
+
+string original_encode( const string& input )
+{
+   string str( base64::encode_size( input.length( ) ), '\0' );
+   original_encode( ( const unsigned char* )input.data( ), input.length( ), &str[ 0 ] );
+
+   return str;
+}
+
+bool original_validate( const string& input )
+{
+   bool invalid = false;
+
+   if( !input.length( ) || input.length( ) % 4 != 0 )
+      invalid = true;
+   else
+   {
+      size_t i;
+
+      for( i = 0; i < input.length( ); i++ )
+      {
+         if( g_b64_table.find( input[ i ] ) == string::npos )
+            break;
+      }
+
+      if( i < input.length( ) - 2 )
+         invalid = true;
+      else if( i < input.length( ) )
+      {
+         if( input[ i ] != '=' )
+            invalid = true;
+         else if( i == input.length( ) - 2 )
+         {
+            if( input[ i + 1 ] != '=' )
+               invalid = true;
+         }
+      }
+   }
+
+   return !invalid;
+}
+
+bool original_valid_characters( const string& input )
+{
+   if( !input.length( ) || input.length( ) % 4 != 0 )
+      return false;
+
+   return input.find_first_not_of( g_b64_table + c_fillchar ) == string::npos;
+}
+
+void original_decode( const string& input, unsigned char* p_data )
+{
+   char c;
+   char c1;
+   string::size_type o = 0;
+   string::size_type len = input.length( );
+
+   for( string::size_type i = 0; i < len; ++i )
+   {
+      c = original_get_b64_char_value( input[ i ] );
+      ++i;
+
+      c1 = original_get_b64_char_value( input[ i ] );
+      c = ( c << 2 ) | ( ( c1 >> 4 ) & 0x03 );
+
+      p_data[ o++ ] = c;
+
+      if( ++i < len )
+      {
+         c = input[ i ];
+         if( c == c_fillchar )
+            break;
+
+         c = original_get_b64_char_value( c );
+         c1 = ( ( c1 << 4 ) & 0xf0 ) | ( ( c >> 2 ) & 0x0f );
+
+         p_data[ o++ ] = c1;
+      }
+
+      if( ++i < len )
+      {
+         c1 = input[ i ];
+         if( c1 == c_fillchar )
+            break;
+
+         c1 = original_get_b64_char_value( c1 );
+         c = ( ( c << 6 ) & 0xc0 ) | c1;
+
+         p_data[ o++ ] = c;
+      }
+   }
+}
+
+string original_decode( const string& input )
+{
+   // NOTE: Extra space is allocated as the original decoding can write past the decoded size if
+   // the input is not valid.
+   string str( base64::decode_size( input ) + 4, '\0' );
+   original_decode( input, ( unsigned char* )&str[ 0 ] );
+
+   str.resize( base64::decode_size( input ) );
+
+   return str;
+}
+
+string streamed_encode( const string& data )
+{
+   string output;
+   base64_encoder encoder;
+
+   for( size_t i = 0; i < data.size( ); )
+   {
+      size_t chunk = min( data.size( ) - i, ( size_t )( next_random( ) % 40 ) );
+
+      encoder.update( ( const unsigned char* )data.data( ) + i, chunk, output );
+      i += chunk;
+   }
+
+   encoder.finish( output );
+
+   return output;
+}
+
+string streamed_decode( const string& encoded )
+{
+   string output;
+   base64_decoder decoder;
+
+   for( size_t i = 0; i < encoded.size( ); )
+   {
+      size_t chunk = min( encoded.size( ) - i, ( size_t )( next_random( ) % 40 ) );
+
+      decoder.update( encoded.data( ) + i, chunk, output );
+      i += chunk;
+   }
+
+   decoder.finish( );
+
+   return output;
+}
+
+size_t check_level( base64::simd_level level, bool output = true )
+{
+   size_t num_errors = 0;
+
+   base64::set_simd_level( level );
+
+   for( size_t length = 0; length <= c_max_check_length; length++ )
+   {
+      string data( random_data( length ) );
+      string encoded( base64::encode( data ) );
+
+      if( encoded != original_encode( data ) )
+         ++num_errors;
+
+      if( streamed_encode( data ) != encoded )
+         ++num_errors;
+
+      if( length )
+      {
+         bool rc = false;
+
+         if( base64::decode( encoded ) != data
+          || base64::validate_and_decode( encoded, &rc ) != data || !rc )
+            ++num_errors;
+
+         if( streamed_decode( encoded ) != data )
+            ++num_errors;
+
+         if( !base64::valid_characters( encoded ) )
+            ++num_errors;
+
+         base64::validate( encoded, &rc );
+
+         if( !rc )
+            ++num_errors;
+      }
+   }
+
+   // NOTE: Check that invalid characters (and misplaced fill chars) are being handled identically.
+   string invalid_chars( c_invalid_chars );
+
+   for( size_t i = 0; i < c_num_invalid_checks; i++ )
+   {
+      string encoded( base64::encode( random_data( 1 + ( next_random( ) % c_max_check_length ) ) ) );
+
+      size_t num_changes = 1 + ( next_random( ) % 2 );
+
+      for( size_t j = 0; j < num_changes; j++ )
+      {
+         // NOTE: Changes are more likely to occur near the end (to test the handling of padding).
+         size_t pos = encoded.size( ) - 1 - ( next_random( ) % ( j ? encoded.size( ) : min( ( size_t )6, encoded.size( ) ) ) );
+
+         encoded[ pos ] = invalid_chars[ next_random( ) % invalid_chars.size( ) ];
+      }
+
+      bool rc = false;
+      base64::validate( encoded, &rc );
+
+      if( rc != original_validate( encoded ) )
+         ++num_errors;
+
+      if( base64::valid_characters( encoded ) != original_valid_characters( encoded ) )
+         ++num_errors;
+
+      bool decoded_rc = false;
+      string decoded( base64::validate_and_decode( encoded, &decoded_rc ) );
+
+      if( decoded_rc != rc )
+         ++num_errors;
+
+      string expected( original_decode( encoded ) );
+
+      string actual( base64::decode_size( encoded ) + 4, '\0' );
+      base64::decode( encoded, ( unsigned char* )&actual[ 0 ], actual.size( ) );
+
+      actual.resize( base64::decode_size( encoded ) );
+
+      if( actual != expected || ( rc && decoded != expected ) )
+         ++num_errors;
+   }
+
+   if( output )
+      cout << c_level_names[ level ] << ": " << num_errors << " errors" << endl;
+
+   return num_errors;
+}
+
+size_t check_values( base64::simd_level max_level )
+{
+   size_t num_errors = 0;
+
+   for( size_t i = 0; i < sizeof( c_test_values ) / sizeof( c_test_values[ 0 ] ); i++ )
+   {
+      string encoded( base64::encode( c_test_values[ i ] ) );
+
+      cout << "encode \"" << c_test_values[ i ] << "\": \"" << encoded << "\"" << endl;
+
+      for( int level = base64::e_simd_level_none; level <= max_level; level++ )
+      {
+         base64::set_simd_level( ( base64::simd_level )level );
+
+         if( base64::encode( c_test_values[ i ] ) != encoded
+          || ( !encoded.empty( ) && base64::decode( encoded ) != c_test_values[ i ] ) )
+            ++num_errors;
+      }
+   }
+
+   for( size_t i = 0; i < sizeof( c_invalid_values ) / sizeof( c_invalid_values[ 0 ] ); i++ )
+   {
+      bool rc = true;
+
+      for( int level = base64::e_simd_level_none; level <= max_level; level++ )
+      {
+         base64::set_simd_level( ( base64::simd_level )level );
+
+         bool level_rc = false;
+         base64::validate( c_invalid_values[ i ], &level_rc );
+
+         if( level_rc != original_validate( c_invalid_values[ i ] ) )
+            ++num_errors;
+
+         if( level == base64::e_simd_level_none )
+            rc = level_rc;
+      }
+
+      cout << "validate \"" << c_invalid_values[ i ] << "\": " << ( rc ? "valid" : "invalid" ) << endl;
+   }
+
+   base64::set_simd_level( max_level );
+
+   return num_errors;
+}
+
+void output_rate( const string& name, size_t num_bytes, unsigned long usecs )
+{
+   cout << "  " << name << ": " << ( usecs / 1000 ) << " msecs";
+
+   if( usecs )
+      cout << " (" << ( ( double )num_bytes / usecs ) << " MB/s)";
+
+   cout << endl;
+}
+
+void perform_bench( size_t megabytes, base64::simd_level max_level )
+{
+   string data( random_data( megabytes * 1024 * 1024 ) );
+
+   string encoded( base64::encode_size( data.size( ) ), '\0' );
+   string decoded( data.size( ), '\0' );
+
+   cout << "\nencode (" << data.size( ) << " bytes):" << endl;
+
+   unsigned long start = get_usecs( );
+   original_encode( ( const unsigned char* )data.data( ), data.size( ), &encoded[ 0 ] );
+
+   output_rate( "original", data.size( ), get_usecs( ) - start );
+
+   for( int level = base64::e_simd_level_none; level <= max_level; level++ )
+   {
+      base64::set_simd_level( ( base64::simd_level )level );
+
+      start = get_usecs( );
+      base64::encode( ( const unsigned char* )data.data( ), data.size( ), &encoded[ 0 ] );
+
+      output_rate( c_level_names[ level ], data.size( ), get_usecs( ) - start );
+   }
+
+   cout << "\nvalidate and decode (" << encoded.size( ) << " chars):" << endl;
+
+   start = get_usecs( );
+
+   if( original_valid_characters( encoded ) )
+      original_decode( encoded, ( unsigned char* )&decoded[ 0 ] );
+
+   output_rate( "original", encoded.size( ), get_usecs( ) - start );
+
+   for( int level = base64::e_simd_level_none; level <= max_level; level++ )
+   {
+      base64::set_simd_level( ( base64::simd_level )level );
+
+      size_t dec_len = 0;
+
+      start = get_usecs( );
+      base64::decode_if_valid( encoded.data( ), encoded.size( ), ( unsigned char* )&decoded[ 0 ], &dec_len );
+
+      output_rate( c_level_names[ level ], encoded.size( ), get_usecs( ) - start );
+
+      if( decoded != data )
+         throw runtime_error( string( "unexpected decode result for " ) + c_level_names[ level ] );
+   }
+
+   base64::set_simd_level( max_level );
+}
+
+}
+
+int main( int argc, char* argv[ ] )
+{
+   if( argc > 2 )
+   {
+      cout << "usage: test_base64 [" << c_test_option << " | <megabytes>]" << endl;
+      return 0;
+   }
+
+   int rc = 0;
+
+   try
+   {
+      size_t megabytes = c_default_megabytes;
+
+      bool is_test = false;
+
+      if( argc > 1 )
+      {
+         if( string( argv[ 1 ] ) == c_test_option )
+            is_test = true;
+         else
+            megabytes = atoi( argv[ 1 ] );
+      }
+
+      if( !megabytes )
+         throw runtime_error( "invalid number of megabytes" );
+
+      base64::simd_level max_level = base64::set_simd_level( base64::e_simd_level_avx2 );
+
+      size_t num_errors = 0;
+
+      if( is_test )
+         num_errors += check_values( max_level );
+
+      for( int level = base64::e_simd_level_none; level <= max_level; level++ )
+         num_errors += check_level( ( base64::simd_level )level, !is_test );
+
+      if( is_test )
+         cout << "errors: " << num_errors << endl;
+      else
+         perform_bench( megabytes, max_level );
+
+      if( num_errors )
+         rc = 1;
+   }
+   catch( exception& x )
+   {
+      cerr << "error: " << x.what( ) << endl;
+      rc = 1;
+   }
+   catch( ... )
+   {
+      cerr << "error: unexpected exception caught" << endl;
+      rc = 2;
+   }
+
+   return rc;
+}
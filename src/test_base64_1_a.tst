@@ -0,0 +1,14 @@
+encode "": ""
+encode "f": "Zg=="
+encode "fo": "Zm8="
+encode "foo": "Zm9v"
+encode "foob": "Zm9vYg=="
+encode "fooba": "Zm9vYmE="
+encode "foobar": "Zm9vYmFy"
+validate "Zg=": invalid
+validate "Zg=a": invalid
+validate "Z===": invalid
+validate "Zm9v YmFy": invalid
+validate "Zm9vYg==Zm9v": invalid
+validate "Zm9v*mFy": invalid
+errors: 0
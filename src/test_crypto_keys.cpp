@@ -9,11 +9,24 @@
 #pragma hdrstop
 
 #ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <cstdlib>
+#  include <cstring>
 #  include <iomanip>
 #  include <iostream>
 #  include <stdexcept>
 #endif
 
+#ifdef _WIN32
+#  ifndef STRICT
+#     define STRICT // Needed for "windows.h" by various Borland headers.
+#  endif
+#  define NOMINMAX
+#  include <windows.h>
+#else
+#  include <unistd.h>
+#  include <sys/time.h>
+#endif
+
 #include "crypto_keys.h"
 
 #include "utilities.h"
@@ -22,10 +35,422 @@
 
 using namespace std;
 
-int main( )
+namespace
+{
+
+const size_t c_num_signers = 10;
+const size_t c_default_checks = 100;
+const size_t c_default_signatures = 1000;
+
+const size_t c_scalar_size = 32;
+
+const char* const c_bench_prefix = "@bench";
+const char* const c_check_prefix = "@check";
+const char* const c_threads_prefix = "-t=";
+
+// NOTE: This is the order (n) of the secp256k1 curve.
+const unsigned char c_curve_order[ c_scalar_size ] =
+{
+   0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+   0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48, 0xa0, 0x3b, 0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x41
+};
+
+size_t get_num_cpus( )
+{
+#ifdef _WIN32
+   SYSTEM_INFO info;
+   ::GetSystemInfo( &info );
+
+   return info.dwNumberOfProcessors;
+#else
+   long num = ::sysconf( _SC_NPROCESSORS_ONLN );
+
+   return num > 0 ? num : 1;
+#endif
+}
+
+struct signed_message
+{
+   string key;
+   string msg;
+   string sig;
+};
+
+void output_rate( const string& name, size_t num_verifications, unsigned long usecs )
+{
+   cout << "  " << name << ": " << ( usecs / 1000 ) << " msecs";
+
+   if( usecs )
+      cout << " (" << ( unsigned long )( num_verifications * 1000000.0 / usecs ) << " verifications/sec)";
+
+   cout << endl;
+}
+
+void verify_individually( const string& name, const vector< signed_message >& messages )
+{
+   unsigned long start = get_usecs( );
+
+   for( size_t i = 0; i < messages.size( ); i++ )
+   {
+      public_key pub( messages[ i ].key );
+
+      if( !pub.verify_signature( messages[ i ].msg, messages[ i ].sig ) )
+         throw runtime_error( "unexpected signature verification failure for " + name );
+   }
+
+   output_rate( name, messages.size( ), get_usecs( ) - start );
+}
+
+void check_verifiers( const vector< signed_message >& messages )
+{
+   vector< public_key* > keys;
+   vector< signature_verification > verifications;
+
+   for( size_t i = 0; i < messages.size( ); i++ )
+   {
+      keys.push_back( new public_key( messages[ i ].key ) );
+
+      // NOTE: Every third message is altered so that its signature should not be verified.
+      verifications.push_back( signature_verification( *keys.back( ),
+       messages[ i ].msg + ( i % 3 ? "" : "." ), messages[ i ].sig ) );
+   }
+
+   vector< bool > openssl_results, secp256k1_results;
+
+   set_signature_verifier( e_signature_verifier_openssl );
+   verify_signatures( verifications, openssl_results );
+
+   set_signature_verifier( e_signature_verifier_secp256k1 );
+   verify_signatures( verifications, secp256k1_results, 2 );
+
+   for( size_t i = 0; i < keys.size( ); i++ )
+      delete keys[ i ];
+
+   for( size_t i = 0; i < openssl_results.size( ); i++ )
+   {
+      if( openssl_results[ i ] != ( i % 3 != 0 ) || secp256k1_results[ i ] != openssl_results[ i ] )
+         throw runtime_error( "unexpected verification result mismatch for message #" + to_string( i ) );
+   }
+}
+
+void perform_bench( size_t num_signatures, size_t max_threads )
 {
+   vector< signed_message > messages;
+
+   private_key signers[ c_num_signers ];
+
+   for( size_t i = 0; i < num_signatures; i++ )
+   {
+      const private_key& signer( signers[ i % c_num_signers ] );
+
+      signed_message next;
+
+      next.key = signer.get_public( );
+      next.msg = "This is test message #" + to_string( i ) + ".";
+      next.sig = signer.construct_signature( next.msg, true );
+
+      messages.push_back( next );
+   }
+
+   check_verifiers( messages );
+
+   cout << "\nverifying " << num_signatures
+    << " signatures (from " << c_num_signers << " signers):" << endl;
+
+   size_t cache_limit = get_public_key_cache_limit( );
+
+   bool has_secp256k1 = false;
+
+   set_signature_verifier( e_signature_verifier_secp256k1 );
+
+   if( get_signature_verifier( ) == e_signature_verifier_secp256k1 )
+      has_secp256k1 = true;
+
+   for( size_t i = 0; i < 2; i++ )
+   {
+      set_signature_verifier( i ? e_signature_verifier_secp256k1 : e_signature_verifier_openssl );
+
+      if( i && !has_secp256k1 )
+         break;
+
+      string name( i ? "secp256k1" : "openssl" );
+
+      set_public_key_cache_limit( 0 );
+      verify_individually( name + " (uncached keys)", messages );
+
+      set_public_key_cache_limit( cache_limit );
+      verify_individually( name + " (cached keys)", messages );
+   }
+
+   vector< public_key* > keys;
+   vector< signature_verification > verifications;
+
+   for( size_t i = 0; i < messages.size( ); i++ )
+   {
+      keys.push_back( new public_key( messages[ i ].key ) );
+      verifications.push_back( signature_verification( *keys.back( ), messages[ i ].msg, messages[ i ].sig ) );
+   }
+
+   cout << "\nbatch verifying " << num_signatures << " signatures:" << endl;
+
    try
    {
+      for( size_t threads = 1; threads <= max_threads; threads *= 2 )
+      {
+         vector< bool > results;
+
+         unsigned long start = get_usecs( );
+         verify_signatures( verifications, results, threads );
+
+         output_rate( to_string( threads ) + " thread" + ( threads > 1 ? "s" : "" ), num_signatures, get_usecs( ) - start );
+
+         for( size_t i = 0; i < results.size( ); i++ )
+         {
+            if( !results[ i ] )
+               throw runtime_error( "unexpected batch verification failure for message #" + to_string( i ) );
+         }
+      }
+   }
+   catch( ... )
+   {
+      for( size_t i = 0; i < keys.size( ); i++ )
+         delete keys[ i ];
+
+      throw;
+   }
+
+   for( size_t i = 0; i < keys.size( ); i++ )
+      delete keys[ i ];
+}
+
+// NOTE: Scalars are big endian and are always "c_scalar_size" bytes.
+string scalar_from_integer( const string& value )
+{
+   string scalar( value );
+
+   while( scalar.size( ) > c_scalar_size && scalar[ 0 ] == '\0' )
+      scalar.erase( 0, 1 );
+
+   if( scalar.size( ) > c_scalar_size )
+      throw runtime_error( "unexpected integer size in scalar_from_integer" );
+
+   return string( c_scalar_size - scalar.size( ), '\0' ) + scalar;
+}
+
+// NOTE: Returns n - value (or n + value if "add" is true) with the latter only being used for
+// small values so that the result will still fit.
+string scalar_with_order( const string& value, bool add = false )
+{
+   string result( c_scalar_size, '\0' );
+
+   int carry = 0;
+
+   for( size_t i = c_scalar_size; i > 0; i-- )
+   {
+      int next = c_curve_order[ i - 1 ];
+
+      if( add )
+         next += ( unsigned char )value[ i - 1 ] + carry;
+      else
+         next -= ( unsigned char )value[ i - 1 ] + carry;
+
+      carry = 0;
+
+      if( next > 0xff )
+      {
+         carry = 1;
+         next -= 0x100;
+      }
+      else if( next < 0 )
+      {
+         carry = 1;
+         next += 0x100;
+      }
+
+      result[ i - 1 ] = ( char )next;
+   }
+
+   return result;
+}
+
+// NOTE: Encodes a scalar as a minimal DER integer (unless "leading_zeros" is non-zero in which
+// case additional zero bytes are prefixed and so the encoding will not be strict). If "padded"
+// is false then a value with its high bit set will not be prefixed by a zero (and so will be a
+// negative integer).
+string der_integer( const string& scalar, size_t leading_zeros = 0, bool padded = true )
+{
+   string value( scalar );
+
+   while( value.size( ) > 1 && value[ 0 ] == '\0' )
+      value.erase( 0, 1 );
+
+   if( padded && ( value[ 0 ] & 0x80 ) )
+      value = string( 1, '\0' ) + value;
+
+   value = string( leading_zeros, '\0' ) + value;
+
+   return string( 1, '\x02' ) + string( 1, ( char )value.size( ) ) + value;
+}
+
+string der_signature( const string& r, const string& s )
+{
+   string content( r + s );
+
+   return string( 1, '\x30' ) + string( 1, ( char )content.size( ) ) + content;
+}
+
+void split_der_signature( const string& der, string& r, string& s )
+{
+   if( der.size( ) < 8 || der[ 0 ] != '\x30' || der[ 2 ] != '\x02' )
+      throw runtime_error( "unexpected DER signature format" );
+
+   size_t r_size = ( unsigned char )der[ 3 ];
+
+   if( der.size( ) < 6 + r_size || der[ 4 + r_size ] != '\x02' )
+      throw runtime_error( "unexpected DER signature format" );
+
+   size_t s_size = ( unsigned char )der[ 5 + r_size ];
+
+   r = scalar_from_integer( der.substr( 4, r_size ) );
+   s = scalar_from_integer( der.substr( 6 + r_size, s_size ) );
+}
+
+string random_bytes( size_t num_bytes )
+{
+   string bytes( num_bytes, '\0' );
+
+   for( size_t i = 0; i < num_bytes; i++ )
+      bytes[ i ] = ( char )( rand( ) & 0xff );
+
+   return bytes;
+}
+
+// NOTE: Verifies each signature with both OpenSSL and the secp256k1 verifier (if available) and
+// counts any differences. Along with valid (and high S) signatures a number of invalid ones are
+// checked which include out of range r and s values, non-strict and negative DER integers and
+// randomly truncated, extended or altered encodings. The keys are random so the output is only
+// the number of signatures checked and the number of mismatches.
+void perform_check( size_t num_checks )
+{
+   srand( 1 );
+
+   size_t num_checked = 0;
+   size_t num_mismatches = 0;
+
+   string zero( c_scalar_size, '\0' );
+   string one( scalar_from_integer( string( 1, '\x01' ) ) );
+   string order( ( const char* )c_curve_order, c_scalar_size );
+   string maximum( c_scalar_size, '\xff' );
+
+   for( size_t i = 0; i < num_checks; i++ )
+   {
+      private_key priv_key;
+      public_key pub_key( priv_key.get_public( i % 2 == 0 ) );
+
+      string digest( random_bytes( c_scalar_size ) );
+      string other_digest( digest );
+
+      other_digest[ rand( ) % c_scalar_size ] ^= ( char )( 1 << ( rand( ) % 8 ) );
+
+      string der( hex_decode( priv_key.construct_signature( ( const unsigned char* )digest.data( ) ) ) );
+
+      string r, s;
+      split_der_signature( der, r, s );
+
+      vector< pair< string, string > > checks;
+
+      checks.push_back( make_pair( digest, der ) );
+      checks.push_back( make_pair( other_digest, der ) );
+
+      checks.push_back( make_pair( digest, der_signature( der_integer( r ), der_integer( scalar_with_order( s ) ) ) ) );
+
+      checks.push_back( make_pair( digest, der_signature( der_integer( zero ), der_integer( s ) ) ) );
+      checks.push_back( make_pair( digest, der_signature( der_integer( r ), der_integer( zero ) ) ) );
+      checks.push_back( make_pair( digest, der_signature( der_integer( order ), der_integer( s ) ) ) );
+      checks.push_back( make_pair( digest, der_signature( der_integer( r ), der_integer( order ) ) ) );
+      checks.push_back( make_pair( digest, der_signature( der_integer( scalar_with_order( one, true ) ), der_integer( s ) ) ) );
+      checks.push_back( make_pair( digest, der_signature( der_integer( r ), der_integer( scalar_with_order( one, true ) ) ) ) );
+      checks.push_back( make_pair( digest, der_signature( der_integer( maximum ), der_integer( s ) ) ) );
+      checks.push_back( make_pair( digest, der_signature( der_integer( r ), der_integer( maximum ) ) ) );
+
+      checks.push_back( make_pair( digest, der_signature( der_integer( r, 1 ), der_integer( s ) ) ) );
+      checks.push_back( make_pair( digest, der_signature( der_integer( r ), der_integer( s, 1 ) ) ) );
+      checks.push_back( make_pair( digest, der_signature( der_integer( r, 0, false ), der_integer( s, 0, false ) ) ) );
+
+      checks.push_back( make_pair( digest, der.substr( 0, 1 + ( rand( ) % ( der.size( ) - 1 ) ) ) ) );
+      checks.push_back( make_pair( digest, der + random_bytes( 1 ) ) );
+
+      string altered( der );
+      altered[ rand( ) % altered.size( ) ] ^= ( char )( 1 << ( rand( ) % 8 ) );
+
+      checks.push_back( make_pair( digest, altered ) );
+
+      for( size_t j = 0; j < checks.size( ); j++ )
+      {
+         string sig( hex_encode( checks[ j ].second ) );
+         const unsigned char* p_digest = ( const unsigned char* )checks[ j ].first.data( );
+
+         set_signature_verifier( e_signature_verifier_openssl );
+         bool openssl_okay = pub_key.verify_signature( p_digest, sig );
+
+         set_signature_verifier( e_signature_verifier_secp256k1 );
+         bool secp256k1_okay = pub_key.verify_signature( p_digest, sig );
+
+         ++num_checked;
+
+         if( openssl_okay != secp256k1_okay )
+         {
+            ++num_mismatches;
+            cerr << "mismatch for check #" << j << " (openssl = " << openssl_okay << "): " << sig << endl;
+         }
+      }
+   }
+
+   set_signature_verifier( e_signature_verifier_openssl );
+
+   cout << "checked " << num_checked << " signatures: " << num_mismatches << " mismatches" << endl;
+}
+
+}
+
+int main( int argc, char* argv[ ] )
+{
+   size_t num_checks = 0;
+   size_t num_threads = 0;
+   size_t num_signatures = 0;
+
+   for( int i = 1; i < argc; i++ )
+   {
+      string arg( argv[ i ] );
+
+      if( arg.find( c_threads_prefix ) == 0 )
+         num_threads = atoi( arg.substr( strlen( c_threads_prefix ) ).c_str( ) );
+      else if( arg == c_bench_prefix )
+         num_signatures = c_default_signatures;
+      else if( arg.find( string( c_bench_prefix ) + ':' ) == 0 )
+         num_signatures = atoi( arg.substr( strlen( c_bench_prefix ) + 1 ).c_str( ) );
+      else if( arg == c_check_prefix )
+         num_checks = c_default_checks;
+      else if( arg.find( string( c_check_prefix ) + ':' ) == 0 )
+         num_checks = atoi( arg.substr( strlen( c_check_prefix ) + 1 ).c_str( ) );
+      else
+      {
+         cout << "usage: test_crypto_keys [" << c_threads_prefix << "<threads>] ["
+          << c_bench_prefix << "[:<signatures>]] [" << c_check_prefix << "[:<checks>]]" << endl;
+         return 0;
+      }
+   }
+
+   try
+   {
+      // NOTE: As the keys being checked are random (and so would differ each run) only
+      // the check is performed.
+      if( num_checks )
+      {
+         perform_check( num_checks );
+         return 0;
+      }
+
       private_key skey( "18E14A7B6A307F426A94F8114701E7C8E774E7F9A47E2C2035DB29A206321725" );
 
       string key( skey.get_public( ) );
@@ -91,6 +516,9 @@ int main( )
       outputs.push_back( output_information( 20000, "1ciyam3htJit1feGa26p2wQ4aw6KFTejU" ) );
 
       cout << "\n" << construct_raw_transaction( inputs, outputs ) << endl;
+
+      if( num_signatures )
+         perform_bench( num_signatures, num_threads ? num_threads : get_num_cpus( ) );
    }
    catch( exception& x )
    {
@@ -0,0 +1 @@
+checked 1700 signatures: 0 mismatches
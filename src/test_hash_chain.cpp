@@ -10,6 +10,7 @@
 
 #ifndef HAS_PRECOMPILED_STD_HEADERS
 #  include <memory.h>
+#  include <cstdlib>
 #  include <vector>
 #  include <iostream>
 #  include <stdexcept>
@@ -30,14 +31,86 @@ const char* const c_test_hash_chain_external = "~test_hash_chain_external";
 
 const char* const c_test_hash_chain_password = "password";
 
-int main( )
+const char* const c_timings_option = "-timings";
+
+const unsigned int c_timings_length = 1000000;
+const unsigned int c_timings_num_calls = 1000;
+
+namespace
 {
+
+// NOTE: The first call for a new chain has to walk the entire chain (and creates the checkpoints
+// that are used by later calls) so it is timed separately from the calls that follow it (each of
+// which is checked to be the predecessor of the previously published hash).
+int perform_timings( unsigned int length )
+{
+   if( length <= c_timings_num_calls + 1 )
+      throw runtime_error( "chain length must be greater than " + to_string( c_timings_num_calls + 1 ) );
+
+   hash_chain chain_internal( c_test_hash_chain_internal, true, length, false );
+
+   unsigned long start = get_usecs( );
+
+   string last( chain_internal.get_next_hashes_to_publish( c_test_hash_chain_password ) );
+
+   unsigned long first_usecs = get_usecs( ) - start;
+
+   size_t num_errors = 0;
+   unsigned long max_usecs = 0;
+
+   start = get_usecs( );
+
+   for( unsigned int i = 0; i < c_timings_num_calls; i++ )
+   {
+      unsigned long call_start = get_usecs( );
+
+      string next( chain_internal.get_next_hashes_to_publish( c_test_hash_chain_password ) );
+
+      unsigned long call_usecs = get_usecs( ) - call_start;
+
+      if( call_usecs > max_usecs )
+         max_usecs = call_usecs;
+
+      if( !check_if_valid_hash_pair( next, last ) )
+         ++num_errors;
+
+      last = next;
+   }
+
+   unsigned long total_usecs = get_usecs( ) - start;
+
+   file_remove( c_test_hash_chain_internal );
+
+   cout << "chain length: " << length << '\n';
+   cout << "first call: " << ( first_usecs / 1000 ) << " msecs\n";
+
+   cout << "next " << c_timings_num_calls << " calls: " << ( total_usecs / 1000 )
+    << " msecs (avg " << ( total_usecs / c_timings_num_calls ) << " usecs, max " << max_usecs << " usecs)\n";
+
+   cout << "errors: " << num_errors << endl;
+
+   return num_errors ? 1 : 0;
+}
+
+}
+
+int main( int argc, char* argv[ ] )
+{
+   if( argc > 1 && ( string( argv[ 1 ] ) != c_timings_option || argc > 3 ) )
+   {
+      cout << "usage: test_hash_chain [" << c_timings_option << " [<length>]]" << endl;
+      return 0;
+   }
+
    unsigned char buffer[ c_buffer_size ];
 
    memset( buffer, 0, c_buffer_size );
 
    try
    {
+      if( argc > 1 )
+         return perform_timings( argc > 2 ? atoi( argv[ 2 ] ) : c_timings_length );
+
       cout << "01. create seedless internal hash chain and get the last hash\n";
       hash_chain chain_internal( c_test_hash_chain_internal, true, c_test_rounds, false );
 
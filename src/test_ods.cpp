@@ -13,6 +13,7 @@
 #  include <stack>
 #  include <memory>
 #  include <vector>
+#  include <iomanip>
 #  include <sstream>
 #  include <iostream>
 #  include <algorithm>
@@ -36,6 +37,7 @@
 #include "oid_pointer.h"
 #include "storable_file.h"
 #include "console_commands.h"
+#include "ods_file_system.h"
 #include "read_write_stream.h"
 
 using namespace std;
@@ -50,6 +52,9 @@ const int c_max_trans_depth = 100;
 const char* const c_app_title = "test_ods";
 const char* const c_app_version = "0.1";
 
+const char* const c_bench_ods_name = "test_ods_bench";
+const char* const c_bench_folder_name = "bench";
+
 const char* const c_cmd_exclusive = "x";
 const char* const c_cmd_use_transaction_log = "tlg";
 
@@ -82,6 +87,66 @@ string application_title( app_info_request request )
    }
 }
 
+void remove_bench_ods_files( )
+{
+   string name( c_bench_ods_name );
+
+   file_remove( name + ".dat" );
+   file_remove( name + ".hdr" );
+   file_remove( name + ".idx" );
+   file_remove( name + ".ops" );
+   file_remove( name + ".tlg" );
+   file_remove( name + ".fre" );
+}
+
+// NOTE: Used by the serialisation benchmark (which needs an object that consists mostly
+// of a string and a vector of primitives so that their (de)serialisation will dominate).
+class bench_object_base : public storable_base
+{
+   public:
+   bench_object_base( ) { }
+
+   bench_object_base( size_t data_size )
+    :
+    data( data_size, 'x' ),
+    values( data_size / sizeof( uint32_t ) )
+   {
+      for( size_t i = 0; i < values.size( ); i++ )
+         values[ i ] = i;
+   }
+
+   const string& get_data( ) const { return data; }
+   const vector< uint32_t >& get_values( ) const { return values; }
+
+   friend int64_t size_of( const bench_object_base& o );
+
+   friend read_stream& operator >>( read_stream& rs, bench_object_base& o );
+   friend write_stream& operator <<( write_stream& ws, const bench_object_base& o );
+
+   private:
+   string data;
+   vector< uint32_t > values;
+};
+
+typedef storable< bench_object_base > bench_object;
+
+int64_t size_of( const bench_object_base& o )
+{
+   return size_determiner( &o.data ) + size_determiner( &o.values );
+}
+
+read_stream& operator >>( read_stream& rs, bench_object_base& o )
+{
+   rs >> o.data >> o.values;
+   return rs;
+}
+
+write_stream& operator <<( write_stream& ws, const bench_object_base& o )
+{
+   ws << o.data << o.values;
+   return ws;
+}
+
 struct temp_read_outline_description;
 
 class outline_base;
@@ -831,6 +896,26 @@ void test_ods_command_functor::operator ( )( const string& command, const parame
          handler.issue_command_reponse( "completed" );
       }
    }
+   else if( command == c_cmd_test_ods_compact )
+   {
+      string max_objects( get_parm_val( parameters, c_cmd_test_ods_compact_max_objects ) );
+
+      if( g_shared_write )
+         handler.issue_command_reponse( "*** must be locked for exclusive write to perform this operation ***" );
+      else
+      {
+         int64_t num_moved = o.compact_data( max_objects.empty( ) ? 1 : atoi( max_objects.c_str( ) ) );
+         handler.issue_command_reponse( "moved " + to_string( num_moved ) + " object(s)" );
+      }
+   }
+   else if( command == c_cmd_test_ods_free )
+   {
+      ostringstream osstr;
+      o.dump_free_data( osstr );
+
+      string info( osstr.str( ) );
+      handler.issue_command_reponse( info.substr( 0, info.length( ) - 1 ) );
+   }
    else if( command == c_cmd_test_ods_truncate )
    {
       if( g_shared_write )
@@ -838,6 +923,128 @@ void test_ods_command_functor::operator ( )( const string& command, const parame
       else
          o.truncate_log( );
    }
+   else if( command == c_cmd_test_ods_bench_ofs )
+   {
+      size_t num_files = atoi( get_parm_val( parameters, c_cmd_test_ods_bench_ofs_num_files ).c_str( ) );
+
+      // NOTE: A separate ODS is used for this so that it won't be affected by the test ODS content.
+      remove_bench_ods_files( );
+
+      // NOTE: Scope for ODS and file system objects.
+      {
+         ods bench_ods( c_bench_ods_name, ods::e_open_mode_create_if_not_exist, ods::e_write_mode_exclusive );
+
+         ods_file_system ofs( bench_ods );
+
+         ofs.add_folder( c_bench_folder_name );
+         ofs.set_folder( c_bench_folder_name );
+
+         unsigned long start = get_msecs( );
+
+         // NOTE: The file names are spread so that inserts will not simply be appends.
+         for( size_t i = 0; i < num_files; i++ )
+         {
+            ostringstream osstr;
+            osstr << "file_" << setw( 8 ) << setfill( '0' ) << ( ( i * 7919 ) % num_files ) << '_' << i;
+
+            ofs.add_file( osstr.str( ), "*" );
+         }
+
+         unsigned long added = get_msecs( );
+
+         vector< string > files;
+         ofs.list_files( files );
+
+         unsigned long listed = get_msecs( );
+
+         size_t num_found = 0;
+
+         for( size_t i = 0; i < files.size( ); i++ )
+         {
+            if( ofs.has_file( files[ ( i * 7919 ) % files.size( ) ] ) )
+               ++num_found;
+         }
+
+         unsigned long found = get_msecs( );
+
+         handler.issue_command_reponse( "added " + to_string( num_files )
+          + " files in " + to_string( added - start ) + " msecs" );
+
+         handler.issue_command_reponse( "listed " + to_string( files.size( ) )
+          + " files in " + to_string( listed - added ) + " msecs" );
+
+         handler.issue_command_reponse( "found " + to_string( num_found )
+          + " files in " + to_string( found - listed ) + " msecs" );
+      }
+
+      remove_bench_ods_files( );
+   }
+   else if( command == c_cmd_test_ods_bench_ser )
+   {
+      size_t num_objects = atoi( get_parm_val( parameters, c_cmd_test_ods_bench_ser_num_objects ).c_str( ) );
+      size_t object_size = atoi( get_parm_val( parameters, c_cmd_test_ods_bench_ser_object_size ).c_str( ) );
+
+      remove_bench_ods_files( );
+
+      // NOTE: Scope for ODS object.
+      {
+         ods bench_ods( c_bench_ods_name, ods::e_open_mode_create_if_not_exist, ods::e_write_mode_exclusive );
+
+         bench_object source( object_size );
+
+         int64_t total_bytes = size_of( source ) * num_objects;
+
+         vector< oid > ids;
+         ids.reserve( num_objects );
+
+         unsigned long start = get_msecs( );
+
+         // NOTE: Scope for bulk write object.
+         {
+            ods::bulk_write bulk( bench_ods );
+
+            for( size_t i = 0; i < num_objects; i++ )
+            {
+               source.set_new( );
+               bench_ods << source;
+
+               ids.push_back( source.get_id( ) );
+            }
+         }
+
+         unsigned long written = get_msecs( );
+
+         size_t num_okay = 0;
+
+         // NOTE: Scope for bulk read object.
+         {
+            ods::bulk_read bulk( bench_ods );
+
+            bench_object dest;
+
+            for( size_t i = 0; i < num_objects; i++ )
+            {
+               dest.set_id( ids[ i ] );
+               bench_ods >> dest;
+
+               if( dest.get_data( ) == source.get_data( ) && dest.get_values( ) == source.get_values( ) )
+                  ++num_okay;
+            }
+         }
+
+         unsigned long read = get_msecs( );
+
+         handler.issue_command_reponse( "wrote " + to_string( num_objects ) + " objects ("
+          + to_string( total_bytes ) + " bytes) in " + to_string( written - start ) + " msecs"
+          + ( written > start ? " (" + to_string( total_bytes / 1000 / ( written - start ) ) + " MB/s)" : string( ) ) );
+
+         handler.issue_command_reponse( "read " + to_string( num_okay ) + " objects ("
+          + to_string( total_bytes ) + " bytes) in " + to_string( read - written ) + " msecs"
+          + ( read > written ? " (" + to_string( total_bytes / 1000 / ( read - written ) ) + " MB/s)" : string( ) ) );
+      }
+
+      remove_bench_ods_files( );
+   }
    else if( command == c_cmd_test_ods_exit )
    {
       while( trans_level )
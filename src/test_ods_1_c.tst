@@ -13,37 +13,37 @@ Data Transformation Id = 16
 Index Transformation Id = 39
 
 ** Entry Info for: 0-13
-num: 0000000000000000          pos: 0000000000000000          len: 0000000000000034
+num: 0000000000000000          pos: 000000000000006b          len: 0000000000000034
 txn: 0000000000000011          txo: 0000000000000000               flags: lk=0 tx=0
 
-num: 0000000000000001          pos: 00000000000000be          len: 0000000000000033
+num: 0000000000000001          pos: 00000000000000d9          len: 0000000000000033
 txn: 000000000000000c          txo: 0000000000000000               flags: lk=0 tx=0
 
-num: 0000000000000002          pos: 0000000000000034          len: 0000000000000033
+num: 0000000000000002          pos: 000000000000001b          len: 0000000000000033
 txn: 000000000000000c          txo: 0000000000000000               flags: lk=0 tx=0
 
-num: 0000000000000003          pos: 0000000000000149          len: 000000000000001b
+num: 0000000000000003          pos: 0000000000000000          len: 000000000000001b
 txn: 000000000000000d          txo: 0000000000000000               flags: lk=0 tx=0
 
 num: 0000000000000004          pos: 000000000000017f          len: 000000000000002d
 txn: 0000000000000010          txo: 0000000000000000               flags: lk=0 tx=0
 
-num: 0000000000000005          pos: 000000000000012c          len: 000000000000001d
+num: 0000000000000005          pos: 0000000000000147          len: 000000000000001d
 txn: 000000000000000c          txo: 0000000000000000               flags: lk=0 tx=0
 
-num: 0000000000000006          pos: 000000000000010e          len: 000000000000001e
+num: 0000000000000006          pos: 0000000000000129          len: 000000000000001e
 txn: 000000000000000c          txo: 0000000000000000               flags: lk=0 tx=0
 
-num: 0000000000000007          pos: 00000000000000f1          len: 000000000000001d
+num: 0000000000000007          pos: 000000000000010c          len: 000000000000001d
 txn: 000000000000000c          txo: 0000000000000000               flags: lk=0 tx=0
 
-num: 0000000000000008          pos: 00000000000000a1          len: 000000000000001d
+num: 0000000000000008          pos: 00000000000000bc          len: 000000000000001d
 txn: 000000000000000c          txo: 0000000000000000               flags: lk=0 tx=0
 
-num: 0000000000000009          pos: 0000000000000084          len: 000000000000001d
+num: 0000000000000009          pos: 000000000000009f          len: 000000000000001d
 txn: 000000000000000c          txo: 0000000000000000               flags: lk=0 tx=0
 
-num: 000000000000000a          pos: 0000000000000067          len: 000000000000001d
+num: 000000000000000a          pos: 000000000000004e          len: 000000000000001d
 txn: 000000000000000c          txo: 0000000000000000               flags: lk=0 tx=0
 
 num: 000000000000000b          pos: 0000000000000164          len: 000000000000001b
@@ -13,31 +13,31 @@ Data Transformation Id = 16
 Index Transformation Id = 39
 
 ** Entry Info for: 0-13
-num: 0000000000000000          pos: 0000000000000000          len: 0000000000000034
+num: 0000000000000000          pos: 000000000000006b          len: 0000000000000034
 txn: 0000000000000011          txo: 0000000000000000               flags: lk=0 tx=0
-0000000000000000  04 00 00 00 00 00 00 00 72 6f 6f 74 ff ff ff ff  ........root....
-0000000000000010  ff ff ff ff 03 00 00 00 00 00 00 00 01 00 00 00  ................
-0000000000000020  00 00 00 00 02 00 00 00 00 00 00 00 04 00 00 00  ................
-0000000000000030  00 00 00 00                                      ....
+000000000000006b  04 00 00 00 00 00 00 00 72 6f 6f 74 ff ff ff ff  ........root....
+000000000000007b  ff ff ff ff 03 00 00 00 00 00 00 00 01 00 00 00  ................
+000000000000008b  00 00 00 00 02 00 00 00 00 00 00 00 04 00 00 00  ................
+000000000000009b  00 00 00 00                                      ....
 
-num: 0000000000000001          pos: 00000000000000be          len: 0000000000000033
+num: 0000000000000001          pos: 00000000000000d9          len: 0000000000000033
 txn: 000000000000000c          txo: 0000000000000000               flags: lk=0 tx=0
-00000000000000be  03 00 00 00 00 00 00 00 6f 6e 65 ff ff ff ff ff  ........one.....
-00000000000000ce  ff ff ff 03 00 00 00 00 00 00 00 05 00 00 00 00  ................
-00000000000000de  00 00 00 06 00 00 00 00 00 00 00 07 00 00 00 00  ................
-00000000000000ee  00 00 00                                         ...
+00000000000000d9  03 00 00 00 00 00 00 00 6f 6e 65 ff ff ff ff ff  ........one.....
+00000000000000e9  ff ff ff 03 00 00 00 00 00 00 00 05 00 00 00 00  ................
+00000000000000f9  00 00 00 06 00 00 00 00 00 00 00 07 00 00 00 00  ................
+0000000000000109  00 00 00                                         ...
 
-num: 0000000000000002          pos: 0000000000000034          len: 0000000000000033
+num: 0000000000000002          pos: 000000000000001b          len: 0000000000000033
 txn: 000000000000000c          txo: 0000000000000000               flags: lk=0 tx=0
-0000000000000034  03 00 00 00 00 00 00 00 74 77 6f ff ff ff ff ff  ........two.....
-0000000000000044  ff ff ff 03 00 00 00 00 00 00 00 08 00 00 00 00  ................
-0000000000000054  00 00 00 09 00 00 00 00 00 00 00 0a 00 00 00 00  ................
-0000000000000064  00 00 00                                         ...
+000000000000001b  03 00 00 00 00 00 00 00 74 77 6f ff ff ff ff ff  ........two.....
+000000000000002b  ff ff ff 03 00 00 00 00 00 00 00 08 00 00 00 00  ................
+000000000000003b  00 00 00 09 00 00 00 00 00 00 00 0a 00 00 00 00  ................
+000000000000004b  00 00 00                                         ...
 
-num: 0000000000000003          pos: 0000000000000149          len: 000000000000001b
+num: 0000000000000003          pos: 0000000000000000          len: 000000000000001b
 txn: 000000000000000d          txo: 0000000000000000               flags: lk=0 tx=0
-0000000000000149  03 00 00 00 00 00 00 00 61 61 61 ff ff ff ff ff  ........aaa.....
-0000000000000159  ff ff ff 00 00 00 00 00 00 00 00                 ...........
+0000000000000000  03 00 00 00 00 00 00 00 61 61 61 ff ff ff ff ff  ........aaa.....
+0000000000000010  ff ff ff 00 00 00 00 00 00 00 00                 ...........
 
 num: 0000000000000004          pos: 000000000000017f          len: 000000000000002d
 txn: 0000000000000010          txo: 0000000000000000               flags: lk=0 tx=0
@@ -45,35 +45,35 @@ txn: 0000000000000010          txo: 0000000000000000               flags: lk=0 t
 000000000000018f  ff ff ff ff ff 02 00 00 00 00 00 00 00 03 00 00  ................
 000000000000019f  00 00 00 00 00 0b 00 00 00 00 00 00 00           .............
 
-num: 0000000000000005          pos: 000000000000012c          len: 000000000000001d
+num: 0000000000000005          pos: 0000000000000147          len: 000000000000001d
 txn: 000000000000000c          txo: 0000000000000000               flags: lk=0 tx=0
-000000000000012c  05 00 00 00 00 00 00 00 66 69 72 73 74 ff ff ff  ........first...
-000000000000013c  ff ff ff ff ff 00 00 00 00 00 00 00 00           .............
+0000000000000147  05 00 00 00 00 00 00 00 66 69 72 73 74 ff ff ff  ........first...
+0000000000000157  ff ff ff ff ff 00 00 00 00 00 00 00 00           .............
 
-num: 0000000000000006          pos: 000000000000010e          len: 000000000000001e
+num: 0000000000000006          pos: 0000000000000129          len: 000000000000001e
 txn: 000000000000000c          txo: 0000000000000000               flags: lk=0 tx=0
-000000000000010e  06 00 00 00 00 00 00 00 73 65 63 6f 6e 64 ff ff  ........second..
-000000000000011e  ff ff ff ff ff ff 00 00 00 00 00 00 00 00        ..............
+0000000000000129  06 00 00 00 00 00 00 00 73 65 63 6f 6e 64 ff ff  ........second..
+0000000000000139  ff ff ff ff ff ff 00 00 00 00 00 00 00 00        ..............
 
-num: 0000000000000007          pos: 00000000000000f1          len: 000000000000001d
+num: 0000000000000007          pos: 000000000000010c          len: 000000000000001d
 txn: 000000000000000c          txo: 0000000000000000               flags: lk=0 tx=0
-00000000000000f1  05 00 00 00 00 00 00 00 74 68 69 72 64 ff ff ff  ........third...
-0000000000000101  ff ff ff ff ff 00 00 00 00 00 00 00 00           .............
+000000000000010c  05 00 00 00 00 00 00 00 74 68 69 72 64 ff ff ff  ........third...
+000000000000011c  ff ff ff ff ff 00 00 00 00 00 00 00 00           .............
 
-num: 0000000000000008          pos: 00000000000000a1          len: 000000000000001d
+num: 0000000000000008          pos: 00000000000000bc          len: 000000000000001d
 txn: 000000000000000c          txo: 0000000000000000               flags: lk=0 tx=0
-00000000000000a1  05 00 00 00 00 00 00 00 74 65 73 74 31 ff ff ff  ........test1...
-00000000000000b1  ff ff ff ff ff 00 00 00 00 00 00 00 00           .............
+00000000000000bc  05 00 00 00 00 00 00 00 74 65 73 74 31 ff ff ff  ........test1...
+00000000000000cc  ff ff ff ff ff 00 00 00 00 00 00 00 00           .............
 
-num: 0000000000000009          pos: 0000000000000084          len: 000000000000001d
+num: 0000000000000009          pos: 000000000000009f          len: 000000000000001d
 txn: 000000000000000c          txo: 0000000000000000               flags: lk=0 tx=0
-0000000000000084  05 00 00 00 00 00 00 00 74 65 73 74 32 ff ff ff  ........test2...
-0000000000000094  ff ff ff ff ff 00 00 00 00 00 00 00 00           .............
+000000000000009f  05 00 00 00 00 00 00 00 74 65 73 74 32 ff ff ff  ........test2...
+00000000000000af  ff ff ff ff ff 00 00 00 00 00 00 00 00           .............
 
-num: 000000000000000a          pos: 0000000000000067          len: 000000000000001d
+num: 000000000000000a          pos: 000000000000004e          len: 000000000000001d
 txn: 000000000000000c          txo: 0000000000000000               flags: lk=0 tx=0
-0000000000000067  05 00 00 00 00 00 00 00 74 65 73 74 33 ff ff ff  ........test3...
-0000000000000077  ff ff ff ff ff 00 00 00 00 00 00 00 00           .............
+000000000000004e  05 00 00 00 00 00 00 00 74 65 73 74 33 ff ff ff  ........test3...
+000000000000005e  ff ff ff ff ff 00 00 00 00 00 00 00 00           .............
 
 num: 000000000000000b          pos: 0000000000000164          len: 000000000000001b
 txn: 000000000000000f          txo: 0000000000000000               flags: lk=0 tx=0
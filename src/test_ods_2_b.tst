@@ -8,7 +8,7 @@ Total Entries = 20001
 Tranlog Offset = 0
 Transaction Id = 30008
 Index Free List = 1
-Total Size of Data = 488974
+Total Size of Data = 28
 Data Transformation Id = 10007
 Index Transformation Id = 50009
 
@@ -8,15 +8,15 @@ Total Entries = 20001
 Tranlog Offset = 0
 Transaction Id = 30008
 Index Free List = 1
-Total Size of Data = 488974
+Total Size of Data = 28
 Data Transformation Id = 10007
 Index Transformation Id = 50009
 
 ** Entry Info for: 0
-num: 0000000000000000          pos: 0000000000063d72          len: 000000000000001c
+num: 0000000000000000          pos: 0000000000000000          len: 000000000000001c
 txn: 0000000000007537          txo: 0000000000000000               flags: lk=0 tx=0
-0000000000063d72  04 00 00 00 00 00 00 00 72 6f 6f 74 ff ff ff ff  ........root....
-0000000000063d82  ff ff ff ff 00 00 00 00 00 00 00 00              ............
+0000000000000000  04 00 00 00 00 00 00 00 72 6f 6f 74 ff ff ff ff  ........root....
+0000000000000010  ff ff ff ff 00 00 00 00 00 00 00 00              ............
 
 ** Freelist Info
 First freelist entry = 1
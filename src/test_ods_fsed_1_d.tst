@@ -15,11 +15,11 @@ Index Transformation Id = 13
 ** Entry Info for: 0
 num: 0000000000000000          pos: 0000000000000000          len: 0000000000000100
 txn: 0000000000000005          txo: 0000000000000000               flags: lk=0 tx=0
-0000000000000000  01 ff 00 55 01 00 01 00 00 00 00 00 00 00 08 00  ...U............
-0000000000000010  00 00 00 00 00 00 01 00 00 00 00 00 00 00 01 00  ................
-0000000000000020  00 00 00 00 00 00 01 00 00 00 00 00 00 00 ff ff  ................
+0000000000000000  02 ff 03 00 55 01 00 01 00 00 00 00 00 00 00 08  ....U...........
+0000000000000010  00 00 00 00 00 00 00 01 00 00 00 00 00 00 00 01  ................
+0000000000000020  00 00 00 00 00 00 00 01 00 00 00 00 00 00 00 ff  ................
 0000000000000030  ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff  ................
-0000000000000040  ff ff ff ff ff ff 00 00 00 00 00 00 00 00 00 00  ................
+0000000000000040  ff ff ff ff ff ff ff 00 00 00 00 00 00 00 00 00  ................
 0000000000000050  00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00  ................
 0000000000000060  00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00  ................
 0000000000000070  00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00  ................
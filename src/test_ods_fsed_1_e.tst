@@ -15,16 +15,16 @@ Index Transformation Id = 13
 ** Entry Info for: 1
 num: 0000000000000001          pos: 0000000000000100          len: 0000000000000400
 txn: 0000000000000005          txo: 0000000000000000               flags: lk=0 tx=0
-0000000000000100  01 08 03 00 ff ff ff ff ff ff ff ff ff ff ff ff  ................
-0000000000000110  ff ff ff ff ff ff ff ff ff ff ff ff 04 00 2f 61  ............../a
-0000000000000120  62 63 ff ff ff ff ff ff ff ff 04 00 2f 64 65 66  bc........../def
-0000000000000130  ff ff ff ff ff ff ff ff 04 00 2f 67 68 69 ff ff  ........../ghi..
-0000000000000140  ff ff ff ff ff ff 04 00 2f 78 79 7a ff ff ff ff  ......../xyz....
-0000000000000150  ff ff ff ff 05 00 3a 2f 61 62 63 ff ff ff ff ff  ......:/abc.....
-0000000000000160  ff ff ff 05 00 3a 2f 64 65 66 ff ff ff ff ff ff  .....:/def......
-0000000000000170  ff ff 05 00 3a 2f 67 68 69 ff ff ff ff ff ff ff  ....:/ghi.......
-0000000000000180  ff 05 00 3a 2f 78 79 7a ff ff ff ff ff ff ff ff  ...:/xyz........
-0000000000000190  00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00  ................
+0000000000000100  02 08 00 03 00 ff ff ff ff ff ff ff ff ff ff ff  ................
+0000000000000110  ff ff ff ff ff ff ff ff ff ff ff ff ff 04 00 00  ................
+0000000000000120  00 2f 61 62 63 ff ff ff ff ff ff ff ff 04 00 01  ./abc...........
+0000000000000130  00 64 65 66 ff ff ff ff ff ff ff ff 04 00 01 00  .def............
+0000000000000140  67 68 69 ff ff ff ff ff ff ff ff 04 00 01 00 78  ghi............x
+0000000000000150  79 7a ff ff ff ff ff ff ff ff 05 00 00 00 3a 2f  yz............:/
+0000000000000160  61 62 63 ff ff ff ff ff ff ff ff 05 00 02 00 64  abc............d
+0000000000000170  65 66 ff ff ff ff ff ff ff ff 05 00 02 00 67 68  ef............gh
+0000000000000180  69 ff ff ff ff ff ff ff ff 05 00 02 00 78 79 7a  i............xyz
+0000000000000190  ff ff ff ff ff ff ff ff 00 00 00 00 00 00 00 00  ................
 00000000000001a0  00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00  ................
 00000000000001b0  00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00  ................
 00000000000001c0  00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00  ................
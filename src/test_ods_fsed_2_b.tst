@@ -15,11 +15,11 @@ Index Transformation Id = 13
 ** Entry Info for: 0-4
 num: 0000000000000000          pos: 0000000000000000          len: 0000000000000100
 txn: 0000000000000004          txo: 0000000000000000               flags: lk=0 tx=0
-0000000000000000  01 ff 00 55 01 00 01 00 00 00 00 00 00 00 03 00  ...U............
-0000000000000010  00 00 00 00 00 00 02 00 00 00 00 00 00 00 02 00  ................
-0000000000000020  00 00 00 00 00 00 02 00 00 00 00 00 00 00 ff ff  ................
+0000000000000000  02 ff 03 00 55 01 00 01 00 00 00 00 00 00 00 03  ....U...........
+0000000000000010  00 00 00 00 00 00 00 02 00 00 00 00 00 00 00 02  ................
+0000000000000020  00 00 00 00 00 00 00 02 00 00 00 00 00 00 00 ff  ................
 0000000000000030  ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff  ................
-0000000000000040  ff ff ff ff ff ff 00 00 00 00 00 00 00 00 00 00  ................
+0000000000000040  ff ff ff ff ff ff ff 00 00 00 00 00 00 00 00 00  ................
 0000000000000050  00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00  ................
 0000000000000060  00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00  ................
 0000000000000070  00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00  ................
@@ -457,13 +457,13 @@ txn: 0000000000000002          txo: 0000000000000000               flags: lk=0 t
 
 num: 0000000000000002          pos: 0000000000000100          len: 0000000000000400
 txn: 0000000000000004          txo: 0000000000000000               flags: lk=0 tx=0
-0000000000000100  01 03 03 00 ff ff ff ff ff ff ff ff ff ff ff ff  ................
-0000000000000110  ff ff ff ff ff ff ff ff ff ff ff ff 05 80 7c 2f  ..............|/
-0000000000000120  78 78 78 01 00 00 00 00 00 00 00 ff ff ff ff ff  xxx.............
-0000000000000130  ff ff ff 05 80 7c 2f 79 79 79 03 00 00 00 00 00  .....|/yyy......
-0000000000000140  00 00 ff ff ff ff ff ff ff ff 05 80 7c 2f 7a 7a  ............|/zz
-0000000000000150  7a 04 00 00 00 00 00 00 00 ff ff ff ff ff ff ff  z...............
-0000000000000160  ff 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00  ................
+0000000000000100  02 03 00 03 00 ff ff ff ff ff ff ff ff ff ff ff  ................
+0000000000000110  ff ff ff ff ff ff ff ff ff ff ff ff ff 05 80 00  ................
+0000000000000120  00 7c 2f 78 78 78 01 00 00 00 00 00 00 00 ff ff  .|/xxx..........
+0000000000000130  ff ff ff ff ff ff 05 80 02 00 79 79 79 03 00 00  ..........yyy...
+0000000000000140  00 00 00 00 00 ff ff ff ff ff ff ff ff 05 80 02  ................
+0000000000000150  00 7a 7a 7a 04 00 00 00 00 00 00 00 ff ff ff ff  .zzz............
+0000000000000160  ff ff ff ff 00 00 00 00 00 00 00 00 00 00 00 00  ................
 0000000000000170  00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00  ................
 0000000000000180  00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00  ................
 0000000000000190  00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00  ................
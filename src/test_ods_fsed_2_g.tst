@@ -8,7 +8,7 @@ Total Entries = 5
 Tranlog Offset = 0
 Transaction Id = 18
 Index Free List = n/a
-Total Size of Data = 29196
+Total Size of Data = 23512
 Data Transformation Id = 17
 Index Transformation Id = 52
 
@@ -22,7 +22,7 @@ txn: 0000000000000010          txo: 0000000000000000               flags: lk=0 t
 num: 0000000000000002          pos: 0000000000000100          len: 0000000000000400
 txn: 000000000000000d          txo: 0000000000000000               flags: lk=0 tx=0
 
-num: 0000000000000003          pos: 0000000000005bd8          len: 0000000000001634
+num: 0000000000000003          pos: 0000000000000500          len: 0000000000001634
 txn: 0000000000000011          txo: 0000000000000000               flags: lk=0 tx=0
 
 num: 0000000000000004          pos: 0000000000003568          len: 0000000000000c3c
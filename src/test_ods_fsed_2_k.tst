@@ -8,7 +8,7 @@ Total Entries = 5
 Tranlog Offset = 0
 Transaction Id = 35
 Index Free List = 3
-Total Size of Data = 23512
+Total Size of Data = 16804
 Data Transformation Id = 34
 Index Transformation Id = 105
 
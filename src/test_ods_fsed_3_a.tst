@@ -0,0 +1,26 @@
+
+/> folder_add abc
+
+/> folder_add xyz
+
+/> cd abc
+
+/abc> file_add xxx test_ods_fsed_3_a.cin
+
+/abc> folder_add def
+
+/abc> cd def
+
+/abc/def> file_add yyy test_ods_fsed_4_a.cin
+
+/abc/def> cd /
+
+/> folder_remove xyz
+
+/> branch objects
+abc/
+abc/def/
+abc/def/yyy (63 B)
+abc/xxx (172 B)
+
+/> exit
@@ -0,0 +1,12 @@
+
+/> branch objects
+abc/
+abc/def/
+abc/def/yyy (63 B)
+abc/xxx (172 B)
+
+/> cd abc/def
+
+/abc/def> file_get yyy ~test_ods_fsed.txt
+
+/abc/def> exit
@@ -0,0 +1,4 @@
+branch objects
+cd abc/def
+file_get yyy ~test_ods_fsed.txt
+exit
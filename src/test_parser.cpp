@@ -10,6 +10,11 @@
 #pragma hdrstop
 
 #ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <cstdlib>
+#  include <map>
+#  include <string>
+#  include <vector>
+#  include <sstream>
 #  include <iostream>
 #  ifdef __GNUG__
 #     include <unistd.h>
@@ -21,7 +26,10 @@
 #include "config.h"
 #include "macros.h"
 #include "console.h"
+#include "numeric.h"
+#include "date_time.h"
 #include "utilities.h"
+#include "command_handler.h"
 
 #ifdef __GNUG__
 #  ifdef RDLINE_SUPPORT
@@ -994,6 +1002,408 @@ command_tests[ ] =
    { "[<opt/a>|[<opt/b>][<opt/c>]<opt/d>|[<opt/e>][<opt/f>]<opt/g>]", "d g f e", false }
 };
 
+const size_t c_default_bench_fields = 1000000;
+const size_t c_default_dispatch_commands = 500000;
+
+struct dispatch_command
+{
+   const char* p_name;
+   const char* p_syntax;
+   const char* p_fields;
+};
+
+// NOTE: These are the syntaxes (and the parameters that are used) of the most commonly issued
+// application server session commands (all but the first of which can use the flat matcher).
+dispatch_command g_dispatch_commands[ ] =
+{
+   { "perform_fetch|pf", "<val//module><val//mclass>[<opt/-rev/reverse>][<val/-u=/uid>][<val/-d=/dtm>][<val/-g=/grp>]"
+    "[<val/-td=/tmp_dir>][<val/-tz=/tz_name>][<list/-f=/filters>][<list/-p=/perms>][<val/-s=/security_info>][<val/-t=/search_text>]"
+    "[<val/-q=/search_query>][<list/-x=/extra_vars>][<val/-c=/cursor>][<val/-cn=/cursor_next>][<oval//key_info>][<val/#/limit>]"
+    "[<list/-v=/set_values>][<list//fields>][{<opt/-min/minimal>[<opt/-ndv/no_default_values>][<val//map_file>]}"
+    "|{<opt/-pdf/create_pdf><val//format_file><val//output_file>[<val//title_name>]}]",
+    "module,mclass,uid,dtm,tz_name,filters,perms,key_info,limit,fields,minimal" },
+   { "perform_create|pc", "<val//uid><val//dtm><val//module><val//mclass>[<val/-g=/grp>][<val/-tz=/tz_name>]"
+    "<oval//key>[<olist//field_values>][<val/-x=/method>]", "uid,dtm,module,mclass,grp,tz_name,key,field_values,method" },
+   { "perform_update|pu", "<val//uid><val//dtm><val//module><val//mclass>[<val/-g=/grp>][<val/-tz=/tz_name>]"
+    "<val//key>[<val/=/ver_info>]<olist//field_values>[<val/-x=/method>][<list//check_values>]",
+    "uid,dtm,module,mclass,grp,tz_name,key,ver_info,field_values,method,check_values" },
+   { "perform_destroy|pd", "<val//uid><val//dtm><val//module><val//mclass>[<val/-g=/grp>][<val/-tz=/tz_name>]"
+    "[<olist/-v=/set_values>][<opt/-p/progress>][<opt/-q/quiet>]<val//key>[<val/=/ver_info>]",
+    "uid,dtm,module,mclass,grp,tz_name,set_values,progress,quiet,key,ver_info" },
+   { "perform_execute|pe", "<val//uid><val//dtm><val//module><val//mclass>[<val/-g=/grp>][<val/-tz=/tz_name>]"
+    "[<olist/-v=/set_values>]<list//keys>[<list/=/vers>]<val//method>[<val//args>]",
+    "uid,dtm,module,mclass,grp,tz_name,set_values,keys,vers,method,args" },
+   { "session_variable", "<val//name_or_expr>[<oval//new_value>]", "name_or_expr,new_value" },
+   { "file_get", "<val//tag_or_hash>[<val//filename>]", "tag_or_hash,filename" }
+};
+
+// NOTE: The relative frequency of these reflects that of a typical interactive UI session.
+const char* const g_dispatch_mix[ ] =
+{
+   "pf 100 100100 -u=admin -d=20201018101530 -tz=AEST -f=100100102=Y -p=admin,user #20 100101,100102,100103",
+   "pf 100 100100 -u=admin -d=20201018101530 -tz=AEST 100100001 100101,100102,100103,100104,100105",
+   "pf 100 100200 -u=guest -d=20201018101531 #10 100201,100202 -min",
+   "pf 100 100100 -u=admin -d=20201018101532 -c=100100007 #25 100101,100102,100103",
+   "pc admin 20201018101533 100 100100 -g=admins -tz=AEST 100100009 \"100101=Test,100102=1,100103=20201018\"",
+   "pu admin 20201018101534 100 100100 -tz=AEST 100100009 =1.2 \"100101=Updated,100102=2\"",
+   "pd admin 20201018101535 100 100100 -q 100100009 =1.3",
+   "pe admin 20201018101536 100 100100 -v=@async=1 100100001,100100002 =1.0,1.0 -100410 \"arg1,arg2\"",
+   "session_variable @uid",
+   "session_variable @dtm 20201018101537",
+   "file_get 2f8c1e0aab73b3dd10c9bc4bd3cb72c5e4e3ce0a3f1e9fb1c8bd4e5cf8cc5a1c ~test.txt"
+};
+
+const size_t c_num_dispatch_commands = sizeof( g_dispatch_commands ) / sizeof( g_dispatch_commands[ 0 ] );
+const size_t c_num_dispatch_mix = sizeof( g_dispatch_mix ) / sizeof( g_dispatch_mix[ 0 ] );
+
+namespace
+{
+
+// NOTE: The "-bench" option measures how many field values per second can be parsed from (and
+// for some types also converted back into) strings in the same way that the generated class
+// setters and the SQL fetch/persistence code do. For types which had previously been handled
+// by a string stream the rate that a stream achieves is also output (along with a check that
+// the stream produced the same values).
+uint64_t g_seed = 1;
+
+uint64_t next_random( )
+{
+   g_seed = g_seed * 6364136223846793005ULL + 1442695040888963407ULL;
+   return g_seed >> 11;
+}
+
+template< typename T > T stream_from_string( const string& s )
+{
+   istringstream iss( s );
+
+   T t = T( );
+   iss >> t;
+
+   return t;
+}
+
+template< typename T > string stream_to_string( const T& t )
+{
+   ostringstream oss;
+   oss << t;
+
+   return oss.str( );
+}
+
+void output_rate( const string& name, size_t num_fields, unsigned long msecs, unsigned long stream_msecs = 0 )
+{
+   cout << name << ": " << num_fields << " fields in " << msecs << " msecs";
+
+   cout << " (" << ( uint64_t )num_fields * 1000 / ( msecs ? msecs : 1 ) << " fields/sec)";
+
+   if( stream_msecs )
+      cout << " [stream: " << ( uint64_t )num_fields * 1000 / stream_msecs << " fields/sec]";
+
+   cout << endl;
+}
+
+template< typename T > void bench_from_string( const string& name, const vector< string >& values, size_t& num_errors )
+{
+   uint64_t check = 0;
+   unsigned long start = get_msecs( );
+
+   for( size_t i = 0; i < values.size( ); i++ )
+      check += ( uint64_t )from_string< T >( values[ i ] );
+
+   unsigned long msecs = get_msecs( ) - start;
+
+   uint64_t stream_check = 0;
+   start = get_msecs( );
+
+   for( size_t i = 0; i < values.size( ); i++ )
+      stream_check += ( uint64_t )stream_from_string< T >( values[ i ] );
+
+   unsigned long stream_msecs = get_msecs( ) - start;
+
+   output_rate( name, values.size( ), msecs, stream_msecs ? stream_msecs : 1 );
+
+   if( check != stream_check )
+   {
+      ++num_errors;
+      cout << "error: " << name << " values differ from those parsed by a stream" << endl;
+   }
+}
+
+template< typename T > void bench_to_string( const string& name, const vector< T >& values, size_t& num_errors )
+{
+   size_t check = 0;
+   unsigned long start = get_msecs( );
+
+   for( size_t i = 0; i < values.size( ); i++ )
+      check += to_string( ( T )values[ i ] ).size( );
+
+   unsigned long msecs = get_msecs( ) - start;
+
+   size_t stream_check = 0;
+   start = get_msecs( );
+
+   for( size_t i = 0; i < values.size( ); i++ )
+      stream_check += stream_to_string( ( T )values[ i ] ).size( );
+
+   unsigned long stream_msecs = get_msecs( ) - start;
+
+   output_rate( name, values.size( ), msecs, stream_msecs ? stream_msecs : 1 );
+
+   if( check != stream_check )
+   {
+      ++num_errors;
+      cout << "error: " << name << " strings differ from those output by a stream" << endl;
+   }
+}
+
+void perform_bench( size_t num_fields )
+{
+   size_t num_errors = 0;
+
+   vector< int > ints;
+   vector< bool > bools;
+
+   vector< string > int_values;
+   vector< string > int64_values;
+   vector< string > unsigned_values;
+   vector< string > numeric_values;
+   vector< string > date_time_values;
+
+   // NOTE: Include some edge cases (which will also be checked against the stream results).
+   int_values.push_back( "-2147483648" );
+   int_values.push_back( "2147483647" );
+   int_values.push_back( " +42" );
+   int_values.push_back( "7x" );
+   int_values.push_back( "99999999999" );
+   int_values.push_back( "-99999999999" );
+   int_values.push_back( "" );
+
+   int64_values.push_back( "-9223372036854775808" );
+   int64_values.push_back( "9223372036854775807" );
+
+   unsigned_values.push_back( "4294967295" );
+   unsigned_values.push_back( "0" );
+   unsigned_values.push_back( "-1" );
+   unsigned_values.push_back( "99999999999" );
+
+   while( int_values.size( ) < num_fields )
+   {
+      uint64_t r = next_random( );
+
+      int i = ( int )( r % 2000000000 ) - 1000000000;
+      i >>= ( r >> 40 ) % 24;
+
+      ints.push_back( i );
+      int_values.push_back( to_string( i ) );
+
+      int64_t i64 = ( int64_t )( r << 11 );
+      i64 >>= ( r >> 32 ) % 56;
+
+      int64_values.push_back( to_string( i64 ) );
+
+      unsigned_values.push_back( to_string( ( unsigned )( r >> 13 ) >> ( ( r >> 8 ) % 24 ) ) );
+
+      bools.push_back( r & 1 );
+
+      numeric_values.push_back( to_string( i ) + '.' + to_string( ( r >> 20 ) % 10000 ) );
+
+      date_time dt( udate( ( year )( 1900 + ( r >> 5 ) % 200 ), ( month )( 1 + ( r >> 12 ) % 12 ), ( day )( 1 + ( r >> 16 ) % 28 ) ),
+       mtime( ( hour )( ( r >> 22 ) % 24 ), ( minute )( ( r >> 28 ) % 60 ), ( second )( ( r >> 34 ) % 60 ) ) );
+
+      date_time_values.push_back( dt.as_string( ) );
+   }
+
+   cout << "parsing...\n";
+
+   bench_from_string< int >( "int", int_values, num_errors );
+   bench_from_string< int64_t >( "int64", int64_values, num_errors );
+   bench_from_string< unsigned >( "unsigned", unsigned_values, num_errors );
+
+   unsigned long start = get_msecs( );
+
+   for( size_t i = 0; i < numeric_values.size( ); i++ )
+   {
+      numeric n( numeric_values[ i ].c_str( ) );
+      ( void )n;
+   }
+
+   output_rate( "numeric", numeric_values.size( ), get_msecs( ) - start );
+
+   start = get_msecs( );
+
+   for( size_t i = 0; i < date_time_values.size( ); i++ )
+   {
+      date_time dt( date_time_values[ i ] );
+      ( void )dt;
+   }
+
+   output_rate( "date_time", date_time_values.size( ), get_msecs( ) - start );
+
+   cout << "\nconverting...\n";
+
+   bench_to_string< int >( "int", ints, num_errors );
+   bench_to_string< bool >( "bool", bools, num_errors );
+
+   cout << "\nfound " << num_errors << " error(s)" << endl;
+}
+
+// NOTE: The "-dispatch" option measures how many commands per second can be dispatched using a
+// command handler (which parses into reused parameter slots) and the rate that is achieved when
+// instead each command is parsed into a map (as was done previously) with both checked to have
+// provided the same parameter values.
+size_t g_dispatch_check = 0;
+
+class dispatch_functor : public command_functor
+{
+   public:
+   dispatch_functor( command_handler& handler, const string& fields )
+    :
+    command_functor( handler )
+   {
+      split( fields, names );
+   }
+
+   void operator ( )( const string& /*command*/, const parameter_info& parameters )
+   {
+      for( size_t i = 0; i < names.size( ); i++ )
+      {
+         if( has_parm_val( parameters, names[ i ] ) )
+            g_dispatch_check += get_parm_val( parameters, names[ i ] ).size( ) + i;
+      }
+   }
+
+   private:
+   vector< string > names;
+};
+
+class dispatch_handler : public command_handler
+{
+   public:
+   dispatch_handler( ) : num_errors( 0 ) { }
+
+   size_t num_errors;
+
+   private:
+   void handle_unknown_command( const string& command )
+   {
+      ++num_errors;
+      cout << "error: unknown command '" << command << "'" << endl;
+   }
+
+   void handle_invalid_command( const command_parser& /*parser*/, const string& cmd_and_args )
+   {
+      ++num_errors;
+      cout << "error: invalid command '" << cmd_and_args << "'" << endl;
+   }
+};
+
+struct map_dispatcher
+{
+   command_parser parser;
+   vector< string > names;
+};
+
+void perform_dispatch( size_t num_commands )
+{
+   size_t num_flat = 0;
+   size_t num_errors = 0;
+
+   dispatch_handler handler;
+
+   map< string, string > short_names;
+   map< string, size_t > map_dispatcher_nums;
+
+   map_dispatcher map_dispatchers[ c_num_dispatch_commands ];
+
+   for( size_t i = 0; i < c_num_dispatch_commands; i++ )
+   {
+      string name( g_dispatch_commands[ i ].p_name );
+
+      handler.add_command( name, 0, g_dispatch_commands[ i ].p_syntax,
+       "", new dispatch_functor( handler, g_dispatch_commands[ i ].p_fields ) );
+
+      string::size_type pos = name.find( '|' );
+
+      map_dispatcher& dispatcher( map_dispatchers[ i ] );
+      map_dispatcher_nums.insert( make_pair( name.substr( 0, pos ), i ) );
+
+      dispatcher.parser.parse_syntax( g_dispatch_commands[ i ].p_syntax );
+      split( g_dispatch_commands[ i ].p_fields, dispatcher.names );
+
+      if( dispatcher.parser.has_flat_matcher( ) )
+         ++num_flat;
+
+      if( pos != string::npos )
+         short_names.insert( make_pair( name.substr( pos + 1 ), name.substr( 0, pos ) ) );
+   }
+
+   cout << "dispatching " << num_commands << " commands ("
+    << num_flat << " of " << c_num_dispatch_commands << " syntaxes are flat)...\n";
+
+   g_dispatch_check = 0;
+   unsigned long start = get_msecs( );
+
+   for( size_t i = 0; i < num_commands; i++ )
+      handler.execute_command( g_dispatch_mix[ i % c_num_dispatch_mix ] );
+
+   unsigned long msecs = get_msecs( ) - start;
+
+   num_errors += handler.num_errors;
+   size_t check = g_dispatch_check;
+
+   size_t map_check = 0;
+   start = get_msecs( );
+
+   for( size_t i = 0; i < num_commands; i++ )
+   {
+      string s( g_dispatch_mix[ i % c_num_dispatch_mix ] );
+
+      string::size_type pos = s.find( ' ' );
+      string cmd( s.substr( 0, pos ) );
+
+      if( short_names.count( cmd ) )
+         cmd = short_names[ cmd ];
+
+      map_dispatcher& dispatcher( map_dispatchers[ map_dispatcher_nums[ cmd ] ] );
+
+      vector< string > arguments;
+      map< string, string > parameters;
+
+      if( pos != string::npos )
+         setup_arguments( s.substr( pos + 1 ).c_str( ), arguments );
+
+      if( !dispatcher.parser.parse_command( arguments, parameters ) )
+      {
+         ++num_errors;
+         continue;
+      }
+
+      for( size_t j = 0; j < dispatcher.names.size( ); j++ )
+      {
+         map< string, string >::const_iterator ci = parameters.find( dispatcher.names[ j ] );
+
+         if( ci != parameters.end( ) )
+            map_check += ci->second.size( ) + j;
+      }
+   }
+
+   unsigned long map_msecs = get_msecs( ) - start;
+
+   cout << "dispatched " << num_commands << " commands in " << msecs << " msecs";
+   cout << " (" << ( uint64_t )num_commands * 1000 / ( msecs ? msecs : 1 ) << " commands/sec)";
+   cout << " [map: " << ( uint64_t )num_commands * 1000 / ( map_msecs ? map_msecs : 1 ) << " commands/sec]" << endl;
+
+   if( check != map_check )
+   {
+      ++num_errors;
+      cout << "error: parameter values differ from those parsed into a map" << endl;
+   }
+
+   cout << "\nfound " << num_errors << " error(s)" << endl;
+}
+
+}
+
 int main( int argc, char* argv[ ] )
 {
    bool is_quiet = false;
@@ -1178,8 +1588,12 @@ int main( int argc, char* argv[ ] )
                cout << "unknown command '" << cmd << "' (type ? for list of commands)" << endl;
          }
       }
+      else if( argc > 1 && string( argv[ 1 ] ) == "-bench" )
+         perform_bench( argc > 2 ? atoi( argv[ 2 ] ) : c_default_bench_fields );
+      else if( argc > 1 && string( argv[ 1 ] ) == "-dispatch" )
+         perform_dispatch( argc > 2 ? atoi( argv[ 2 ] ) : c_default_dispatch_commands );
       else
-         cout << "usage: test_parser [-test|-quiet]" << endl;
+         cout << "usage: test_parser [-test|-quiet|-bench [<fields>]|-dispatch [<commands>]]" << endl;
    }
    catch( exception& x )
    {
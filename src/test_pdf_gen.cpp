@@ -10,12 +10,18 @@
 #pragma hdrstop
 
 #ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <cstring>
 #  include <string>
+#  include <iomanip>
 #  include <sstream>
 #  include <iostream>
 #  include <stdexcept>
 #endif
 
+#ifndef _WIN32
+#  include <sys/resource.h>
+#endif
+
 #include "pdf_gen.h"
 
 #include "utilities.h"
@@ -69,6 +75,58 @@ const char* const c_header_size_variable = "@header_size";
 const char* const c_grid_normal = "normal";
 const char* const c_grid_reverse = "reverse";
 
+const char* const c_row_template_prefix = "00000_";
+
+long get_peak_memory_kb( )
+{
+#ifdef _WIN32
+   return 0;
+#else
+   struct rusage usage;
+   ::getrusage( RUSAGE_SELF, &usage );
+
+   return usage.ru_maxrss;
+#endif
+}
+
+// NOTE: Repeats the variables of the first row (i.e. those with the "00000_" prefix) for as many
+// rows as were requested (so that large documents can be generated from small variable files).
+class repeated_row_source : public pdf_gen_row_source
+{
+   public:
+   repeated_row_source( const map< string, string >& variables, size_t num_rows )
+    :
+    row( 0 ),
+    num_rows( num_rows )
+   {
+      for( map< string, string >::const_iterator i = variables.begin( ); i != variables.end( ); ++i )
+      {
+         if( i->first.find( c_row_template_prefix ) == 0 )
+            row_template.insert( make_pair( i->first.substr( strlen( c_row_template_prefix ) ), i->second ) );
+      }
+   }
+
+   bool next_row( map< string, string >& variables )
+   {
+      if( row >= num_rows || row_template.empty( ) )
+         return false;
+
+      ostringstream osstr;
+      osstr << setw( 5 ) << setfill( '0' ) << row++ << '_';
+
+      for( map< string, string >::iterator i = row_template.begin( ); i != row_template.end( ); ++i )
+         variables.insert( make_pair( osstr.str( ) + i->first, i->second ) );
+
+      return true;
+   }
+
+   private:
+   size_t row;
+   size_t num_rows;
+
+   map< string, string > row_template;
+};
+
 class test_pdf_gen_command_functor;
 
 class test_pdf_gen_command_handler : public console_command_handler
@@ -196,6 +254,42 @@ void test_pdf_gen_command_functor::operator ( )( const string& command, const pa
 
          cout << "created " << filename << endl;
       }
+      else if( command == c_cmd_test_pdf_gen_rows )
+      {
+         bool stream( has_parm_val( parameters, c_cmd_test_pdf_gen_rows_stream ) );
+         string filename( get_parm_val( parameters, c_cmd_test_pdf_gen_rows_filename ) );
+         string num_rows( get_parm_val( parameters, c_cmd_test_pdf_gen_rows_num_rows ) );
+
+         unsigned long start = get_msecs( );
+
+         map< string, string > variables;
+         repeated_row_source row_source( g_string_variables, atoi( num_rows.c_str( ) ) );
+
+         for( map< string, string >::iterator i = g_string_variables.begin( ); i != g_string_variables.end( ); ++i )
+         {
+            if( i->first.find( c_row_template_prefix ) != 0 )
+               variables.insert( *i );
+         }
+
+         // NOTE: As the peak memory usage is for the process (and never decreases) the streamed and
+         // the non-streamed generation should be compared by using separate runs of this program.
+         if( stream )
+            generate_pdf_doc( g_format_file, filename, variables, row_source );
+         else
+         {
+            while( row_source.next_row( variables ) )
+               ;
+
+            generate_pdf_doc( g_format_file, filename, variables );
+         }
+
+         cout << "created " << filename << " (" << num_rows << " rows"
+          << ( stream ? " streamed" : "" ) << ") in " << ( get_msecs( ) - start ) << " msecs" << endl;
+
+         long peak_memory = get_peak_memory_kb( );
+         if( peak_memory )
+            cout << "peak memory usage: " << peak_memory << " KB" << endl;
+      }
       else if( command == c_cmd_test_pdf_gen_exit )
          handler.set_finished( );
    }
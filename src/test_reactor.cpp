@@ -0,0 +1,505 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef PRECOMPILE_H
+#  include "precompile.h"
+#endif
+#pragma hdrstop
+
+#ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <cstdlib>
+#  include <memory>
+#  include <string>
+#  include <vector>
+#  include <iostream>
+#  include <algorithm>
+#  include <stdexcept>
+#endif
+
+#ifndef _WIN32
+#  include <sys/resource.h>
+#endif
+
+#include "reactor.h"
+#include "threads.h"
+#include "utilities.h"
+#include "thread_pool.h"
+#include "stand_in_server.h"
+
+using namespace std;
+
+// NOTE: This program is a load test for the reactor that is used by the application server to
+// handle sessions with a fixed number of worker threads. A local stand-in server (which simply
+// acknowledges each request line) is used with a large number of idle connections along with a
+// smaller number of active connections (whose command latencies are measured) so that using the
+// reactor can be compared with the use of a thread for every connection. The "-test" option will
+// instead run a fixed set of checks whose output does not depend upon the timing of the run.
+
+const int c_port = 12997;
+
+const int c_connect_timeout = 5000;
+const int c_request_timeout = 5000;
+
+const size_t c_wait_timeout = 30000;
+const size_t c_wake_check_msecs = 100;
+
+const char* const c_localhost = "127.0.0.1";
+
+const char* const c_request = "perform_fetch";
+const char* const c_response = "(okay)";
+
+const char* const c_test_option = "-test";
+const char* const c_threads_option = "-threads";
+
+namespace
+{
+
+mutex g_mutex;
+condition g_changed;
+
+size_t g_num_failures = 0;
+
+size_t g_num_sessions = 0;
+size_t g_max_sessions = 0;
+size_t g_total_sessions = 0;
+
+vector< unsigned long > g_latencies;
+
+void session_started( )
+{
+   guard g( g_mutex );
+
+   ++g_total_sessions;
+
+   if( ++g_num_sessions > g_max_sessions )
+      g_max_sessions = g_num_sessions;
+
+   g_changed.notify_all( );
+}
+
+void session_finished( )
+{
+   guard g( g_mutex );
+
+   --g_num_sessions;
+   g_changed.notify_all( );
+}
+
+// NOTE: Waits until the total number of sessions that have been started and the number of those
+// that are still connected have both reached the expected values.
+void wait_for_sessions( size_t total, size_t remaining )
+{
+   guard g( g_mutex );
+
+   while( g_total_sessions != total || g_num_sessions != remaining )
+   {
+      if( !g_changed.wait( g_mutex, c_wait_timeout ) )
+         throw runtime_error( "timed out waiting for sessions" );
+   }
+}
+
+// NOTE: Returns false if the connection has been closed (a timeout is not treated as an error).
+bool handle_request( tcp_socket& socket, const stand_in_server& server )
+{
+   string request;
+
+   if( socket.read_line( request, c_request_timeout ) <= 0 )
+      return socket.had_timeout( ) && !server.is_stopping( );
+
+   return socket.write_line( c_response, c_request_timeout ) > 0;
+}
+
+class reactor_session : public reactor_handler
+{
+   public:
+   reactor_session( reactor& r, const stand_in_server& server, tcp_socket* p_socket )
+    :
+    r( r ),
+    server( server ),
+    ap_socket( p_socket )
+   {
+      session_started( );
+   }
+
+   void handle_ready( )
+   {
+      // NOTE: If the server is stopping then the session is finished without reading anything.
+      bool okay = !server.is_stopping( );
+
+      // NOTE: Requests are handled whilst there is input available (and then the session parks).
+      while( okay )
+      {
+         if( !handle_request( *ap_socket, server ) )
+            okay = false;
+         else if( !ap_socket->has_input( ) )
+            break;
+      }
+
+      if( okay )
+         r.park( ap_socket->get_socket( ), this );
+      else
+      {
+         ap_socket->close( );
+         session_finished( );
+
+         delete this;
+      }
+   }
+
+   bool needs_wake( ) { return server.is_stopping( ); }
+
+   private:
+   reactor& r;
+   const stand_in_server& server;
+
+   auto_ptr< tcp_socket > ap_socket;
+};
+
+// NOTE: If a reactor is provided then each accepted connection is parked in the reactor rather
+// than being handled by its own session thread.
+class reactor_server : public stand_in_server
+{
+   public:
+   reactor_server( reactor* p_reactor ) : stand_in_server( c_port ), p_reactor( p_reactor ) { }
+
+   ~reactor_server( ) { stop( ); }
+
+   protected:
+   void accept_session( tcp_socket* p_socket )
+   {
+      if( !p_reactor )
+         stand_in_server::accept_session( p_socket );
+      else
+      {
+         SOCKET s = p_socket->get_socket( );
+         p_reactor->park( s, new reactor_session( *p_reactor, *this, p_socket ) );
+      }
+   }
+
+   void handle_session( tcp_socket& socket )
+   {
+      session_started( );
+
+      while( handle_request( socket, *this ) )
+         ;
+
+      session_finished( );
+   }
+
+   private:
+   reactor* p_reactor;
+};
+
+tcp_socket* connect_to_server( )
+{
+   auto_ptr< tcp_socket > ap_socket( new tcp_socket );
+
+   if( !ap_socket->open( ) || !ap_socket->connect( ip_address( c_localhost, c_port ), c_connect_timeout ) )
+      throw runtime_error( "unable to connect to stand-in server" );
+
+   ap_socket->set_no_delay( );
+
+   return ap_socket.release( );
+}
+
+class client_job : public thread_pool_job
+{
+   public:
+   client_job( size_t num_commands ) : num_commands( num_commands ) { }
+
+   void run( )
+   {
+      size_t num_failures = 0;
+
+      vector< unsigned long > latencies;
+      latencies.reserve( num_commands );
+
+      try
+      {
+         auto_ptr< tcp_socket > ap_socket( connect_to_server( ) );
+
+         for( size_t i = 0; i < num_commands; i++ )
+         {
+            unsigned long start = get_usecs( );
+
+            string response;
+
+            if( ap_socket->write_line( c_request, c_request_timeout ) <= 0
+             || ap_socket->read_line( response, c_request_timeout ) <= 0 || response != c_response )
+            {
+               ++num_failures;
+               break;
+            }
+
+            latencies.push_back( get_usecs( ) - start );
+         }
+
+         ap_socket->close( );
+      }
+      catch( exception& )
+      {
+         ++num_failures;
+      }
+
+      guard g( g_mutex );
+
+      g_num_failures += num_failures;
+      g_latencies.insert( g_latencies.end( ), latencies.begin( ), latencies.end( ) );
+   }
+
+   private:
+   size_t num_commands;
+};
+
+// NOTE: Returns the number of msecs taken for all of the active clients to have issued their commands.
+unsigned long run_clients( size_t num_active, size_t num_commands )
+{
+   unsigned long start = get_usecs( );
+
+   thread_pool clients( num_active );
+   clients.start( );
+
+   for( size_t i = 0; i < num_active; i++ )
+      clients.queue_job( new client_job( num_commands ) );
+
+   clients.stop( );
+
+   return ( get_usecs( ) - start ) / 1000;
+}
+
+void connect_idle( vector< tcp_socket* >& idle_sockets, size_t num_idle )
+{
+   for( size_t i = 0; i < num_idle; i++ )
+   {
+      auto_ptr< tcp_socket > ap_socket( connect_to_server( ) );
+
+      idle_sockets.push_back( ap_socket.get( ) );
+      ap_socket.release( );
+   }
+}
+
+void close_idle( vector< tcp_socket* >& idle_sockets )
+{
+   for( size_t i = 0; i < idle_sockets.size( ); i++ )
+   {
+      idle_sockets[ i ]->close( );
+      delete idle_sockets[ i ];
+   }
+
+   idle_sockets.clear( );
+}
+
+void reset_counters( )
+{
+   guard g( g_mutex );
+
+   g_num_failures = 0;
+
+   g_num_sessions = 0;
+   g_max_sessions = 0;
+   g_total_sessions = 0;
+
+   g_latencies.clear( );
+}
+
+unsigned long percentile( const vector< unsigned long >& sorted, size_t pct )
+{
+   if( sorted.empty( ) )
+      return 0;
+
+   return sorted[ min( sorted.size( ) - 1, sorted.size( ) * pct / 100 ) ];
+}
+
+void raise_open_files_limit( )
+{
+#ifndef _WIN32
+   struct rlimit rl;
+
+   if( ::getrlimit( RLIMIT_NOFILE, &rl ) == 0 && rl.rlim_cur < rl.rlim_max )
+   {
+      rl.rlim_cur = rl.rlim_max;
+      ::setrlimit( RLIMIT_NOFILE, &rl );
+   }
+#endif
+}
+
+void run_tests( )
+{
+   const size_t num_idle = 10;
+   const size_t num_active = 4;
+   const size_t num_commands = 25;
+
+   vector< tcp_socket* > idle_sockets;
+
+   // NOTE: Scope for server object.
+   {
+      reset_counters( );
+
+      reactor_server server( 0 );
+      server.start( );
+
+      connect_idle( idle_sockets, num_idle );
+      run_clients( num_active, num_commands );
+
+      wait_for_sessions( num_idle + num_active, num_idle );
+
+      cout << "threads: commands " << g_latencies.size( ) << ", failures "
+       << g_num_failures << ", sessions " << g_total_sessions << endl;
+
+      close_idle( idle_sockets );
+      wait_for_sessions( num_idle + num_active, 0 );
+
+      server.stop( );
+   }
+
+   // NOTE: Scope for reactor and server objects.
+   {
+      reset_counters( );
+
+      reactor r( 2, c_wake_check_msecs );
+      r.start( );
+
+      reactor_server server( &r );
+      server.start( );
+
+      connect_idle( idle_sockets, num_idle );
+      run_clients( num_active, num_commands );
+
+      wait_for_sessions( num_idle + num_active, num_idle );
+
+      reactor_stats stats;
+      r.get_stats( stats );
+
+      cout << "reactor: commands " << g_latencies.size( ) << ", failures " << g_num_failures
+       << ", sessions " << g_total_sessions << ", parked " << stats.num_parked << endl;
+
+      // NOTE: Once the server is stopping every parked session will be woken (and will finish).
+      server.stop( );
+      wait_for_sessions( num_idle + num_active, 0 );
+
+      r.get_stats( stats );
+
+      cout << "stopping: woken " << stats.num_woken << ", parked " << stats.num_parked << endl;
+
+      r.stop( );
+
+      close_idle( idle_sockets );
+   }
+}
+
+}
+
+int main( int argc, char* argv[ ] )
+{
+   if( ( argc < 4 || argc > 6 ) && ( argc != 2 || string( argv[ 1 ] ) != c_test_option ) )
+   {
+      cout << "Usage: test_reactor " << c_test_option
+       << " | <idle> <active> <commands> [<workers>] [" << c_threads_option << "]" << endl;
+      return 0;
+   }
+
+   int rc = 0;
+
+   try
+   {
+      raise_open_files_limit( );
+
+      if( argc == 2 )
+      {
+         run_tests( );
+         return 0;
+      }
+
+      size_t num_idle = atoi( argv[ 1 ] );
+      size_t num_active = atoi( argv[ 2 ] );
+      size_t num_commands = atoi( argv[ 3 ] );
+
+      size_t num_workers = 8;
+
+      bool use_threads = false;
+
+      for( int i = 4; i < argc; i++ )
+      {
+         if( string( argv[ i ] ) == c_threads_option )
+            use_threads = true;
+         else
+            num_workers = atoi( argv[ i ] );
+      }
+
+      if( !num_active )
+         throw runtime_error( "number of active connections must be non-zero" );
+
+      auto_ptr< reactor > ap_reactor;
+
+      if( !use_threads )
+      {
+         ap_reactor.reset( new reactor( num_workers ) );
+         ap_reactor->start( );
+      }
+
+      reactor_server server( ap_reactor.get( ) );
+      server.start( );
+
+      vector< tcp_socket* > idle_sockets;
+      connect_idle( idle_sockets, num_idle );
+
+      unsigned long elapsed = run_clients( num_active, num_commands );
+
+      sort( g_latencies.begin( ), g_latencies.end( ) );
+
+      cout << "idle: " << num_idle << ", active: " << num_active << ", commands: " << g_latencies.size( );
+
+      if( use_threads )
+         cout << " (thread per connection)" << endl;
+      else
+         cout << " (reactor with " << num_workers << " workers)" << endl;
+
+      cout << "elapsed: " << elapsed << " msecs";
+
+      if( elapsed )
+         cout << " (" << ( g_latencies.size( ) * 1000 / elapsed ) << " commands/sec)";
+
+      cout << ", sessions: " << g_max_sessions;
+
+      if( use_threads )
+         cout << " (threads: " << g_max_sessions << ")";
+
+      cout << endl;
+
+      cout << "latency: p50 " << percentile( g_latencies, 50 ) << " usecs, p99 "
+       << percentile( g_latencies, 99 ) << " usecs, max " << percentile( g_latencies, 100 ) << " usecs" << endl;
+
+      if( ap_reactor.get( ) )
+      {
+         reactor_stats stats;
+         ap_reactor->get_stats( stats );
+
+         cout << "parked: " << stats.num_parked << ", dispatched: " << stats.num_dispatched << endl;
+      }
+
+      close_idle( idle_sockets );
+      wait_for_sessions( num_idle + num_active, 0 );
+
+      server.stop( );
+
+      if( ap_reactor.get( ) )
+         ap_reactor->stop( );
+
+      if( g_num_failures )
+         rc = 1;
+   }
+   catch( exception& x )
+   {
+      cerr << "error: " << x.what( ) << endl;
+      rc = 1;
+   }
+   catch( ... )
+   {
+      cerr << "error: unexpected exception caught" << endl;
+      rc = 2;
+   }
+
+   return rc;
+}
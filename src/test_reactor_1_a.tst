@@ -0,0 +1,3 @@
+threads: commands 100, failures 0, sessions 14
+reactor: commands 100, failures 0, sessions 14, parked 10
+stopping: woken 10, parked 0
@@ -0,0 +1,479 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef PRECOMPILE_H
+#  include "precompile.h"
+#endif
+#pragma hdrstop
+
+#ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <cstdlib>
+#  include <memory>
+#  include <string>
+#  include <vector>
+#  include <iostream>
+#  include <stdexcept>
+#endif
+
+#include "regex.h"
+#include "utilities.h"
+
+using namespace std;
+
+// NOTE: This program compares the original regex matching with the use of a DFA (both for single
+// expressions and for multiple expressions via "multi_regex") using generated HTML and log text.
+// All results (positions, lengths and refs) are checked to be identical (along with the results
+// from searching random text) and the throughput of each approach is output in MB/s. The "-test"
+// option instead checks a fixed set of searches along with smaller amounts of generated text (and
+// as no timings are output the results will be the same for every run).
+
+const size_t c_default_megabytes = 4;
+const size_t c_test_kilobytes = 256;
+
+const size_t c_num_random_texts = 50000;
+const size_t c_max_random_length = 48;
+
+const char* const c_random_chars = "<>/\\\"aAbBeFz09 .,:+-_@=\t\n";
+
+const char* const c_test_option = "-test";
+
+const char* const c_html_expressions[ ] =
+{
+   c_regex_html_tag,
+   c_regex_email_address,
+   "\".*\""
+};
+
+const char* const c_log_expressions[ ] =
+{
+   "ERROR",
+   "user=[a-z]+",
+   "[0-9]+\\.[0-9]+\\.[0-9]+\\.[0-9]+",
+   "[A-Fa-f0-9]{64}",
+   c_regex_email_address,
+   c_regex_floating_point_number
+};
+
+const char* const c_other_expressions[ ] =
+{
+   c_regex_label,
+   c_regex_integer,
+   c_regex_hash_256,
+   c_regex_bitcoin_address,
+   c_regex_html_paired_tags,
+   "^[0-9]{1,12}$",
+   "^a.*z$",
+   "a[^b]",
+   "\\bbee\\b",
+   "(a+)b",
+   "x?y*z+",
+   "A.B",
+   "^a{1,2}b",
+   "^[a-z]{2,3}$",
+   "[a-z]{2}[0-9]{1,2}b",
+   "ab*[^b][0-9]+"
+};
+
+struct test_case
+{
+   const char* p_expr;
+   const char* p_text;
+};
+
+// NOTE: The results for expressions that are to match at the start are those of the original
+// matching (which can find a match after the start if a bounded repeat had been exceeded).
+const test_case c_test_cases[ ] =
+{
+   { c_regex_integer, "-123" },
+   { c_regex_integer, "12a" },
+   { c_regex_integer, "12345678901234567890" },
+   { c_regex_email_address, "fred@example.com" },
+   { c_regex_html_tag, "text <b>bold</b> text" },
+   { "^[0-9]{1,12}$", "1234567890123" },
+   { "^[0-9]{1,3}$", "12345" },
+   { "^a{1,2}b", "aaab" },
+   { "^a{1,2}", "aaab" },
+   { "^[a-z]{2,3}$", "abcd" },
+   { "^ab", "xab" },
+   { "^x?y", "zy" },
+   { "^a.*z$", "abcz" },
+   { "^a.*z$", "abczy" },
+   { "a[^b]", "abac" },
+   { "\\bbee\\b", "a bee b" },
+   { "\\bbee\\b", "beetle" },
+   { "(a+)b", "xaaab" },
+   { c_regex_floating_point_number, "1.25" },
+   { "A.B", "AxB" },
+   { "user=[a-z]+", "login user=fred ok" }
+};
+
+namespace
+{
+
+unsigned int g_seed = 1;
+
+unsigned int next_random( )
+{
+   g_seed = ( g_seed * 1103515245 ) + 12345;
+
+   return ( g_seed >> 16 ) & 0x7fff;
+}
+
+string random_word( size_t max_length )
+{
+   string word;
+   size_t length = 1 + ( next_random( ) % max_length );
+
+   for( size_t i = 0; i < length; i++ )
+      word += ( char )( 'a' + ( next_random( ) % 26 ) );
+
+   return word;
+}
+
+string random_hex( size_t length )
+{
+   string hex;
+
+   for( size_t i = 0; i < length; i++ )
+      hex += "0123456789abcdef"[ next_random( ) % 16 ];
+
+   return hex;
+}
+
+void generate_html_lines( size_t num_bytes, vector< string >& lines )
+{
+   const char* const tags[ ] = { "p", "div", "span", "a", "li", "td" };
+
+   size_t total = 0;
+
+   while( total < num_bytes )
+   {
+      string line;
+      size_t type = next_random( ) % 10;
+
+      if( type < 3 )
+      {
+         const char* p_tag = tags[ next_random( ) % ( sizeof( tags ) / sizeof( tags[ 0 ] ) ) ];
+
+         line = "<" + string( p_tag ) + " class=\"" + random_word( 8 ) + "\">"
+          + random_word( 12 ) + " " + random_word( 12 ) + "</" + string( p_tag ) + ">";
+      }
+      else
+      {
+         // NOTE: Most lines are simply paragraph text (without any tags).
+         size_t num_words = 8 + ( next_random( ) % 16 );
+
+         for( size_t i = 0; i < num_words; i++ )
+         {
+            if( i )
+               line += ' ';
+
+            line += random_word( 10 );
+         }
+
+         if( type == 9 )
+            line += " contact " + random_word( 6 ) + "@" + random_word( 8 ) + ".com";
+      }
+
+      total += line.size( ) + 1;
+      lines.push_back( line );
+   }
+}
+
+void generate_log_lines( size_t num_bytes, vector< string >& lines )
+{
+   const char* const levels[ ] = { "INFO", "DEBUG", "WARN", "ERROR" };
+
+   size_t total = 0;
+
+   while( total < num_bytes )
+   {
+      size_t type = next_random( ) % 20;
+
+      string line( "2020-01-" + to_string( 10 + ( next_random( ) % 20 ) ) + " 12:" + to_string( 10 + ( next_random( ) % 50 ) ) );
+
+      line += " [" + string( levels[ type < 17 ? type % 3 : 3 ] ) + "] ";
+
+      if( type == 0 )
+         line += "connection from " + to_string( next_random( ) % 256 ) + "." + to_string( next_random( ) % 256 )
+          + "." + to_string( next_random( ) % 256 ) + "." + to_string( next_random( ) % 256 );
+      else if( type == 1 )
+         line += "login user=" + random_word( 8 ) + " ok";
+      else if( type == 2 )
+         line += "stored file " + random_hex( 64 );
+      else if( type == 3 )
+         line += "elapsed " + to_string( next_random( ) % 100 ) + "." + to_string( next_random( ) % 1000 ) + " secs";
+      else
+      {
+         size_t num_words = 4 + ( next_random( ) % 10 );
+
+         for( size_t i = 0; i < num_words; i++ )
+            line += random_word( 9 ) + ' ';
+      }
+
+      total += line.size( ) + 1;
+      lines.push_back( line );
+   }
+}
+
+bool matches_are_equal( const regex_match& lhs, const regex_match& rhs )
+{
+   return lhs.index == rhs.index && lhs.pos == rhs.pos
+    && ( lhs.pos == string::npos || ( lhs.length == rhs.length && lhs.refs == rhs.refs ) );
+}
+
+void search_with( regex& expr, size_t index, const string& text, vector< regex_match >& matches )
+{
+   regex_match match;
+
+   match.index = index;
+   match.pos = expr.search( text, &match.length, &match.refs );
+
+   if( match.pos != string::npos )
+      matches.push_back( match );
+}
+
+size_t compare_results( const vector< regex_match >& lhs, const vector< regex_match >& rhs, const string& name )
+{
+   size_t num_errors = 0;
+
+   if( lhs.size( ) != rhs.size( ) )
+      ++num_errors;
+   else
+   {
+      for( size_t i = 0; i < lhs.size( ); i++ )
+      {
+         if( !matches_are_equal( lhs[ i ], rhs[ i ] ) )
+            ++num_errors;
+      }
+   }
+
+   if( num_errors )
+      cerr << "error: " << name << " results differ (" << lhs.size( ) << " vs " << rhs.size( ) << " matches)" << endl;
+
+   return num_errors;
+}
+
+void output_rate( const string& name, size_t num_bytes, unsigned long usecs, bool timed )
+{
+   if( !timed )
+      return;
+
+   cout << "  " << name << ": " << ( usecs / 1000 ) << " msecs";
+
+   if( usecs )
+      cout << " (" << ( ( double )num_bytes / usecs ) << " MB/s)";
+
+   cout << endl;
+}
+
+size_t perform_bench( const string& name,
+ const vector< string >& lines, const char* const* p_exprs, size_t num_exprs, bool timed = true )
+{
+   size_t num_bytes = 0;
+
+   for( size_t i = 0; i < lines.size( ); i++ )
+      num_bytes += lines[ i ].size( );
+
+   cout << name << ": " << lines.size( ) << " lines, " << num_bytes << " bytes, " << num_exprs << " expressions" << endl;
+
+   vector< regex* > original_exprs;
+   vector< regex* > dfa_exprs;
+
+   multi_regex multi_exprs;
+
+   for( size_t i = 0; i < num_exprs; i++ )
+   {
+      original_exprs.push_back( new regex( p_exprs[ i ], false ) );
+      dfa_exprs.push_back( new regex( p_exprs[ i ] ) );
+
+      multi_exprs.add( p_exprs[ i ] );
+   }
+
+   vector< regex_match > original_matches;
+   vector< regex_match > dfa_matches;
+   vector< regex_match > multi_matches;
+
+   unsigned long start = get_usecs( );
+
+   for( size_t i = 0; i < lines.size( ); i++ )
+   {
+      for( size_t j = 0; j < num_exprs; j++ )
+         search_with( *original_exprs[ j ], j, lines[ i ], original_matches );
+   }
+
+   output_rate( "original", num_bytes, get_usecs( ) - start, timed );
+
+   start = get_usecs( );
+
+   for( size_t i = 0; i < lines.size( ); i++ )
+   {
+      for( size_t j = 0; j < num_exprs; j++ )
+         search_with( *dfa_exprs[ j ], j, lines[ i ], dfa_matches );
+   }
+
+   output_rate( "dfa", num_bytes, get_usecs( ) - start, timed );
+
+   start = get_usecs( );
+
+   for( size_t i = 0; i < lines.size( ); i++ )
+      multi_exprs.search( lines[ i ], multi_matches );
+
+   output_rate( "multi", num_bytes, get_usecs( ) - start, timed );
+
+   cout << "  matches: " << original_matches.size( ) << endl;
+
+   size_t num_errors = compare_results( original_matches, dfa_matches, name + " dfa" );
+   num_errors += compare_results( original_matches, multi_matches, name + " multi" );
+
+   for( size_t i = 0; i < num_exprs; i++ )
+   {
+      delete original_exprs[ i ];
+      delete dfa_exprs[ i ];
+   }
+
+   return num_errors;
+}
+
+size_t check_random_texts( const char* const* p_exprs, size_t num_exprs )
+{
+   size_t num_errors = 0;
+   size_t num_matches = 0;
+
+   string chars( c_random_chars );
+
+   for( size_t i = 0; i < num_exprs; i++ )
+   {
+      regex original_expr( p_exprs[ i ], false );
+      regex dfa_expr( p_exprs[ i ] );
+
+      for( size_t j = 0; j < c_num_random_texts; j++ )
+      {
+         string text;
+         size_t length = next_random( ) % c_max_random_length;
+
+         for( size_t k = 0; k < length; k++ )
+            text += chars[ next_random( ) % chars.size( ) ];
+
+         vector< regex_match > original_matches;
+         vector< regex_match > dfa_matches;
+
+         search_with( original_expr, i, text, original_matches );
+         search_with( dfa_expr, i, text, dfa_matches );
+
+         num_matches += original_matches.size( );
+
+         if( compare_results( original_matches, dfa_matches, string( "random (" ) + p_exprs[ i ] + ")" ) )
+         {
+            ++num_errors;
+            cerr << "text: " << text << endl;
+         }
+      }
+   }
+
+   cout << "random: " << ( num_exprs * c_num_random_texts ) << " searches, " << num_matches << " matches" << endl;
+
+   return num_errors;
+}
+
+size_t check_test_cases( )
+{
+   size_t num_errors = 0;
+
+   for( size_t i = 0; i < sizeof( c_test_cases ) / sizeof( c_test_cases[ 0 ] ); i++ )
+   {
+      regex original_expr( c_test_cases[ i ].p_expr, false );
+      regex dfa_expr( c_test_cases[ i ].p_expr );
+
+      vector< regex_match > original_matches;
+      vector< regex_match > dfa_matches;
+
+      search_with( original_expr, i, c_test_cases[ i ].p_text, original_matches );
+      search_with( dfa_expr, i, c_test_cases[ i ].p_text, dfa_matches );
+
+      cout << c_test_cases[ i ].p_expr << " in \"" << c_test_cases[ i ].p_text << "\": ";
+
+      if( original_matches.empty( ) )
+         cout << "not found" << endl;
+      else
+         cout << "found at " << original_matches[ 0 ].pos << " (length " << original_matches[ 0 ].length << ")" << endl;
+
+      num_errors += compare_results( original_matches, dfa_matches, string( "test (" ) + c_test_cases[ i ].p_expr + ")" );
+   }
+
+   return num_errors;
+}
+
+}
+
+int main( int argc, char* argv[ ] )
+{
+   if( argc > 2 )
+   {
+      cout << "usage: test_regex [" << c_test_option << " | <megabytes>]" << endl;
+      return 0;
+   }
+
+   int rc = 0;
+
+   try
+   {
+      size_t num_bytes = c_default_megabytes * 1024 * 1024;
+
+      bool is_test = false;
+
+      if( argc > 1 )
+      {
+         if( string( argv[ 1 ] ) == c_test_option )
+         {
+            is_test = true;
+            num_bytes = c_test_kilobytes * 1024;
+         }
+         else
+            num_bytes = atoi( argv[ 1 ] ) * 1024 * 1024;
+      }
+
+      if( !num_bytes )
+         throw runtime_error( "invalid number of megabytes" );
+
+      size_t num_errors = 0;
+
+      if( is_test )
+         num_errors += check_test_cases( );
+
+      num_errors += check_random_texts( c_html_expressions, sizeof( c_html_expressions ) / sizeof( c_html_expressions[ 0 ] ) );
+      num_errors += check_random_texts( c_log_expressions, sizeof( c_log_expressions ) / sizeof( c_log_expressions[ 0 ] ) );
+      num_errors += check_random_texts( c_other_expressions, sizeof( c_other_expressions ) / sizeof( c_other_expressions[ 0 ] ) );
+
+      vector< string > html_lines;
+      generate_html_lines( num_bytes, html_lines );
+
+      num_errors += perform_bench( "html", html_lines,
+       c_html_expressions, sizeof( c_html_expressions ) / sizeof( c_html_expressions[ 0 ] ), !is_test );
+
+      vector< string > log_lines;
+      generate_log_lines( num_bytes, log_lines );
+
+      num_errors += perform_bench( "log", log_lines,
+       c_log_expressions, sizeof( c_log_expressions ) / sizeof( c_log_expressions[ 0 ] ), !is_test );
+
+      cout << "errors: " << num_errors << endl;
+
+      if( num_errors )
+         rc = 1;
+   }
+   catch( exception& x )
+   {
+      cerr << "error: " << x.what( ) << endl;
+      rc = 1;
+   }
+   catch( ... )
+   {
+      cerr << "error: unexpected exception caught" << endl;
+      rc = 2;
+   }
+
+   return rc;
+}
@@ -0,0 +1,29 @@
+^[0-9]{1,19}$ in "-123": not found
+^[0-9]{1,19}$ in "12a": not found
+^[0-9]{1,19}$ in "12345678901234567890": found at 1 (length 19)
+[A-Za-z0-9._%+-]+@[A-Za-z0-9.-]+\.[A-Za-z]{2,8} in "fred@example.com": found at 0 (length 16)
+<[/]?([A-Za-z][A-Za-z0-9]*)[\s]*([^>]*)> in "text <b>bold</b> text": found at 5 (length 3)
+^[0-9]{1,12}$ in "1234567890123": found at 1 (length 12)
+^[0-9]{1,3}$ in "12345": found at 2 (length 3)
+^a{1,2}b in "aaab": found at 1 (length 3)
+^a{1,2} in "aaab": found at 2 (length 1)
+^[a-z]{2,3}$ in "abcd": found at 1 (length 3)
+^ab in "xab": not found
+^x?y in "zy": not found
+^a.*z$ in "abcz": found at 0 (length 4)
+^a.*z$ in "abczy": not found
+a[^b] in "abac": found at 2 (length 2)
+\bbee\b in "a bee b": found at 2 (length 3)
+\bbee\b in "beetle": not found
+(a+)b in "xaaab": found at 1 (length 4)
+[-+]?[0-9]+\.[0-9]+ in "1.25": found at 0 (length 4)
+A.B in "AxB": found at 0 (length 3)
+user=[a-z]+ in "login user=fred ok": found at 6 (length 9)
+random: 150000 searches, 17515 matches
+random: 300000 searches, 470 matches
+random: 800000 searches, 111121 matches
+html: 3166 lines, 259000 bytes, 3 expressions
+  matches: 2245
+log: 3567 lines, 258619 bytes, 6 expressions
+  matches: 1423
+errors: 0
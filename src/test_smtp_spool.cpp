@@ -0,0 +1,432 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef PRECOMPILE_H
+#  include "precompile.h"
+#endif
+#pragma hdrstop
+
+#ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <cstdlib>
+#  include <memory>
+#  include <string>
+#  include <vector>
+#  include <iostream>
+#  include <stdexcept>
+#endif
+
+#include "smtp.h"
+#include "threads.h"
+#include "sockets.h"
+#include "utilities.h"
+#include "smtp_spool.h"
+#include "fs_iterator.h"
+#include "thread_pool.h"
+#include "stand_in_server.h"
+
+using namespace std;
+
+// NOTE: This program is a load test for the outbound mail spool. A local stand-in SMTP server
+// (which accepts every message apart from optionally rejecting every nth one with a temporary
+// failure reply) is used so that the cost of sending messages either directly (with their own
+// connection each) or via the spool (which reuses connections) can be measured. The "-test"
+// option instead runs a fixed set of checks whose output does not depend upon the timing of the
+// run (including checking that messages which had been spooled are sent after a restart).
+
+const int c_port = 12998;
+
+const int c_request_timeout = 5000;
+const int c_retry_msecs = 100;
+const int c_max_attempts = 5;
+
+const size_t c_wait_timeout = 300000;
+
+const char* const c_localhost = "127.0.0.1";
+
+const char* const c_spool_directory = "~test_smtp_spool";
+
+const char* const c_test_option = "-test";
+const char* const c_direct_option = "-direct";
+
+namespace
+{
+
+mutex g_mutex;
+
+size_t g_num_failures = 0;
+
+class smtp_server : public stand_in_server
+{
+   public:
+   smtp_server( size_t reject_every )
+    :
+    stand_in_server( c_port ),
+    reject_every( reject_every ),
+    num_sessions( 0 ),
+    num_accepted( 0 ),
+    num_rejected( 0 )
+   {
+   }
+
+   ~smtp_server( ) { stop( ); }
+
+   void get_counts( size_t& sessions, size_t& accepted, size_t& rejected ) const
+   {
+      guard g( counts_mutex );
+
+      sessions = num_sessions;
+      accepted = num_accepted;
+      rejected = num_rejected;
+   }
+
+   protected:
+   void accept_session( tcp_socket* p_socket )
+   {
+      // NOTE: Scope for guard object.
+      {
+         guard g( counts_mutex );
+         ++num_sessions;
+      }
+
+      stand_in_server::accept_session( p_socket );
+   }
+
+   void handle_session( tcp_socket& socket )
+   {
+      bool in_data = false;
+
+      socket.write_line( "220 stand-in ready", c_request_timeout );
+
+      while( true )
+      {
+         string line;
+         if( socket.read_line( line, c_request_timeout ) <= 0 && !socket.had_blank_line( ) )
+         {
+            if( socket.had_timeout( ) && !is_stopping( ) )
+               continue;
+
+            break;
+         }
+
+         string response;
+
+         if( in_data )
+         {
+            if( line != "." )
+               continue;
+
+            in_data = false;
+
+            guard g( counts_mutex );
+
+            if( reject_every && ( ( num_accepted + num_rejected + 1 ) % reject_every ) == 0 )
+            {
+               ++num_rejected;
+               response = "451 temporary failure";
+            }
+            else
+            {
+               ++num_accepted;
+               response = "250 accepted";
+            }
+         }
+         else if( line.find( "DATA" ) == 0 )
+         {
+            in_data = true;
+            response = "354 go ahead";
+         }
+         else if( line.find( "QUIT" ) == 0 )
+         {
+            socket.write_line( "221 bye", c_request_timeout );
+            break;
+         }
+         else
+            response = "250 okay";
+
+         if( socket.write_line( response, c_request_timeout ) <= 0 )
+            break;
+      }
+   }
+
+   private:
+   size_t reject_every;
+
+   size_t num_sessions;
+   size_t num_accepted;
+   size_t num_rejected;
+
+   mutable mutex counts_mutex;
+};
+
+void send_message( smtp_spool* p_spool, size_t num )
+{
+   string host( string( c_localhost ) + ':' + to_string( c_port ) );
+
+   smtp_user_info user_info( "sender@localhost" );
+
+   vector< string > recipients;
+   recipients.push_back( "recipient" + to_string( num ) + "@localhost" );
+
+   string data( compose_smtp_message( user_info, recipients,
+    "Test message #" + to_string( num ), "This is a test message.", "", 0, 0, 0 ) );
+
+   if( !p_spool )
+      send_composed_smtp_message( host, user_info, recipients, data );
+   else
+      p_spool->spool_message( host, user_info, recipients, data );
+}
+
+class client_job : public thread_pool_job
+{
+   public:
+   client_job( smtp_spool* p_spool, size_t num_messages ) : p_spool( p_spool ), num_messages( num_messages ) { }
+
+   void run( )
+   {
+      size_t num_failures = 0;
+
+      for( size_t i = 0; i < num_messages; i++ )
+      {
+         try
+         {
+            send_message( p_spool, i );
+         }
+         catch( exception& )
+         {
+            ++num_failures;
+         }
+      }
+
+      guard g( g_mutex );
+
+      g_num_failures += num_failures;
+   }
+
+   private:
+   smtp_spool* p_spool;
+   size_t num_messages;
+};
+
+// NOTE: If no spool is provided then the messages are sent directly.
+void run_clients( smtp_spool* p_spool, size_t num_clients, size_t num_messages )
+{
+   g_num_failures = 0;
+
+   thread_pool clients( num_clients );
+   clients.start( );
+
+   for( size_t i = 0; i < num_clients; i++ )
+      clients.queue_job( new client_job( p_spool, num_messages ) );
+
+   clients.stop( );
+}
+
+void remove_spool_files( )
+{
+   if( file_exists( c_spool_directory ) )
+   {
+      file_filter ff;
+      fs_iterator fs( c_spool_directory, &ff );
+
+      vector< string > file_names;
+
+      while( fs.has_next( ) )
+         file_names.push_back( fs.get_full_name( ) );
+
+      for( size_t i = 0; i < file_names.size( ); i++ )
+         file_remove( file_names[ i ] );
+   }
+}
+
+size_t num_spool_files( )
+{
+   size_t num_files = 0;
+
+   if( file_exists( c_spool_directory ) )
+   {
+      file_filter ff;
+      fs_iterator fs( c_spool_directory, &ff );
+
+      while( fs.has_next( ) )
+         ++num_files;
+   }
+
+   return num_files;
+}
+
+void run_tests( )
+{
+   size_t sessions, accepted, rejected;
+
+   // NOTE: Scope for server object.
+   {
+      smtp_server server( 0 );
+      server.start( );
+
+      run_clients( 0, 2, 5 );
+
+      server.get_counts( sessions, accepted, rejected );
+
+      cout << "direct: messages 10, failures " << g_num_failures << ", accepted " << accepted << endl;
+   }
+
+   remove_spool_files( );
+
+   // NOTE: Scope for server object.
+   {
+      smtp_server server( 4 );
+      server.start( );
+
+      smtp_spool spool( c_spool_directory, c_max_attempts, c_retry_msecs );
+      spool.start( );
+
+      run_clients( &spool, 2, 10 );
+
+      bool sent = spool.wait_until_empty( c_wait_timeout );
+
+      smtp_spool_stats stats;
+      spool.get_stats( stats );
+
+      spool.stop( );
+
+      server.get_counts( sessions, accepted, rejected );
+
+      cout << "spooled: messages 20, failures " << g_num_failures << ", sent " << stats.num_sent
+       << ", failed " << stats.num_failed << ", accepted " << accepted << ", rejected " << rejected
+       << ( sent ? "" : " (timed out)" ) << ", spool files " << num_spool_files( ) << endl;
+   }
+
+   // NOTE: Scope for spool object.
+   {
+      smtp_spool spool( c_spool_directory, c_max_attempts, c_retry_msecs );
+
+      for( size_t i = 0; i < 5; i++ )
+         send_message( &spool, i );
+   }
+
+   cout << "stopped: spool files " << num_spool_files( ) << endl;
+
+   // NOTE: Scope for server object.
+   {
+      smtp_server server( 0 );
+      server.start( );
+
+      smtp_spool spool( c_spool_directory, c_max_attempts, c_retry_msecs );
+      spool.start( );
+
+      bool sent = spool.wait_until_empty( c_wait_timeout );
+
+      smtp_spool_stats stats;
+      spool.get_stats( stats );
+
+      spool.stop( );
+
+      server.get_counts( sessions, accepted, rejected );
+
+      cout << "restarted: sent " << stats.num_sent << ", accepted " << accepted
+       << ( sent ? "" : " (timed out)" ) << ", spool files " << num_spool_files( ) << endl;
+   }
+}
+
+}
+
+int main( int argc, char* argv[ ] )
+{
+   if( ( argc < 3 || argc > 5 ) && ( argc != 2 || string( argv[ 1 ] ) != c_test_option ) )
+   {
+      cout << "Usage: test_smtp_spool " << c_test_option
+       << " | <clients> <messages> [<reject_every>] [" << c_direct_option << "]" << endl;
+      return 0;
+   }
+
+   int rc = 0;
+
+   try
+   {
+      if( argc == 2 )
+      {
+         run_tests( );
+         return 0;
+      }
+
+      size_t num_clients = atoi( argv[ 1 ] );
+      size_t num_messages = atoi( argv[ 2 ] );
+
+      bool direct = false;
+      size_t reject_every = 0;
+
+      for( int i = 3; i < argc; i++ )
+      {
+         if( string( argv[ i ] ) == c_direct_option )
+            direct = true;
+         else
+            reject_every = atoi( argv[ i ] );
+      }
+
+      if( !num_clients )
+         throw runtime_error( "number of clients must be non-zero" );
+
+      smtp_server server( reject_every );
+      server.start( );
+
+      remove_spool_files( );
+
+      smtp_spool spool( c_spool_directory, c_max_attempts, c_retry_msecs );
+      spool.start( );
+
+      unsigned long start = get_msecs( );
+
+      run_clients( direct ? 0 : &spool, num_clients, num_messages );
+
+      unsigned long queued = get_msecs( ) - start;
+
+      if( !spool.wait_until_empty( c_wait_timeout ) )
+         throw runtime_error( "timed out waiting for spooled messages to be sent" );
+
+      unsigned long elapsed = get_msecs( ) - start;
+
+      smtp_spool_stats stats;
+      spool.get_stats( stats );
+
+      spool.stop( );
+
+      size_t sessions, accepted, rejected;
+      server.get_counts( sessions, accepted, rejected );
+
+      size_t total = num_clients * num_messages;
+
+      cout << "clients: " << num_clients << ", messages: " << total << ( direct ? " (direct)" : " (spooled)" ) << endl;
+
+      if( !direct )
+         cout << "queued: " << queued << " msecs, sent: " << stats.num_sent << ", failed: " << stats.num_failed
+          << ", connects: " << stats.num_connects << ", reused: " << stats.num_reused << endl;
+
+      if( !stats.last_error.empty( ) )
+         cout << "last error: " << stats.last_error << endl;
+
+      cout << "sessions: " << sessions << ", accepted: " << accepted
+       << ", rejected: " << rejected << ", elapsed: " << elapsed << " msecs";
+
+      if( elapsed )
+         cout << " (" << ( total * 1000 / elapsed ) << " messages/sec)";
+
+      cout << endl;
+
+      if( g_num_failures || stats.num_failed )
+         rc = 1;
+   }
+   catch( exception& x )
+   {
+      cerr << "error: " << x.what( ) << endl;
+      rc = 1;
+   }
+   catch( ... )
+   {
+      cerr << "error: unexpected exception caught" << endl;
+      rc = 2;
+   }
+
+   return rc;
+}
@@ -0,0 +1,4 @@
+direct: messages 10, failures 0, accepted 10
+spooled: messages 20, failures 0, sent 20, failed 0, accepted 20, rejected 6, spool files 0
+stopped: spool files 5
+restarted: sent 5, accepted 5, spool files 0
@@ -0,0 +1,326 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef PRECOMPILE_H
+#  include "precompile.h"
+#endif
+#pragma hdrstop
+
+#ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <cstdlib>
+#  include <memory>
+#  include <string>
+#  include <iostream>
+#  include <stdexcept>
+#endif
+
+#include "threads.h"
+#include "utilities.h"
+#include "socket_pool.h"
+#include "thread_pool.h"
+#include "stand_in_server.h"
+
+using namespace std;
+
+// NOTE: This program is a load benchmark for the socket pool that is used by the FCGI interface
+// to hand out application server connections to its request handlers. A local stand-in server
+// (that just acknowledges each request line after an optional delay) is used so that the costs
+// of connecting and of waiting for a pooled socket can be measured without an actual server.
+// The "-test" option instead runs a fixed set of checks whose output does not depend upon the
+// timing of the run.
+
+const int c_port = 12999;
+
+const int c_connect_timeout = 2500;
+const int c_request_timeout = 5000;
+const int c_obtain_timeout = 30000;
+
+const char* const c_localhost = "127.0.0.1";
+
+const char* const c_greeting = "(okay)";
+const char* const c_response = "(okay)";
+
+const char* const c_request = "perform_fetch";
+
+const char* const c_test_option = "-test";
+const char* const c_reconnect_option = "-reconnect";
+
+namespace
+{
+
+mutex g_mutex;
+
+size_t g_num_failures = 0;
+size_t g_num_connects = 0;
+
+class socket_pool_server : public stand_in_server
+{
+   public:
+   socket_pool_server( int delay ) : stand_in_server( c_port ), delay( delay ) { }
+
+   ~socket_pool_server( ) { stop( ); }
+
+   protected:
+   void handle_session( tcp_socket& socket )
+   {
+      string pid;
+      if( socket.read_line( pid, c_request_timeout ) <= 0 )
+         return;
+
+      socket.write_line( c_greeting, c_request_timeout );
+
+      while( true )
+      {
+         string request;
+         if( socket.read_line( request, c_request_timeout ) <= 0 )
+         {
+            if( socket.had_timeout( ) && !is_stopping( ) )
+               continue;
+
+            break;
+         }
+
+         if( delay )
+            msleep( delay );
+
+         if( socket.write_line( c_response, c_request_timeout ) <= 0 )
+            break;
+      }
+   }
+
+   private:
+   int delay;
+};
+
+// NOTE: Returns false if either connecting (for a socket that is not yet connected) or issuing
+// the request failed (and increments the number of connects if a connection was made).
+bool perform_request( tcp_socket& socket, size_t& num_connects )
+{
+   bool okay = true;
+
+   if( !socket.okay( ) )
+   {
+      ++num_connects;
+
+      string greeting;
+      okay = socket.open( )
+       && socket.connect( ip_address( c_localhost, c_port ), c_connect_timeout )
+       && socket.set_no_delay( )
+       && socket.write_line( to_string( get_pid( ) ), c_request_timeout ) > 0
+       && socket.read_line( greeting, c_request_timeout ) > 0 && greeting == c_greeting;
+   }
+
+   string response;
+   if( okay )
+      okay = socket.write_line( c_request, c_request_timeout ) > 0
+       && socket.read_line( response, c_request_timeout ) > 0 && response == c_response;
+
+   return okay;
+}
+
+class client_job : public thread_pool_job
+{
+   public:
+   client_job( socket_pool< tcp_socket >& pool, size_t num_requests, bool reconnect )
+    :
+    pool( pool ),
+    num_requests( num_requests ),
+    reconnect( reconnect )
+   {
+   }
+
+   void run( )
+   {
+      size_t num_failures = 0;
+      size_t num_connects = 0;
+
+      for( size_t i = 0; i < num_requests; i++ )
+      {
+         tcp_socket* p_socket = pool.obtain_socket( c_obtain_timeout );
+
+         if( !p_socket )
+         {
+            ++num_failures;
+            continue;
+         }
+
+         bool okay = perform_request( *p_socket, num_connects );
+
+         if( !okay )
+            ++num_failures;
+
+         if( !okay || reconnect )
+            pool.disconnect_socket( p_socket );
+         else
+            pool.release_socket( p_socket );
+      }
+
+      guard g( g_mutex );
+
+      g_num_failures += num_failures;
+      g_num_connects += num_connects;
+   }
+
+   private:
+   socket_pool< tcp_socket >& pool;
+
+   size_t num_requests;
+   bool reconnect;
+};
+
+// NOTE: Returns the number of msecs taken for all of the clients to have issued their requests.
+unsigned long run_clients( socket_pool< tcp_socket >& pool, size_t num_clients, size_t num_requests, bool reconnect )
+{
+   g_num_failures = g_num_connects = 0;
+
+   unsigned long start = get_msecs( );
+
+   thread_pool clients( num_clients );
+   clients.start( );
+
+   for( size_t i = 0; i < num_clients; i++ )
+      clients.queue_job( new client_job( pool, num_requests, reconnect ) );
+
+   clients.stop( );
+
+   return get_msecs( ) - start;
+}
+
+void run_tests( )
+{
+   socket_pool_server server( 0 );
+   server.start( );
+
+   // NOTE: Scope for pool object.
+   {
+      socket_pool< tcp_socket > pool( 2 );
+
+      size_t num_connects = 0;
+      size_t num_failures = 0;
+
+      for( size_t i = 0; i < 10; i++ )
+      {
+         tcp_socket* p_socket = pool.obtain_socket( );
+
+         if( !perform_request( *p_socket, num_connects ) )
+            ++num_failures;
+
+         pool.release_socket( p_socket );
+      }
+
+      cout << "sequential: requests 10, connects " << num_connects << ", failures " << num_failures << endl;
+
+      tcp_socket* p_first = pool.obtain_socket( );
+      tcp_socket* p_second = pool.obtain_socket( );
+      tcp_socket* p_third = pool.obtain_socket( );
+
+      cout << "exhausted: third socket " << ( p_third ? "obtained" : "not obtained" ) << endl;
+
+      perform_request( *p_second, num_connects );
+
+      pool.release_socket( p_first );
+      pool.release_socket( p_second );
+
+      tcp_socket* p_preferred = pool.obtain_socket( 0, p_first );
+
+      cout << "preferred: " << ( p_preferred == p_first ? "reused" : "not reused" ) << endl;
+
+      pool.release_socket( p_preferred );
+   }
+
+   // NOTE: Scope for pool object.
+   {
+      socket_pool< tcp_socket > pool( 2 );
+
+      run_clients( pool, 4, 25, false );
+
+      cout << "concurrent: requests 100, failures " << g_num_failures
+       << ", connects " << ( g_num_connects <= 2 ? "within limit" : "exceeded limit" ) << endl;
+
+      pool.disconnect_sockets( true );
+
+      run_clients( pool, 4, 25, true );
+
+      cout << "reconnecting: requests 100, failures " << g_num_failures << ", connects " << g_num_connects << endl;
+   }
+}
+
+}
+
+int main( int argc, char* argv[ ] )
+{
+   if( ( argc < 4 || argc > 6 ) && ( argc != 2 || string( argv[ 1 ] ) != c_test_option ) )
+   {
+      cout << "Usage: test_socket_pool " << c_test_option
+       << " | <clients> <sockets> <requests> [<delay_msecs>] [" << c_reconnect_option << "]" << endl;
+      return 0;
+   }
+
+   int rc = 0;
+
+   try
+   {
+      if( argc == 2 )
+      {
+         run_tests( );
+         return 0;
+      }
+
+      size_t num_clients = atoi( argv[ 1 ] );
+      size_t num_sockets = atoi( argv[ 2 ] );
+      size_t num_requests = atoi( argv[ 3 ] );
+
+      int delay = 0;
+      bool reconnect = false;
+
+      for( int i = 4; i < argc; i++ )
+      {
+         if( string( argv[ i ] ) == c_reconnect_option )
+            reconnect = true;
+         else
+            delay = atoi( argv[ i ] );
+      }
+
+      if( !num_clients || !num_sockets )
+         throw runtime_error( "number of clients and sockets must both be non-zero" );
+
+      socket_pool_server server( delay );
+      server.start( );
+
+      socket_pool< tcp_socket > pool( num_sockets );
+
+      unsigned long elapsed = run_clients( pool, num_clients, num_requests, reconnect );
+
+      size_t total = num_clients * num_requests;
+
+      cout << "clients: " << num_clients << ", sockets: " << num_sockets
+       << ", requests: " << total << ( reconnect ? " (reconnecting)" : "" ) << endl;
+
+      cout << "connects: " << g_num_connects << ", failures: " << g_num_failures
+       << ", elapsed: " << elapsed << " msecs";
+
+      if( elapsed )
+         cout << " (" << ( total * 1000 / elapsed ) << " requests/sec)";
+
+      cout << endl;
+
+      pool.disconnect_sockets( false );
+
+      if( g_num_failures )
+         rc = 1;
+   }
+   catch( exception& x )
+   {
+      cerr << "error: " << x.what( ) << endl;
+      rc = 1;
+   }
+   catch( ... )
+   {
+      cerr << "error: unexpected exception caught" << endl;
+      rc = 2;
+   }
+
+   return rc;
+}
@@ -0,0 +1,5 @@
+sequential: requests 10, connects 1, failures 0
+exhausted: third socket not obtained
+preferred: reused
+concurrent: requests 100, failures 0, connects within limit
+reconnecting: requests 100, failures 0, connects 100
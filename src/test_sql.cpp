@@ -1,5 +1,6 @@
 // Copyright (c) 2012-2020 CIYAM Developers
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <fstream>
@@ -11,18 +12,20 @@
 
 using namespace std;
 
+const size_t c_max_group_connections = 4;
+
 int main( int argc, char* argv[ ] )
 {
 #ifdef RDBMS_SQLITE
    if( argc < 3 || argc > 4 )
    {
-      cout << "Usage: " << argv[ 0 ] << " <db_file> <sql|@sql_file> [-group]" << endl;
+      cout << "Usage: " << argv[ 0 ] << " <db_file> <sql|@sql_file> [-group|-group_concurrent]" << endl;
       return 0;
    }
 #else
    if( argc < 4 || argc > 5 )
    {
-      cout << "Usage: " << argv[ 0 ] << " <db> <uid> <sql|@sql_file> [-group]" << endl;
+      cout << "Usage: " << argv[ 0 ] << " <db> <uid> <sql|@sql_file> [-group|-group_concurrent]" << endl;
       return 0;
    }
 #endif
@@ -30,21 +33,32 @@ int main( int argc, char* argv[ ] )
    try
    {
       bool use_dataset_group = false;
+      bool use_concurrent_group = false;
 
 #ifdef RDBMS_SQLITE
       sql_db db( argv[ 1 ] );
 
+      sql_db_pool db_pool( argv[ 1 ], "", c_max_group_connections );
+      sql_query_pool query_pool( c_max_group_connections );
+
       string sql( argv[ 2 ] );
 
       if( ( argc == 4 ) && string( argv[ 3 ] ) == "-group" )
          use_dataset_group = true;
+      else if( ( argc == 4 ) && string( argv[ 3 ] ) == "-group_concurrent" )
+         use_dataset_group = use_concurrent_group = true;
 #else
       sql_db db( argv[ 1 ], argv[ 2 ] );
 
+      sql_db_pool db_pool( argv[ 1 ], argv[ 2 ], c_max_group_connections );
+      sql_query_pool query_pool( c_max_group_connections );
+
       string sql( argv[ 3 ] );
 
       if( ( argc == 5 ) && string( argv[ 4 ] ) == "-group" )
          use_dataset_group = true;
+      else if( ( argc == 5 ) && string( argv[ 4 ] ) == "-group_concurrent" )
+         use_dataset_group = use_concurrent_group = true;
 #endif
 
       if( sql.length( ) && sql[ 0 ] == '@' )
@@ -56,7 +70,14 @@ int main( int argc, char* argv[ ] )
             vector< string > queries;
             buffer_file_lines( sql.substr( 1 ), queries );
 
-            sql_dataset_group dsg( db, queries );
+            auto_ptr< sql_dataset_group > ap_dsg;
+
+            if( !use_concurrent_group )
+               ap_dsg.reset( new sql_dataset_group( db, queries ) );
+            else
+               ap_dsg.reset( new sql_dataset_group( db_pool, query_pool, queries ) );
+
+            sql_dataset_group& dsg( *ap_dsg );
 
             while( dsg.next( ) )
             {
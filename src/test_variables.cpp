@@ -0,0 +1,440 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef PRECOMPILE_H
+#  include "precompile.h"
+#endif
+#pragma hdrstop
+
+#ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <map>
+#  include <cstdlib>
+#  include <string>
+#  include <vector>
+#  include <utility>
+#  include <iostream>
+#  include <stdexcept>
+#endif
+
+#include "threads.h"
+#include "utilities.h"
+#include "thread_pool.h"
+#include "variable_store.h"
+
+using namespace std;
+
+// NOTE: This program is a contention test for the sharded variable store that is used for the
+// application server's system variables. A number of threads will each read other threads'
+// variables, write their own variables and occasionally acquire one of a small number of shared
+// lock variables (in the same manner as "system_variable_lock") with the same workload first
+// being run against a single mutex protected map (whose locks are acquired by polling) and then
+// against the variable store. If the bulk option is used then each operation will instead get or
+// set a batch of variables. The test option performs checks of the store's adjust function along
+// with smaller (untimed) workloads so that its output can be compared.
+
+const size_t c_num_locks = 4;
+const size_t c_num_variables = 64;
+const size_t c_batch_size = 32;
+
+const size_t c_lock_percent = 1;
+const size_t c_write_percent = 20;
+
+const unsigned long c_lock_poll_msecs = 200;
+const unsigned long c_lock_timeout_msecs = 30000;
+
+const char* const c_locked = "<locked>";
+
+const char* const c_test_option = "-test";
+const char* const c_bulk_option = "-bulk";
+
+const size_t c_test_threads = 4;
+const size_t c_test_operations = 1000;
+
+const size_t c_test_adjustments = 1500;
+
+struct adjust_test_case
+{
+   const char* p_initial;
+   int amount;
+};
+
+const adjust_test_case c_adjust_test_cases[ ] =
+{
+   { "", 1 },
+   { "", -1 },
+   { "1", 1 },
+   { "1", -1 },
+   { "2", -1 },
+   { "3", -5 },
+   { "", 3 },
+   { "-3", 1 },
+   { "-3", -1 },
+   { "-1", 1 },
+   { "0", -1 }
+};
+
+namespace
+{
+
+mutex g_mutex;
+
+string g_error;
+
+unsigned long g_max_lock_wait = 0;
+
+class single_mutex_store
+{
+   public:
+   string get( const string& name ) const
+   {
+      guard g( lock );
+
+      map< string, string >::const_iterator ci = values.find( name );
+
+      return ci == values.end( ) ? string( ) : ci->second;
+   }
+
+   void get( const vector< string >& names, vector< string >& values ) const
+   {
+      values.resize( names.size( ) );
+
+      for( size_t i = 0; i < names.size( ); i++ )
+         values[ i ] = get( names[ i ] );
+   }
+
+   void set( const string& name, const string& value )
+   {
+      guard g( lock );
+
+      if( !value.empty( ) )
+         values[ name ] = value;
+      else
+         values.erase( name );
+   }
+
+   void set( const vector< pair< string, string > >& names_and_values )
+   {
+      for( size_t i = 0; i < names_and_values.size( ); i++ )
+         set( names_and_values[ i ].first, names_and_values[ i ].second );
+   }
+
+   bool set_if_when_changed( const string& name,
+    const string& value, const string& current, unsigned long timeout_msecs )
+   {
+      for( unsigned long waited = 0; ; waited += c_lock_poll_msecs )
+      {
+         // NOTE: Scope for guard object.
+         {
+            guard g( lock );
+
+            if( get( name ) == current )
+            {
+               set( name, value );
+               return true;
+            }
+         }
+
+         if( waited >= timeout_msecs )
+            return false;
+
+         msleep( c_lock_poll_msecs );
+      }
+   }
+
+   private:
+   mutable mutex lock;
+   map< string, string > values;
+};
+
+void worker_finished( unsigned long max_lock_wait, const string& error )
+{
+   guard g( g_mutex );
+
+   if( max_lock_wait > g_max_lock_wait )
+      g_max_lock_wait = max_lock_wait;
+
+   if( g_error.empty( ) )
+      g_error = error;
+}
+
+template< typename T > class worker : public thread_pool_job
+{
+   public:
+   worker( T& store, size_t num, size_t num_threads, size_t num_operations, bool use_bulk )
+    :
+    store( store ),
+    num( num ),
+    num_operations( num_operations ),
+    use_bulk( use_bulk )
+   {
+      for( size_t i = 0; i < c_num_variables; i++ )
+      {
+         own_names.push_back( "thread_" + to_string( num ) + "_var_" + to_string( i ) );
+         other_names.push_back( "thread_" + to_string( ( num + 1 ) % num_threads ) + "_var_" + to_string( i ) );
+      }
+   }
+
+   void run( )
+   {
+      string error;
+      unsigned long max_lock_wait = 0;
+
+      try
+      {
+         perform_operations( max_lock_wait );
+      }
+      catch( exception& x )
+      {
+         error = x.what( );
+      }
+
+      worker_finished( max_lock_wait, error );
+   }
+
+   private:
+   void perform_operations( unsigned long& max_lock_wait )
+   {
+      vector< string > names, values;
+      vector< pair< string, string > > names_and_values;
+
+      for( size_t i = 0; i < num_operations; i++ )
+      {
+         size_t percent = ( i + num ) % 100;
+
+         if( percent < c_lock_percent )
+         {
+            string lock_name( "lock_" + to_string( ( i / 100 ) % c_num_locks ) );
+
+            unsigned long start = get_usecs( );
+
+            if( !store.set_if_when_changed( lock_name, c_locked, "", c_lock_timeout_msecs ) )
+               throw runtime_error( "unable to acquire " + lock_name );
+
+            unsigned long wait = get_usecs( ) - start;
+
+            if( wait > max_lock_wait )
+               max_lock_wait = wait;
+
+            store.set( own_names[ 0 ], to_string( i ) );
+            store.set( lock_name, "" );
+         }
+         else if( percent < c_lock_percent + c_write_percent )
+         {
+            if( !use_bulk )
+               store.set( own_names[ i % c_num_variables ], to_string( i ) );
+            else
+            {
+               names_and_values.clear( );
+
+               for( size_t j = 0; j < c_batch_size; j++ )
+                  names_and_values.push_back( make_pair( own_names[ ( i + j ) % c_num_variables ], to_string( i ) ) );
+
+               store.set( names_and_values );
+            }
+         }
+         else
+         {
+            if( !use_bulk )
+               store.get( other_names[ i % c_num_variables ] );
+            else
+            {
+               names.clear( );
+
+               for( size_t j = 0; j < c_batch_size; j++ )
+                  names.push_back( other_names[ ( i + j ) % c_num_variables ] );
+
+               store.get( names, values );
+            }
+         }
+      }
+
+   }
+
+   T& store;
+
+   size_t num;
+   size_t num_operations;
+
+   bool use_bulk;
+
+   vector< string > own_names;
+   vector< string > other_names;
+};
+
+template< typename T > void run_workload( const char* p_name,
+ T& store, size_t num_threads, size_t num_operations, bool use_bulk, bool timed = true )
+{
+   g_error.erase( );
+   g_max_lock_wait = 0;
+
+   unsigned long start = get_usecs( );
+
+   thread_pool workers( num_threads );
+   workers.start( );
+
+   for( size_t i = 0; i < num_threads; i++ )
+      workers.queue_job( new worker< T >( store, i, num_threads, num_operations, use_bulk ) );
+
+   workers.stop( );
+
+   unsigned long elapsed = get_usecs( ) - start;
+
+   if( !g_error.empty( ) )
+      throw runtime_error( g_error );
+
+   size_t total = num_threads * num_operations;
+
+   cout << p_name << ": " << total << " operations";
+
+   if( timed )
+      cout << " in " << ( elapsed / 1000 ) << " ms ("
+       << ( elapsed ? ( unsigned long )( total * 1000000.0 / elapsed ) : 0 ) << " per second), max lock wait "
+       << ( g_max_lock_wait / 1000 ) << " ms" << endl;
+   else
+   {
+      size_t num_held = 0;
+
+      for( size_t i = 0; i < c_num_locks; i++ )
+      {
+         if( !store.get( "lock_" + to_string( i ) ).empty( ) )
+            ++num_held;
+      }
+
+      cout << ", locks held " << num_held << endl;
+   }
+}
+
+class adjuster : public thread_pool_job
+{
+   public:
+   adjuster( variable_store& store, const string& name, int amount, size_t num_adjustments )
+    :
+    store( store ),
+    name( name ),
+    amount( amount ),
+    num_adjustments( num_adjustments )
+   {
+   }
+
+   void run( )
+   {
+      for( size_t i = 0; i < num_adjustments; i++ )
+         store.adjust( name, amount );
+   }
+
+   private:
+   variable_store& store;
+
+   string name;
+
+   int amount;
+   size_t num_adjustments;
+};
+
+void run_concurrent_adjustments( variable_store& store, const string& name, int amount, size_t num_adjustments )
+{
+   thread_pool adjusters( c_test_threads );
+   adjusters.start( );
+
+   for( size_t i = 0; i < c_test_threads; i++ )
+      adjusters.queue_job( new adjuster( store, name, amount, num_adjustments ) );
+
+   adjusters.stop( );
+}
+
+void run_tests( )
+{
+   variable_store store;
+
+   for( size_t i = 0; i < sizeof( c_adjust_test_cases ) / sizeof( c_adjust_test_cases[ 0 ] ); i++ )
+   {
+      const adjust_test_case& test_case( c_adjust_test_cases[ i ] );
+
+      string name( "adjust_" + to_string( i ) );
+
+      store.set( name, test_case.p_initial );
+
+      string result( store.adjust( name, test_case.amount ) );
+
+      cout << "adjust \"" << test_case.p_initial << "\" by " << test_case.amount << ": \"" << result << "\" ("
+       << ( store.has( name ) ? "set" : "removed" ) << ( store.get( name ) != result ? ", mismatch" : "" ) << ")" << endl;
+   }
+
+   run_concurrent_adjustments( store, "counter", 1, c_test_adjustments );
+   cout << "concurrent increments: \"" << store.get( "counter" ) << "\"" << endl;
+
+   // NOTE: As there are more decrements than increments this checks the value can't go below zero.
+   run_concurrent_adjustments( store, "counter", -1, c_test_adjustments * 2 );
+   cout << "concurrent decrements: \"" << store.get( "counter" ) << "\"" << endl;
+
+   cout << "threads: " << c_test_threads << ", operations per thread: " << c_test_operations << endl;
+
+   single_mutex_store single_store;
+   run_workload( "single mutex", single_store, c_test_threads, c_test_operations, false, false );
+   run_workload( "single mutex (bulk)", single_store, c_test_threads, c_test_operations, true, false );
+
+   variable_store sharded_store;
+   run_workload( "sharded store", sharded_store, c_test_threads, c_test_operations, false, false );
+   run_workload( "sharded store (bulk)", sharded_store, c_test_threads, c_test_operations, true, false );
+}
+
+}
+
+int main( int argc, char* argv[ ] )
+{
+   if( ( argc < 3 || argc > 4 ) && ( argc != 2 || string( argv[ 1 ] ) != c_test_option ) )
+   {
+      cout << "Usage: test_variables " << c_test_option
+       << " | <threads> <operations> [" << c_bulk_option << "]" << endl;
+      return 0;
+   }
+
+   int rc = 0;
+
+   try
+   {
+      if( argc == 2 )
+      {
+         run_tests( );
+         return 0;
+      }
+
+      size_t num_threads = atoi( argv[ 1 ] );
+      size_t num_operations = atoi( argv[ 2 ] );
+
+      bool use_bulk = false;
+
+      if( argc > 3 )
+      {
+         if( string( argv[ 3 ] ) != c_bulk_option )
+            throw runtime_error( "unexpected option '" + string( argv[ 3 ] ) + "'" );
+
+         use_bulk = true;
+      }
+
+      if( !num_threads )
+         throw runtime_error( "number of threads must be non-zero" );
+
+      cout << "threads: " << num_threads << ", operations per thread: " << num_operations;
+
+      if( use_bulk )
+         cout << " (bulk with " << c_batch_size << " variables per operation)";
+
+      cout << endl;
+
+      single_mutex_store single_store;
+      run_workload( "single mutex", single_store, num_threads, num_operations, use_bulk );
+
+      variable_store sharded_store;
+      run_workload( "sharded store", sharded_store, num_threads, num_operations, use_bulk );
+   }
+   catch( exception& x )
+   {
+      cerr << "error: " << x.what( ) << endl;
+      rc = 1;
+   }
+
+   return rc;
+}
@@ -0,0 +1,18 @@
+adjust "" by 1: "1" (set)
+adjust "" by -1: "" (removed)
+adjust "1" by 1: "2" (set)
+adjust "1" by -1: "" (removed)
+adjust "2" by -1: "1" (set)
+adjust "3" by -5: "" (removed)
+adjust "" by 3: "3" (set)
+adjust "-3" by 1: "-2" (set)
+adjust "-3" by -1: "-3" (set)
+adjust "-1" by 1: "" (removed)
+adjust "0" by -1: "" (removed)
+concurrent increments: "6000"
+concurrent decrements: ""
+threads: 4, operations per thread: 1000
+single mutex: 4000 operations, locks held 0
+single mutex (bulk): 4000 operations, locks held 0
+sharded store: 4000 operations, locks held 0
+sharded store (bulk): 4000 operations, locks held 0
@@ -0,0 +1,204 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef PRECOMPILE_H
+#  include "precompile.h"
+#endif
+#pragma hdrstop
+
+#ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <deque>
+#  include <memory>
+#  include <vector>
+#  include <stdexcept>
+#endif
+
+#include "thread_pool.h"
+
+#include "threads.h"
+
+using namespace std;
+
+class thread_pool_worker : public thread
+{
+   public:
+   thread_pool_worker( thread_pool& pool ) : pool( pool ) { }
+
+   void on_start( );
+
+   private:
+   thread_pool& pool;
+};
+
+struct thread_pool::impl
+{
+   impl( size_t num_threads )
+    :
+    num_threads( num_threads ),
+    num_running( 0 ),
+    is_started( false ),
+    is_stopping( false )
+   {
+      if( !num_threads )
+         throw runtime_error( "thread pool requires at least one thread" );
+   }
+
+   size_t num_threads;
+   size_t num_running;
+
+   bool is_started;
+   bool is_stopping;
+
+   mutable mutex pool_mutex;
+
+   condition job_condition;
+   condition idle_condition;
+
+   deque< thread_pool_job* > jobs;
+
+   vector< thread_pool_worker* > workers;
+};
+
+void thread_pool_worker::on_start( )
+{
+   pool.on_thread_start( );
+
+   thread_pool::impl& pi( *pool.p_impl );
+
+   while( true )
+   {
+      auto_ptr< thread_pool_job > ap_job;
+
+      // NOTE: Scope for guard object.
+      {
+         guard g( pi.pool_mutex );
+
+         while( pi.jobs.empty( ) && !pi.is_stopping )
+            pi.job_condition.wait( pi.pool_mutex );
+
+         if( pi.jobs.empty( ) )
+            break;
+
+         ap_job.reset( pi.jobs.front( ) );
+         pi.jobs.pop_front( );
+
+         ++pi.num_running;
+      }
+
+      try
+      {
+         ap_job->run( );
+      }
+      catch( ... )
+      {
+      }
+
+      ap_job.reset( );
+
+      guard g( pi.pool_mutex );
+
+      if( !--pi.num_running && pi.jobs.empty( ) )
+         pi.idle_condition.notify_all( );
+   }
+
+   pool.on_thread_finish( );
+}
+
+thread_pool::thread_pool( size_t num_threads )
+{
+   p_impl = new impl( num_threads );
+}
+
+thread_pool::~thread_pool( )
+{
+   stop( );
+
+   for( size_t i = 0; i < p_impl->jobs.size( ); i++ )
+      delete p_impl->jobs[ i ];
+
+   delete p_impl;
+}
+
+size_t thread_pool::get_num_threads( ) const
+{
+   return p_impl->num_threads;
+}
+
+void thread_pool::start( )
+{
+   guard g( p_impl->pool_mutex );
+
+   if( p_impl->is_started )
+      return;
+
+   p_impl->is_started = true;
+   p_impl->is_stopping = false;
+
+   for( size_t i = 0; i < p_impl->num_threads; i++ )
+   {
+      auto_ptr< thread_pool_worker > ap_worker( new thread_pool_worker( *this ) );
+
+      p_impl->workers.push_back( ap_worker.get( ) );
+      ap_worker.release( )->start( true );
+   }
+}
+
+void thread_pool::stop( )
+{
+   vector< thread_pool_worker* > workers;
+
+   // NOTE: Scope for guard object.
+   {
+      guard g( p_impl->pool_mutex );
+
+      if( !p_impl->is_started )
+         return;
+
+      p_impl->is_stopping = true;
+      p_impl->job_condition.notify_all( );
+
+      workers.swap( p_impl->workers );
+   }
+
+   for( size_t i = 0; i < workers.size( ); i++ )
+   {
+      workers[ i ]->join( );
+      delete workers[ i ];
+   }
+
+   guard g( p_impl->pool_mutex );
+
+   p_impl->is_started = false;
+}
+
+void thread_pool::queue_job( thread_pool_job* p_job )
+{
+   auto_ptr< thread_pool_job > ap_job( p_job );
+
+   guard g( p_impl->pool_mutex );
+
+   if( !p_impl->is_started || p_impl->is_stopping )
+      throw runtime_error( "thread pool is not running" );
+
+   p_impl->jobs.push_back( ap_job.get( ) );
+   ap_job.release( );
+
+   p_impl->job_condition.notify_one( );
+}
+
+size_t thread_pool::get_num_pending( ) const
+{
+   guard g( p_impl->pool_mutex );
+
+   return p_impl->jobs.size( ) + p_impl->num_running;
+}
+
+void thread_pool::wait_until_idle( )
+{
+   guard g( p_impl->pool_mutex );
+
+   while( !p_impl->jobs.empty( ) || p_impl->num_running )
+      p_impl->idle_condition.wait( p_impl->pool_mutex );
+}
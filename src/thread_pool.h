@@ -0,0 +1,63 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef THREAD_POOL_H
+#  define THREAD_POOL_H
+
+#  ifndef HAS_PRECOMPILED_STD_HEADERS
+#     include <cstddef>
+#  endif
+
+class thread_pool_job
+{
+   public:
+   virtual ~thread_pool_job( ) { }
+
+   virtual void run( ) = 0;
+};
+
+// NOTE: A fixed number of joinable worker threads that will run queued jobs (in the order that
+// they were queued). A job is deleted by the pool after it has been run and any exception that
+// is thrown by a job is ignored (so jobs need to record their own errors). A job may run for as
+// long as it likes (such as a service loop) but it then needs its own means of being told that
+// it should finish before "stop" is called.
+//
+// The "stop" function (which is also called by the destructor) will wait for all queued jobs to
+// be run and then joins every worker thread so no worker will still be touching the pool (or
+// anything that its owner has given to its jobs) after "stop" has returned. Derived classes can
+// override "on_thread_start" and "on_thread_finish" for any per thread initialisation/clean up
+// (but if they do so then must call "stop" from their own destructor).
+class thread_pool
+{
+   public:
+   thread_pool( size_t num_threads );
+   virtual ~thread_pool( );
+
+   size_t get_num_threads( ) const;
+
+   void start( );
+   void stop( );
+
+   void queue_job( thread_pool_job* p_job );
+
+   size_t get_num_pending( ) const;
+
+   void wait_until_idle( );
+
+   protected:
+   virtual void on_thread_start( ) { }
+   virtual void on_thread_finish( ) { }
+
+   private:
+   struct impl;
+   impl* p_impl;
+
+   friend class thread_pool_worker;
+
+   thread_pool( const thread_pool& );
+   thread_pool& operator =( const thread_pool& );
+};
+
+#endif
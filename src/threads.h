@@ -13,6 +13,7 @@
 #  endif
 
 #  ifndef _WIN32
+#     include <time.h>
 #     include <pthread.h>
 #  else
 #     define NOMINMAX
@@ -70,9 +71,12 @@ inline thread_id current_thread_id( )
 }
 
 class guard;
+class condition;
 
 class mutex
 {
+   friend class condition;
+
    public:
 #  ifdef _WIN32
    mutex( )
@@ -177,23 +181,147 @@ class guard
    std::string msg;
 };
 
+// NOTE: A condition must only be waited upon or notified whilst its associated mutex is held
+// (via a guard) and the mutex will be held again when "wait" returns (if a timeout was given
+// then the return value will be false if the wait timed out).
+//
+// As the mutex is recursive it should be noted that if it is being held more than once by the
+// waiting thread (e.g. via nested guards) then "wait" will still fully release the underlying
+// mutex (with the recursion count being restored when it returns) so any outer guarded scope
+// must not assume that the state it protects is unchanged after an inner scope has waited.
+class condition
+{
+   public:
+#  ifdef _WIN32
+   condition( )
+   {
+      ::InitializeConditionVariable( &cv );
+   }
+#  else
+   condition( )
+   {
+      ::pthread_cond_init( &ptc, 0 );
+   }
+
+   ~condition( )
+   {
+      ::pthread_cond_destroy( &ptc );
+   }
+#  endif
+
+   bool wait( mutex& m, unsigned long timeout_msecs = 0 )
+   {
+      bool okay = true;
+
+#  ifndef _WIN32
+      int count = m.count;
+
+      m.tid = 0;
+      m.lock_id = 0;
+
+      if( !timeout_msecs )
+         ::pthread_cond_wait( &ptc, &m.ptm );
+      else
+      {
+         struct timespec ts;
+         ::clock_gettime( CLOCK_REALTIME, &ts );
+
+         ts.tv_sec += timeout_msecs / 1000;
+         ts.tv_nsec += ( timeout_msecs % 1000 ) * 1000000;
+
+         if( ts.tv_nsec >= 1000000000 )
+         {
+            ++ts.tv_sec;
+            ts.tv_nsec -= 1000000000;
+         }
+
+         if( ::pthread_cond_timedwait( &ptc, &m.ptm, &ts ) != 0 )
+            okay = false;
+      }
+
+      m.count = count;
+      m.tid = ::pthread_self( );
+#  else
+      m.lock_id = 0;
+
+      if( !::SleepConditionVariableCS( &cv, &m.cs, timeout_msecs ? timeout_msecs : INFINITE ) )
+         okay = false;
+#  endif
+      m.lock_id = current_thread_id( );
+
+      return okay;
+   }
+
+   void notify_one( )
+   {
+#  ifndef _WIN32
+      ::pthread_cond_signal( &ptc );
+#  else
+      ::WakeConditionVariable( &cv );
+#  endif
+   }
+
+   void notify_all( )
+   {
+#  ifndef _WIN32
+      ::pthread_cond_broadcast( &ptc );
+#  else
+      ::WakeAllConditionVariable( &cv );
+#  endif
+   }
+
+   private:
+#  ifdef _WIN32
+   CONDITION_VARIABLE cv;
+#  else
+   pthread_cond_t ptc;
+#  endif
+
+   condition( const condition& );
+   condition& operator =( const condition& );
+};
+
 #  ifdef _WIN32
 unsigned long __stdcall threadfunc( void* pv );
 #  else
 void* threadfunc( void* p );
 #  endif
 
+// NOTE: By default a thread is detached (and so will typically "delete this" at the end of its
+// "on_start") but if started as joinable then it must not delete itself and instead the owner
+// needs to call "join" (which waits for "on_start" to return) before deleting the thread.
 struct thread
 {
-   void start( )
+   virtual ~thread( ) { }
+
+   void start( bool joinable = false )
    {
 #ifdef _WIN32
-      ::CreateThread( 0, 0, threadfunc, this, 0, &tid );
+      handle = ::CreateThread( 0, 0, threadfunc, this, 0, &tid );
+
+      if( !joinable )
+      {
+         ::CloseHandle( handle );
+         handle = 0;
+      }
 #else
       pthread_attr_t tattr;
       ::pthread_attr_init( &tattr );
-      ::pthread_attr_setdetachstate( &tattr, PTHREAD_CREATE_DETACHED );
+      ::pthread_attr_setdetachstate( &tattr, joinable ? PTHREAD_CREATE_JOINABLE : PTHREAD_CREATE_DETACHED );
       ::pthread_create( &tid, &tattr, threadfunc, ( void* )this );
+      ::pthread_attr_destroy( &tattr );
+#endif
+   }
+
+   void join( )
+   {
+#ifdef _WIN32
+      ::WaitForSingleObject( handle, INFINITE );
+      ::CloseHandle( handle );
+
+      handle = 0;
+#else
+      ::pthread_join( tid, 0 );
 #endif
    }
 
@@ -201,6 +329,7 @@ struct thread
 
 #  ifdef _WIN32
    DWORD tid;
+   HANDLE handle;
 #  else
    pthread_t tid;
 #  endif
@@ -0,0 +1,232 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef TIMER_WHEEL_H
+#  define TIMER_WHEEL_H
+
+#  ifndef HAS_PRECOMPILED_STD_HEADERS
+#     include <vector>
+#     include <algorithm>
+#  endif
+
+#  include "ptypes.h"
+
+const size_t c_timer_wheel_levels = 4;
+const size_t c_timer_wheel_slot_bits = 6;
+const size_t c_timer_wheel_slots = 1 << c_timer_wheel_slot_bits;
+
+const uint64_t c_timer_wheel_slot_mask = c_timer_wheel_slots - 1;
+
+// NOTE: Timers (identified by a "T" and due at a tick which is typically a second) are held in a
+// hierarchy of wheels with the lowest level slots each being a single tick and each slot in a higher
+// level spanning all the slots of the level that is below it (with timers further ahead than the top
+// level can hold being held separately). A timer will be found in a level only if its due tick shares
+// all of the digits above this level with the current tick (its digit for the level being greater than
+// the current one) so whenever a level's digit wraps around the timers in the next slot of the level
+// above are moved down (which means both adding a timer and advancing a tick are performed in constant
+// time) and the earliest due timer can be found in the first non-empty slot of the lowest non-empty
+// level. Any timer added with a due tick that is not after the current one will be expired by the next
+// call to "advance" and the same id can be added more than once (with each being expired separately).
+// The class is not thread safe (so any locking needs to be performed by its owner).
+template< typename T > class timer_wheel
+{
+   public:
+   timer_wheel( uint64_t now = 0 ) : current( now ), num_timers( 0 ) { }
+
+   void clear( uint64_t now );
+
+   void add( const T& id, uint64_t due );
+
+   void advance( uint64_t now, std::vector< T >& expired );
+
+   bool empty( ) const { return num_timers == 0; }
+
+   size_t size( ) const { return num_timers; }
+
+   uint64_t get_current( ) const { return current; }
+
+   uint64_t next_due( ) const;
+
+   private:
+   struct timer
+   {
+      timer( const T& id, uint64_t due ) : id( id ), due( due ) { }
+
+      T id;
+      uint64_t due;
+   };
+
+   void insert( const timer& t );
+   void cascade( size_t level );
+
+   uint64_t current;
+
+   size_t num_timers;
+
+   std::vector< T > ready;
+   std::vector< timer > overflow;
+
+   std::vector< timer > slots[ c_timer_wheel_levels ][ c_timer_wheel_slots ];
+};
+
+template< typename T > void timer_wheel< T >::clear( uint64_t now )
+{
+   current = now;
+   num_timers = 0;
+
+   ready.clear( );
+   overflow.clear( );
+
+   for( size_t i = 0; i < c_timer_wheel_levels; i++ )
+   {
+      for( size_t j = 0; j < c_timer_wheel_slots; j++ )
+         slots[ i ][ j ].clear( );
+   }
+}
+
+template< typename T > void timer_wheel< T >::add( const T& id, uint64_t due )
+{
+   ++num_timers;
+
+   if( due <= current )
+      ready.push_back( id );
+   else
+      insert( timer( id, due ) );
+}
+
+template< typename T > void timer_wheel< T >::advance( uint64_t now, std::vector< T >& expired )
+{
+   if( !ready.empty( ) )
+   {
+      num_timers -= ready.size( );
+
+      expired.insert( expired.end( ), ready.begin( ), ready.end( ) );
+      ready.clear( );
+   }
+
+   // NOTE: If a large number of ticks need to be advanced (which would only be expected if the
+   // clock had been changed) then it is quicker to just re-insert all the timers.
+   if( num_timers && now > current + c_timer_wheel_slots * c_timer_wheel_slots )
+   {
+      std::vector< timer > timers;
+      timers.swap( overflow );
+
+      for( size_t i = 0; i < c_timer_wheel_levels; i++ )
+      {
+         for( size_t j = 0; j < c_timer_wheel_slots; j++ )
+         {
+            timers.insert( timers.end( ), slots[ i ][ j ].begin( ), slots[ i ][ j ].end( ) );
+            slots[ i ][ j ].clear( );
+         }
+      }
+
+      current = now;
+
+      for( size_t i = 0; i < timers.size( ); i++ )
+      {
+         if( timers[ i ].due <= current )
+         {
+            --num_timers;
+            expired.push_back( timers[ i ].id );
+         }
+         else
+            insert( timers[ i ] );
+      }
+   }
+
+   while( num_timers && current < now )
+   {
+      ++current;
+
+      if( ( current & c_timer_wheel_slot_mask ) == 0 )
+         cascade( 1 );
+
+      std::vector< timer >& slot( slots[ 0 ][ current & c_timer_wheel_slot_mask ] );
+
+      for( size_t i = 0; i < slot.size( ); i++ )
+         expired.push_back( slot[ i ].id );
+
+      num_timers -= slot.size( );
+      slot.clear( );
+   }
+
+   if( current < now )
+      current = now;
+}
+
+template< typename T > uint64_t timer_wheel< T >::next_due( ) const
+{
+   if( !ready.empty( ) )
+      return current;
+
+   for( size_t i = 0; i < c_timer_wheel_levels; i++ )
+   {
+      size_t digit = ( current >> ( c_timer_wheel_slot_bits * i ) ) & c_timer_wheel_slot_mask;
+
+      for( size_t j = digit + 1; j < c_timer_wheel_slots; j++ )
+      {
+         const std::vector< timer >& slot( slots[ i ][ j ] );
+
+         if( !slot.empty( ) )
+         {
+            uint64_t due = slot[ 0 ].due;
+
+            for( size_t k = 1; k < slot.size( ); k++ )
+               due = std::min( due, slot[ k ].due );
+
+            return due;
+         }
+      }
+   }
+
+   uint64_t due = overflow.empty( ) ? current : overflow[ 0 ].due;
+
+   for( size_t i = 1; i < overflow.size( ); i++ )
+      due = std::min( due, overflow[ i ].due );
+
+   return due;
+}
+
+template< typename T > void timer_wheel< T >::insert( const timer& t )
+{
+   for( size_t i = 0; i < c_timer_wheel_levels; i++ )
+   {
+      size_t shift = c_timer_wheel_slot_bits * ( i + 1 );
+
+      if( ( t.due >> shift ) == ( current >> shift ) )
+      {
+         slots[ i ][ ( t.due >> ( c_timer_wheel_slot_bits * i ) ) & c_timer_wheel_slot_mask ].push_back( t );
+         return;
+      }
+   }
+
+   overflow.push_back( t );
+}
+
+template< typename T > void timer_wheel< T >::cascade( size_t level )
+{
+   std::vector< timer > timers;
+
+   if( level == c_timer_wheel_levels )
+      timers.swap( overflow );
+   else
+   {
+      size_t digit = ( current >> ( c_timer_wheel_slot_bits * level ) ) & c_timer_wheel_slot_mask;
+
+      // NOTE: If this level has also wrapped around then the level above it needs to be
+      // moved down first (as some of its timers could belong in the slot being emptied).
+      if( digit == 0 )
+         cascade( level + 1 );
+
+      timers.swap( slots[ level ][ digit ] );
+   }
+
+   // NOTE: Any timer that is due at the current tick will be put into the current lowest
+   // level slot (which is expired immediately after cascading).
+   for( size_t i = 0; i < timers.size( ); i++ )
+      insert( timers[ i ] );
+}
+
+#endif
@@ -13,8 +13,10 @@
 #  include <cstring>
 #  include <cstdlib>
 #  include <string>
+#  include <vector>
 #  include <fstream>
 #  include <iostream>
+#  include <algorithm>
 #endif
 
 #include "fcgiapp.h"
@@ -29,9 +31,11 @@
 #endif
 
 #include "config.h"
+#include "sha256.h"
 #include "threads.h"
 #include "date_time.h"
 #include "utilities.h"
+#include "ciyam_constants.h"
 
 #ifdef _WIN32
 #  define USE_MOD_FASTCGI_KLUDGE
@@ -53,6 +57,99 @@ const char* const c_kill_script = "upload.kill.bat";
 
 string g_exe_path;
 
+// NOTE: Copies multipart content up until (but not including) the boundary marker to an output
+// stream without needing to read it line by line (so binary content without any line breaks is
+// handled efficiently). As the marker might span two reads the last "marker size - 1" bytes are
+// held back until more content has been read. The content can also be hashed as it is written.
+class multipart_content_copier
+{
+   public:
+   multipart_content_copier( const string& marker )
+    :
+    matcher( marker ),
+    marker_size( marker.size( ) ),
+    buffer( c_chunk_size + marker.size( ) ),
+    p_hash( 0 ),
+    num_read( 0 ),
+    num_written( 0 )
+   {
+   }
+
+   void set_hash( sha256* p_sha256 ) { p_hash = p_sha256; }
+
+   bool copy( FCGX_Stream* p_in, ostream* p_outs, size_t max_size );
+
+   size_t get_num_read( ) const { return num_read; }
+   size_t get_num_written( ) const { return num_written; }
+
+   private:
+   void output( ostream* p_outs, size_t length );
+
+   boyer_moore matcher;
+   size_t marker_size;
+
+   vector< char > buffer;
+
+   sha256* p_hash;
+
+   size_t num_read;
+   size_t num_written;
+};
+
+bool multipart_content_copier::copy( FCGX_Stream* p_in, ostream* p_outs, size_t max_size )
+{
+   size_t held = 0;
+
+   while( true )
+   {
+      int len = FCGX_GetStr( &buffer[ held ], c_chunk_size, p_in );
+
+      if( len <= 0 )
+         return false;
+
+      num_read += len;
+
+      size_t available = held + len;
+
+      string::size_type pos = matcher.find( &buffer[ 0 ], available );
+
+      if( pos != string::npos )
+      {
+         output( p_outs, pos );
+
+         // NOTE: Any remaining input (i.e. the final boundary) is read so the request is completed.
+         while( ( len = FCGX_GetStr( &buffer[ 0 ], c_chunk_size, p_in ) ) > 0 )
+            num_read += len;
+
+         return true;
+      }
+
+      held = min( available, marker_size - 1 );
+
+      output( p_outs, available - held );
+
+      if( held )
+         memmove( &buffer[ 0 ], &buffer[ available - held ], held );
+
+      if( max_size && num_written > max_size )
+         return false;
+   }
+}
+
+void multipart_content_copier::output( ostream* p_outs, size_t length )
+{
+   if( length )
+   {
+      if( p_outs )
+         p_outs->write( &buffer[ 0 ], length );
+
+      if( p_hash )
+         p_hash->update( ( const unsigned char* )&buffer[ 0 ], length );
+
+      num_written += length;
+   }
+}
+
 class pid_handler : public thread
 {
    public:
@@ -166,8 +263,6 @@ void request_handler::process_request( )
 
    string name, file_name;
    char buf[ c_chunk_size ];
-   char buf2[ c_chunk_size ];
-   char dbuf[ c_chunk_size * 2 ];
 
    string disposition, file_source;
    if( FCGX_GetLine( buf, c_chunk_size, p_in ) )
@@ -276,8 +371,6 @@ void request_handler::process_request( )
       string line_break( buf );
       size += line_break.size( );
 
-      size_t len2( 0 );
-
       ofstream outf;
       if( !ext.empty( ) )
          outf.open( file_name.c_str( ), ios::out | ios::binary );
@@ -293,48 +386,33 @@ void request_handler::process_request( )
       }
 #endif
 
-      size_t written = 0;
-      bool max_size_exceeded = false;
-      while( true )
-      {
-         int len = FCGX_GetStr( buf, c_chunk_size, p_in );
+      // NOTE: The hash is of the content prefixed by the blob file type (so it is identical to the
+      // hash that "create_raw_file" would determine for the uncompressed content) so that it can be
+      // passed as its "p_hash" argument without the file needing to be read again for hashing.
+      sha256 hash;
+      hash.update( string( 1, c_file_type_char_blob ) );
 
-         if( len < c_chunk_size )
-         {
-            if( len > 0 )
-            {
-               if( len2 )
-                  memcpy( dbuf, buf2, len2 );
-               memcpy( dbuf + len2, buf, len );
-            }
+      multipart_content_copier copier( marker );
 
-            string last( dbuf, len2 + len );
-            pos = last.find( marker );
-            if( pos == string::npos )
-               FCGX_FPrintF( p_out, "<p>*** unexpected end-of-file marker not found ***</p>" );
-            else
-            {
-               outf.write( dbuf, pos );
-               written += pos;
-            }
+      if( !session_id.empty( ) )
+         copier.set_hash( &hash );
 
-            size += len;
-            break;
-         }
+      date_time dtm( date_time::standard( ) );
 
-         if( len2 > 0 )
-         {
-            outf.write( buf2, len2 );
-            written += len2;
-         }
+      if( !copier.copy( p_in, outf ? &outf : 0, max_size ) && !( max_size && copier.get_num_written( ) > max_size ) )
+         FCGX_FPrintF( p_out, "<p>*** unexpected end-of-file marker not found ***</p>" );
 
-         memcpy( buf2, buf, len );
-         len2 = len;
+      seconds elapsed( date_time::standard( ) - dtm );
 
-         size += len;
-         if( max_size && written > max_size )
-            break;
-      }
+      outf.close( );
+
+      size += copier.get_num_read( );
+
+      size_t written = copier.get_num_written( );
+      bool max_size_exceeded = false;
+
+      if( elapsed > 0 )
+         FCGX_FPrintF( p_out, "<p>Upload rate was: %.2f MB/s</p>", ( copier.get_num_read( ) / elapsed ) / ( 1024.0 * 1024.0 ) );
 
       if( max_size && written > max_size )
       {
@@ -349,11 +427,12 @@ void request_handler::process_request( )
          file_info = path + sub_path;
          file_info += "/" + session_id;
 
+         // NOTE: If the file was written then its hash and size follow its name (on a separate line).
          ofstream outf( file_info.c_str( ) );
          if( max_size_exceeded )
             outf << ">" << max_size << endl;
          else if( !ext.empty( ) )
-            outf << file_name;
+            outf << file_name << '\n' << hash.get_digest_as_string( ) << ' ' << written << '\n';
       }
    }
 
@@ -225,6 +225,30 @@ void msleep( unsigned long amt )
 void msleep( unsigned long amt ) { ::Sleep( amt ); }
 #endif
 
+unsigned long get_msecs( )
+{
+#ifndef _WIN32
+   timeval tv;
+   ::gettimeofday( &tv, 0 );
+
+   return ( tv.tv_sec * 1000 ) + ( tv.tv_usec / 1000 );
+#else
+   return ::GetTickCount( );
+#endif
+}
+
+unsigned long get_usecs( )
+{
+#ifndef _WIN32
+   timeval tv;
+   ::gettimeofday( &tv, 0 );
+
+   return ( tv.tv_sec * 1000000 ) + tv.tv_usec;
+#else
+   return ::GetTickCount( ) * 1000;
+#endif
+}
+
 int get_pid( )
 {
 #ifndef _WIN32
@@ -744,7 +768,7 @@ string valid_file_name( const string& str, bool* p_has_utf8_chars )
    return s;
 }
 
-// NOTE: This Boyer-Moore implementation was taken from that published by Eduard Igushev.
+// NOTE: This Boyer-Moore implementation was originally based on that published by Eduard Igushev.
 boyer_moore::boyer_moore( const string& pattern )
  :
  pattern( pattern ),
@@ -757,57 +781,60 @@ boyer_moore::boyer_moore( const string& pattern )
    int psize = ( int )( pattern.size( ) );
 
    for( int i = 0; i < psize; ++i )
-      slide[ pattern[ i ] ] = psize - i - 1;
+      slide[ ( unsigned char )pattern[ i ] ] = psize - i - 1;
 
-   for( int i = 0; i < psize; ++i )
-      jump[ i ] = 2 * psize - i - 1;
-
-   vector< int > matches( pattern.size( ) );
+   // NOTE: The "good suffix" table is constructed using the longest pattern prefix that is also
+   // a suffix (for when a matched suffix does not reoccur) along with any reoccurring suffixes.
+   int last_prefix = psize;
 
-   int curr = psize - 1;
-   int match = curr + 1;
-   while( curr >= 0 )
+   for( int i = psize - 1; i >= 0; --i )
    {
-      while( match < psize && pattern[ curr ] != pattern[ match ] )
-      {
-         jump[ match ] = min( jump[ match ], psize - curr - 1 );
-         match = matches[ match ];
-      }
+      if( pattern.compare( i + 1, string::npos, pattern, 0, psize - i - 1 ) == 0 )
+         last_prefix = i + 1;
 
-      matches[ curr ] = match;
-      --curr;
-      --match;
+      jump[ i ] = last_prefix + ( psize - 1 - i );
    }
 
-   int curr_match = matches[ 0 ];
-   for( int i = 0; i < psize; ++i )
+   for( int i = 0; i < psize - 1; ++i )
    {
-      jump[ i ] = min( jump[ i ], psize + curr_match - i - 1 );
+      int suffix_length = 0;
+
+      while( suffix_length < i && pattern[ i - suffix_length ] == pattern[ psize - 1 - suffix_length ] )
+         ++suffix_length;
 
-      if( curr_match == i )
-         curr_match = matches[ curr_match ];
+      if( pattern[ i - suffix_length ] != pattern[ psize - 1 - suffix_length ] )
+         jump[ psize - 1 - suffix_length ] = psize - 1 - i + suffix_length;
    }
 }
 
 string::size_type boyer_moore::find( const string& text )
 {
-   if( text.empty( ) || pattern.empty( ) || text.size( ) < pattern.size( ) )
+   return find( text.data( ), text.size( ), 0 );
+}
+
+string::size_type boyer_moore::find( const char* p_text, size_t length, size_t offset )
+{
+   if( !length || pattern.empty( ) || offset + pattern.size( ) > length )
       return string::npos;
- 
-   int text_i = pattern.size( ) - 1;
-   while( text_i < ( int )( text.size( ) ) )
+
+   int psize = ( int )( pattern.size( ) );
+
+   // NOTE: The "bad character" shift is determined by the text character that failed to match
+   // (rather than the pattern one which would never permit more than the "good suffix" shift).
+   int text_i = ( int )offset + psize - 1;
+   while( text_i < ( int )length )
    {
-      int pattern_i = ( int )( pattern.size( ) - 1 );
-      while( pattern_i >= 0 && text[ text_i ] == pattern[ pattern_i ] )
+      int pattern_i = psize - 1;
+      while( pattern_i >= 0 && p_text[ text_i ] == pattern[ pattern_i ] )
       {
          --text_i;
          --pattern_i;
       }
- 
+
       if( pattern_i < 0 )
          return text_i + 1;
- 
-      text_i += max( slide[ pattern[ pattern_i ] ], jump[ pattern_i ] );
+
+      text_i += max( slide[ ( unsigned char )p_text[ text_i ] ], jump[ pattern_i ] );
    }
 
    return string::npos;
@@ -262,6 +262,11 @@ class uuid
 
 void msleep( unsigned long amt );
 
+// NOTE: Elapsed time counters (from an arbitrary starting point) that are intended for measuring
+// short intervals (under Windows "get_usecs" only has the resolution of "get_msecs").
+unsigned long get_msecs( );
+unsigned long get_usecs( );
+
 int get_pid( );
 
 int vmem_used( );
@@ -458,6 +463,87 @@ template< typename T > inline std::string unsigned_to_string( T val )
    return &buf[ pos ];
 }
 
+// NOTE: The following parse decimal integers directly from the string's buffer (rather than via
+// an istringstream) so they are locale independent and do not allocate. To be consistent with a
+// stream extraction leading whitespace and a sign are skipped, parsing stops at the first non-digit
+// (with zero returned if no digits were found) and a value that is out of range is clamped.
+inline const char* skip_leading_whitespace( const char* p )
+{
+   while( *p == ' ' || ( *p >= '\t' && *p <= '\r' ) )
+      ++p;
+
+   return p;
+}
+
+template< typename T > inline T signed_from_string( const std::string& s )
+{
+   const char* p = skip_leading_whitespace( s.c_str( ) );
+
+   bool is_neg = ( *p == '-' );
+
+   if( is_neg || *p == '+' )
+      ++p;
+
+   const T min_val = std::numeric_limits< T >::min( );
+   const T min_div = min_val / 10;
+   const int min_rem = -( int )( min_val % 10 );
+
+   // NOTE: The value is accumulated as a negative so that the minimum value can be parsed.
+   T val = 0;
+
+   for( ; *p >= '0' && *p <= '9'; ++p )
+   {
+      int digit = *p - '0';
+
+      if( val < min_div || ( val == min_div && digit > min_rem ) )
+         return is_neg ? min_val : std::numeric_limits< T >::max( );
+
+      val = ( T )( val * 10 - digit );
+   }
+
+   if( !is_neg )
+   {
+      if( val == min_val )
+         return std::numeric_limits< T >::max( );
+
+      val = -val;
+   }
+
+   return val;
+}
+
+template< typename T > inline T unsigned_from_string( const std::string& s )
+{
+   const char* p = skip_leading_whitespace( s.c_str( ) );
+
+   bool is_neg = ( *p == '-' );
+
+   if( is_neg || *p == '+' )
+      ++p;
+
+   const T max_val = std::numeric_limits< T >::max( );
+   const T max_div = max_val / 10;
+   const int max_rem = ( int )( max_val % 10 );
+
+   T val = 0;
+
+   for( ; *p >= '0' && *p <= '9'; ++p )
+   {
+      int digit = *p - '0';
+
+      if( val > max_div || ( val == max_div && digit > max_rem ) )
+         return max_val;
+
+      val = ( T )( val * 10 + digit );
+   }
+
+   // NOTE: As with "strtoul" a negative value is wrapped around.
+   if( is_neg )
+      val = ( T )( 0 - val );
+
+   return val;
+}
+
 template< typename T > struct string_converter
 {
    std::string operator ( )( const T& t ) const;
@@ -476,6 +562,11 @@ template< typename T > inline std::string string_converter< T >::operator ( )( c
 #     pragma option pop
 #  endif
 
+template< > inline std::string string_converter< bool >::operator ( )( const bool& v ) const
+{
+   return std::string( 1, v ? '1' : '0' );
+}
+
 template< > inline std::string string_converter< char >::operator ( )( const char& v ) const
 {
    return std::string( 1, v );
@@ -570,6 +661,50 @@ template< > inline std::string from_string( const std::string& s )
 {
    return s;
 }
+
+template< > inline short from_string( const std::string& s )
+{
+   return signed_from_string< short >( s );
+}
+
+template< > inline int from_string( const std::string& s )
+{
+   return signed_from_string< int >( s );
+}
+
+template< > inline long from_string( const std::string& s )
+{
+   return signed_from_string< long >( s );
+}
+
+#     ifndef _LP64
+template< > inline int64_t from_string( const std::string& s )
+{
+   return signed_from_string< int64_t >( s );
+}
+#     endif
+
+template< > inline unsigned short from_string( const std::string& s )
+{
+   return unsigned_from_string< unsigned short >( s );
+}
+
+template< > inline unsigned from_string( const std::string& s )
+{
+   return unsigned_from_string< unsigned >( s );
+}
+
+template< > inline unsigned long from_string( const std::string& s )
+{
+   return unsigned_from_string< unsigned long >( s );
+}
+
+#     ifndef _LP64
+template< > inline uint64_t from_string( const std::string& s )
+{
+   return unsigned_from_string< uint64_t >( s );
+}
+#     endif
 #  else
 inline void from_string_impl( std::string& t, const std::string& s )
 {
@@ -603,6 +738,9 @@ class boyer_moore
    boyer_moore( const std::string& pattern );
 
    std::string::size_type find( const std::string& text );
+   std::string::size_type find( const char* p_text, size_t length, size_t offset = 0 );
+
+   size_t pattern_length( ) const { return pattern.size( ); }
 
    private:
    std::string pattern;
@@ -0,0 +1,323 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef PRECOMPILE_H
+#  include "precompile.h"
+#endif
+#pragma hdrstop
+
+#ifndef HAS_PRECOMPILED_STD_HEADERS
+#  include <map>
+#  include <iostream>
+#  include <algorithm>
+#  include <stdexcept>
+#endif
+
+#include "variable_store.h"
+
+#include "threads.h"
+#include "utilities.h"
+
+using namespace std;
+
+namespace
+{
+
+struct shard
+{
+   shard( ) : num_waiters( 0 ) { }
+
+   mutex lock;
+   condition changed;
+
+   size_t num_waiters;
+
+   map< string, string > values;
+};
+
+inline const string& name_of( const string& name ) { return name; }
+inline const string& name_of( const pair< string, string >& name_and_value ) { return name_and_value.first; }
+
+// NOTE: Must be called with the shard's lock held.
+void set_value( shard& s, const string& name, const string& value )
+{
+   if( !value.empty( ) )
+      s.values[ name ] = value;
+   else
+      s.values.erase( name );
+
+   if( s.num_waiters )
+      s.changed.notify_all( );
+}
+
+// NOTE: Must be called with the shard's lock held.
+bool set_value_if( shard& s, const string& name, const string& value, const string& current )
+{
+   map< string, string >::iterator i = s.values.find( name );
+
+   if( i == s.values.end( ) ? !current.empty( ) : current != i->second )
+      return false;
+
+   set_value( s, name, value );
+
+   return true;
+}
+
+}
+
+struct variable_store::impl
+{
+   impl( size_t num_shards )
+   {
+      if( !num_shards )
+         throw runtime_error( "variable store requires at least one shard" );
+
+      for( size_t i = 0; i < num_shards; i++ )
+         shards.push_back( new shard );
+   }
+
+   ~impl( )
+   {
+      for( size_t i = 0; i < shards.size( ); i++ )
+         delete shards[ i ];
+   }
+
+   size_t get_shard_num( const string& name ) const
+   {
+      // NOTE: Uses the FNV-1a hash of the variable name to determine its shard.
+      uint32_t hash = 2166136261u;
+
+      for( size_t i = 0; i < name.size( ); i++ )
+      {
+         hash ^= ( unsigned char )name[ i ];
+         hash *= 16777619u;
+      }
+
+      return hash % shards.size( );
+   }
+
+   shard& get_shard( const string& name ) const { return *shards[ get_shard_num( name ) ]; }
+
+   // NOTE: Returns the item indexes (for the supplied names) ordered by their shard numbers.
+   template< typename T > void get_shard_order(
+    const vector< T >& items, vector< pair< size_t, size_t > >& order ) const
+   {
+      order.reserve( items.size( ) );
+
+      for( size_t i = 0; i < items.size( ); i++ )
+         order.push_back( make_pair( get_shard_num( name_of( items[ i ] ) ), i ) );
+
+      sort( order.begin( ), order.end( ) );
+   }
+
+   vector< shard* > shards;
+};
+
+namespace
+{
+
+// NOTE: Locks all shards (in order) so that a consistent snapshot of the variables can be taken.
+class all_shards_guard
+{
+   public:
+   all_shards_guard( const vector< shard* >& shards )
+    :
+    shards( shards )
+   {
+      for( size_t i = 0; i < shards.size( ); i++ )
+         shards[ i ]->lock.acquire( 0, 0 );
+   }
+
+   ~all_shards_guard( )
+   {
+      for( size_t i = shards.size( ); i > 0; i-- )
+         shards[ i - 1 ]->lock.release( 0, 0 );
+   }
+
+   private:
+   const vector< shard* >& shards;
+};
+
+}
+
+variable_store::variable_store( size_t num_shards )
+{
+   p_impl = new impl( num_shards );
+}
+
+variable_store::~variable_store( )
+{
+   delete p_impl;
+}
+
+size_t variable_store::size( ) const
+{
+   all_shards_guard g( p_impl->shards );
+
+   size_t total = 0;
+
+   for( size_t i = 0; i < p_impl->shards.size( ); i++ )
+      total += p_impl->shards[ i ]->values.size( );
+
+   return total;
+}
+
+bool variable_store::has( const string& name ) const
+{
+   shard& s( p_impl->get_shard( name ) );
+   guard g( s.lock );
+
+   return s.values.count( name );
+}
+
+string variable_store::get( const string& name ) const
+{
+   shard& s( p_impl->get_shard( name ) );
+   guard g( s.lock );
+
+   map< string, string >::const_iterator ci = s.values.find( name );
+
+   return ci == s.values.end( ) ? string( ) : ci->second;
+}
+
+void variable_store::get( const vector< string >& names, vector< string >& values ) const
+{
+   vector< pair< size_t, size_t > > order;
+   p_impl->get_shard_order( names, order );
+
+   // NOTE: The existing values are assigned to (rather than cleared) so their memory is reused.
+   values.resize( names.size( ) );
+
+   for( size_t i = 0; i < order.size( ); )
+   {
+      shard& s( *p_impl->shards[ order[ i ].first ] );
+      guard g( s.lock );
+
+      for( size_t shard_num = order[ i ].first; i < order.size( ) && order[ i ].first == shard_num; i++ )
+      {
+         map< string, string >::const_iterator ci = s.values.find( names[ order[ i ].second ] );
+
+         if( ci != s.values.end( ) )
+            values[ order[ i ].second ] = ci->second;
+         else
+            values[ order[ i ].second ].erase( );
+      }
+   }
+}
+
+void variable_store::set( const string& name, const string& value )
+{
+   shard& s( p_impl->get_shard( name ) );
+   guard g( s.lock );
+
+   set_value( s, name, value );
+}
+
+void variable_store::set( const vector< pair< string, string > >& names_and_values )
+{
+   vector< pair< size_t, size_t > > order;
+   p_impl->get_shard_order( names_and_values, order );
+
+   for( size_t i = 0; i < order.size( ); )
+   {
+      shard& s( *p_impl->shards[ order[ i ].first ] );
+      guard g( s.lock );
+
+      // NOTE: As the sort is by shard and then by index any duplicate names will be set in the
+      // same order that they were provided in (so the last value provided for a name will win).
+      for( size_t shard_num = order[ i ].first; i < order.size( ) && order[ i ].first == shard_num; i++ )
+         set_value( s, names_and_values[ order[ i ].second ].first, names_and_values[ order[ i ].second ].second );
+   }
+}
+
+bool variable_store::set_if( const string& name, const string& value, const string& current )
+{
+   shard& s( p_impl->get_shard( name ) );
+   guard g( s.lock );
+
+   return set_value_if( s, name, value, current );
+}
+
+bool variable_store::set_if_when_changed( const string& name,
+ const string& value, const string& current, unsigned long timeout_msecs )
+{
+   shard& s( p_impl->get_shard( name ) );
+   guard g( s.lock );
+
+   unsigned long start = get_msecs( );
+
+   while( !set_value_if( s, name, value, current ) )
+   {
+      unsigned long elapsed = get_msecs( ) - start;
+
+      if( elapsed >= timeout_msecs )
+         return false;
+
+      ++s.num_waiters;
+      s.changed.wait( s.lock, timeout_msecs - elapsed );
+      --s.num_waiters;
+   }
+
+   return true;
+}
+
+string variable_store::adjust( const string& name, int amount )
+{
+   shard& s( p_impl->get_shard( name ) );
+   guard g( s.lock );
+
+   map< string, string >::const_iterator ci = s.values.find( name );
+
+   int num_value = ( ci == s.values.end( ) ) ? 0 : from_string< int >( ci->second );
+
+   if( amount > 0 )
+      num_value += amount;
+   else if( num_value > 0 )
+      num_value = max( num_value + amount, 0 );
+
+   string value;
+
+   if( num_value != 0 )
+      value = to_string( num_value );
+
+   set_value( s, name, value );
+
+   return value;
+}
+
+void variable_store::list( const string& wildcard_expr, vector< pair< string, string > >& names_and_values ) const
+{
+   names_and_values.clear( );
+
+   // NOTE: Scope for guard object.
+   {
+      all_shards_guard g( p_impl->shards );
+
+      for( size_t i = 0; i < p_impl->shards.size( ); i++ )
+      {
+         const map< string, string >& values( p_impl->shards[ i ]->values );
+
+         for( map< string, string >::const_iterator ci = values.begin( ); ci != values.end( ); ++ci )
+         {
+            if( wildcard_match( wildcard_expr, ci->first ) )
+               names_and_values.push_back( *ci );
+         }
+      }
+   }
+
+   sort( names_and_values.begin( ), names_and_values.end( ) );
+}
+
+void variable_store::list_lock_ids( ostream& outs, const string& label ) const
+{
+   // NOTE: Only the shards that are currently locked are output.
+   for( size_t i = 0; i < p_impl->shards.size( ); i++ )
+   {
+      thread_id lock_id( p_impl->shards[ i ]->lock.get_lock_id( ) );
+
+      if( lock_id != thread_id( ) )
+         outs << label << '[' << i << "] = " << lock_id << '\n';
+   }
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2012-2020 CIYAM Developers
+//
+// Distributed under the MIT/X11 software license, please refer to the file license.txt
+// in the root project directory or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef VARIABLE_STORE_H
+#  define VARIABLE_STORE_H
+
+#  ifndef HAS_PRECOMPILED_STD_HEADERS
+#     include <iosfwd>
+#     include <string>
+#     include <vector>
+#     include <utility>
+#  endif
+
+const size_t c_default_variable_store_shards = 16;
+
+// NOTE: A map of named string values that is split into shards (each with its own lock) so that
+// threads which are reading or writing different variables will rarely contend with each other.
+// An empty value is the same as the variable not existing (so setting a variable to an empty
+// value will remove it). Waiting for a variable to change is done using a condition per shard
+// which is only signalled if a thread is actually waiting for a variable in that shard.
+//
+// The bulk get and set functions will lock each shard just once (no matter how many variables
+// that shard is holding) and the list function locks all shards (in order) so that a consistent
+// snapshot is output (sorted by name).
+class variable_store
+{
+   public:
+   variable_store( size_t num_shards = c_default_variable_store_shards );
+   ~variable_store( );
+
+   size_t size( ) const;
+
+   bool has( const std::string& name ) const;
+
+   std::string get( const std::string& name ) const;
+
+   void get( const std::vector< std::string >& names, std::vector< std::string >& values ) const;
+
+   void set( const std::string& name, const std::string& value );
+
+   void set( const std::vector< std::pair< std::string, std::string > >& names_and_values );
+
+   // NOTE: Only sets the new value if the current value matches (returning false if it did not).
+   bool set_if( const std::string& name, const std::string& value, const std::string& current );
+
+   // NOTE: Same as "set_if" but if the current value does not match then will wait for the value
+   // to be changed (by another thread) and then try again until the timeout has been reached.
+   bool set_if_when_changed( const std::string& name,
+    const std::string& value, const std::string& current, unsigned long timeout_msecs );
+
+   // NOTE: Adds the amount to the integer value (treating a missing value as zero) and returns the
+   // result (a zero value will remove the variable). A negative amount will only be applied to a
+   // positive value and will not take it below zero (so an existing negative value is unchanged).
+   std::string adjust( const std::string& name, int amount );
+
+   void list( const std::string& wildcard_expr,
+    std::vector< std::pair< std::string, std::string > >& names_and_values ) const;
+
+   void list_lock_ids( std::ostream& outs, const std::string& label ) const;
+
+   private:
+   struct impl;
+   impl* p_impl;
+
+   variable_store( const variable_store& );
+   variable_store& operator =( const variable_store& );
+};
+
+#endif